@@ -27,6 +27,9 @@ and store it in the C<result>.
 For more information about the structure of the JSON representation, see
 the documentation at L<http://www.json.org/>.
 
+The C<JSONCodec> dynpmc in F<src/dynpmc/jsoncodec.pmc> builds the same values
+directly in C, and can parse large documents from a handle or in pieces.
+
 =cut
 
 .HLL 'data_json'
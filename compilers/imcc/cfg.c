@@ -96,22 +96,6 @@ static int check_invoke_type(
         __attribute__nonnull__(3)
         FUNC_MODIFIES(*imcc);
 
-static void free_dominance_frontiers(ARGMOD(IMC_Unit *unit))
-        __attribute__nonnull__(1)
-        FUNC_MODIFIES(*unit);
-
-static void free_dominators(ARGMOD(IMC_Unit *unit))
-        __attribute__nonnull__(1)
-        FUNC_MODIFIES(*unit);
-
-static void free_edge(ARGMOD(IMC_Unit *unit))
-        __attribute__nonnull__(1)
-        FUNC_MODIFIES(*unit);
-
-static void free_loops(ARGMOD(IMC_Unit *unit))
-        __attribute__nonnull__(1)
-        FUNC_MODIFIES(*unit);
-
 static void init_basic_blocks(
     ARGMOD(imc_info_t *imcc),
     ARGMOD(IMC_Unit *unit))
@@ -173,14 +157,6 @@ static void sort_loops(ARGMOD(imc_info_t *imcc), ARGIN(IMC_Unit *unit))
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit) \
     , PARROT_ASSERT_ARG(ins))
-#define ASSERT_ARGS_free_dominance_frontiers __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_free_dominators __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_free_edge __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_free_loops __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(unit))
 #define ASSERT_ARGS_init_basic_blocks __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
@@ -281,10 +257,13 @@ find_basic_blocks(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit), int first)
 
     ins = unit->instructions;
 
-    if (unit->type & IMC_PCCSUB) {
+    /* the blocks are found again after each optimization, but the params
+     * and return of the sub must be expanded only once */
+    if ((unit->type & IMC_PCCSUB) && (ins->type & ITPCCPARAM)) {
         IMCC_debug(imcc, DEBUG_CFG, "pcc_sub %s nparams %d\n",
                 ins->symregs[0]->name, ins->symregs[0]->pcc_sub->nargs);
         expand_pcc_sub(imcc, unit, ins);
+        ins->type &= ~ITPCCPARAM;
     }
 
     ins->index = i = 0;
@@ -564,7 +543,7 @@ bb_add_edge(ARGMOD(imc_info_t *imcc),
 
     /* we assume that the data is correct, and thus if the edge is not
      * on the predecessors of 'from', it won't be on the successors of 'to' */
-    e             = mem_gc_allocate_typed(imcc->interp, Edge);
+    e             = imc_arena_allocate_typed(imcc, &unit->cfg_arena, Edge);
 
     e->succ_next  = from->succ_list;
     e->from       = from;
@@ -590,7 +569,8 @@ bb_add_edge(ARGMOD(imc_info_t *imcc),
 
 =item C<static void bb_remove_edge(IMC_Unit *unit, Edge *edge)>
 
-Removes the given edge from the graph.
+Removes the given edge from the graph.  Its memory goes back with the rest of
+the CFG.
 
 =cut
 
@@ -626,14 +606,12 @@ bb_remove_edge(ARGMOD(IMC_Unit *unit), ARGMOD(Edge *edge))
 
     if (unit->edge_list == edge) {
         unit->edge_list = edge->next;
-        mem_sys_free(edge);
     }
     else {
         Edge *prev;
         for (prev = unit->edge_list; prev; prev = prev->next) {
             if (prev->next == edge) {
                 prev->next = edge->next;
-                mem_sys_free(edge);
                 break;
             }
         }
@@ -641,32 +619,6 @@ bb_remove_edge(ARGMOD(IMC_Unit *unit), ARGMOD(Edge *edge))
 }
 
 
-/*
-
-=item C<static void free_edge(IMC_Unit *unit)>
-
-Frees the memory of an IMC_Unit's edge list.
-
-=cut
-
-*/
-
-static void
-free_edge(ARGMOD(IMC_Unit *unit))
-{
-    ASSERT_ARGS(free_edge)
-    Edge *e;
-
-    for (e = unit->edge_list; e;) {
-        Edge * const next = e->next;
-        mem_sys_free(e);
-        e = next;
-    }
-
-    unit->edge_list = NULL;
-}
-
-
 /*
 
 =item C<int edge_count(const IMC_Unit *unit)>
@@ -715,6 +667,7 @@ compute_dominators(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 
 #if !USE_BFS
     int i, change, pred_index;
+    Set *s;
 #else
     int i, cur, len, succ_index;
     int *q;
@@ -723,24 +676,24 @@ compute_dominators(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
     int b, runner, wrong;
     Set **dominators;
 
-    const unsigned int n = unit->n_basic_blocks;
+    const unsigned int n     = unit->n_basic_blocks;
+    imc_arena_t * const arena = &unit->cfg_arena;
     IMCC_info(imcc, 2, "compute_dominators\n");
 
-    unit->idoms = mem_gc_allocate_n_zeroed_typed(imcc->interp, n, int);
-    dominators  = mem_gc_allocate_n_zeroed_typed(imcc->interp, n, Set *);
+    unit->idoms = imc_arena_allocate_n_typed(imcc, arena, n, int);
+    dominators  = imc_arena_allocate_n_typed(imcc, arena, n, Set *);
     unit->dominators = dominators;
 
-    dominators[0] = set_make(imcc, n);
+    dominators[0] = set_make_arena(imcc, arena, n);
     set_add(dominators[0], 0);
 
     for (i = n - 1; i; --i) {
-        if (unit->bb_list[i]->pred_list) {
-            dominators[i] = set_make_full(imcc, n);
-        }
-        else {
-            dominators[i] = set_make(imcc, n);
+        dominators[i] = set_make_arena(imcc, arena, n);
+
+        if (unit->bb_list[i]->pred_list)
+            set_fill(dominators[i]);
+        else
             set_add(dominators[i], i);
-        }
     }
 
 #if USE_BFS
@@ -769,15 +722,19 @@ compute_dominators(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 #else
     change = 1;
 
+    /* each pass works on a scratch set, swapped in when it differs */
+    s = set_make_arena(imcc, arena, n);
+
     while (change) {
         unsigned int i;
         change = 0;
 
         /* TODO: This 'for' should be a breadth-first search for speed */
         for (i = 1; i < n; i++) {
-            Set  * const s = set_copy(imcc, dominators[i]);
             Edge *edge;
 
+            set_copy_into(s, dominators[i]);
+
             for (edge = unit->bb_list[i]->pred_list;
                 edge;
                 edge = edge->pred_next) {
@@ -788,12 +745,11 @@ compute_dominators(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
             set_add(s, i);
 
             if (! set_equal(dominators[i], s)) {
-                change = 1;
-                set_free(dominators[i]);
-                dominators[i] = s;
+                Set * const old = dominators[i];
+                change          = 1;
+                dominators[i]   = s;
+                s               = old;
             }
-            else
-                set_free(s);
         }
     }
 #endif
@@ -854,12 +810,12 @@ compute_dominance_frontiers(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 
     const int n = unit->n_basic_blocks;
     Set ** const dominance_frontiers = unit->dominance_frontiers =
-            mem_gc_allocate_n_typed(imcc->interp, n, Set *);
+            imc_arena_allocate_n_typed(imcc, &unit->cfg_arena, n, Set *);
 
     IMCC_info(imcc, 2, "compute_dominance_frontiers\n");
 
     for (i = 0; i < n; i++) {
-        dominance_frontiers[i] = set_make(imcc, n);
+        dominance_frontiers[i] = set_make_arena(imcc, &unit->cfg_arena, n);
     }
 
     /* for all nodes, b */
@@ -898,61 +854,6 @@ compute_dominance_frontiers(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 }
 
 
-/*
-
-=item C<static void free_dominators(IMC_Unit *unit)>
-
-Frees the memory in the given unit related to all dominators.
-
-=cut
-
-*/
-
-static void
-free_dominators(ARGMOD(IMC_Unit *unit))
-{
-    ASSERT_ARGS(free_dominators)
-    if (unit->dominators) {
-        unsigned int i;
-
-        for (i = 0; i < unit->n_basic_blocks; i++) {
-            set_free(unit->dominators[i]);
-        }
-
-        mem_sys_free(unit->dominators);
-        unit->dominators = NULL;
-        mem_sys_free(unit->idoms);
-    }
-}
-
-
-/*
-
-=item C<static void free_dominance_frontiers(IMC_Unit *unit)>
-
-Frees the memory in the given unit related to all dominance frontiers.
-
-=cut
-
-*/
-
-static void
-free_dominance_frontiers(ARGMOD(IMC_Unit *unit))
-{
-    ASSERT_ARGS(free_dominance_frontiers)
-    if (unit->dominance_frontiers) {
-        unsigned int i;
-
-        for (i = 0; i < unit->n_basic_blocks; i++) {
-            set_free(unit->dominance_frontiers[i]);
-        }
-
-        mem_sys_free(unit->dominance_frontiers);
-        unit->dominance_frontiers = NULL;
-    }
-}
-
-
 /*
 
 =item C<static void sort_loops(imc_info_t *imcc, IMC_Unit *unit)>
@@ -1158,7 +1059,7 @@ mark_loop(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit), ARGIN(const Edge *e)
                 "\tcan't determine loop entry block (%d found)\n" , i);
     }
 
-    loop = set_make(imcc, unit->n_basic_blocks);
+    loop = set_make_arena(imcc, &unit->cfg_arena, unit->n_basic_blocks);
     set_add(loop, footer->index);
     set_add(loop, header->index);
 
@@ -1169,7 +1070,7 @@ mark_loop(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit), ARGIN(const Edge *e)
         search_predecessors_not_in(footer, loop);
     }
 
-    exits = set_make(imcc, unit->n_basic_blocks);
+    exits = set_make_arena(imcc, &unit->cfg_arena, unit->n_basic_blocks);
 
     for (i = 1; i < unit->n_basic_blocks; i++) {
         if (set_contains(loop, i)) {
@@ -1187,7 +1088,7 @@ mark_loop(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit), ARGIN(const Edge *e)
     n_loops   = unit->n_loops;
     loop_info = mem_gc_realloc_n_typed(imcc->interp, unit->loop_info,
                                        n_loops + 1, Loop_info *);
-    loop_info[n_loops] = mem_gc_allocate_typed(imcc->interp, Loop_info);
+    loop_info[n_loops] = imc_arena_allocate_typed(imcc, &unit->cfg_arena, Loop_info);
     loop_info[n_loops]->loop      = loop;
     loop_info[n_loops]->exits     = exits;
     loop_info[n_loops]->depth     = footer->loop_depth;
@@ -1201,35 +1102,6 @@ mark_loop(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit), ARGIN(const Edge *e)
 }
 
 
-/*
-
-=item C<static void free_loops(IMC_Unit *unit)>
-
-Frees the memory associated with the loops in this unit.
-
-=cut
-
-*/
-
-static void
-free_loops(ARGMOD(IMC_Unit *unit))
-{
-    ASSERT_ARGS(free_loops)
-    int i;
-
-    for (i = 0; i < unit->n_loops; i++) {
-        set_free(unit->loop_info[i]->loop);
-        set_free(unit->loop_info[i]->exits);
-        mem_sys_free(unit->loop_info[i]);
-    }
-
-    mem_sys_free(unit->loop_info);
-
-    unit->n_loops   = 0;
-    unit->loop_info = NULL;
-}
-
-
 /*
 
 =item C<void search_predecessors_not_in(const Basic_block *node, Set *s)>
@@ -1275,7 +1147,7 @@ init_basic_blocks(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 {
     ASSERT_ARGS(init_basic_blocks)
 
-    if (!unit->bb_list)
+    if (unit->bb_list)
         clear_basic_blocks(unit);
 
     unit->n_basic_blocks = 0;
@@ -1290,7 +1162,9 @@ init_basic_blocks(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 
 =item C<void clear_basic_blocks(IMC_Unit *unit)>
 
-Frees all of the blocks and CFG memory allocated for this unit.
+Frees all of the blocks and CFG memory allocated for this unit.  The blocks,
+edges, dominators and loops all live in the unit's CFG arena, which is given
+back in one go; its memory is then reused by the next CFG of the unit.
 
 =cut
 
@@ -1301,20 +1175,18 @@ clear_basic_blocks(ARGMOD(IMC_Unit *unit))
 {
     ASSERT_ARGS(clear_basic_blocks)
 
-    if (unit->bb_list) {
-        unsigned int i;
-
-        for (i = 0; i < unit->n_basic_blocks; i++)
-            mem_sys_free(unit->bb_list[i]);
-
-        mem_sys_free(unit->bb_list);
-        unit->bb_list = NULL;
-    }
-
-    free_edge(unit);
-    free_dominators(unit);
-    free_dominance_frontiers(unit);
-    free_loops(unit);
+    mem_sys_free(unit->bb_list);
+    mem_sys_free(unit->loop_info);
+    imc_arena_reset(&unit->cfg_arena);
+
+    unit->bb_list             = NULL;
+    unit->n_basic_blocks      = 0;
+    unit->edge_list           = NULL;
+    unit->dominators          = NULL;
+    unit->idoms               = NULL;
+    unit->dominance_frontiers = NULL;
+    unit->loop_info           = NULL;
+    unit->n_loops             = 0;
 }
 
 
@@ -1336,7 +1208,7 @@ make_basic_block(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
         ARGMOD(Instruction *ins))
 {
     ASSERT_ARGS(make_basic_block)
-    Basic_block * const bb = mem_gc_allocate_typed(imcc->interp, Basic_block);
+    Basic_block * const bb = imc_arena_allocate_typed(imcc, &unit->cfg_arena, Basic_block);
     int n = unit->n_basic_blocks;
 
     bb->start      = ins;
@@ -53,6 +53,12 @@ static IMC_Unit * imc_new_unit(ARGMOD(imc_info_t * imcc), IMC_Unit_Type t)
 
 #define COMPILE_IMMEDIATE 1
 
+/* Arena blocks are this big unless an allocation needs more; allocations are
+ * rounded up to keep the memory they return aligned. */
+#define ARENA_BLOCK_SIZE  8192
+#define ARENA_ALIGN(n)    (((n) + sizeof (void *) - 1) & ~(sizeof (void *) - 1))
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof (imc_arena_block_t))
+
 /*
 
 =item C<void imc_compile_all_units(imc_info_t * imcc)>
@@ -115,7 +121,7 @@ on a single compilation unit at a time.
 */
 
 void
-imc_compile_unit(ARGMOD(imc_info_t * imcc), ARGIN(IMC_Unit *unit))
+imc_compile_unit(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
 {
     ASSERT_ARGS(imc_compile_unit)
     /* Not much here for now except the allocator */
@@ -123,6 +129,10 @@ imc_compile_unit(ARGMOD(imc_info_t * imcc), ARGIN(IMC_Unit *unit))
 
     imc_reg_alloc(imcc, unit);
     emit_flush(imcc, NULL, unit);
+
+    /* the CFG isn't needed once the unit is emitted */
+    clear_basic_blocks(unit);
+    imc_arena_destroy(&unit->cfg_arena);
 }
 
 
@@ -272,10 +282,118 @@ imc_free_unit(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
     if (unit->instance_of)
         mem_sys_free(unit->instance_of);
 
+    imc_arena_destroy(&unit->cfg_arena);
     mem_sys_free(unit->hash.data);
     mem_sys_free(unit);
 }
 
+
+/*
+
+=item C<void * imc_arena_allocate(imc_info_t * imcc, imc_arena_t *arena, size_t
+size)>
+
+Returns C<size> bytes of zeroed memory from C<arena>.  The memory can't be
+freed on its own; it stays valid until the arena is reset or destroyed.
+
+=cut
+
+*/
+
+PARROT_MALLOC
+PARROT_CANNOT_RETURN_NULL
+void *
+imc_arena_allocate(ARGMOD(imc_info_t * imcc), ARGMOD(imc_arena_t *arena), size_t size)
+{
+    ASSERT_ARGS(imc_arena_allocate)
+    imc_arena_block_t *block = arena->blocks;
+    char              *mem;
+
+    size = ARENA_ALIGN(size);
+
+    if (!block || block->used + size > block->size) {
+        imc_arena_block_t **prev = &arena->spare;
+
+        /* take an emptied block if one is big enough, or else a new one */
+        while (*prev && (*prev)->size < size)
+            prev = &(*prev)->next;
+
+        if (*prev) {
+            block = *prev;
+            *prev = block->next;
+        }
+        else {
+            const size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+            block       = (imc_arena_block_t *)mem_gc_allocate_n_typed(imcc->interp,
+                    ARENA_HEADER_SIZE + block_size, char);
+            block->size = block_size;
+        }
+
+        block->used   = 0;
+        block->next   = arena->blocks;
+        arena->blocks = block;
+    }
+
+    mem          = (char *)block + ARENA_HEADER_SIZE + block->used;
+    block->used += size;
+
+    memset(mem, 0, size);
+
+    return mem;
+}
+
+
+/*
+
+=item C<void imc_arena_reset(imc_arena_t *arena)>
+
+Gives back all of the memory allocated from C<arena> at once.  The blocks are
+kept, to be reused by the next allocations.
+
+=cut
+
+*/
+
+void
+imc_arena_reset(ARGMOD(imc_arena_t *arena))
+{
+    ASSERT_ARGS(imc_arena_reset)
+
+    while (arena->blocks) {
+        imc_arena_block_t * const block = arena->blocks;
+
+        arena->blocks = block->next;
+        block->next   = arena->spare;
+        arena->spare  = block;
+    }
+}
+
+
+/*
+
+=item C<void imc_arena_destroy(imc_arena_t *arena)>
+
+Frees all of the blocks of C<arena>.
+
+=cut
+
+*/
+
+void
+imc_arena_destroy(ARGMOD(imc_arena_t *arena))
+{
+    ASSERT_ARGS(imc_arena_destroy)
+
+    imc_arena_reset(arena);
+
+    while (arena->spare) {
+        imc_arena_block_t * const next = arena->spare->next;
+
+        mem_sys_free(arena->spare);
+        arena->spare = next;
+    }
+}
+
 /*
 
 =back
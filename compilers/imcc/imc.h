@@ -44,6 +44,24 @@ typedef struct _imc_info_t imc_info_t;
    are used in an embedding situation. */
 #define IMCC_IMC_H_HAVE_TYPEDEFS
 
+/* A bump-pointer arena: memory is carved out of large blocks and only given
+ * back all at once, by imc_arena_reset or imc_arena_destroy. */
+typedef struct imc_arena_block_t {
+    struct imc_arena_block_t *next;
+    size_t                    size;     /* bytes of memory after the header */
+    size_t                    used;
+} imc_arena_block_t;
+
+typedef struct imc_arena_t {
+    imc_arena_block_t *blocks;          /* blocks in use, the newest first */
+    imc_arena_block_t *spare;           /* blocks emptied by a reset */
+} imc_arena_t;
+
+#define imc_arena_allocate_typed(imcc, arena, type) \
+    ((type *)imc_arena_allocate((imcc), (arena), sizeof (type)))
+#define imc_arena_allocate_n_typed(imcc, arena, n, type) \
+    ((type *)imc_arena_allocate((imcc), (arena), (n) * sizeof (type)))
+
 #include "imcc/yyscanner.h"
 #include "symreg.h"
 #include "instructions.h"
@@ -114,6 +132,25 @@ Instruction * INS_LABEL(
 /* HEADERIZER BEGIN: compilers/imcc/imc.c */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
+PARROT_MALLOC
+PARROT_CANNOT_RETURN_NULL
+void * imc_arena_allocate(
+    ARGMOD(imc_info_t * imcc),
+    ARGMOD(imc_arena_t *arena),
+    size_t size)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(* imcc)
+        FUNC_MODIFIES(*arena);
+
+void imc_arena_destroy(ARGMOD(imc_arena_t *arena))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*arena);
+
+void imc_arena_reset(ARGMOD(imc_arena_t *arena))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*arena);
+
 void imc_cleanup(ARGMOD(imc_info_t * imcc), ARGIN_NULLOK(void *yyscanner))
         __attribute__nonnull__(1)
         FUNC_MODIFIES(* imcc);
@@ -126,16 +163,24 @@ void imc_compile_all_units(ARGMOD(imc_info_t * imcc))
         __attribute__nonnull__(1)
         FUNC_MODIFIES(* imcc);
 
-void imc_compile_unit(ARGMOD(imc_info_t * imcc), ARGIN(IMC_Unit *unit))
+void imc_compile_unit(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        FUNC_MODIFIES(* imcc);
+        FUNC_MODIFIES(* imcc)
+        FUNC_MODIFIES(*unit);
 
 PARROT_CANNOT_RETURN_NULL
 IMC_Unit * imc_open_unit(ARGMOD(imc_info_t * imc_info), IMC_Unit_Type t)
         __attribute__nonnull__(1)
         FUNC_MODIFIES(* imc_info);
 
+#define ASSERT_ARGS_imc_arena_allocate __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(arena))
+#define ASSERT_ARGS_imc_arena_destroy __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(arena))
+#define ASSERT_ARGS_imc_arena_reset __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(arena))
 #define ASSERT_ARGS_imc_cleanup __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc))
 #define ASSERT_ARGS_imc_close_unit __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -388,6 +433,7 @@ typedef enum _enum_opt {
     OPT_PRE,
     OPT_CFG  = 0x002,
     OPT_SUB  = 0x004,
+    OPT_LOOP = 0x008,
     OPT_PASM = 0x100,
     OPT_J    = 0x200
 } enum_opt_t;
@@ -426,6 +472,7 @@ typedef struct subs_t {
     int            pmc_const;          /* sub pmc index in const table */
     int            lexinfo_const;      /* lexinfo pmc index in const table */
     size_t         size;               /* code size in ops */
+    struct subs_t *same_name;          /* next sub with the same name */
 } subs_t;
 
 /* subs are kept per code segment */
@@ -437,6 +484,8 @@ typedef struct code_segment_t {
     struct code_segment_t *prev;          /* previous code segment */
     struct code_segment_t *next;          /* next code segment */
     SymHash                key_consts;    /* this seg's cached key constants */
+    size_t                 size;          /* code size of its subs in ops */
+    int                    ins_line;      /* lines of its subs, for debug */
 } code_segment_t;
 
 typedef struct _imcc_globals_t {
@@ -482,6 +531,9 @@ struct _imc_info_t {
     SymReg               *keys[IMCC_MAX_FIX_REGS]; /* TODO key overflow check */
     AsmState              asm_state;
     SymHash               ghash;
+    SymReg              **unfolded;          /* ghash symbols not yet folded */
+    unsigned int          n_unfolded;
+    unsigned int          unfolded_size;
     jmp_buf               jump_buf;          /* The jump for error  handling */
     int                   IMCC_DEBUG;
     int                   cnr;
@@ -236,7 +236,10 @@ imcc_set_verbosity(ARGMOD(imc_info_t *imcc), INTVAL verbose)
 
 =item C<void imcc_set_optimization_level(imc_info_t *imcc, const char *opts)>
 
-Set the optimization level. C<opts> is a string with character code flags.
+Set the optimization level. C<opts> is a string with character code flags:
+C<1> runs the optimizations which don't need the CFG, C<2> adds those which
+do, and C<3> adds loop-invariant code motion. C<p> and C<c> enable OPT_PASM
+and OPT_SUB. C<0> changes nothing.
 
 =cut
 
@@ -263,6 +266,9 @@ imcc_set_optimization_level(ARGMOD(imc_info_t *imcc), ARGIN(const char *opts))
     if (strchr(opts, '2')) {
         imcc->optimizer_level |= (OPT_PRE | OPT_CFG);
     }
+    if (strchr(opts, '3')) {
+        imcc->optimizer_level |= (OPT_PRE | OPT_CFG | OPT_LOOP);
+    }
 }
 
 /*
@@ -42,6 +42,11 @@ unused labels and dead_code_remove() to remove unreachable code
 cfg_optimize may be called multiple times during the construction of the
 CFG depending on whether or not it finds anything to optimize.
 
+The scheduler runs its tasks, such as callbacks and alarms, only at C<branch>
+ops, so none of these may remove a C<branch> back to an earlier label or make
+a conditional branch jump back without passing one. A loop would never let
+the tasks it waits for run.
+
 subst_constants ... rewrite e.g. add_i_ic_ic
 
 optimizer
@@ -49,9 +54,25 @@ optimizer
 
 runs with CFG and life info
 
-used_once ... deletes assignments, when LHS is unused
+constant_propagation ... propagates constants within a basic block
+
+The global optimizations work on the I, N and S registers which are assigned
+by a single instruction dominating all of their reads. Such a register holds
+the same value wherever it is read, as in SSA form, without renaming the
+registers and inserting phi functions, which would have to be undone before
+register allocation. PMC registers are left alone, as the PMCs they refer to
+can change behind their backs, except by scalar_replacement.
+
+value_numbering ... replaces recomputations of a value by copies
+
+copy_propagation ... reads the source of a copy instead of the copy
 
-constant_propagation
+dead_store_remove ... deletes assignments, when LHS is unused
+
+scalar_replacement ... replaces Integer and Float PMCs which never escape by
+I and N registers
+
+loop_invariant_motion ... moves invariant computations out of loops (-O3)
 
 post_optimizer: currently pcc_optimize in pcc.c
 ---------------
@@ -77,6 +98,36 @@ e.g. eliminate new Px .PerlUndef because Px where different before
 
 /* HEADERIZER HFILE: compilers/imcc/optimizer.h */
 
+/* what the global optimizations know of a register of a unit */
+typedef struct opt_reg_t {
+    const SymReg *r;
+    Instruction  *def;          /* the instruction assigning it, if only one */
+    Instruction  *seen;         /* the last instruction noted */
+    SymReg       *copy_of;      /* the register or constant it is a copy of */
+    unsigned int  n_defs;       /* instructions assigning it */
+    unsigned int  n_reads;      /* instructions reading it */
+    int           single;       /* assigned once, before all of its reads */
+    int           keyed;        /* read in a key, so it can't be replaced */
+    int           native;       /* 'I' or 'N' if a native register can replace
+                                 * the PMC it holds */
+    SymReg       *scalar;       /* that register */
+} opt_reg_t;
+
+/* the registers of a unit, and the blocks a handler can enter */
+typedef struct opt_info_t {
+    IMC_Unit     *unit;
+    opt_reg_t    *regs;         /* sorted by the address of the register */
+    unsigned int  n_regs;
+    Set          *exceptional;  /* blocks reachable from a handler */
+} opt_info_t;
+
+/* an instruction in the table of value_numbering */
+typedef struct vn_entry_t {
+    struct vn_entry_t *next;
+    Instruction       *ins;
+    const SymReg      *args[2]; /* its operands, commutative ones sorted */
+} vn_entry_t;
+
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
@@ -86,46 +137,43 @@ static int branch_branch(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
-static int branch_cond_loop(
-    ARGMOD(imc_info_t *imcc),
-    ARGMOD(IMC_Unit *unit))
+PARROT_WARN_UNUSED_RESULT
+static int branch_reorg(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
 PARROT_WARN_UNUSED_RESULT
-static int branch_cond_loop_swap(
+static int build_opt_info(
     ARGMOD(imc_info_t *imcc),
     ARGMOD(IMC_Unit *unit),
-    ARGMOD(Instruction *branch),
-    ARGMOD(Instruction *start),
-    ARGMOD(Instruction *cond))
+    ARGOUT(opt_info_t *info))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
         __attribute__nonnull__(3)
-        __attribute__nonnull__(4)
-        __attribute__nonnull__(5)
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit)
-        FUNC_MODIFIES(*branch)
-        FUNC_MODIFIES(*start)
-        FUNC_MODIFIES(*cond);
+        FUNC_MODIFIES(*info);
 
-PARROT_WARN_UNUSED_RESULT
-static int branch_reorg(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
+static int constant_propagation(
+    ARGMOD(imc_info_t *imcc),
+    ARGMOD(IMC_Unit *unit))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
-static int constant_propagation(
+static int copy_propagation(
     ARGMOD(imc_info_t *imcc),
-    ARGMOD(IMC_Unit *unit))
+    ARGMOD(IMC_Unit *unit),
+    ARGMOD(opt_info_t *info))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
         FUNC_MODIFIES(*imcc)
-        FUNC_MODIFIES(*unit);
+        FUNC_MODIFIES(*unit)
+        FUNC_MODIFIES(*info);
 
 static int dead_code_remove(
     ARGMOD(imc_info_t *imcc),
@@ -135,6 +183,16 @@ static int dead_code_remove(
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
+static int dead_store_remove(
+    ARGMOD(imc_info_t *imcc),
+    ARGMOD(IMC_Unit *unit),
+    ARGIN(const opt_info_t *info))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*imcc)
+        FUNC_MODIFIES(*unit);
+
 PARROT_WARN_UNUSED_RESULT
 static int eval_ins(
     ARGMOD(imc_info_t *imcc),
@@ -146,12 +204,95 @@ static int eval_ins(
         __attribute__nonnull__(4)
         FUNC_MODIFIES(*imcc);
 
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static opt_reg_t * find_opt_reg(
+    ARGIN(const opt_info_t *info),
+    ARGIN(const SymReg *r))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
 static int if_branch(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
+PARROT_WARN_UNUSED_RESULT
+static int ins_dominates(
+    ARGIN(const IMC_Unit *unit),
+    ARGIN(const Instruction *a),
+    ARGIN(const Instruction *b))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+PARROT_WARN_UNUSED_RESULT
+static int is_pure_ins(ARGIN(const Instruction *ins))
+        __attribute__nonnull__(1);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_PURE_FUNCTION
+static int label_before(
+    ARGIN(const Instruction *ins),
+    ARGIN(const SymReg *label))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static int loop_invariant_motion(
+    ARGMOD(imc_info_t *imcc),
+    ARGMOD(IMC_Unit *unit),
+    ARGIN(const opt_info_t *info))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*imcc)
+        FUNC_MODIFIES(*unit);
+
+static void note_ins(
+    ARGMOD(opt_info_t *info),
+    ARGIN(Instruction *ins),
+    int check)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*info);
+
+static void note_reg(
+    ARGMOD(opt_info_t *info),
+    ARGIN(Instruction *ins),
+    ARGIN(const SymReg *r),
+    int keyed,
+    int check)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*info);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_PURE_FUNCTION
+static int opt_reg_cmp(ARGIN(const void *a), ARGIN(const void *b))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static int scalar_replacement(
+    ARGMOD(imc_info_t *imcc),
+    ARGMOD(IMC_Unit *unit),
+    ARGMOD(opt_info_t *info))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*imcc)
+        FUNC_MODIFIES(*unit)
+        FUNC_MODIFIES(*info);
+
+PARROT_WARN_UNUSED_RESULT
+static int single_operands(
+    ARGIN(const opt_info_t *info),
+    ARGIN(const Instruction *ins),
+    int result)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
 static int strength_reduce(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
@@ -165,49 +306,90 @@ static int unused_label(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
-static int used_once(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
+static int value_numbering(
+    ARGMOD(imc_info_t *imcc),
+    ARGMOD(IMC_Unit *unit),
+    ARGIN(const opt_info_t *info))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
         FUNC_MODIFIES(*imcc)
         FUNC_MODIFIES(*unit);
 
 #define ASSERT_ARGS_branch_branch __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_branch_cond_loop __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+#define ASSERT_ARGS_branch_reorg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_branch_cond_loop_swap __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+#define ASSERT_ARGS_build_opt_info __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit) \
-    , PARROT_ASSERT_ARG(branch) \
-    , PARROT_ASSERT_ARG(start) \
-    , PARROT_ASSERT_ARG(cond))
-#define ASSERT_ARGS_branch_reorg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(imcc) \
-    , PARROT_ASSERT_ARG(unit))
+    , PARROT_ASSERT_ARG(info))
 #define ASSERT_ARGS_constant_propagation __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
+#define ASSERT_ARGS_copy_propagation __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(unit) \
+    , PARROT_ASSERT_ARG(info))
 #define ASSERT_ARGS_dead_code_remove __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
+#define ASSERT_ARGS_dead_store_remove __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(unit) \
+    , PARROT_ASSERT_ARG(info))
 #define ASSERT_ARGS_eval_ins __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(op) \
     , PARROT_ASSERT_ARG(r))
+#define ASSERT_ARGS_find_opt_reg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(info) \
+    , PARROT_ASSERT_ARG(r))
 #define ASSERT_ARGS_if_branch __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
+#define ASSERT_ARGS_ins_dominates __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(unit) \
+    , PARROT_ASSERT_ARG(a) \
+    , PARROT_ASSERT_ARG(b))
+#define ASSERT_ARGS_is_pure_ins __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ins))
+#define ASSERT_ARGS_label_before __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ins) \
+    , PARROT_ASSERT_ARG(label))
+#define ASSERT_ARGS_loop_invariant_motion __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(unit) \
+    , PARROT_ASSERT_ARG(info))
+#define ASSERT_ARGS_note_ins __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(info) \
+    , PARROT_ASSERT_ARG(ins))
+#define ASSERT_ARGS_note_reg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(info) \
+    , PARROT_ASSERT_ARG(ins) \
+    , PARROT_ASSERT_ARG(r))
+#define ASSERT_ARGS_opt_reg_cmp __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(a) \
+    , PARROT_ASSERT_ARG(b))
+#define ASSERT_ARGS_scalar_replacement __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(unit) \
+    , PARROT_ASSERT_ARG(info))
+#define ASSERT_ARGS_single_operands __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(info) \
+    , PARROT_ASSERT_ARG(ins))
 #define ASSERT_ARGS_strength_reduce __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
 #define ASSERT_ARGS_unused_label __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_used_once __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+#define ASSERT_ARGS_value_numbering __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
-    , PARROT_ASSERT_ARG(unit))
+    , PARROT_ASSERT_ARG(unit) \
+    , PARROT_ASSERT_ARG(info))
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 /* HEADERIZER END: static */
 
@@ -259,8 +441,6 @@ cfg_optimize(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         IMCC_info(imcc, 2, "cfg_optimize\n");
         if (branch_branch(imcc, unit))
             return 1;
-        if (branch_cond_loop(imcc, unit))
-            return 1;
         if (branch_reorg(imcc, unit))
             return 1;
         if (unused_label(imcc, unit))
@@ -275,9 +455,13 @@ cfg_optimize(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 
 =item C<int optimize(imc_info_t *imcc, IMC_Unit *unit)>
 
-Runs after the CFG is built and handles constant propagation.
+Runs after the CFG is built and handles constant propagation, then the global
+optimizations: value numbering, copy propagation, dead store removal, scalar
+replacement of PMCs and, with OPT_LOOP, loop-invariant code motion. Each of
+them runs only if the ones before it changed nothing, as the CFG has to be
+built again after a change.
 
-used_once ... deletes assignments, when LHS is unused
+Returns TRUE if any optimization was performed.
 
 =cut
 
@@ -287,14 +471,29 @@ int
 optimize(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 {
     ASSERT_ARGS(optimize)
-    int any = 0;
     if (imcc->optimizer_level & OPT_CFG) {
+        opt_info_t info;
+
         IMCC_info(imcc, 2, "optimize\n");
-        any = constant_propagation(imcc, unit);
-        if (used_once(imcc, unit))
+        if (constant_propagation(imcc, unit))
+            return 1;
+
+        if (!build_opt_info(imcc, unit, &info))
+            return 0;
+
+        if (value_numbering(imcc, unit, &info))
+            return 1;
+        if (copy_propagation(imcc, unit, &info))
+            return 1;
+        if (dead_store_remove(imcc, unit, &info))
+            return 1;
+        if (scalar_replacement(imcc, unit, &info))
+            return 1;
+        if ((imcc->optimizer_level & OPT_LOOP)
+        &&  loop_invariant_motion(imcc, unit, &info))
             return 1;
     }
-    return any;
+    return 0;
 }
 
 /*
@@ -339,6 +538,31 @@ get_neg_op(ARGIN(const char *op), ARGOUT(int *n))
  */
 /*
 
+=item C<static int label_before(const Instruction *ins, const SymReg *label)>
+
+Returns whether C<label> is defined before instruction C<ins>, so a jump
+there from C<ins> goes back.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_PURE_FUNCTION
+static int
+label_before(ARGIN(const Instruction *ins), ARGIN(const SymReg *label))
+{
+    ASSERT_ARGS(label_before)
+
+    for (ins = ins->prev; ins; ins = ins->prev)
+        if ((ins->type & ITLABEL) && STREQ(ins->symregs[0]->name, label->name))
+            return 1;
+
+    return 0;
+}
+
+/*
+
 =item C<static int if_branch(imc_info_t *imcc, IMC_Unit *unit)>
 
 Convert if/branch/label constructs of the form:
@@ -374,7 +598,8 @@ if_branch(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
             SymReg * const br_dest = last->symregs[reg];
             if (ins->next &&
                     (ins->next->type & ITLABEL) &&    /* L1 */
-                    ins->next->symregs[0] == br_dest) {
+                    ins->next->symregs[0] == br_dest &&
+                    !label_before(ins, get_branch_reg(ins))) {
                 const char * neg_op;
                 SymReg * const go = get_branch_reg(ins);
                 int args;
@@ -660,7 +885,9 @@ strength_reduce(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 
 Does conservative constant propagation.
 This code will not propagate constants past labels or saves,
-even though sometimes it may be safe.
+even though sometimes it may be safe. Nor does it propagate them past sub
+calls, their arguments and results, or C<push_eh>, as the registers these
+assign or read aren't operands of their ops.
 
 =cut
 
@@ -670,6 +897,7 @@ static int
 constant_propagation(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 {
     ASSERT_ARGS(constant_propagation)
+    op_lib_t * const core_ops = PARROT_GET_CORE_OPLIB(imcc->interp);
     Instruction *ins;
     SymReg *c, *o;
     int any = 0;
@@ -682,6 +910,7 @@ constant_propagation(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         if (STREQ(ins->opname, "set") &&
                 ins->opsize == 3 &&             /* no keyed set */
                 ins->symregs[1]->type == VTCONST &&
+                ins->symregs[1]->set == ins->symregs[0]->set && /* no conversion */
                 ins->symregs[0]->set != 'P') {        /* no PMC consts */
             found = 1;
             c = ins->symregs[1];
@@ -704,6 +933,13 @@ constant_propagation(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
                 if (ins2->bbindex != ins->bbindex)
                     /* restrict to within a basic block */
                     goto next_constant;
+                if ((ins2->type & (ITPCCSUB | ITPCCYIELD))
+                ||  ins2->op == &core_ops->op_info_table[PARROT_OP_set_args_pc]
+                ||  ins2->op == &core_ops->op_info_table[PARROT_OP_get_results_pc]
+                ||  ins2->op == &core_ops->op_info_table[PARROT_OP_get_params_pc]
+                ||  ins2->op == &core_ops->op_info_table[PARROT_OP_set_returns_pc]
+                ||  STREQ(ins2->opname, "push_eh"))
+                    goto next_constant;
                 /* was opsize - 2, changed to n_r - 1
                  */
                 for (i = ins2->symreg_count - 1; i >= 0; i--) {
@@ -724,21 +960,32 @@ constant_propagation(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
                                 unit, ins2->opname, ins2->symregs, ins2->opsize,
                                 &found);
                             if (found) {
-                                const Instruction * const prev = ins2->prev;
+                                Instruction * const prev = ins2->prev;
                                 if (prev) {
-                                    subst_ins(unit, ins2, tmp, 1);
+                                    /* a branch which is never taken is gone */
+                                    if (tmp) {
+                                        subst_ins(unit, ins2, tmp, 1);
+                                        IMCC_debug(imcc, DEBUG_OPT2,
+                                                " reduced to %d\n", tmp);
+                                    }
+                                    else {
+                                        ins2 = delete_ins(unit, ins2);
+                                        IMCC_debug(imcc, DEBUG_OPT2,
+                                                " deleted\n");
+                                    }
                                     any = 1;
-                                    IMCC_debug(imcc, DEBUG_OPT2,
-                                            " reduced to %d\n", tmp);
-                                    ins2 = prev->next;
+                                    ins2 = prev;
+                                    break;
                                 }
                             }
                             else {
+                                op_info_t * const op = ins2->op;
                                 char fullname[128];
                                 check_op(imcc, &ins2->op, fullname, ins2->opname,
                                     ins2->symregs, ins2->symreg_count, ins2->keys);
                                 if (!ins2->op) {
                                     ins2->symregs[i] = old;
+                                    ins2->op         = op;
                                     IMCC_debug(imcc, DEBUG_OPT2,
                                             " - no %s\n", fullname);
                                 }
@@ -1132,7 +1379,9 @@ branch_branch(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
                 if (next &&
                         (next->type & IF_goto) &&
                         STREQ(next->opname, "branch") &&
-                        !STREQ(next->symregs[0]->name, get_branch_reg(ins)->name)) {
+                        !STREQ(next->symregs[0]->name, get_branch_reg(ins)->name) &&
+                        (STREQ(ins->opname, "branch") ||
+                         !label_before(ins, next->symregs[0]))) {
                     const int regno = get_branch_regno(ins);
                     IMCC_debug(imcc, DEBUG_OPT1,
                             "found branch to branch '%s' %d\n",
@@ -1187,7 +1436,8 @@ branch_reorg(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
         if ((ins->type & IF_goto) && STREQ(ins->opname, "branch")) {
             SymReg * const r = get_sym(imcc, ins->symregs[0]->name);
 
-            if (r && (r->type & VTADDRESS) && r->first_ins) {
+            if (r && (r->type & VTADDRESS) && r->first_ins
+            &&  r->first_ins->index > ins->index) {
                 Edge               *edge;
                 Instruction * const start = r->first_ins;
                 int                 found = 0;
@@ -1246,172 +1496,6 @@ branch_reorg(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 
 /*
 
-=item C<static int branch_cond_loop_swap(imc_info_t *imcc, IMC_Unit *unit,
-Instruction *branch, Instruction *start, Instruction *cond)>
-
-Converts conditional loops to post-test
-
-Returns TRUE if any optimizations were performed. Otherwise, returns
-FALSE.
-
-=cut
-
-*/
-
-PARROT_WARN_UNUSED_RESULT
-static int
-branch_cond_loop_swap(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit), ARGMOD(Instruction *branch),
-        ARGMOD(Instruction *start), ARGMOD(Instruction *cond))
-{
-    ASSERT_ARGS(branch_cond_loop_swap)
-    int changed = 0;
-    int args;
-    const char * const neg_op = get_neg_op(cond->opname, &args);
-    if (neg_op) {
-        const size_t size  = strlen(branch->symregs[0]->name) + 10; /* + '_post999' */
-        char * const label = (char *)mem_sys_allocate(size);
-        int count;
-        int found = 0;
-
-        for (count = 1; count != 999; ++count) {
-            snprintf(label, size, "%s_post%d", branch->symregs[0]->name, count);
-            if (get_sym(imcc, label) == NULL) {
-                found = 1;
-                break;
-            }
-        }
-
-        if (found) {
-            Instruction *tmp;
-            SymReg *regs[3], *r;
-            int reg_index;
-
-            /* cond_op has 2 or 3 args */
-            PARROT_ASSERT(args <= 3);
-
-            r = mk_local_label(imcc, label);
-            tmp = INS_LABEL(imcc, unit, r, 0);
-            insert_ins(unit, cond, tmp);
-
-            for (start = start->next; start != cond; start = start->next) {
-                if (!(start->type & ITLABEL)) {
-                    tmp = INS(imcc, unit, start->opname, "",
-                        start->symregs, start->symreg_count, start->keys, 0);
-                    prepend_ins(unit, branch, tmp);
-                }
-            }
-
-            for (count = 0; count != args; ++count) {
-                regs[count] = cond->symregs[count];
-            }
-
-            reg_index = get_branch_regno(cond);
-            if (reg_index < 0)
-                Parrot_ex_throw_from_c_args(imcc->interp, NULL, 1,
-                    "Negative branch register address detected");
-
-            regs[reg_index] = mk_label_address(imcc, label);
-            tmp = INS(imcc, unit, (const char*)neg_op, "", regs, args, 0, 0);
-
-            IMCC_debug(imcc, DEBUG_OPT1,
-                "loop %s -> %s converted to post-test, added label %s\n",
-                branch->symregs[0]->name, get_branch_reg(cond)->name, label);
-
-            subst_ins(unit, branch, tmp, 1);
-            unit->ostat.branch_cond_loop++;
-            changed = 1;
-        }
-
-        mem_sys_free(label);
-    }
-
-    return changed;
-}
-
-/*
-
-=item C<static int branch_cond_loop(imc_info_t *imcc, IMC_Unit *unit)>
-
-start:           => start:
-if cond goto end    if cond goto end
-...
-branch start        start_post1:
-end:                ...
-                    unless cond goto start_post562
-                    end:
-
-The basic premise is "branch (A) to conditional (B), where B goes to
-just after A."
-
-Returns TRUE if any optimizations were performed. Otherwise, returns
-FALSE.
-
-=cut
-
-*/
-
-static int
-branch_cond_loop(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
-{
-    ASSERT_ARGS(branch_cond_loop)
-    Instruction *ins, *cond, *start, *prev;
-    int changed = 0, found;
-
-    IMCC_info(imcc, 2, "\tbranch_cond_loop\n");
-    /* reset statistic globals */
-
-    for (ins = unit->instructions; ins; ins = ins->next) {
-        if ((ins->type & IF_goto) && STREQ(ins->opname, "branch")) {
-            /* get `end` label */
-            Instruction * const end = ins->next;
-            /* get `start` label */
-            SymReg * const r = get_sym(imcc, ins->symregs[0]->name);
-
-            if (end && (end->type & ITLABEL) &&
-                r && (r->type & VTADDRESS) && r->first_ins) {
-
-                start = r->first_ins;
-                found = 0;
-
-                for (cond = start->next; cond; cond = cond->next) {
-                    /* no good if it's an unconditional branch*/
-                    if (cond->type & IF_goto && STREQ(cond->opname, "branch")) {
-                        break;
-                    }
-                    else if ((cond->type & ITPCCRET) || (cond->type & ITPCCSUB)
-                            || (cond->type & ITCALL)) {
-                        break;
-                        /* just until we can copy set_args et al */
-                    }
-                    else if ((cond->type & ITBRANCH) && (get_branch_regno(cond) >= 0)) {
-                        found = 1;
-                        break;
-                    }
-                }
-
-                if (found) {
-                    const char * const lbl = get_branch_reg(cond)->name;
-                    const SymReg * const r = get_sym(imcc, lbl);
-                    if (r && (r->type & VTADDRESS) && r->first_ins == end) {
-                        /* the current ins is replaced - remember prev
-                         * and set ins again after the changes
-                         */
-                        prev = ins->prev;
-                        if (!prev)
-                            continue;
-                        changed |= branch_cond_loop_swap(imcc,
-                                unit, ins, start, cond);
-                        ins = prev->next;
-                    }
-                }
-            }
-        }
-    }
-    return changed;
-}
-
-/*
-
 =item C<static int unused_label(imc_info_t *imcc, IMC_Unit *unit)>
 
 Removes unused labels.
@@ -1573,41 +1657,926 @@ dead_code_remove(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
 /* optimizations with CFG & life info built */
 /*
 
-=item C<static int used_once(imc_info_t *imcc, IMC_Unit *unit)>
+=item C<static int opt_reg_cmp(const void *a, const void *b)>
 
-used_once ... deletes assignments, when LHS is unused
+Compares two C<opt_reg_t> by the address of their register, for sorting and
+searching the registers of an C<opt_info_t>.
 
 =cut
 
 */
 
+PARROT_WARN_UNUSED_RESULT
+PARROT_PURE_FUNCTION
 static int
-used_once(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit))
+opt_reg_cmp(ARGIN(const void *a), ARGIN(const void *b))
 {
-    ASSERT_ARGS(used_once)
-    Instruction *ins;
-    int opt = 0;
+    ASSERT_ARGS(opt_reg_cmp)
+    const SymReg * const ra = ((const opt_reg_t *)a)->r;
+    const SymReg * const rb = ((const opt_reg_t *)b)->r;
 
-    for (ins = unit->instructions; ins; ins = ins->next) {
-        if (ins->symregs) {
-            SymReg * const r = ins->symregs[0];
-            if (r && (r->use_count == 1 && r->lhs_use_count == 1)) {
-                IMCC_debug(imcc, DEBUG_OPT2, "used once '%d' deleted\n", ins);
-                ins = delete_ins(unit, ins);
+    return ra < rb ? -1 : ra > rb;
+}
 
-                /* find previous instruction or first instruction of this CU
-                 * ... but only the latter if it wasn't deleted */
-                ins = ins->prev
-                    ? ins->prev
-                    : opt ? unit->instructions : NULL;
+/*
 
-                unit->ostat.deleted_ins++;
-                unit->ostat.used_once++;
-                opt++;
-            }
-        }
-    }
-    return opt;
+=item C<static opt_reg_t * find_opt_reg(const opt_info_t *info, const SymReg
+*r)>
+
+Returns what C<info> knows of the register C<r>, or NULL if C<r> is not a
+register which the global optimizations may rewrite.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static opt_reg_t *
+find_opt_reg(ARGIN(const opt_info_t *info), ARGIN(const SymReg *r))
+{
+    ASSERT_ARGS(find_opt_reg)
+    opt_reg_t key;
+
+    if (!info->n_regs || (r->type & VTCONST))
+        return NULL;
+
+    key.r = r;
+    return (opt_reg_t *)bsearch(&key, info->regs, info->n_regs,
+            sizeof (opt_reg_t), opt_reg_cmp);
+}
+
+/*
+
+=item C<static int ins_dominates(const IMC_Unit *unit, const Instruction *a,
+const Instruction *b)>
+
+Returns whether every path to instruction C<b> runs instruction C<a> before
+it.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+ins_dominates(ARGIN(const IMC_Unit *unit), ARGIN(const Instruction *a),
+        ARGIN(const Instruction *b))
+{
+    ASSERT_ARGS(ins_dominates)
+
+    if (a->bbindex == b->bbindex)
+        return a->index < b->index;
+
+    return set_contains(unit->dominators[b->bbindex], a->bbindex);
+}
+
+/*
+
+=item C<static int is_pure_ins(const Instruction *ins)>
+
+Returns whether C<ins> only computes its first operand, an I, N or S
+register, from its other operands, which are I, N or S registers or
+constants. Such an instruction has no other effect and can't throw, so it can
+be removed or moved as long as its operands keep their values.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+is_pure_ins(ARGIN(const Instruction *ins))
+{
+    ASSERT_ARGS(is_pure_ins)
+    /* these take I and N operands only, as some of their S variants throw */
+    static const char * const numeric_ops[] = {
+        "add", "sub", "mul", "neg", "abs", "band", "bor", "bxor", "bnot",
+        "shl", "shr", "lsr", "and", "or", "xor", "not", "cmp",
+        "iseq", "isne", "islt", "isle", "isgt", "isge", "floor", "ceil"
+    };
+    const char  *sets = "INS";
+    unsigned int i;
+
+    if (!ins->op || ins->op->lib != PARROT_GET_CORE_OPLIB(NULL) || ins->keys
+    ||  ins->symreg_count < 1 || ins->symreg_count > 3)
+        return 0;
+
+    if (STREQ(ins->opname, "set") || STREQ(ins->opname, "length")) {
+        if (ins->symreg_count != 2)
+            return 0;
+    }
+    else if (STREQ(ins->opname, "null")) {
+        if (ins->symreg_count != 1)
+            return 0;
+    }
+    else {
+        for (i = 0; i < N_ELEMENTS(numeric_ops); i++)
+            if (STREQ(ins->opname, numeric_ops[i]))
+                break;
+
+        if (i == N_ELEMENTS(numeric_ops))
+            return 0;
+
+        sets = "IN";
+    }
+
+    /* the result is only written, the operands only read */
+    if ((ins->flags & 1) || !(ins->flags & (1 << 16))
+    ||  (ins->symregs[0]->type & VTCONST))
+        return 0;
+
+    for (i = 0; i < (unsigned int)ins->symreg_count; i++) {
+        const SymReg * const r = ins->symregs[i];
+
+        if (!strchr(sets, r->set) || !(r->type & (VTCONST | VTREG | VTIDENTIFIER)))
+            return 0;
+
+        if (i && (!(ins->flags & (1 << i)) || (ins->flags & (1 << (16 + i)))))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+
+=item C<static void note_reg(opt_info_t *info, Instruction *ins, const SymReg
+*r, int keyed, int check)>
+
+Notes that instruction C<ins> mentions the register C<r>, inside a key if
+C<keyed> is set. Unless C<check> is set, counts the instructions assigning and
+reading the register. If it is, clears the C<single> flag of the register if
+C<ins> reads it without being dominated by its assignment.
+
+=cut
+
+*/
+
+static void
+note_reg(ARGMOD(opt_info_t *info), ARGIN(Instruction *ins), ARGIN(const SymReg *r),
+        int keyed, int check)
+{
+    ASSERT_ARGS(note_reg)
+    opt_reg_t * const reg = find_opt_reg(info, r);
+
+    if (!reg)
+        return;
+
+    if (keyed)
+        reg->keyed = 1;
+
+    if (reg->seen == ins)
+        return;
+
+    reg->seen = ins;
+
+    if (check) {
+        if (reg->single && instruction_reads(ins, r)
+        && (ins == reg->def || !ins_dominates(info->unit, reg->def, ins)))
+            reg->single = 0;
+    }
+    else {
+        if (instruction_writes(ins, r)) {
+            reg->def = ins;
+            reg->n_defs++;
+        }
+
+        if (instruction_reads(ins, r))
+            reg->n_reads++;
+    }
+}
+
+/*
+
+=item C<static void note_ins(opt_info_t *info, Instruction *ins, int check)>
+
+Calls C<note_reg> for the registers instruction C<ins> mentions, including
+those in keys and the arguments and results of a sub call.
+
+=cut
+
+*/
+
+static void
+note_ins(ARGMOD(opt_info_t *info), ARGIN(Instruction *ins), int check)
+{
+    ASSERT_ARGS(note_ins)
+    op_lib_t * const core_ops = PARROT_GET_CORE_OPLIB(NULL);
+    const Instruction *pcc;
+    int i;
+
+    for (i = 0; i < ins->symreg_count; i++) {
+        const SymReg * const r = ins->symregs[i];
+
+        note_reg(info, ins, r, 0, check);
+
+        if (r->set == 'K') {
+            const SymReg *key;
+
+            for (key = r->nextkey; key; key = key->nextkey) {
+                note_reg(info, ins, key, 1, check);
+
+                if (key->reg)
+                    note_reg(info, ins, key->reg, 1, check);
+            }
+        }
+    }
+
+    if (!(ins->type & ITPCCSUB))
+        return;
+
+    /* a sub call reads the previous args and assigns the results after it */
+    for (pcc = ins->prev; pcc; pcc = pcc->prev)
+        if (pcc->op == &core_ops->op_info_table[PARROT_OP_set_args_pc])
+            break;
+
+    for (i = 0; pcc && i < pcc->symreg_count; i++)
+        note_reg(info, ins, pcc->symregs[i], 0, check);
+
+    for (pcc = ins->prev; pcc; pcc = pcc->next)
+        if (pcc->op == &core_ops->op_info_table[PARROT_OP_get_results_pc])
+            break;
+
+    for (i = 0; pcc && i < pcc->symreg_count; i++)
+        note_reg(info, ins, pcc->symregs[i], 0, check);
+}
+
+/*
+
+=item C<static int build_opt_info(imc_info_t *imcc, IMC_Unit *unit, opt_info_t
+*info)>
+
+Finds out which registers of C<unit> are assigned by a single instruction
+which dominates all of their reads, and which blocks an exception handler or a
+continuation can enter. Between such an assignment and a read of the register
+it dominates, the register keeps its value, as in SSA form. For a PMC
+register, that is the PMC it refers to, not the value of the PMC.
+
+The information lives in the CFG arena of the unit, so it is valid until the
+CFG is built again. Returns FALSE if the unit has unreachable blocks,
+C<local_branch> ops, whose returns the CFG doesn't show, or the debugger ops
+C<debug_break> and C<debug_print>, which show every register.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+build_opt_info(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
+        ARGOUT(opt_info_t *info))
+{
+    ASSERT_ARGS(build_opt_info)
+    const unsigned int n_bb = unit->n_basic_blocks;
+    Instruction       *ins;
+    Set               *reached;
+    unsigned int      *todo;
+    unsigned int       i, n_todo;
+
+    info->unit   = unit;
+    info->regs   = NULL;
+    info->n_regs = 0;
+
+    if (!n_bb || !unit->dominators)
+        return 0;
+
+    reached           = set_make_arena(imcc, &unit->cfg_arena, n_bb);
+    info->exceptional = set_make_arena(imcc, &unit->cfg_arena, n_bb);
+    todo              = imc_arena_allocate_n_typed(imcc, &unit->cfg_arena,
+                                                   n_bb, unsigned int);
+
+    /* find the entries of handlers and continuations */
+    for (n_todo = 0, ins = unit->instructions; ins; ins = ins->next) {
+        const SymReg *label;
+
+        if (STREQ(ins->opname, "local_branch")
+        ||  STREQ(ins->opname, "debug_break")
+        ||  STREQ(ins->opname, "debug_print"))
+            return 0;
+
+        if (!STREQ(ins->opname, "push_eh") && !STREQ(ins->opname, "set_addr"))
+            continue;
+
+        label = get_branch_reg(ins);
+
+        for (i = 0; label && i < n_bb; i++) {
+            const Instruction * const start = unit->bb_list[i]->start;
+
+            if ((start->type & ITLABEL)
+            &&   STREQ(start->symregs[0]->name, label->name)
+            &&  !set_contains(info->exceptional, i)) {
+                set_add(info->exceptional, i);
+                todo[n_todo++] = i;
+            }
+        }
+    }
+
+    /* they can jump there from anywhere, so the dominators of the blocks
+     * they reach don't tell which values the registers hold */
+    while (n_todo) {
+        const Edge *edge = unit->bb_list[todo[--n_todo]]->succ_list;
+
+        for (; edge; edge = edge->succ_next) {
+            if (!set_contains(info->exceptional, edge->to->index)) {
+                set_add(info->exceptional, edge->to->index);
+                todo[n_todo++] = edge->to->index;
+            }
+        }
+    }
+
+    /* unreachable blocks seem dominated by every other block */
+    set_add(reached, 0);
+    todo[n_todo++] = 0;
+
+    while (n_todo) {
+        const Edge *edge = unit->bb_list[todo[--n_todo]]->succ_list;
+
+        for (; edge; edge = edge->succ_next) {
+            if (!set_contains(reached, edge->to->index)) {
+                set_add(reached, edge->to->index);
+                todo[n_todo++] = edge->to->index;
+            }
+        }
+    }
+
+    for (i = 0; i < n_bb; i++)
+        if (!set_contains(reached, i))
+            return 0;
+
+    for (i = 0; i < unit->n_symbols; i++) {
+        const SymReg * const r = unit->reglist[i];
+
+        if (strchr("INSP", r->set) && (r->type & (VTREG | VTIDENTIFIER))
+        && !(r->type & VTPASM) && !(r->usage & U_LEXICAL) && !r->reg)
+            info->n_regs++;
+    }
+
+    if (!info->n_regs)
+        return 1;
+
+    info->regs = imc_arena_allocate_n_typed(imcc, &unit->cfg_arena,
+                                            info->n_regs, opt_reg_t);
+
+    for (info->n_regs = i = 0; i < unit->n_symbols; i++) {
+        const SymReg * const r = unit->reglist[i];
+
+        if (strchr("INSP", r->set) && (r->type & (VTREG | VTIDENTIFIER))
+        && !(r->type & VTPASM) && !(r->usage & U_LEXICAL) && !r->reg)
+            info->regs[info->n_regs++].r = r;
+    }
+
+    qsort(info->regs, info->n_regs, sizeof (opt_reg_t), opt_reg_cmp);
+
+    for (ins = unit->instructions; ins; ins = ins->next)
+        note_ins(info, ins, 0);
+
+    for (i = 0; i < info->n_regs; i++) {
+        info->regs[i].single = info->regs[i].n_defs == 1;
+        info->regs[i].seen   = NULL;
+    }
+
+    for (ins = unit->instructions; ins; ins = ins->next)
+        note_ins(info, ins, 1);
+
+    return 1;
+}
+
+/*
+
+=item C<static int single_operands(const opt_info_t *info, const Instruction
+*ins, int result)>
+
+Returns whether each operand of the pure instruction C<ins> is a constant or
+a register assigned once, and if C<result> is set, whether its result is such
+a register, too. The instruction then computes the same value wherever it is
+dominated by the assignments of its operands.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+single_operands(ARGIN(const opt_info_t *info), ARGIN(const Instruction *ins),
+        int result)
+{
+    ASSERT_ARGS(single_operands)
+    int i;
+
+    for (i = result ? 0 : 1; i < ins->symreg_count; i++) {
+        const SymReg * const r = ins->symregs[i];
+
+        if (i == 0 || !(r->type & VTCONST)) {
+            const opt_reg_t * const reg = find_opt_reg(info, r);
+
+            if (!reg || !reg->single)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+
+=item C<static int value_numbering(imc_info_t *imcc, IMC_Unit *unit, const
+opt_info_t *info)>
+
+Global value numbering on the registers which are assigned once: replaces a
+pure instruction which applies the same op to the same operands as one which
+dominates it by a copy of the result of the earlier one, if that result is
+assigned only there. Copy propagation then makes the copy go away.
+
+Returns TRUE if any instruction was replaced.
+
+=cut
+
+*/
+
+static int
+value_numbering(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
+        ARGIN(const opt_info_t *info))
+{
+    ASSERT_ARGS(value_numbering)
+    Instruction  *ins;
+    vn_entry_t  **table;
+    unsigned int  size = 16;
+    int           changed = 0;
+
+    IMCC_info(imcc, 2, "\tvalue_numbering\n");
+
+    for (ins = unit->instructions; ins; ins = ins->next)
+        if (ins->index >= size)
+            size <<= 1;
+
+    table = imc_arena_allocate_n_typed(imcc, &unit->cfg_arena, size, vn_entry_t *);
+
+    for (ins = unit->instructions; ins; ins = ins->next) {
+        const SymReg *args[2];
+        vn_entry_t   *e;
+        unsigned int  h;
+
+        if (STREQ(ins->opname, "set") || STREQ(ins->opname, "null")
+        || !is_pure_ins(ins) || !single_operands(info, ins, 0)
+        ||  set_contains(info->exceptional, ins->bbindex))
+            continue;
+
+        args[0] = ins->symregs[1];
+        args[1] = ins->symreg_count > 2 ? ins->symregs[2] : NULL;
+
+        /* the operands of commutative ops go in a fixed order */
+        if (args[1] && args[0] > args[1]
+        &&  args[0]->set == args[1]->set
+        && (args[0]->type & VTCONST) == (args[1]->type & VTCONST)
+        && (STREQ(ins->opname, "add")  || STREQ(ins->opname, "mul")
+        ||  STREQ(ins->opname, "band") || STREQ(ins->opname, "bor")
+        ||  STREQ(ins->opname, "bxor") || STREQ(ins->opname, "and")
+        ||  STREQ(ins->opname, "or")   || STREQ(ins->opname, "xor")
+        ||  STREQ(ins->opname, "iseq") || STREQ(ins->opname, "isne"))) {
+            const SymReg * const tmp = args[0];
+            args[0] = args[1];
+            args[1] = tmp;
+        }
+
+        h = (unsigned int)((PTR2UINTVAL(ins->op) >> 3)
+                         ^ (PTR2UINTVAL(args[0]) >> 3) * 31
+                         ^ (PTR2UINTVAL(args[1]) >> 3) * 131) & (size - 1);
+
+        for (e = table[h]; e; e = e->next)
+            if (e->ins->op == ins->op && e->args[0] == args[0]
+            &&  e->args[1] == args[1] && ins_dominates(unit, e->ins, ins))
+                break;
+
+        if (e) {
+            SymReg      *regs[2];
+            Instruction *tmp;
+
+            regs[0] = ins->symregs[0];
+            regs[1] = e->ins->symregs[0];
+            tmp     = INS(imcc, unit, "set", NULL, regs, 2, 0, 0);
+
+            IMCC_debug(imcc, DEBUG_OPT2, "value numbering %d => %d\n", ins, tmp);
+            tmp->bbindex = ins->bbindex;
+            subst_ins(unit, ins, tmp, 1);
+            ins = tmp;
+
+            unit->ostat.redundant_ins++;
+            changed = 1;
+        }
+        else if (single_operands(info, ins, 1)) {
+            /* its result stays available only if nothing else assigns it */
+            e          = imc_arena_allocate_typed(imcc, &unit->cfg_arena, vn_entry_t);
+            e->ins     = ins;
+            e->args[0] = args[0];
+            e->args[1] = args[1];
+            e->next    = table[h];
+            table[h]   = e;
+        }
+    }
+
+    return changed;
+}
+
+/*
+
+=item C<static int copy_propagation(imc_info_t *imcc, IMC_Unit *unit, opt_info_t
+*info)>
+
+Global copy propagation: where the register assigned by C<set A, B> is read,
+reads C<B> instead, if C<A> is assigned only there and C<B> is a constant or
+a register which is assigned once, too. Copies of registers are propagated
+into any instruction, constants only where there is an op taking a constant
+there. The copy itself is left for C<dead_store_remove>.
+
+Returns TRUE if any read was replaced.
+
+=cut
+
+*/
+
+static int
+copy_propagation(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
+        ARGMOD(opt_info_t *info))
+{
+    ASSERT_ARGS(copy_propagation)
+    op_lib_t * const core_ops = PARROT_GET_CORE_OPLIB(imcc->interp);
+    Instruction     *ins;
+    int              changed = 0, copies = 0;
+
+    IMCC_info(imcc, 2, "\tcopy_propagation\n");
+
+    for (ins = unit->instructions; ins; ins = ins->next) {
+        SymReg          *src;
+        opt_reg_t       *dest;
+        const opt_reg_t *from;
+
+        if (!STREQ(ins->opname, "set") || !is_pure_ins(ins))
+            continue;
+
+        src  = ins->symregs[1];
+        dest = find_opt_reg(info, ins->symregs[0]);
+        from = find_opt_reg(info, src);
+
+        if (dest && dest->single && !dest->keyed && src->set == dest->r->set
+        && ((src->type & VTCONST) || (from && from->single))) {
+            dest->copy_of = src;
+            copies++;
+        }
+    }
+
+    if (!copies)
+        return 0;
+
+    for (ins = unit->instructions; ins; ins = ins->next) {
+        /* constants change the signature of calls */
+        const int pcc = (ins->type & ITPCCSUB)
+                     || ins->op == &core_ops->op_info_table[PARROT_OP_set_args_pc]
+                     || ins->op == &core_ops->op_info_table[PARROT_OP_set_returns_pc]
+                     || ins->op == &core_ops->op_info_table[PARROT_OP_get_params_pc]
+                     || ins->op == &core_ops->op_info_table[PARROT_OP_get_results_pc];
+        int i;
+
+        if (!ins->op || set_contains(info->exceptional, ins->bbindex))
+            continue;
+
+        for (i = 0; i < ins->symreg_count; i++) {
+            SymReg          * const r   = ins->symregs[i];
+            const opt_reg_t * const reg = find_opt_reg(info, r);
+            SymReg          *by;
+
+            if (!reg || !reg->copy_of || reg->def == ins
+            || !instruction_reads(ins, r) || instruction_writes(ins, r))
+                continue;
+
+            /* copies of copies, up to the original */
+            for (by = reg->copy_of; !(by->type & VTCONST);) {
+                const opt_reg_t * const next = find_opt_reg(info, by);
+
+                if (!next->copy_of)
+                    break;
+
+                by = next->copy_of;
+            }
+
+            if (by->type & VTCONST) {
+                op_info_t * const op = ins->op;
+                char fullname[128];
+
+                if (pcc)
+                    continue;
+
+                ins->symregs[i] = by;
+                check_op(imcc, &ins->op, fullname, ins->opname,
+                    ins->symregs, ins->symreg_count, ins->keys);
+
+                if (!ins->op) {
+                    IMCC_debug(imcc, DEBUG_OPT2, "no %s\n", fullname);
+                    ins->symregs[i] = r;
+                    ins->op         = op;
+                    continue;
+                }
+            }
+            else
+                ins->symregs[i] = by;
+
+            IMCC_debug(imcc, DEBUG_OPT2, "propagating %s => %d\n", r->name, ins);
+            unit->ostat.copies_propagated++;
+            changed = 1;
+        }
+    }
+
+    return changed;
+}
+
+/*
+
+=item C<static int dead_store_remove(imc_info_t *imcc, IMC_Unit *unit, const
+opt_info_t *info)>
+
+Deletes the pure instructions assigning registers which are never read.
+
+=cut
+
+*/
+
+static int
+dead_store_remove(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
+        ARGIN(const opt_info_t *info))
+{
+    ASSERT_ARGS(dead_store_remove)
+    Instruction *ins;
+    int          changed = 0;
+
+    IMCC_info(imcc, 2, "\tdead_store_remove\n");
+
+    for (ins = unit->instructions; ins;) {
+        const opt_reg_t * const reg = is_pure_ins(ins)
+                                    ? find_opt_reg(info, ins->symregs[0])
+                                    : NULL;
+
+        if (reg && !reg->n_reads) {
+            IMCC_debug(imcc, DEBUG_OPT2, "dead store '%d' deleted\n", ins);
+            ins = delete_ins(unit, ins);
+
+            unit->ostat.deleted_ins++;
+            unit->ostat.dead_stores++;
+            changed = 1;
+        }
+        else
+            ins = ins->next;
+    }
+
+    return changed;
+}
+
+/*
+
+=item C<static int scalar_replacement(imc_info_t *imcc, IMC_Unit *unit,
+opt_info_t *info)>
+
+Replaces the C<Integer> and C<Float> PMCs which never escape C<unit> by I and
+N registers, so they aren't allocated at all. Such a PMC is created by the
+only C<new> assigning its register, and the register is only used to set,
+read, test or print the value of the PMC, or for a C<Float>, to add to,
+subtract from or multiply it by a number.
+
+Passing the register to a sub or to any other op, copying it or using it
+where an exception handler can enter keeps the PMC, as do the ops which morph
+it into another type or promote an C<Integer> to a C<BigInt> on overflow.
+Units of an HLL are left alone, as their C<new> may not create the core PMCs.
+
+Returns TRUE if any PMC was replaced.
+
+=cut
+
+*/
+
+static int
+scalar_replacement(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
+        ARGMOD(opt_info_t *info))
+{
+    ASSERT_ARGS(scalar_replacement)
+    /* the ops using the value of the PMC only, with the same result as the
+     * ops on the native register */
+    static const char * const integer_ops[] = {
+        "set_p_i", "set_p_ic", "set_i_p", "set_n_p", "set_s_p",
+        "if_p_ic", "unless_p_ic", "say_p", "print_p"
+    };
+    static const char * const float_ops[] = {
+        "set_p_n", "set_p_nc", "set_i_p", "set_n_p", "if_p_ic", "unless_p_ic",
+        "add_p_n", "add_p_nc", "sub_p_n", "sub_p_nc", "mul_p_n", "mul_p_nc"
+    };
+    op_lib_t * const core_ops = PARROT_GET_CORE_OPLIB(imcc->interp);
+    Instruction     *ins;
+    unsigned int     i;
+    int              changed = 0;
+
+    if (unit->hll_id)
+        return 0;
+
+    IMCC_info(imcc, 2, "\tscalar_replacement\n");
+
+    for (i = 0; i < info->n_regs; i++) {
+        opt_reg_t         * const reg = &info->regs[i];
+        const Instruction * const def = reg->def;
+        const SymReg      *type;
+
+        if (reg->r->set != 'P' || !reg->single || reg->keyed
+        ||  set_contains(info->exceptional, def->bbindex))
+            continue;
+
+        if (def->op == &core_ops->op_info_table[PARROT_OP_new_p_sc])
+            type = def->symregs[1];
+        else if (def->op == &core_ops->op_info_table[PARROT_OP_new_p_pc]
+             &&  def->symregs[1]->set == 'K' && def->symregs[1]->nextkey
+             && !def->symregs[1]->nextkey->nextkey)
+            type = def->symregs[1]->nextkey;
+        else
+            continue;
+
+        if (type->set != 'S' || !(type->type & VTCONST))
+            continue;
+
+        if (STREQ(type->name, "'Integer'") || STREQ(type->name, "\"Integer\""))
+            reg->native = 'I';
+        else if (STREQ(type->name, "'Float'") || STREQ(type->name, "\"Float\""))
+            reg->native = 'N';
+    }
+
+    /* any other use of the register lets the PMC escape */
+    for (ins = unit->instructions; ins; ins = ins->next) {
+        for (i = 0; i < (unsigned int)ins->symreg_count; i++) {
+            opt_reg_t * const reg = find_opt_reg(info, ins->symregs[i]);
+            const char * const *ops;
+            size_t              n_ops, j;
+
+            if (!reg || !reg->native || ins == reg->def)
+                continue;
+
+            if (!ins->op || ins->op->lib != core_ops || ins->keys
+            ||  set_contains(info->exceptional, ins->bbindex)) {
+                reg->native = 0;
+                continue;
+            }
+
+            ops   = reg->native == 'I' ? integer_ops : float_ops;
+            n_ops = reg->native == 'I' ? N_ELEMENTS(integer_ops) : N_ELEMENTS(float_ops);
+
+            for (j = 0; j < n_ops; j++)
+                if (STREQ(ins->op->full_name, ops[j]))
+                    break;
+
+            if (j == n_ops)
+                reg->native = 0;
+        }
+    }
+
+    for (i = 0; i < info->n_regs; i++) {
+        if (info->regs[i].native) {
+            info->regs[i].scalar = mk_temp_reg(imcc, info->regs[i].native);
+            unit->ostat.pmcs_replaced++;
+            changed = 1;
+        }
+    }
+
+    if (!changed)
+        return 0;
+
+    for (ins = unit->instructions; ins; ins = ins->next) {
+        const opt_reg_t *reg = NULL;
+        SymReg          *regs[2];
+        Instruction     *tmp;
+
+        for (i = 0; i < (unsigned int)ins->symreg_count; i++) {
+            const opt_reg_t * const r = find_opt_reg(info, ins->symregs[i]);
+
+            if (r && r->native)
+                reg = r;
+        }
+
+        if (!reg)
+            continue;
+
+        /* the allowed ops have two operands at most, one of them the PMC */
+        if (ins == reg->def) {
+            regs[0] = reg->scalar;
+            tmp     = INS(imcc, unit, "null", NULL, regs, 1, 0, 0);
+        }
+        else {
+            for (i = 0; i < (unsigned int)ins->symreg_count; i++)
+                regs[i] = ins->symregs[i] == reg->r ? reg->scalar : ins->symregs[i];
+
+            tmp = INS(imcc, unit, ins->opname, NULL, regs, ins->symreg_count, 0, 0);
+        }
+
+        IMCC_debug(imcc, DEBUG_OPT2, "scalar replacement %d => %d\n", ins, tmp);
+        tmp->bbindex = ins->bbindex;
+        subst_ins(unit, ins, tmp, 1);
+        ins = tmp;
+    }
+
+    return changed;
+}
+
+/*
+
+=item C<static int loop_invariant_motion(imc_info_t *imcc, IMC_Unit *unit, const
+opt_info_t *info)>
+
+Moves the pure instructions of a loop whose operands are constants or
+registers assigned once outside of the loop to its preheader, so they run
+once instead of once per iteration. This is safe because those instructions
+can't throw, and their results are assigned once and not read before them.
+
+Loops without a natural preheader or which an exception handler can enter are
+left alone. As moving instructions invalidates the blocks, only one loop is
+handled at a time. Returns TRUE if any instruction was moved.
+
+=cut
+
+*/
+
+static int
+loop_invariant_motion(ARGMOD(imc_info_t *imcc), ARGMOD(IMC_Unit *unit),
+        ARGIN(const opt_info_t *info))
+{
+    ASSERT_ARGS(loop_invariant_motion)
+    op_lib_t * const core_ops = PARROT_GET_CORE_OPLIB(imcc->interp);
+    int              l;
+
+    IMCC_info(imcc, 2, "\tloop_invariant_motion\n");
+
+    for (l = 0; l < unit->n_loops; l++) {
+        const Loop_info * const loop = unit->loop_info[l];
+        const Basic_block      *pre;
+        Instruction            *after;
+        unsigned int            b;
+        int                     moved = 0;
+
+        if (loop->preheader >= unit->n_basic_blocks)
+            continue;
+
+        for (b = 0; b < unit->n_basic_blocks; b++)
+            if (set_contains(loop->loop, b) && set_contains(info->exceptional, b))
+                break;
+
+        if (b < unit->n_basic_blocks)
+            continue;
+
+        /* the invariants go at the end of the preheader, before its branch */
+        pre   = unit->bb_list[loop->preheader];
+        after = pre->end->type & ITBRANCH ? pre->end->prev : pre->end;
+
+        if (pre->end == pre->start && (pre->end->type & ITBRANCH))
+            continue;
+
+        if ((pre->end->type & (ITPCCSUB | ITPCCYIELD))
+        || (after->next
+        &&  after->next->op == &core_ops->op_info_table[PARROT_OP_get_results_pc]))
+            continue;
+
+        for (b = 0; b < unit->n_basic_blocks; b++) {
+            const Basic_block * const bb = unit->bb_list[b];
+            Instruction       *ins, *next;
+
+            if (!set_contains(loop->loop, b))
+                continue;
+
+            for (ins = bb->start; ins; ins = next) {
+                int i;
+
+                next = ins == bb->end ? NULL : ins->next;
+
+                if (!is_pure_ins(ins) || !single_operands(info, ins, 1))
+                    continue;
+
+                for (i = 1; i < ins->symreg_count; i++) {
+                    const opt_reg_t * const reg = find_opt_reg(info, ins->symregs[i]);
+
+                    if (reg && set_contains(loop->loop, reg->def->bbindex))
+                        break;
+                }
+
+                if (i < ins->symreg_count)
+                    continue;
+
+                IMCC_debug(imcc, DEBUG_OPT2, "invariant %d moved to block %d\n",
+                        ins, (int)pre->index);
+                move_ins(unit, ins, after);
+                ins->bbindex = pre->index;
+                after        = ins;
+
+                unit->ostat.invariants_moved++;
+                moved = 1;
+            }
+        }
+
+        if (moved)
+            return 1;
+    }
+
+    return 0;
 }
 
 /*
@@ -141,15 +141,14 @@ PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 static subs_t * find_global_label(
     ARGMOD(imc_info_t * imcc),
+    ARGIN(const Hash *labels),
     ARGIN(const char *name),
-    ARGIN(const subs_t *sym),
-    ARGOUT(int *pc))
+    ARGIN(const subs_t *sym))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
         __attribute__nonnull__(3)
         __attribute__nonnull__(4)
-        FUNC_MODIFIES(* imcc)
-        FUNC_MODIFIES(*pc);
+        FUNC_MODIFIES(* imcc);
 
 PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
@@ -164,15 +163,12 @@ PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 static subs_t * find_sub_by_subid(
     ARGMOD(imc_info_t * imcc),
-    ARGIN(const char *lookup),
-    ARGIN(const subs_t *sym),
-    ARGOUT(int *pc))
+    ARGIN(const Hash *subids),
+    ARGIN(const char *lookup))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
         __attribute__nonnull__(3)
-        __attribute__nonnull__(4)
-        FUNC_MODIFIES(* imcc)
-        FUNC_MODIFIES(*pc);
+        FUNC_MODIFIES(* imcc);
 
 static void fixup_globals(ARGMOD(imc_info_t * imcc))
         __attribute__nonnull__(1)
@@ -315,17 +311,16 @@ static void verify_signature(
     , PARROT_ASSERT_ARG(bc))
 #define ASSERT_ARGS_find_global_label __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(labels) \
     , PARROT_ASSERT_ARG(name) \
-    , PARROT_ASSERT_ARG(sym) \
-    , PARROT_ASSERT_ARG(pc))
+    , PARROT_ASSERT_ARG(sym))
 #define ASSERT_ARGS_find_outer __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
 #define ASSERT_ARGS_find_sub_by_subid __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
-    , PARROT_ASSERT_ARG(lookup) \
-    , PARROT_ASSERT_ARG(sym) \
-    , PARROT_ASSERT_ARG(pc))
+    , PARROT_ASSERT_ARG(subids) \
+    , PARROT_ASSERT_ARG(lookup))
 #define ASSERT_ARGS_fixup_globals __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc))
 #define ASSERT_ARGS_get_code_size __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -553,11 +548,8 @@ get_old_size(ARGMOD(imc_info_t * imcc), ARGIN(PackFile_ByteCode * bc),
     *ins_line   = 0;
 
     if (imcc->globals->cs && bc->base.data) {
-        const subs_t *s;
-        for (s = imcc->globals->cs->subs; s; s = s->prev) {
-            size      += s->size;
-            *ins_line += s->ins_line;
-        }
+        size      = imcc->globals->cs->size;
+        *ins_line = imcc->globals->cs->ins_line;
     }
 
     return size;
@@ -569,7 +561,8 @@ get_old_size(ARGMOD(imc_info_t * imcc), ARGIN(PackFile_ByteCode * bc),
 =item C<static void store_sub_size(imc_info_t * imcc, size_t size, size_t
 ins_line)>
 
-Sets the given size and line parameters for the current compilation unit.
+Sets the given size and line parameters for the current compilation unit,
+and adds them to the totals of its code segment.
 
 =cut
 
@@ -581,6 +574,8 @@ store_sub_size(ARGMOD(imc_info_t * imcc), size_t size, size_t ins_line)
     ASSERT_ARGS(store_sub_size)
     imcc->globals->cs->subs->size     = size;
     imcc->globals->cs->subs->ins_line = ins_line;
+    imcc->globals->cs->size          += size;
+    imcc->globals->cs->ins_line      += ins_line;
 }
 
 
@@ -768,6 +763,9 @@ bytecode_map_op(ARGMOD(imc_info_t * imcc), op_info_t *info) {
     PackFile_ByteCode_OpMappingEntry *om;
     opcode_t i;
 
+    /* only segments unpacked from a file share their op tables */
+    PARROT_ASSERT(!bc->op_tables);
+
     for (i = 0; i < bc->op_mapping.n_libs; i++) {
         if (lib == bc->op_mapping.libs[i].lib) {
             om = &bc->op_mapping.libs[i];
@@ -827,11 +825,12 @@ bytecode_map_op(ARGMOD(imc_info_t * imcc), op_info_t *info) {
 
 /*
 
-=item C<static subs_t * find_global_label(imc_info_t * imcc, const char *name,
-const subs_t *sym, int *pc)>
+=item C<static subs_t * find_global_label(imc_info_t * imcc, const Hash *labels,
+const char *name, const subs_t *sym)>
 
-Finds a global label, returning the symreg (and setting the (absolute) pc
-through the out parameter).
+Finds a global label, returning the first sub of that name in the namespace
+of C<sym>.  C<labels> holds the first sub of each name, as C<fixup_globals>
+builds it.
 
 =cut
 
@@ -840,33 +839,27 @@ through the out parameter).
 PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 static subs_t *
-find_global_label(ARGMOD(imc_info_t * imcc), ARGIN(const char *name),
-    ARGIN(const subs_t *sym), ARGOUT(int *pc))
+find_global_label(ARGMOD(imc_info_t * imcc), ARGIN(const Hash *labels),
+    ARGIN(const char *name), ARGIN(const subs_t *sym))
 {
     ASSERT_ARGS(find_global_label)
     subs_t *s;
 
-    *pc = 0;
-
-    for (s = imcc->globals->cs->first; s; s = s->next) {
-        const SymReg * const r = s->unit->instructions->symregs[0];
-
-        /* if names and namespaces are matching - ok */
-        if (r && r->name && (strcmp(r->name, name) == 0)
-                && ((sym->unit->_namespace && s->unit->_namespace
-                        && (strcmp(sym->unit->_namespace->name, s->unit->_namespace->name) == 0))
-                    || (!sym->unit->_namespace && !s->unit->_namespace)))
+    for (s = (subs_t *)Parrot_hash_get(imcc->interp, labels, name);
+            s; s = s->same_name) {
+        /* if namespaces are matching - ok */
+        if ((sym->unit->_namespace && s->unit->_namespace
+                && (strcmp(sym->unit->_namespace->name, s->unit->_namespace->name) == 0))
+            || (!sym->unit->_namespace && !s->unit->_namespace))
             return s;
-
-        *pc += s->size;
     }
     return NULL;
 }
 
 /*
 
-=item C<static subs_t * find_sub_by_subid(imc_info_t * imcc, const char *lookup,
-const subs_t *sym, int *pc)>
+=item C<static subs_t * find_sub_by_subid(imc_info_t * imcc, const Hash *subids,
+const char *lookup)>
 
 Find the first sub in the current code segment with a given subid.
 
@@ -877,25 +870,12 @@ Find the first sub in the current code segment with a given subid.
 PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 static subs_t *
-find_sub_by_subid(ARGMOD(imc_info_t * imcc), ARGIN(const char *lookup),
-    ARGIN(const subs_t *sym), ARGOUT(int *pc))
+find_sub_by_subid(ARGMOD(imc_info_t * imcc), ARGIN(const Hash *subids),
+    ARGIN(const char *lookup))
 {
     ASSERT_ARGS(find_sub_by_subid)
-    subs_t *s;
-    UNUSED(sym);
-
-    *pc = 0;
-
-    for (s = imcc->globals->cs->first; s; s = s->next) {
-        const SymReg * const r = s->unit->instructions->symregs[0];
-
-        /* if subid matches - ok */
-        if (r && (r->subid && (strcmp(r->subid->name, lookup) == 0)))
-            return s;
 
-        *pc += s->size;
-    }
-    return NULL;
+    return (subs_t *)Parrot_hash_get(imcc->interp, subids, lookup);
 }
 
 /*
@@ -916,6 +896,23 @@ fixup_globals(ARGMOD(imc_info_t * imcc))
     int     jumppc = 0;
     op_lib_t *core_ops = PARROT_GET_CORE_OPLIB(imcc->interp);
     PackFile_ByteCode * const bc = Parrot_pf_get_current_code_segment(imcc->interp);
+    Hash * const labels = Parrot_hash_create(imcc->interp, enum_type_ptr, Hash_key_type_cstring);
+    Hash * const subids = Parrot_hash_create(imcc->interp, enum_type_ptr, Hash_key_type_cstring);
+
+    /* index the subs by name and subid; going backwards leaves the first
+     * sub of each in the hashes, and the ones sharing its name chained in
+     * order behind it */
+    for (s = imcc->globals->cs->subs; s; s = s->prev) {
+        const SymReg * const r = s->unit->instructions->symregs[0];
+
+        if (r && r->name) {
+            s->same_name = (subs_t *)Parrot_hash_get(imcc->interp, labels, r->name);
+            Parrot_hash_put(imcc->interp, labels, r->name, s);
+        }
+
+        if (r && r->subid)
+            Parrot_hash_put(imcc->interp, subids, r->subid->name, s);
+    }
 
     for (s = imcc->globals->cs->first; s; s = s->next) {
         const SymHash * const hsh = &s->fixup;
@@ -925,7 +922,7 @@ fixup_globals(ARGMOD(imc_info_t * imcc))
             SymReg *fixup;
 
             for (fixup = hsh->data[i]; fixup; fixup = fixup->next) {
-                int pc, pmc_const;
+                int pmc_const;
                 const int addr = jumppc + fixup->color;
                 int subid_lookup = 0;
                 subs_t *s1;
@@ -935,11 +932,10 @@ fixup_globals(ARGMOD(imc_info_t * imcc))
                     s1 = NULL;
                 else if (fixup->usage & U_SUBID_LOOKUP) {
                     subid_lookup = 1;
-                    /* s1 = find_sub_by_subid(interp, fixup->name, &pc); */
-                    s1 = find_sub_by_subid(imcc, fixup->name, s, &pc);
+                    s1 = find_sub_by_subid(imcc, subids, fixup->name);
                 }
                 else if (fixup->usage & U_LEXINFO_LOOKUP) {
-                    s1 = find_sub_by_subid(imcc, fixup->name, s, &pc);
+                    s1 = find_sub_by_subid(imcc, subids, fixup->name);
                     if (!s1 || s1->pmc_const == -1)
                         IMCC_fataly(imcc, EXCEPTION_INVALID_OPERATION,
                                 "Sub '%s' not found\n", fixup->name);
@@ -957,7 +953,7 @@ fixup_globals(ARGMOD(imc_info_t * imcc))
                     continue;
                 }
                 else
-                    s1 = find_global_label(imcc, fixup->name, s, &pc);
+                    s1 = find_global_label(imcc, labels, fixup->name, s);
 
                 /*
                  * if failed change opcode:
@@ -1026,6 +1022,9 @@ fixup_globals(ARGMOD(imc_info_t * imcc))
 
         jumppc += s->size;
     }
+
+    Parrot_hash_destroy(imcc->interp, labels);
+    Parrot_hash_destroy(imcc->interp, subids);
 }
 
 
@@ -2136,7 +2135,9 @@ add_1_const(ARGMOD(imc_info_t * imcc), ARGMOD(SymReg *r),
 =item C<static void constant_folding(imc_info_t * imcc, const IMC_Unit *unit,
 PackFile_ByteCode * bc)>
 
-Stores a constant's idx for later reuse.
+Stores a constant's idx for later reuse.  Global constants are taken from the
+symbols queued by C<_store_symreg>; those which don't get a constant table
+entry yet stay queued for the next sub.
 
 =cut
 
@@ -2147,31 +2148,34 @@ constant_folding(ARGMOD(imc_info_t * imcc), ARGIN(const IMC_Unit *unit),
         ARGMOD(PackFile_ByteCode * bc))
 {
     ASSERT_ARGS(constant_folding)
-    const SymHash *hsh = &imcc->ghash;
-    unsigned int   i;
+    const SymHash *hsh;
+    unsigned int   i, kept;
 
-    /* go through all consts of current sub */
-    for (i = 0; i < hsh->size; i++) {
-        SymReg *r;
+    /* go through all new consts ... */
+    for (i = kept = 0; i < imcc->n_unfolded; i++) {
+        SymReg * const r = imcc->unfolded[i];
 
         /* normally constants are in ghash ... */
-        for (r = hsh->data[i]; r; r = r->next) {
-            if (r->type & (VTCONST|VT_CONSTP))
-                add_1_const(imcc, r, bc);
+        if (r->type & (VTCONST|VT_CONSTP))
+            add_1_const(imcc, r, bc);
 
-            if (r->usage & U_LEXICAL) {
-                SymReg *n = r->reg;
+        if (r->usage & U_LEXICAL) {
+            SymReg *n = r->reg;
 
-                /* r->reg is a chain of names for the same lex sym */
-                while (n) {
-                    /* lex_name */
-                    add_1_const(imcc, n, bc);
-                    n = n->reg;
-                }
+            /* r->reg is a chain of names for the same lex sym */
+            while (n) {
+                /* lex_name */
+                add_1_const(imcc, n, bc);
+                n = n->reg;
             }
         }
+
+        if (r->type & (VTCONST|VT_CONSTP) && r->color < 0)
+            imcc->unfolded[kept++] = r;
     }
 
+    imcc->n_unfolded = kept;
+
     /* ... but keychains 'K' are in local hash, they may contain
      * variables and constants */
     hsh = &unit->hash;
@@ -2249,11 +2253,17 @@ e_pbc_end_sub(ARGMOD(imc_info_t * imcc), SHIM(void *param), ARGIN(IMC_Unit *unit
         /* clear global symbols temporarily -- TT #1324, for example */
         imcc_globals *g = imcc->globals;
         SymHash ghash;
+        SymReg     ** const unfolded      = imcc->unfolded;
+        const unsigned int  n_unfolded    = imcc->n_unfolded;
+        const unsigned int  unfolded_size = imcc->unfolded_size;
 
         imcc->globals = NULL;
 
         memmove(&ghash, &imcc->ghash, sizeof (SymHash));
         memset(&imcc->ghash, 0, sizeof (SymHash));
+        imcc->unfolded      = NULL;
+        imcc->n_unfolded    = 0;
+        imcc->unfolded_size = 0;
 
         IMCC_debug(imcc, DEBUG_PBC, "immediate sub '%s'", ins->symregs[0]->name);
         /* TODO: Don't use this function, it is deprecated (TT #2140). We need
@@ -2262,6 +2272,10 @@ e_pbc_end_sub(ARGMOD(imc_info_t * imcc), SHIM(void *param), ARGIN(IMC_Unit *unit
 
         imcc->globals  = g;
         memmove(&imcc->ghash, &ghash, sizeof (SymHash));
+        mem_sys_free(imcc->unfolded);
+        imcc->unfolded      = unfolded;
+        imcc->n_unfolded    = n_unfolded;
+        imcc->unfolded_size = unfolded_size;
     }
 }
 
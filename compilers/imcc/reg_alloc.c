@@ -32,9 +32,21 @@ The following parts are just missing:
 #include <string.h>
 #include "imc.h"
 #include "optimizer.h"
+#include "parrot/oplib/core_ops.h"
 
 /* HEADERIZER HFILE: compilers/imcc/imc.h */
 
+/* state of compute_du_chain while it walks the instructions of a unit */
+typedef struct du_chain_t {
+    SymReg      **syms;         /* the reglist, sorted by address */
+    int          *seen;         /* index of the last instruction checked for each */
+    int          *writes;       /* whether that instruction writes it */
+    unsigned int *touched;      /* symbols the current instruction uses */
+    unsigned int  n_touched;
+    unsigned int  n_syms;
+    int           index;        /* index of the current instruction */
+} du_chain_t;
+
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
@@ -61,14 +73,42 @@ static void build_reglist(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
         FUNC_MODIFIES(* imcc)
         FUNC_MODIFIES(*unit);
 
-static void compute_du_chain(ARGMOD(IMC_Unit *unit))
+static void compute_du_chain(
+    ARGMOD(imc_info_t * imcc),
+    ARGMOD(IMC_Unit *unit))
         __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(* imcc)
         FUNC_MODIFIES(*unit);
 
-static void compute_one_du_chain(ARGMOD(SymReg *r), ARGIN(IMC_Unit *unit))
+static void du_note_all(
+    ARGMOD(du_chain_t *du),
+    ARGIN(const Instruction *ins),
+    ARGIN(const Instruction *from))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*du);
+
+static void du_note_ins(
+    ARGMOD(du_chain_t *du),
+    ARGIN(const Instruction *ins))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        FUNC_MODIFIES(*r);
+        FUNC_MODIFIES(*du);
+
+static void du_note_use(
+    ARGMOD(du_chain_t *du),
+    ARGIN(const Instruction *ins),
+    ARGIN_NULLOK(const SymReg *r))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*du);
+
+PARROT_WARN_UNUSED_RESULT
+static int du_sym_cmp(ARGIN(const void *a), ARGIN(const void *b))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
 
 PARROT_WARN_UNUSED_RESULT
 static unsigned int first_avail(
@@ -127,10 +167,21 @@ static void vanilla_reg_alloc(
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
 #define ASSERT_ARGS_compute_du_chain __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(unit))
-#define ASSERT_ARGS_compute_one_du_chain __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
-       PARROT_ASSERT_ARG(r) \
+       PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
+#define ASSERT_ARGS_du_note_all __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(du) \
+    , PARROT_ASSERT_ARG(ins) \
+    , PARROT_ASSERT_ARG(from))
+#define ASSERT_ARGS_du_note_ins __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(du) \
+    , PARROT_ASSERT_ARG(ins))
+#define ASSERT_ARGS_du_note_use __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(du) \
+    , PARROT_ASSERT_ARG(ins))
+#define ASSERT_ARGS_du_sym_cmp __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(a) \
+    , PARROT_ASSERT_ARG(b))
 #define ASSERT_ARGS_first_avail __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(unit))
@@ -370,12 +421,14 @@ print_stat(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
               "%d if_branch, %d branch_branch\n",
               unit->ostat.deleted_labels, unit->ostat.deleted_ins,
               unit->ostat.if_branch, unit->ostat.branch_branch);
-    IMCC_info(imcc, 1, "\t%d branch_cond_loop\n",
-              unit->ostat.branch_cond_loop);
-    IMCC_info(imcc, 1, "\t%d used once deleted\n",
-              unit->ostat.used_once);
+    IMCC_info(imcc, 1, "\t%d dead stores deleted\n",
+              unit->ostat.dead_stores);
+    IMCC_info(imcc, 1, "\t%d redundant, %d copies propagated\n",
+              unit->ostat.redundant_ins, unit->ostat.copies_propagated);
     IMCC_info(imcc, 1, "\t%d invariants_moved\n",
               unit->ostat.invariants_moved);
+    IMCC_info(imcc, 1, "\t%d PMCs replaced by registers\n",
+              unit->ostat.pmcs_replaced);
     IMCC_info(imcc, 1, "\tregisters needed:\t I%d, N%d, S%d, P%d\n",
             sets[0], sets[1], sets[2], sets[3]);
     IMCC_info(imcc, 1,
@@ -485,7 +538,7 @@ build_reglist(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
     if (imcc->debug & DEBUG_IMC)
         dump_symreg(unit);
 
-    compute_du_chain(unit);
+    compute_du_chain(imcc, unit);
 
     /* we might have unused symbols here, from optimizations */
     for (i = count = unused = 0; i < n_symbols; i++) {
@@ -505,76 +558,206 @@ build_reglist(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
 
 /*
 
-=item C<static void compute_du_chain(IMC_Unit *unit)>
+=item C<static int du_sym_cmp(const void *a, const void *b)>
 
-Compute a DU-chain for each symbolic in a compilation unit
+Orders the symbols of C<du_chain_t.syms> by address.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+du_sym_cmp(ARGIN(const void *a), ARGIN(const void *b))
+{
+    ASSERT_ARGS(du_sym_cmp)
+    const SymReg * const ra = *(const SymReg * const *)a;
+    const SymReg * const rb = *(const SymReg * const *)b;
+
+    return ra < rb ? -1 : ra > rb ? 1 : 0;
+}
+
+/*
+
+=item C<static void du_note_use(du_chain_t *du, const Instruction *ins, const
+SymReg *r)>
+
+Notes whether C<ins>, the instruction C<du> is looking at, reads or writes the
+symbol C<r>, if C<r> is one whose DU-chain is being computed.
 
 =cut
 
 */
 
 static void
-compute_du_chain(ARGMOD(IMC_Unit *unit))
+du_note_use(ARGMOD(du_chain_t *du), ARGIN(const Instruction *ins),
+        ARGIN_NULLOK(const SymReg *r))
 {
-    ASSERT_ARGS(compute_du_chain)
-    Instruction *ins = unit->instructions;
-    Instruction *lastbranch = NULL;
-    unsigned int i;
+    ASSERT_ARGS(du_note_use)
+    SymReg      **found;
+    unsigned int  i;
+    int           writes;
 
-    /* Compute last branch in this procedure, update instruction index */
-    for (i = 0; ins; ins = ins->next) {
-        ins->index = i++;
-        if (ins->type == ITBRANCH)
-            lastbranch = ins;
+    if (!r)
+        return;
+
+    found = (SymReg **)bsearch(&r, du->syms, du->n_syms, sizeof (SymReg *), du_sym_cmp);
+
+    if (!found)
+        return;
+
+    i = found - du->syms;
+
+    if (du->seen[i] == du->index)
+        return;
+
+    du->seen[i] = du->index;
+    writes      = instruction_writes(ins, r);
+
+    if (writes || instruction_reads(ins, r)) {
+        du->writes[i]                = writes;
+        du->touched[du->n_touched++] = i;
     }
+}
 
-    /* Compute du-chains for all symbolics */
-    for (i = 0; i < unit->n_symbols; i++) {
-        SymReg * const r = unit->reglist[i];
-        compute_one_du_chain(r, unit);
+/*
 
-        /* what is this used for? -lt */
-        if (r->type == VTIDENTIFIER
-        &&  lastbranch
-        &&  r->last_ins
-        &&  r->last_ins->index < lastbranch->index)
-            r->last_ins = lastbranch;
+=item C<static void du_note_all(du_chain_t *du, const Instruction *ins, const
+Instruction *from)>
+
+Notes the uses by C<ins> of each symbol of C<from>, and of the registers in
+its keys.
+
+=cut
+
+*/
+
+static void
+du_note_all(ARGMOD(du_chain_t *du), ARGIN(const Instruction *ins),
+        ARGIN(const Instruction *from))
+{
+    ASSERT_ARGS(du_note_all)
+    int i;
+
+    for (i = 0; i < from->symreg_count; i++) {
+        const SymReg * const r = from->symregs[i];
+
+        du_note_use(du, ins, r);
+
+        if (r && r->set == 'K') {
+            const SymReg *key;
+            for (key = r->nextkey; key; key = key->nextkey)
+                du_note_use(du, ins, key->reg);
+        }
     }
 }
 
 /*
 
-=item C<static void compute_one_du_chain(SymReg *r, IMC_Unit *unit)>
+=item C<static void du_note_ins(du_chain_t *du, const Instruction *ins)>
 
-Compute the DU-chain for one register within the compilation unit.
+Notes the uses of all symbols which C<ins> might read or write. Besides its
+own, a sub call uses those of the C<set_args> before it and the
+C<get_results> after it, found the way C<instruction_reads> and
+C<instruction_writes> find them.
 
 =cut
 
 */
 
 static void
-compute_one_du_chain(ARGMOD(SymReg *r), ARGIN(IMC_Unit *unit))
+du_note_ins(ARGMOD(du_chain_t *du), ARGIN(const Instruction *ins))
 {
-    ASSERT_ARGS(compute_one_du_chain)
-    Instruction * ins;
+    ASSERT_ARGS(du_note_ins)
+
+    du_note_all(du, ins, ins);
+
+    if (ins->type & ITPCCSUB) {
+        op_lib_t  * const  core_ops = PARROT_GET_CORE_OPLIB(NULL);
+        const Instruction *other;
+
+        for (other = ins; other; other = other->prev)
+            if (other->op == &core_ops->op_info_table[PARROT_OP_set_args_pc]) {
+                du_note_all(du, ins, other);
+                break;
+            }
+
+        for (other = ins->prev; other; other = other->next)
+            if (other->op == &core_ops->op_info_table[PARROT_OP_get_results_pc]) {
+                du_note_all(du, ins, other);
+                break;
+            }
+    }
+}
+
+/*
+
+=item C<static void compute_du_chain(imc_info_t * imcc, IMC_Unit *unit)>
+
+Compute a DU-chain for each symbolic in a compilation unit.  This takes a
+single pass over the instructions, looking up the symbols each one uses in
+the reglist sorted by address.
+
+=cut
+
+*/
+
+static void
+compute_du_chain(ARGMOD(imc_info_t * imcc), ARGMOD(IMC_Unit *unit))
+{
+    ASSERT_ARGS(compute_du_chain)
+    Instruction *ins = unit->instructions;
+    Instruction *lastbranch = NULL;
+    du_chain_t   du;
+    unsigned int i;
+
+    /* Compute last branch in this procedure, update instruction index */
+    for (i = 0; ins; ins = ins->next) {
+        ins->index = i++;
+        if (ins->type == ITBRANCH)
+            lastbranch = ins;
+    }
+
+    if (!unit->n_symbols)
+        return;
+
+    du.n_syms    = unit->n_symbols;
+    du.n_touched = 0;
+    du.syms      = mem_gc_allocate_n_typed(imcc->interp, du.n_syms, SymReg *);
+    du.seen      = mem_gc_allocate_n_typed(imcc->interp, du.n_syms, int);
+    du.writes    = mem_gc_allocate_n_typed(imcc->interp, du.n_syms, int);
+    du.touched   = mem_gc_allocate_n_typed(imcc->interp, du.n_syms, unsigned int);
 
     /* We cannot rely on computing the value of r->first when parsing,
      * since the situation can be changed at any time by the register
      * allocation algorithm */
-    r->first_ins     = NULL;
-    r->use_count     = 0;
-    r->lhs_use_count = 0;
+    for (i = 0; i < du.n_syms; i++) {
+        SymReg * const r = unit->reglist[i];
+
+        r->first_ins     = NULL;
+        r->use_count     = 0;
+        r->lhs_use_count = 0;
+        du.syms[i]       = r;
+        du.seen[i]       = -1;
+    }
+
+    qsort(du.syms, du.n_syms, sizeof (SymReg *), du_sym_cmp);
 
     for (ins = unit->instructions; ins; ins = ins->next) {
-        const int rw = instruction_writes(ins, r);
+        du.index     = (int)ins->index;
+        du.n_touched = 0;
+
+        du_note_ins(&du, ins);
+
+        for (i = 0; i < du.n_touched; i++) {
+            SymReg * const r = du.syms[du.touched[i]];
 
-        if (rw || instruction_reads(ins, r)) {
             if (!r->first_ins)
                 r->first_ins = ins;
 
             r->last_ins = ins;
 
-            if (rw)
+            if (du.writes[du.touched[i]])
                 r->lhs_use_count++;
 
             r->use_count++;
@@ -587,6 +770,22 @@ compute_one_du_chain(ARGMOD(SymReg *r), ARGIN(IMC_Unit *unit))
             }
         }
     }
+
+    mem_sys_free(du.syms);
+    mem_sys_free(du.seen);
+    mem_sys_free(du.writes);
+    mem_sys_free(du.touched);
+
+    for (i = 0; i < unit->n_symbols; i++) {
+        SymReg * const r = unit->reglist[i];
+
+        /* what is this used for? -lt */
+        if (r->type == VTIDENTIFIER
+        &&  lastbranch
+        &&  r->last_ins
+        &&  r->last_ins->index < lastbranch->index)
+            r->last_ins = lastbranch;
+    }
 }
 
 /*
@@ -54,6 +54,33 @@ set_make(ARGMOD(imc_info_t * imcc), unsigned int length)
 }
 
 
+/*
+
+=item C<Set* set_make_arena(imc_info_t * imcc, imc_arena_t *arena, unsigned int
+length)>
+
+Creates a new Set object in C<arena>.  The set goes away with the arena, so it
+mustn't be passed to C<set_free>, nor grow past C<length> items.
+
+=cut
+
+*/
+
+PARROT_CANNOT_RETURN_NULL
+Set*
+set_make_arena(ARGMOD(imc_info_t * imcc), ARGMOD(imc_arena_t *arena),
+        unsigned int length)
+{
+    ASSERT_ARGS(set_make_arena)
+    Set * const s = (Set *)imc_arena_allocate(imcc, arena,
+                            sizeof (Set) + NUM_BYTES(length));
+    s->length     = length;
+    s->bmp        = (unsigned char *)(s + 1);
+
+    return s;
+}
+
+
 /*
 
 =item C<Set* set_make_full(imc_info_t * imcc, unsigned int length)>
@@ -70,11 +97,9 @@ Set*
 set_make_full(ARGMOD(imc_info_t * imcc), unsigned int length)
 {
     ASSERT_ARGS(set_make_full)
-    Set * const s      = set_make(imcc, length);
-    const size_t bytes = NUM_BYTES(length);
+    Set * const s = set_make(imcc, length);
 
-    if (bytes)
-        memset(s->bmp, 0xff, bytes);
+    set_fill(s);
 
     return s;
 }
@@ -142,6 +167,27 @@ set_copy(ARGMOD(imc_info_t * imcc), ARGIN(const Set *s))
 }
 
 
+/*
+
+=item C<void set_copy_into(Set *d, const Set *s)>
+
+Copies the set C<s> into the set C<d>, which must be of the same length.
+
+=cut
+
+*/
+
+void
+set_copy_into(ARGMOD(Set *d), ARGIN(const Set *s))
+{
+    ASSERT_ARGS(set_copy_into)
+
+    PARROT_ASSERT(d->length == s->length);
+
+    memcpy(d->bmp, s->bmp, NUM_BYTES(d->length));
+}
+
+
 /*
 
 =item C<int set_equal(const Set *s1, const Set *s2)>
@@ -179,6 +225,24 @@ set_equal(ARGIN(const Set *s1), ARGIN(const Set *s2))
 }
 
 
+/*
+
+=item C<void set_fill(Set *s)>
+
+Sets all bits in the Set.
+
+=cut
+
+*/
+
+void
+set_fill(ARGMOD(Set *s))
+{
+    ASSERT_ARGS(set_fill)
+    memset(s->bmp, 0xff, NUM_BYTES(s->length));
+}
+
+
 /*
 
 =item C<void set_add(Set *s, unsigned int element)>
@@ -296,7 +360,7 @@ set_union(ARGMOD(imc_info_t * imcc), ARGIN(const Set *s1), ARGIN(const Set *s2))
 
     PARROT_ASSERT(s1->length == s2->length);
 
-    for (i = 0; i < BYTE_IN_SET(s1->length); i++) {
+    for (i = 0; i < NUM_BYTES(s1->length); i++) {
         s->bmp[i] = s1->bmp[i] | s2->bmp[i];
     }
 
@@ -327,7 +391,7 @@ set_intersec(ARGMOD(imc_info_t * imcc), ARGIN(const Set *s1),
 
     PARROT_ASSERT(s1->length == s2->length);
 
-    for (i = 0; i < BYTE_IN_SET(s1->length); i++) {
+    for (i = 0; i < NUM_BYTES(s1->length); i++) {
         s->bmp[i] = s1->bmp[i] & s2->bmp[i];
     }
 
@@ -354,7 +418,7 @@ set_intersec_inplace(ARGMOD(Set *s1), ARGIN(const Set *s2))
 
     PARROT_ASSERT(s1->length == s2->length);
 
-    for (i = 0; i < BYTE_IN_SET(s1->length); i++) {
+    for (i = 0; i < NUM_BYTES(s1->length); i++) {
         s1->bmp[i] &= s2->bmp[i];
     }
 }
@@ -33,11 +33,20 @@ Set* set_copy(ARGMOD(imc_info_t * imcc), ARGIN(const Set *s))
         __attribute__nonnull__(2)
         FUNC_MODIFIES(* imcc);
 
+void set_copy_into(ARGMOD(Set *d), ARGIN(const Set *s))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*d);
+
 PARROT_PURE_FUNCTION
 int set_equal(ARGIN(const Set *s1), ARGIN(const Set *s2))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+void set_fill(ARGMOD(Set *s))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*s);
+
 PARROT_WARN_UNUSED_RESULT
 PARROT_PURE_FUNCTION
 unsigned int set_first_zero(ARGIN(const Set *s))
@@ -69,6 +78,16 @@ Set* set_make(ARGMOD(imc_info_t * imcc), unsigned int length)
         __attribute__nonnull__(1)
         FUNC_MODIFIES(* imcc);
 
+PARROT_CANNOT_RETURN_NULL
+Set* set_make_arena(
+    ARGMOD(imc_info_t * imcc),
+    ARGMOD(imc_arena_t *arena),
+    unsigned int length)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(* imcc)
+        FUNC_MODIFIES(*arena);
+
 PARROT_MALLOC
 PARROT_CANNOT_RETURN_NULL
 Set* set_make_full(ARGMOD(imc_info_t * imcc), unsigned int length)
@@ -95,9 +114,14 @@ Set * set_union(
 #define ASSERT_ARGS_set_copy __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc) \
     , PARROT_ASSERT_ARG(s))
+#define ASSERT_ARGS_set_copy_into __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(d) \
+    , PARROT_ASSERT_ARG(s))
 #define ASSERT_ARGS_set_equal __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(s1) \
     , PARROT_ASSERT_ARG(s2))
+#define ASSERT_ARGS_set_fill __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(s))
 #define ASSERT_ARGS_set_first_zero __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(s))
 #define ASSERT_ARGS_set_free __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -111,6 +135,9 @@ Set * set_union(
     , PARROT_ASSERT_ARG(s2))
 #define ASSERT_ARGS_set_make __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc))
+#define ASSERT_ARGS_set_make_arena __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(imcc) \
+    , PARROT_ASSERT_ARG(arena))
 #define ASSERT_ARGS_set_make_full __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(imcc))
 #define ASSERT_ARGS_set_union __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -32,6 +32,10 @@ and SymbolTable (see symbol.h and symbol.c)
 
 /* HEADERIZER HFILE: compilers/imcc/symreg.h */
 
+/* symbol hashes are a power of two in size, so the bucket of a name is taken
+ * from the low bits of its hash */
+#define SYMHASH_INDEX(hsh, name) (hash_str(name) & ((hsh)->size - 1))
+
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
@@ -156,7 +160,7 @@ _get_sym_typed(ARGIN(const SymHash *hsh), ARGIN(const char *name), int t)
 {
     ASSERT_ARGS(_get_sym_typed)
     SymReg            *p;
-    const unsigned int i = hash_str(name) % hsh->size;
+    const unsigned int i = SYMHASH_INDEX(hsh, name);
 
     for (p = hsh->data[i]; p; p = p->next) {
         if ((t == p->set) && STREQ(name, p->name))
@@ -185,7 +189,7 @@ get_sym_by_name(ARGIN(const SymHash *hsh), ARGIN(const char *name))
     ASSERT_ARGS(get_sym_by_name)
 
     SymReg            *p;
-    const unsigned int i = hash_str(name) % hsh->size;
+    const unsigned int i = SYMHASH_INDEX(hsh, name);
 
     for (p = hsh->data[i]; p; p = p->next) {
         if (STREQ(name, p->name))
@@ -1316,37 +1320,28 @@ static void
 resize_symhash(ARGMOD(imc_info_t * imcc), ARGMOD(SymHash *hsh))
 {
     ASSERT_ARGS(resize_symhash)
-    const int    new_size = hsh->size << 1; /* new size is twice as large */
-    int          n_next   = 16;
-    SymReg **next_r = mem_gc_allocate_n_zeroed_typed(imcc->interp, n_next, SymReg *);
     SymHash      nh;                        /* new symbol table */
     unsigned int i;
 
-    nh.data = mem_gc_allocate_n_zeroed_typed(imcc->interp, new_size, SymReg *);
+    nh.size = hsh->size << 1;               /* new size is twice as large */
+    nh.data = mem_gc_allocate_n_zeroed_typed(imcc->interp, nh.size, SymReg *);
 
+    /* relink the symbols into the new buckets; symbols of the same name
+     * stay in the same order, so the newest one still shadows the others */
     for (i = 0; i < hsh->size; i++) {
         SymReg *r, *next;
-        int     k;
-        int     j = 0;
+        SymReg *rev = NULL;
 
         for (r = hsh->data[i]; r; r = next) {
-            next = r->next;
-
-            /* remember all the chained next pointers and clear r->next */
-            if (j >= n_next) {
-                n_next <<= 1;
-                next_r = mem_gc_realloc_n_typed(imcc->interp, next_r, n_next, SymReg *);
-            }
-
-            r->next     = NULL;
-            next_r[j++] = r;
+            next    = r->next;
+            r->next = rev;
+            rev     = r;
         }
 
-        for (k = 0; k < j; ++k) {
-            int new_i;
-            r              = next_r[k];
-            /* recompute hash for this symbol: */
-            new_i          = hash_str(r->name) % new_size;
+        for (r = rev; r; r = next) {
+            const unsigned int new_i = SYMHASH_INDEX(&nh, r->name);
+
+            next           = r->next;
             r->next        = nh.data[new_i];
             nh.data[new_i] = r;
         }
@@ -1354,11 +1349,10 @@ resize_symhash(ARGMOD(imc_info_t * imcc), ARGMOD(SymHash *hsh))
 
     /* free memory of old hash table */
     mem_sys_free(hsh->data);
-    mem_sys_free(next_r);
 
     /* let the hashtable's data pointers point to the new data */
     hsh->data = nh.data;
-    hsh->size = new_size;
+    hsh->size = nh.size;
 }
 
 
@@ -1366,7 +1360,9 @@ resize_symhash(ARGMOD(imc_info_t * imcc), ARGMOD(SymHash *hsh))
 
 =item C<void _store_symreg(imc_info_t * imcc, SymHash *hsh, SymReg *r)>
 
-Stores a symbol in the hash (internal use only).
+Stores a symbol in the hash (internal use only).  Global symbols are also
+queued for C<constant_folding>, which then needn't walk the whole of the
+global hash for each sub it emits.
 
 =cut
 
@@ -1377,7 +1373,7 @@ _store_symreg(ARGMOD(imc_info_t * imcc), ARGMOD(SymHash *hsh),
         ARGMOD(SymReg *r))
 {
     ASSERT_ARGS(_store_symreg)
-    const int i = hash_str(r->name) % hsh->size;
+    const unsigned int i = SYMHASH_INDEX(hsh, r->name);
     r->next      = hsh->data[i];
     hsh->data[i] = r;
 
@@ -1385,6 +1381,16 @@ _store_symreg(ARGMOD(imc_info_t * imcc), ARGMOD(SymHash *hsh),
 
     if (hsh->entries >= hsh->size)
         resize_symhash(imcc, hsh);
+
+    if (hsh == &imcc->ghash) {
+        if (imcc->n_unfolded == imcc->unfolded_size) {
+            imcc->unfolded_size = imcc->unfolded_size ? imcc->unfolded_size << 1 : 16;
+            imcc->unfolded      = mem_gc_realloc_n_typed(imcc->interp,
+                    imcc->unfolded, imcc->unfolded_size, SymReg *);
+        }
+
+        imcc->unfolded[imcc->n_unfolded++] = r;
+    }
 }
 
 
@@ -1423,7 +1429,7 @@ _get_sym(ARGIN(const SymHash *hsh), ARGIN(const char *name))
 {
     ASSERT_ARGS(_get_sym)
     SymReg   *p;
-    const unsigned int i = hash_str(name) % hsh->size;
+    const unsigned int i = SYMHASH_INDEX(hsh, name);
 
     for (p = hsh->data[i]; p; p = p->next) {
         if (STREQ(name, p->name))
@@ -1612,6 +1618,11 @@ clear_globals(ARGMOD(imc_info_t * imcc))
 
     if (hsh->data)
         clear_sym_hash(hsh);
+
+    mem_sys_free(imcc->unfolded);
+    imcc->unfolded      = NULL;
+    imcc->n_unfolded    = 0;
+    imcc->unfolded_size = 0;
 }
 
 
@@ -1621,7 +1632,8 @@ clear_globals(ARGMOD(imc_info_t * imcc))
 
 =item C<unsigned int hash_str(const char *str)>
 
-Computes the hash value for the string argument.
+Computes the hash value for the string argument (32-bit FNV-1a), which mixes
+every character into the low bits that pick the bucket of a symbol.
 
 =cut
 
@@ -1632,13 +1644,13 @@ unsigned int
 hash_str(ARGIN(const char *str))
 {
     ASSERT_ARGS(hash_str)
-    unsigned long  key = 0;
-    const    char *s;
+    UINTVAL              key = 2166136261U;
+    const unsigned char *s;
 
-    for (s = str; *s; s++)
-        key = key * 65599 + *s;
+    for (s = (const unsigned char *)str; *s; s++)
+        key = ((key ^ *s) * 16777619U) & 0xffffffffU;
 
-    return key;
+    return (unsigned int)key;
 }
 
 
@@ -25,10 +25,12 @@ struct imcc_ostat {
     int deleted_labels;
     int if_branch;
     int branch_branch;
-    int branch_cond_loop;
     int invariants_moved;
     int deleted_ins;
-    int used_once;
+    int dead_stores;
+    int redundant_ins;
+    int copies_propagated;
+    int pmcs_replaced;
 } ;
 
 struct IMC_Unit {
@@ -45,6 +47,7 @@ struct IMC_Unit {
     int               n_loops;
     Loop_info       **loop_info;
     Edge             *edge_list;
+    imc_arena_t       cfg_arena;        /* blocks, edges and sets of the CFG */
 
     /* register allocation */
     SymReg          **reglist;
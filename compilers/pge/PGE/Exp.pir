@@ -44,6 +44,9 @@ PGE::Exp - base class for expressions
     p6meta.'new_class'('PGE::Exp::Closure',      'parent'=>expproto)
     p6meta.'new_class'('PGE::Exp::Action',       'parent'=>expproto)
 
+    $P0 = new 'Hash'
+    set_global '%!nfa', $P0
+
     load_bytecode 'PGE/Util.pbc'
 .end
 
@@ -234,10 +237,39 @@ tree as a PIR code object that can be compiled.
     code.'append_format'("          captscope = mob\n")
   code_body_3:
 
-    code.'append_format'(<<"        CODE", PGE_CUT_RULE, returnop)
+    ##   if the expression is regular, a RegexNFA can skip ahead
+    ##   to the next position where it might match
+    .local string nfaprog
+    nfaprog = exp.'nfa'()
+    if nfaprog == '' goto code_body_4
+    nfaprog = escape(nfaprog)
+    code.'append_format'(<<"        CODE", nfaprog)
+          .local pmc nfa
+          null nfa
+          unless iscont goto code_nfa
+          $P0 = get_root_global ['parrot';'PGE';'Exp'], '!nfa'
+          nfa = $P0(%0)
+        code_nfa:
+        CODE
+  code_body_4:
+
+    code.'append_format'(<<"        CODE")
           .local int pos, rep, cutmark
         try_match:
           if cpos > lastpos goto fail_rule
+        CODE
+    if nfaprog == '' goto code_body_5
+    code.'append_format'(<<"        CODE")
+          if null nfa goto try_match_1
+          cpos = nfa.'find'(target, cpos)
+          if cpos >= 0 goto try_match_1
+          mfrom = lastpos
+          goto fail_rule
+        try_match_1:
+        CODE
+  code_body_5:
+
+    code.'append_format'(<<"        CODE", PGE_CUT_RULE, returnop)
           mfrom = cpos
           pos = cpos
           cutmark = 0
@@ -275,6 +307,73 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+=item C<nfa()>
+
+Return a program for the C<RegexNFA> engine (see
+F<src/dynpmc/regexnfa.pmc>) that matches at least everything
+this (reduced) expression matches, or an empty string if the
+expression can't be described that way.  Subrules, backreferences
+and closures aren't regular, so by default an expression isn't.
+
+=cut
+
+.sub 'nfa' :method
+    .return ('')
+.end
+
+
+.sub '!nfa_chars' :method
+    .param string op
+    .param string chars
+    $I0 = length chars
+    $S0 = $I0
+    op = concat op, $S0
+    op = concat op, ':'
+    op = concat op, chars
+    .return (op)
+.end
+
+
+=item C<!nfa(string prog)>
+
+Return a C<RegexNFA> compiled from C<prog>, or null if the
+C<regexnfa> library isn't available or won't compile it.  Each
+program is only compiled once.
+
+=cut
+
+.sub '!nfa'
+    .param string prog
+    .local pmc cache, nfa
+    cache = get_global '%!nfa'
+    nfa = cache[prog]
+    unless null nfa goto have_nfa
+
+    nfa = new 'Undef'
+    push_eh compile_fail
+    $P0 = loadlib 'regexnfa'
+    $I0 = defined $P0
+    unless $I0 goto compile_end
+    $P0 = new ['RegexNFA']
+    $P0.'compile'(prog)
+    nfa = $P0
+  compile_end:
+    pop_eh
+    cache[prog] = nfa
+    goto have_nfa
+  compile_fail:
+    pop_eh
+    cache[prog] = nfa
+
+  have_nfa:
+    $I0 = defined nfa
+    if $I0 goto end
+    null nfa
+  end:
+    .return (nfa)
+.end
+
+
 .sub 'getargs' :method
     .param pmc label
     .param pmc next
@@ -407,6 +506,33 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    .local string literal, op
+    .local int litlen
+    literal = self.'ast'()
+    litlen = length literal
+    if litlen == 0 goto empty
+    op = 'L'
+    $I0 = self['ignorecase']
+    if $I0 == 0 goto have_literal
+    op = 'I'
+    literal = downcase literal
+    $I0 = length literal
+    if $I0 == litlen goto have_literal
+    ##  downcasing changed the length, so accept any litlen characters
+    $S0 = litlen
+    op = concat 'Q', $S0
+    op = concat op, ','
+    op = concat op, $S0
+    op = concat op, ':.'
+    .return (op)
+  have_literal:
+    .tailcall self.'!nfa_chars'(op, literal)
+  empty:
+    .return ('e')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Concat' ]
 
 .sub 'reduce' :method
@@ -490,6 +616,29 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    .local pmc it, exp
+    .local string prog
+    $P0 = self.'list'()
+    $I0 = elements $P0
+    $S0 = $I0
+    prog = concat '&', $S0
+    prog = concat prog, ':'
+    it = iter $P0
+  iter_loop:
+    unless it goto iter_end
+    exp = shift it
+    $S0 = exp.'nfa'()
+    if $S0 == '' goto irregular
+    prog = concat prog, $S0
+    goto iter_loop
+  iter_end:
+    .return (prog)
+  irregular:
+    .return ('')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Quant' ]
 
 .sub 'reduce' :method
@@ -683,6 +832,66 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    .local pmc exp, sep
+    .local string prog, sepprog
+    .local int min, max
+    exp = self[0]
+    prog = exp.'nfa'()
+    if prog == '' goto irregular
+    min = self['min']
+    max = self['max']
+    if max != PGE_INF goto have_max
+    max = -1
+  have_max:
+    sep = self['sep']
+    if null sep goto quant
+    sepprog = sep.'nfa'()
+    if sepprog == '' goto irregular
+    if max == 0 goto empty
+    ##  x ** sep is x followed by (sep x) one less time than x
+    $S0 = concat '&2:', sepprog
+    $S0 = concat $S0, prog
+    $I0 = min - 1
+    if $I0 >= 0 goto sep_min
+    $I0 = 0
+  sep_min:
+    $I1 = max
+    if $I1 < 0 goto sep_max
+    dec $I1
+  sep_max:
+    $S0 = self.'!nfa_quant'($I0, $I1, $S0)
+    $S1 = concat '&2:', prog
+    prog = concat $S1, $S0
+    if min > 0 goto end
+    prog = concat '|', prog
+    prog = concat prog, 'e'
+    goto end
+  quant:
+    prog = self.'!nfa_quant'(min, max, prog)
+  end:
+    .return (prog)
+  empty:
+    .return ('e')
+  irregular:
+    .return ('')
+.end
+
+.sub '!nfa_quant' :method
+    .param int min
+    .param int max
+    .param string prog
+    $S0 = min
+    $S1 = max
+    $S0 = concat 'Q', $S0
+    $S0 = concat $S0, ','
+    $S0 = concat $S0, $S1
+    $S0 = concat $S0, ':'
+    $S0 = concat $S0, prog
+    .return ($S0)
+.end
+
+
 .namespace [ 'PGE';'Exp';'Group' ]
 
 .sub 'reduce' :method
@@ -747,6 +956,12 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    $P0 = self[0]
+    .tailcall $P0.'nfa'()
+.end
+
+
 .namespace [ 'PGE';'Exp';'CGroup' ]
 
 .sub 'pir' :method :nsentry
@@ -971,6 +1186,17 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    ##  assertions don't consume anything; other subrules can
+    ##  match anything at all
+    $I0 = self['iszerowidth']
+    if $I0 goto zerowidth
+    .return ('')
+  zerowidth:
+    .return ('e')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Alt' ]
 
 .sub 'reduce' :method
@@ -1011,6 +1237,22 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    .local string prog
+    $P0 = self[0]
+    $S0 = $P0.'nfa'()
+    if $S0 == '' goto irregular
+    $P1 = self[1]
+    $S1 = $P1.'nfa'()
+    if $S1 == '' goto irregular
+    prog = concat '|', $S0
+    prog = concat prog, $S1
+    .return (prog)
+  irregular:
+    .return ('')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Anchor' ]
 
 .sub 'reduce' :method
@@ -1135,6 +1377,42 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    .local string token
+    token = self.'ast'()
+    if token == '<?>' goto anchor_null
+    if token == '^' goto anchor_bos
+    if token == '$' goto anchor_eos
+    if token == '^^' goto anchor_bol
+    if token == '$$' goto anchor_eol
+    if token == '<<' goto anchor_word_left
+    if token == '>>' goto anchor_word_right
+    if token == unicode:"\xab" goto anchor_word_left
+    if token == unicode:"\xbb" goto anchor_word_right
+    if token == '\b' goto anchor_word
+    if token == '\B' goto anchor_not_word
+    .return ('F')
+  anchor_null:
+    .return ('e')
+  anchor_bos:
+    .return ('A^')
+  anchor_eos:
+    .return ('A$')
+  anchor_bol:
+    .return ('A<')
+  anchor_eol:
+    .return ('A>')
+  anchor_word_left:
+    .return ('A[')
+  anchor_word_right:
+    .return ('A]')
+  anchor_word:
+    .return ('Ab')
+  anchor_not_word:
+    .return ('AB')
+.end
+
+
 .namespace [ 'PGE';'Exp';'CCShortcut' ]
 
 .sub 'reduce' :method
@@ -1276,6 +1554,23 @@ tree as a PIR code object that can be compiled.
 
 .end
 
+.sub 'nfa' :method
+    .local int cclass, negate
+    cclass = self['cclass']
+    negate = self['negate']
+    if cclass == .CCLASS_ANY goto any
+    $S0 = cclass
+    $S0 = concat 'C', $S0
+    $S0 = concat $S0, ','
+    $S1 = negate
+    $S0 = concat $S0, $S1
+    $S0 = concat $S0, ':'
+    .return ($S0)
+  any:
+    .return ('.')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Cut' ]
 
 .sub 'reduce' :method
@@ -1328,6 +1623,17 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    ##  cutting a group only removes matches, but cutting the
+    ##  rule or match stops the search at the current position
+    $I0 = self['cutmark']
+    if $I0 <= PGE_CUT_RULE goto irregular
+    .return ('e')
+  irregular:
+    .return ('')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Scalar' ]
 
 .sub 'reduce' :method
@@ -1407,6 +1713,22 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    $I0 = self['iszerowidth']
+    if $I0 goto zerowidth
+    .local string op
+    op = 'S'
+    $I0 = self['isnegated']
+    if $I0 == 0 goto have_op
+    op = 'N'
+  have_op:
+    $S0 = self.'ast'()
+    .tailcall self.'!nfa_chars'(op, $S0)
+  zerowidth:
+    .return ('e')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Newline' ]
 
 .sub 'reduce' :method
@@ -1432,6 +1754,14 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    $S0 = .CCLASS_NEWLINE
+    $S0 = concat '|C', $S0
+    $S0 = concat $S0, ",0:L2:\r\n"
+    .return ($S0)
+.end
+
+
 .namespace [ 'PGE';'Exp';'Conj' ]
 
 .sub 'reduce' :method
@@ -1491,6 +1821,20 @@ tree as a PIR code object that can be compiled.
     .return ()
 .end
 
+.sub 'nfa' :method
+    ##  both sides match the same text, so either will do
+    $P0 = self[0]
+    $S0 = $P0.'nfa'()
+    if $S0 == '' goto irregular
+    $P1 = self[1]
+    $S1 = $P1.'nfa'()
+    if $S1 == '' goto irregular
+    .return ($S0)
+  irregular:
+    .return ('')
+.end
+
+
 .namespace [ 'PGE';'Exp';'Closure' ]
 
 .sub 'reduce' :method
@@ -1597,6 +1941,17 @@ tree as a PIR code object that can be compiled.
 .end
 
 
+.sub 'nfa' :method
+    ##  an action's method must still be called wherever
+    ##  the match gets to it
+    $S0 = self['actionname']
+    if $S0 == '' goto no_action
+    .return ('')
+  no_action:
+    .return ('e')
+.end
+
+
 # Local Variables:
 #   mode: pir
 #   fill-column: 100
@@ -425,6 +425,7 @@ include/parrot/caches.h
 include/parrot/config.h
 include/parrot/platform_interface.h
 include/parrot/hll.h
+include/parrot/metrics.h
 include/parrot/packfile.h
 include/parrot/exceptions.h
 include/parrot/string_funcs.h
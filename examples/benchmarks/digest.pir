@@ -0,0 +1,89 @@
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+examples/benchmarks/digest.pir - Message digest throughput
+
+=head1 SYNOPSIS
+
+    % time ./parrot examples/benchmarks/digest.pir [megabytes]
+
+=head1 DESCRIPTION
+
+Feeds the given number of megabytes (default 4) through each algorithm of
+the C<Digest> dynpmc, once as 64 KB strings and once as 64 KB ByteBuffers,
+and prints the digest and the throughput of each run.
+
+=cut
+
+.loadlib 'digest'
+
+.sub main :main
+    .param pmc argv
+
+    .local int megabytes
+    megabytes = 4
+    $I0 = elements argv
+    if $I0 < 2 goto go
+    $S0 = argv[1]
+    megabytes = $S0
+  go:
+
+    .local string chunk
+    chunk = repeat 'parrot!!', 8192
+
+    .local pmc buffer
+    buffer = new ['ByteBuffer']
+    buffer = chunk
+
+    bench('md5',    chunk,  megabytes)
+    bench('md5',    buffer, megabytes)
+    bench('sha1',   chunk,  megabytes)
+    bench('sha1',   buffer, megabytes)
+    bench('sha256', chunk,  megabytes)
+    bench('sha256', buffer, megabytes)
+.end
+
+.sub bench
+    .param string algorithm
+    .param pmc    chunk
+    .param int    megabytes
+
+    .local pmc digest
+    digest = new ['Digest']
+    digest.'reset'(algorithm)
+
+    .local int n
+    n = megabytes * 16
+
+    .local num start
+    start = time
+  loop:
+    digest.'update'(chunk)
+    dec n
+    if n > 0 goto loop
+
+    .local string hex
+    hex = digest.'final'()
+
+    $N0 = time
+    $N0 -= start
+    $N1 = megabytes
+    if $N0 == 0.0 goto report
+    $N1 /= $N0
+  report:
+    $S0 = typeof chunk
+    $P0 = new 'ResizablePMCArray'
+    push $P0, algorithm
+    push $P0, $S0
+    push $P0, hex
+    push $P0, $N1
+    $S0 = sprintf "%-6s %-10s %s %.1f MB/s\n", $P0
+    print $S0
+.end
+
+# Local Variables:
+#   mode: pir
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4 ft=pir:
@@ -0,0 +1,133 @@
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+examples/benchmarks/json.pir - JSON parsing and emitting throughput
+
+=head1 SYNOPSIS
+
+    % time ./parrot examples/benchmarks/json.pir [records]
+
+=head1 DESCRIPTION
+
+Builds a document of the given number of records (default 1000), then emits
+it with the C<JSONCodec> dynpmc and with C<_json> from F<JSON.pir>, and parses
+the result with C<JSONCodec>, printing the throughput of each.  The
+C<data_json> compiler slows down sharply with document size, so it is only
+given a document of ten records.
+
+=cut
+
+.loadlib 'jsoncodec'
+
+.sub main :main
+    .param pmc argv
+
+    .local int records
+    records = 1000
+    $I0 = elements argv
+    if $I0 < 2 goto go
+    $S0 = argv[1]
+    records = $S0
+  go:
+
+    load_bytecode 'JSON.pbc'
+    load_language 'data_json'
+
+    .local pmc document, codec
+    document = build(records)
+    codec    = new ['JSONCodec']
+
+    .local string text
+    .local num start, codec_time, pir_time
+    start = time
+    text  = codec.'emit'(document)
+    codec_time = time
+    codec_time -= start
+
+    start = time
+    $S0 = _json(document)
+    pir_time = time
+    pir_time -= start
+
+    .local int size
+    size = length text
+    report('emit', 'JSONCodec', size, codec_time)
+    report('emit', 'JSON.pir', size, pir_time)
+
+    start = time
+    $P0 = codec.'parse'(text)
+    codec_time = time
+    codec_time -= start
+
+    report('parse', 'JSONCodec', size, codec_time)
+
+    $P1   = build(10)
+    text  = codec.'emit'($P1)
+    size  = length text
+    start = time
+    $P1 = compreg 'data_json'
+    $P2 = $P1.'compile'(text)
+    $P3 = $P2()
+    pir_time = time
+    pir_time -= start
+    report('parse', 'data_json', size, pir_time)
+.end
+
+.sub build
+    .param int records
+
+    .local pmc document, list
+    document = new ['Hash']
+    list     = new ['ResizablePMCArray']
+    document['records'] = list
+    document['count']   = records
+
+    .local int i
+    i = 0
+  loop:
+    if i >= records goto done
+    $P0 = new ['Hash']
+    $P0['id']    = i
+    $P0['name']  = 'record name with some text'
+    $P0['score'] = 0.75
+    $P1 = new ['Boolean']
+    $P1 = 1
+    $P0['valid'] = $P1
+    $P2 = new ['ResizablePMCArray']
+    push $P2, 'red'
+    push $P2, 'green'
+    push $P2, 'blue'
+    $P0['tags']  = $P2
+    push list, $P0
+    inc i
+    goto loop
+  done:
+    .return (document)
+.end
+
+.sub report
+    .param string operation
+    .param string engine
+    .param int    size
+    .param num    seconds
+
+    $N0 = size
+    $N0 /= 1048576.0
+    if seconds == 0.0 goto print
+    $N0 /= seconds
+  print:
+    $P0 = new 'ResizablePMCArray'
+    push $P0, operation
+    push $P0, engine
+    push $P0, seconds
+    push $P0, $N0
+    $S0 = sprintf "%-6s %-10s %.3f s %.2f MB/s\n", $P0
+    print $S0
+.end
+
+# Local Variables:
+#   mode: pir
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4 ft=pir:
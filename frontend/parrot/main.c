@@ -36,6 +36,9 @@ struct init_args_t {
     Parrot_Int have_pasm_file;
     Parrot_Int turn_gc_off;
     Parrot_Int preprocess_only;
+    Parrot_String snapshot_out;
+    Parrot_String snapshot_in;
+    const char *optimize;
 };
 
 extern int Parrot_set_config_hash(Parrot_PMC interp_pmc);
@@ -65,6 +68,9 @@ static int is_float(ARGIN(const char *s))
 PARROT_CAN_RETURN_NULL
 static PMC * load_bytecode_file(Parrot_PMC interp, Parrot_String filename);
 
+PARROT_CAN_RETURN_NULL
+static PMC * load_snapshot_file(Parrot_PMC interp, Parrot_String filename);
+
 PARROT_WARN_UNUSED_RESULT
 PARROT_CANNOT_RETURN_NULL
 static const struct longopt_opt_decl * Parrot_cmd_options(void);
@@ -126,6 +132,7 @@ static void verify_file_names(
 #define ASSERT_ARGS_is_float __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(s))
 #define ASSERT_ARGS_load_bytecode_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
+#define ASSERT_ARGS_load_snapshot_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
 #define ASSERT_ARGS_Parrot_cmd_options __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
 #define ASSERT_ARGS_Parrot_version __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
 #define ASSERT_ARGS_parseflags __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -202,7 +209,12 @@ main(int argc, const char *argv[])
             show_last_error_and_exit(interp);
     }
 
-    if (parsed_flags.have_pbc_file) {
+    if (parsed_flags.snapshot_in) {
+        bytecodepmc = load_snapshot_file(interp, parsed_flags.snapshot_in);
+        if (parsed_flags.turn_gc_off)
+            Parrot_api_toggle_gc(interp, 0);
+    }
+    else if (parsed_flags.have_pbc_file) {
         bytecodepmc = load_bytecode_file(interp, source_str);
         if (parsed_flags.turn_gc_off)
             Parrot_api_toggle_gc(interp, 0);
@@ -222,6 +234,12 @@ main(int argc, const char *argv[])
             bytecodepmc = load_bytecode_file(interp, output_str);
     }
 
+    /* --snapshot-out runs the :init subs and saves the result instead of main */
+    if (parsed_flags.snapshot_out) {
+        if (!Parrot_api_write_snapshot(interp, bytecodepmc, parsed_flags.snapshot_out))
+            show_last_error_and_exit(interp);
+    }
+
     if (parsed_flags.execute_packfile) {
         if (!Parrot_api_run_bytecode(interp, bytecodepmc, argsarray))
             show_last_error_and_exit(interp);
@@ -254,6 +272,10 @@ run_imcc(Parrot_PMC interp, Parrot_String sourcefile, ARGIN(struct init_args_t *
     if (!(imcc_get_pir_compreg_api(interp, 1, &pir_compiler) &&
           imcc_get_pasm_compreg_api(interp, 1, &pasm_compiler)))
         show_last_error_and_exit(interp);
+    if (flags->optimize
+    && !(imcc_set_optimization_level_api(interp, pir_compiler, flags->optimize) &&
+         imcc_set_optimization_level_api(interp, pasm_compiler, flags->optimize)))
+        show_last_error_and_exit(interp);
     if (flags->preprocess_only) {
         Parrot_Int r = imcc_preprocess_file_api(interp, pir_compiler, sourcefile);
         exit(r ? EXIT_SUCCESS : EXIT_FAILURE);
@@ -302,6 +324,37 @@ load_bytecode_file(Parrot_PMC interp, Parrot_String filename)
 
 /*
 
+=item C<static PMC * load_snapshot_file(Parrot_PMC interp, Parrot_String
+filename)>
+
+Restore a snapshot written by C<--snapshot-out> and return its program
+
+=cut
+
+*/
+
+PARROT_CAN_RETURN_NULL
+static PMC *
+load_snapshot_file(Parrot_PMC interp, Parrot_String filename)
+{
+    ASSERT_ARGS(load_snapshot_file)
+    Parrot_PMC bytecode = NULL;
+
+    /* the compregs were registered when the snapshot was written */
+    Parrot_PMC pir_compiler;
+    Parrot_PMC pasm_compiler;
+
+    if (!(imcc_get_pir_compreg_api(interp, 1, &pir_compiler) &&
+          imcc_get_pasm_compreg_api(interp, 1, &pasm_compiler)))
+        show_last_error_and_exit(interp);
+
+    if (!Parrot_api_load_snapshot_file(interp, filename, &bytecode))
+        show_last_error_and_exit(interp);
+    return bytecode;
+}
+
+/*
+
 =item C<static void show_last_error_and_exit(Parrot_PMC interp)>
 
 Prints out the C<interp>'s last error and exits.
@@ -514,8 +567,8 @@ help(void)
     "       --hash-seed F00F  specify hex value to use as hash seed\n"
     "    -X --dynext add path to dynamic extension search\n"
     "   <Run core options>\n"
-    "    -R --runcore slow|bounds|fast\n"
-    "    -R --runcore trace|profiling|gcdebug\n"
+    "    -R --runcore slow|bounds|fast|jit\n"
+    "    -R --runcore trace|profiling|sampling|gcdebug\n"
     "    -t --trace [flags]\n"
     "   <VM options>\n"
     "    -D --parrot-debug[=HEXFLAGS]\n"
@@ -544,6 +597,8 @@ help(void)
     "    -c --pbc\n"
     "    -r --run-pbc\n"
     "    -y --yydebug\n"
+    "       --snapshot-out=FILE  run :init subs, save the interpreter, exit\n"
+    "       --snapshot-in=FILE   start from a saved interpreter\n"
     "   <Language options>\n"
     "see docs/running.pod for more\n");
 }
@@ -600,6 +655,8 @@ Parrot_cmd_options(void)
         { 'v', 'v', (OPTION_flags)0, { "--verbose" } },
         { 'w', 'w', (OPTION_flags)0, { "--warnings" } },
         { 'y', 'y', (OPTION_flags)0, { "--yydebug" } },
+        { '\0', OPT_SNAPSHOT_OUT, OPTION_required_FLAG, { "--snapshot-out" } },
+        { '\0', OPT_SNAPSHOT_IN, OPTION_required_FLAG, { "--snapshot-in" } },
         { 0, 0, (OPTION_flags)0, { NULL } }
     };
     return cmd_options;
@@ -735,6 +792,7 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
     int status;
     int result = 1;
     const char *sourcefile;
+    const char *snapshot = NULL;
 
     args->run_core_name = "fast";
     args->write_packfile = 0;
@@ -746,6 +804,9 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
     args->outfile = NULL;
     args->sourcefile = NULL;
     args->preprocess_only = 0;
+    args->snapshot_out = NULL;
+    args->snapshot_in = NULL;
+    args->optimize = NULL;
 
     if (argc == 1) {
         usage(stderr);
@@ -830,6 +891,16 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
           case 'c':
             args->have_pbc_file = 1;
             break;
+          case OPT_SNAPSHOT_OUT:
+            args->execute_packfile = 0;
+            if (!Parrot_api_string_import(interp, opt.opt_arg, &args->snapshot_out))
+                show_last_error_and_exit(interp);
+            break;
+          case OPT_SNAPSHOT_IN:
+            snapshot = opt.opt_arg;
+            if (!Parrot_api_string_import(interp, opt.opt_arg, &args->snapshot_in))
+                show_last_error_and_exit(interp);
+            break;
           case OPT_GC_DEBUG:
           /*
 #if DISABLE_GC_DEBUG
@@ -858,6 +929,9 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
             /* result = Parrot_api_set_warnings(interp, PARROT_WARNINGS_ALL_FLAG); */
             result = Parrot_api_set_warnings(interp, 0xFFFF);
             break;
+          case 'O':
+            args->optimize = opt.opt_arg ? opt.opt_arg : "1";
+            break;
           case 'E':
             args->preprocess_only = 1;
           default:
@@ -877,6 +951,22 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
         exit(EXIT_FAILURE);
     }
 
+    /* a snapshot holds its program, which sees the snapshot as its name */
+    if (snapshot) {
+        const char ** const snapshot_argv = (const char **)
+                calloc(argc - opt.opt_index + 2, sizeof (const char *));
+        if (!snapshot_argv) {
+            fprintf(stderr, "PARROT VM: Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        snapshot_argv[0] = snapshot;
+        memcpy(snapshot_argv + 1, argv + opt.opt_index,
+                (argc - opt.opt_index) * sizeof (const char *));
+        *pgm_argc = argc - opt.opt_index + 1;
+        *pgm_argv = snapshot_argv;
+        return;
+    }
+
     /* reached the end of the option list and consumed all of argv */
     if (argc == opt.opt_index) {
         /* We are not looking at an option, so it must be a program name */
@@ -32,6 +32,7 @@ struct init_args_t {
     Parrot_Int turn_gc_off;
     const char ** argv;
     int argc;
+    const char *optimize;
 };
 
 extern int Parrot_set_config_hash(Parrot_PMC interp_pmc);
@@ -87,7 +88,9 @@ static void print_parrot_string(
         FUNC_MODIFIES(*vector);
 
 PARROT_CANNOT_RETURN_NULL
-static void setup_imcc(Parrot_PMC interp);
+static void setup_imcc(
+    Parrot_PMC interp,
+    ARGIN_NULLOK(const char *optimize));
 
 static void show_last_error_and_exit(Parrot_PMC interp);
 static void usage(ARGMOD(FILE *fp))
@@ -161,7 +164,7 @@ main(int argc, const char *argv[])
         show_last_error_and_exit(interp);
 
     Parrot_api_toggle_gc(interp, 0);
-    setup_imcc(interp);
+    setup_imcc(interp, parsed_flags.optimize);
     if (!parsed_flags.turn_gc_off)
         Parrot_api_toggle_gc(interp, 1);
 
@@ -179,9 +182,10 @@ main(int argc, const char *argv[])
 
 /*
 
-=item C<static void setup_imcc(Parrot_PMC interp)>
+=item C<static void setup_imcc(Parrot_PMC interp, const char *optimize)>
 
-Call into IMCC to either compile or preprocess the input.
+Register the PIR and PASM compilers, which optimize the code they compile as
+C<optimize> says, if it is set.
 
 =cut
 
@@ -189,7 +193,7 @@ Call into IMCC to either compile or preprocess the input.
 
 PARROT_CANNOT_RETURN_NULL
 static void
-setup_imcc(Parrot_PMC interp)
+setup_imcc(Parrot_PMC interp, ARGIN_NULLOK(const char *optimize))
 {
     ASSERT_ARGS(setup_imcc)
     Parrot_PMC pir_compiler = NULL;
@@ -198,6 +202,10 @@ setup_imcc(Parrot_PMC interp)
     if (!(imcc_get_pir_compreg_api(interp, 1, &pir_compiler) &&
           imcc_get_pasm_compreg_api(interp, 1, &pasm_compiler)))
         show_last_error_and_exit(interp);
+    if (optimize
+    && !(imcc_set_optimization_level_api(interp, pir_compiler, optimize) &&
+         imcc_set_optimization_level_api(interp, pasm_compiler, optimize)))
+        show_last_error_and_exit(interp);
 }
 
 
@@ -410,6 +418,7 @@ Parrot_cmd_options(void)
         { '\0', OPT_HASH_SEED, OPTION_required_FLAG, { "--hash-seed" } },
         { 'I', 'I', OPTION_required_FLAG, { "--include" } },
         { 'L', 'L', OPTION_required_FLAG, { "--library" } },
+        { 'O', 'O', OPTION_optional_FLAG, { "--optimize" } },
         { 'R', 'R', OPTION_required_FLAG, { "--runcore" } },
         { 'g', 'g', OPTION_required_FLAG, { "--gc" } },
         { '\0', OPT_GC_NURSERY_SIZE, OPTION_required_FLAG, { "--gc-nursery-size" } },
@@ -432,6 +441,8 @@ Parrot_cmd_options(void)
         { 't', 't', OPTION_optional_FLAG, { "--trace" } },
         { 'w', 'w', (OPTION_flags)0, { "--warnings" } },
         { 'y', 'y', (OPTION_flags)0, { "--yydebug" } },
+        { '\0', OPT_SNAPSHOT_OUT, OPTION_required_FLAG, { "--snapshot-out" } },
+        { '\0', OPT_SNAPSHOT_IN, OPTION_required_FLAG, { "--snapshot-in" } },
         { 0, 0, (OPTION_flags)0, { NULL } }
     };
     return cmd_options;
@@ -570,6 +581,7 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
     args->run_core_name = "fast";
     args->trace = 0;
     args->turn_gc_off = 0;
+    args->optimize = NULL;
     pargs[nargs++] = argv[0];
 
     while ((status = longopt_get(argc, argv, Parrot_cmd_options(), &opt)) > 0) {
@@ -636,6 +648,14 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
           case 'c':
             pargs[nargs++] = "-c";
             break;
+          case OPT_SNAPSHOT_OUT:
+            pargs[nargs++] = "--snapshot-out";
+            pargs[nargs++] = opt.opt_arg;
+            break;
+          case OPT_SNAPSHOT_IN:
+            pargs[nargs++] = "--snapshot-in";
+            pargs[nargs++] = opt.opt_arg;
+            break;
           case OPT_GC_DEBUG:
           /*
 #if DISABLE_GC_DEBUG
@@ -670,6 +690,9 @@ parseflags(Parrot_PMC interp, int argc, ARGIN(const char *argv[]),
           case 'E':
             pargs[nargs++] = "-E";
             break;
+          case 'O':
+            args->optimize = opt.opt_arg ? opt.opt_arg : "1";
+            break;
           default:
             /* languages handle their arguments later (after being initialized) */
             break;
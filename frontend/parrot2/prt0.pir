@@ -19,99 +19,121 @@
     null $S2
     null $I1
     null $S3
-    null $P1
     null $S4
+    null $S5
+    null $P1
+    null $S6
     null $I2
   __label_3: # while
     elements $I3, __ARG_1
     le $I3, 0, __label_2
-    $S5 = __ARG_1[0]
-    if $S5 == "-o" goto __label_6
-    if $S5 == "-c" goto __label_7
-    if $S5 == "-r" goto __label_8
-    if $S5 == "-E" goto __label_9
-    if $S5 == "--runtime-prefix" goto __label_10
-    if $S5 == "-V" goto __label_11
-    if $S5 == "-h" goto __label_12
+    $S7 = __ARG_1[0]
+    if $S7 == "-o" goto __label_6
+    if $S7 == "-c" goto __label_7
+    if $S7 == "-r" goto __label_8
+    if $S7 == "-E" goto __label_9
+    if $S7 == "--snapshot-out" goto __label_10
+    if $S7 == "--snapshot-in" goto __label_11
+    if $S7 == "--runtime-prefix" goto __label_12
+    if $S7 == "-V" goto __label_13
+    if $S7 == "-h" goto __label_14
     goto __label_4
   __label_6: # case
-    shift $S4, __ARG_1
+    shift $S6, __ARG_1
     shift $S3, __ARG_1
     goto __label_5 # break
   __label_7: # case
-    shift $S4, __ARG_1
+    shift $S6, __ARG_1
     set $I1, 3
     goto __label_5 # break
   __label_8: # case
-    shift $S4, __ARG_1
+    shift $S6, __ARG_1
     set $I2, 2
     goto __label_5 # break
   __label_9: # case
-    shift $S4, __ARG_1
+    shift $S6, __ARG_1
     set $I2, 1
     goto __label_5 # break
   __label_10: # case
-    WSubId_1()
+    shift $S6, __ARG_1
+    shift $S4, __ARG_1
+    goto __label_5 # break
   __label_11: # case
-    WSubId_2()
+    shift $S6, __ARG_1
+    shift $S5, __ARG_1
+    goto __label_1 # goto done_args
   __label_12: # case
+    WSubId_1()
+  __label_13: # case
+    WSubId_2()
+  __label_14: # case
     WSubId_3()
   __label_4: # default
-    set $S2, $S5
+    set $S2, $S7
     goto __label_1 # goto done_args
   __label_5: # switch end
     goto __label_3
   __label_2: # endwhile
   __label_1: # label done_args
+    if_null $S5, __label_15
+    new $P1, [ 'PackfileView' ]
+    $P1.'read_snapshot'($S5)
+    unshift __ARG_1, $S5
+    .return($P1)
+  __label_15: # endif
     isnull $I3, $S2
-    if $I3 goto __label_14
+    if $I3 goto __label_17
     iseq $I3, $S2, ""
-  __label_14:
-    unless $I3 goto __label_13
+  __label_17:
+    unless $I3 goto __label_16
     WSubId_4("Missing program name")
-  __label_13: # endif
-    ne $I2, 1, __label_15
+  __label_16: # endif
+    ne $I2, 1, __label_18
     compreg $P3, "PIR"
     $P3.'preprocess'($S2)
     exit 0
-  __label_15: # endif
-    if $I1 goto __label_16
+  __label_18: # endif
+    if $I1 goto __label_19
     $P3 = WSubId_5($S2)
     set $I1, $P3
-    if $I1 goto __label_17
-    concat $S7, "Invalid file type ", $S2
-    WSubId_4($S7)
-  __label_17: # endif
-  __label_16: # endif
-    ne $I2, 2, __label_18
+    if $I1 goto __label_20
+    concat $S9, "Invalid file type ", $S2
+    WSubId_4($S9)
+  __label_20: # endif
+  __label_19: # endif
+    ne $I2, 2, __label_21
     $P3 = WSubId_6($S2)
-    null $S6
-    if_null $P3, __label_19
-    set $S6, $P3
-  __label_19:
+    null $S8
+    if_null $P3, __label_22
+    set $S8, $P3
+  __label_22:
     compreg $P3, "PIR"
     $P1 = $P3.'compile_file'($S2)
-    $P1.'write_to_file'($S6)
+    $P1.'write_to_file'($S8)
     new $P1, [ 'PackfileView' ]
-    $P1.'read_from_file'($S6)
-  __label_18: # endif
-    unless_null $P1, __label_20
+    $P1.'read_from_file'($S8)
+  __label_21: # endif
+    unless_null $P1, __label_23
     $P1 = WSubId_7($S2, $I1)
-  __label_20: # endif
-    if_null $S3, __label_21
+  __label_23: # endif
+    if_null $S3, __label_24
     $P1.'write_to_file'($S3)
     exit 0
-  __label_21: # endif
+  __label_24: # endif
+    if_null $S4, __label_25
+    $P1.'write_snapshot'($S4)
+    exit 0
+  __label_25: # endif
     $P3 = $P1.'subs_by_tag'("init")
-    if_null $P3, __label_23
+    if_null $P3, __label_27
     iter $P4, $P3
     set $P4, 0
-  __label_22: # for iteration
-    unless $P4 goto __label_23
+  __label_26: # for iteration
+    unless $P4 goto __label_27
     shift $P2, $P4
     $P2()
-    goto __label_22
-  __label_23: # endfor
+    goto __label_26
+  __label_27: # endfor
     .return($P1)
 
 .end # __PARROT_ENTRY_MAIN__args
@@ -294,7 +316,7 @@
 
 
 .sub '__show_help_and_exit' :subid('WSubId_3') :anon
-    set $S1, "parrot [Options] <file> [<program options...>]\n  Options:\n    -h --help\n    -V --version\n    -I --include add path to include search\n    -L --library add path to library search\n       --hash-seed F00F  specify hex value to use as hash seed\n    -X --dynext add path to dynamic extension search\n   <Run core options>\n    -R --runcore slow|bounds|fast|subprof\n    -R --runcore trace|profiling|gcdebug\n    -t --trace [flags]\n   <VM options>\n    -D --parrot-debug[=HEXFLAGS]\n       --help-debug\n    -w --warnings\n    -G --no-gc\n    -g --gc ms2|gms|ms|inf set GC type\n       <GC MS2 options>\n       --gc-dynamic-threshold=percentage    maximum memory wasted by GC\n       --gc-min-threshold=KB\n       <GC GMS options>\n       --gc-nursery-size=percent of sysmem  size of gen0 (default 2)\n       --gc-debug\n       --leak-test|--destroy-at-end\n    -. --wait    Read a keystroke before starting\n       --runtime-prefix\n   <Compiler options>\n    -E --pre-process-only\n    -o --output=FILE\n       --output-pbc\n    -a --pasm\n    -c --pbc\n    -r --run-pbc\n    -y --yydebug\n   <Language options>\nsee docs/running.pod for more\n"
+    set $S1, "parrot [Options] <file> [<program options...>]\n  Options:\n    -h --help\n    -V --version\n    -I --include add path to include search\n    -L --library add path to library search\n       --hash-seed F00F  specify hex value to use as hash seed\n    -X --dynext add path to dynamic extension search\n   <Run core options>\n    -R --runcore slow|bounds|fast|subprof\n    -R --runcore trace|profiling|gcdebug\n    -t --trace [flags]\n   <VM options>\n    -D --parrot-debug[=HEXFLAGS]\n       --help-debug\n    -w --warnings\n    -G --no-gc\n    -g --gc ms2|gms|ms|inf set GC type\n       <GC MS2 options>\n       --gc-dynamic-threshold=percentage    maximum memory wasted by GC\n       --gc-min-threshold=KB\n       <GC GMS options>\n       --gc-nursery-size=percent of sysmem  size of gen0 (default 2)\n       --gc-debug\n       --leak-test|--destroy-at-end\n    -. --wait    Read a keystroke before starting\n       --runtime-prefix\n   <Compiler options>\n    -E --pre-process-only\n    -o --output=FILE\n       --output-pbc\n    -O --optimize[=LEVEL]\n    -a --pasm\n    -c --pbc\n    -r --run-pbc\n    -y --yydebug\n       --snapshot-out=FILE  run :init subs, save the interpreter, exit\n       --snapshot-in=FILE   start from a saved interpreter\n   <Language options>\nsee docs/running.pod for more\n"
     say $S1
     exit 0
 
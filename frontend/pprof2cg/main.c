@@ -0,0 +1,691 @@
+/*
+Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+pprof2cg - Convert a binary profile from the profiling runcore to Callgrind
+format
+
+=head1 SYNOPSIS
+
+ pprof2cg parrot.pprof.1234 [parrot.out.1234]
+
+=head1 DESCRIPTION
+
+This program reads a profile written by C<parrot -R profiling> with
+C<PARROT_PROFILING_OUTPUT=binary> and writes a Callgrind-compatible profile
+that can be loaded into kcachegrind and similar tools.  It is a C counterpart
+of F<tools/dev/pprof2cg.pl>, which handles the text format, and builds the same
+call graph: every context switch to a context that is not already on the
+context stack is treated as a call from the line that was executing, and the
+time of each op is charged both to its own line and, inclusively, to every
+pending call on the stack.
+
+If no output filename is given, the first occurrence of "pprof" in the input
+filename is replaced with "out", or ".out" is appended if there is none.
+
+=head2 Functions
+
+=over 4
+
+=cut
+
+*/
+
+#include "parrot/parrot.h"
+#include "parrot/runcore_profiling.h"
+
+/* one entry on the context stack */
+typedef struct pprof_frame {
+    UHUGEINTVAL ctx;
+    UHUGEINTVAL sub;
+    UINTVAL     ns;
+    UINTVAL     file;
+    INTVAL      line;
+    UINTVAL     callee;     /* ns of the sub this frame is calling, if any */
+} pprof_frame;
+
+/* time spent on a line, or (if callee is set) in calls made from it */
+typedef struct pprof_cost {
+    UINTVAL             file;
+    UINTVAL             ns;
+    INTVAL              line;
+    UINTVAL             callee;
+    UHUGEINTVAL         hits;
+    UHUGEINTVAL         time;
+    struct pprof_cost  *next;
+} pprof_cost;
+
+typedef struct pprof_state {
+    FILE         *in;
+    char        **strings;          /* indexed by string id */
+    UINTVAL       string_alloc;
+    pprof_frame  *stack;
+    UINTVAL       depth;
+    UINTVAL       stack_alloc;
+    pprof_cost  **buckets;
+    UINTVAL       bucket_count;     /* always a power of two */
+    UINTVAL       cost_count;
+    UINTVAL       cli;
+    INTVAL        prev_line;
+    UHUGEINTVAL   total_time;
+} pprof_state;
+
+/* HEADERIZER HFILE: none */
+
+/* HEADERIZER BEGIN: static */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+static void add_cost(
+    ARGMOD(pprof_state *st),
+    ARGIN(const pprof_frame *frame),
+    UINTVAL callee,
+    UHUGEINTVAL hits,
+    UHUGEINTVAL time)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*st);
+
+static int compare_costs(ARGIN(const void *a), ARGIN(const void *b))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static void context_switch(ARGMOD(pprof_state *st))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*st);
+
+PARROT_DOES_NOT_RETURN
+static void fail(ARGIN(const char *msg))
+        __attribute__nonnull__(1);
+
+PARROT_CANNOT_RETURN_NULL
+static const char * lookup_string(ARGIN(const pprof_state *st), UINTVAL id)
+        __attribute__nonnull__(1);
+
+static void op(ARGMOD(pprof_state *st))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*st);
+
+static void read_profile(ARGMOD(pprof_state *st))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*st);
+
+static void read_string(ARGMOD(pprof_state *st))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*st);
+
+static UHUGEINTVAL read_varint(ARGMOD(FILE *in))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*in);
+
+static void write_callgrind(ARGIN(const pprof_state *st), ARGMOD(FILE *out))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*out);
+
+#define ASSERT_ARGS_add_cost __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st) \
+    , PARROT_ASSERT_ARG(frame))
+#define ASSERT_ARGS_compare_costs __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(a) \
+    , PARROT_ASSERT_ARG(b))
+#define ASSERT_ARGS_context_switch __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st))
+#define ASSERT_ARGS_fail __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(msg))
+#define ASSERT_ARGS_lookup_string __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st))
+#define ASSERT_ARGS_op __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st))
+#define ASSERT_ARGS_read_profile __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st))
+#define ASSERT_ARGS_read_string __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st))
+#define ASSERT_ARGS_read_varint __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(in))
+#define ASSERT_ARGS_write_callgrind __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(st) \
+    , PARROT_ASSERT_ARG(out))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: static */
+
+/*
+
+=item C<static void fail(const char *msg)>
+
+Print C<msg> and exit with an error.
+
+=cut
+
+*/
+
+PARROT_DOES_NOT_RETURN
+static void
+fail(ARGIN(const char *msg))
+{
+    ASSERT_ARGS(fail)
+
+    fprintf(stderr, "pprof2cg: %s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+/*
+
+=item C<static UHUGEINTVAL read_varint(FILE *in)>
+
+Read an unsigned LEB128 varint.
+
+=cut
+
+*/
+
+static UHUGEINTVAL
+read_varint(ARGMOD(FILE *in))
+{
+    ASSERT_ARGS(read_varint)
+
+    UHUGEINTVAL  value = 0;
+    unsigned int shift = 0;
+
+    while (1) {
+        const int c = getc(in);
+
+        if (c == EOF)
+            fail("truncated profile");
+        if (shift < sizeof (UHUGEINTVAL) * 8)
+            value |= (UHUGEINTVAL) (c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return value;
+        shift += 7;
+    }
+}
+
+/*
+
+=item C<static void read_string(pprof_state *st)>
+
+Read a string table entry.
+
+=cut
+
+*/
+
+static void
+read_string(ARGMOD(pprof_state *st))
+{
+    ASSERT_ARGS(read_string)
+
+    const UINTVAL id  = (UINTVAL) read_varint(st->in);
+    const size_t  len = (size_t) read_varint(st->in);
+    char         *str;
+
+    if (id == 0)
+        fail("invalid string id");
+
+    if (id >= st->string_alloc) {
+        const UINTVAL old = st->string_alloc;
+
+        while (id >= st->string_alloc)
+            st->string_alloc *= 2;
+        st->strings = mem_internal_realloc_n_zeroed_typed(st->strings,
+                st->string_alloc, old, char *);
+    }
+
+    str = (char *) mem_internal_allocate(len + 1);
+    if (fread(str, 1, len, st->in) != len)
+        fail("truncated profile");
+    str[len] = '\0';
+
+    if (st->strings[id])
+        mem_internal_free(st->strings[id]);
+    st->strings[id] = str;
+}
+
+/*
+
+=item C<static const char * lookup_string(const pprof_state *st, UINTVAL id)>
+
+Return the string with the given id.
+
+=cut
+
+*/
+
+PARROT_CANNOT_RETURN_NULL
+static const char *
+lookup_string(ARGIN(const pprof_state *st), UINTVAL id)
+{
+    ASSERT_ARGS(lookup_string)
+
+    if (id >= st->string_alloc || !st->strings[id])
+        fail("reference to an undefined string");
+
+    return st->strings[id];
+}
+
+/*
+
+=item C<static void add_cost(pprof_state *st, const pprof_frame *frame, UINTVAL
+callee, UHUGEINTVAL hits, UHUGEINTVAL time)>
+
+Add C<hits> and C<time> to the cost of the current line of C<frame>, or to
+its calls to C<callee> if that is non-zero.
+
+=cut
+
+*/
+
+static void
+add_cost(ARGMOD(pprof_state *st), ARGIN(const pprof_frame *frame), UINTVAL callee,
+        UHUGEINTVAL hits, UHUGEINTVAL time)
+{
+    ASSERT_ARGS(add_cost)
+
+    const UINTVAL hash = (frame->file * 31 + frame->ns) * 31
+                       + (UINTVAL) frame->line * 17 + callee;
+    pprof_cost  **slot = &st->buckets[hash & (st->bucket_count - 1)];
+    pprof_cost   *cost;
+
+    for (cost = *slot; cost; cost = cost->next) {
+        if (cost->file == frame->file && cost->ns == frame->ns
+        &&  cost->line == frame->line && cost->callee == callee) {
+            cost->hits += hits;
+            cost->time += time;
+            return;
+        }
+    }
+
+    cost         = mem_internal_allocate_typed(pprof_cost);
+    cost->file   = frame->file;
+    cost->ns     = frame->ns;
+    cost->line   = frame->line;
+    cost->callee = callee;
+    cost->hits   = hits;
+    cost->time   = time;
+    cost->next   = *slot;
+    *slot        = cost;
+
+    /* keep chains short by doubling the table once it is twice full */
+    if (++st->cost_count > st->bucket_count * 2) {
+        const UINTVAL new_count   = st->bucket_count * 2;
+        pprof_cost  **new_buckets = mem_internal_allocate_n_zeroed_typed(new_count, pprof_cost *);
+        UINTVAL       i;
+
+        for (i = 0; i < st->bucket_count; ++i) {
+            pprof_cost *c = st->buckets[i];
+
+            while (c) {
+                pprof_cost * const next = c->next;
+                const UINTVAL      h    = ((c->file * 31 + c->ns) * 31
+                                        + (UINTVAL) c->line * 17 + c->callee)
+                                        & (new_count - 1);
+
+                c->next        = new_buckets[h];
+                new_buckets[h] = c;
+                c              = next;
+            }
+        }
+
+        mem_internal_free(st->buckets);
+        st->buckets      = new_buckets;
+        st->bucket_count = new_count;
+    }
+}
+
+/*
+
+=item C<static void context_switch(pprof_state *st)>
+
+Handle a context switch record: a context not yet on the stack is a call from
+the current frame, a context further down the stack is a return to it and the
+current context with a different sub is a tail call.
+
+=cut
+
+*/
+
+static void
+context_switch(ARGMOD(pprof_state *st))
+{
+    ASSERT_ARGS(context_switch)
+
+    pprof_frame frame;
+    UINTVAL     i;
+
+    frame.ns     = (UINTVAL) read_varint(st->in);
+    frame.file   = (UINTVAL) read_varint(st->in);
+    frame.sub    = read_varint(st->in);
+    frame.ctx    = read_varint(st->in);
+    frame.line   = 0;
+    frame.callee = 0;
+
+    if (st->depth) {
+        pprof_frame * const top = &st->stack[st->depth - 1];
+
+        if (top->ctx == frame.ctx) {
+            if (top->sub != frame.sub) {
+                top->ns  = frame.ns;
+                top->sub = frame.sub;
+            }
+            return;
+        }
+
+        for (i = st->depth - 1; i > 0; --i) {
+            if (st->stack[i - 1].ctx == frame.ctx) {
+                st->depth = i;
+                return;
+            }
+        }
+
+        top->callee = frame.ns;
+        add_cost(st, top, frame.ns, 1, 0);
+    }
+
+    if (st->depth == st->stack_alloc) {
+        st->stack_alloc *= 2;
+        mem_internal_realloc_n_typed(st->stack, st->stack_alloc, pprof_frame);
+    }
+
+    st->stack[st->depth++] = frame;
+}
+
+/*
+
+=item C<static void op(pprof_state *st)>
+
+Handle an op record, charging its time to the current line and to every call
+that is in progress.
+
+=cut
+
+*/
+
+static void
+op(ARGMOD(pprof_state *st))
+{
+    ASSERT_ARGS(op)
+
+    UHUGEINTVAL  delta, time;
+    pprof_frame *top;
+    UINTVAL      i;
+
+    (void) read_varint(st->in);     /* op name */
+    delta = read_varint(st->in);
+    time  = read_varint(st->in);
+
+    st->prev_line = delta & 1
+                  ? st->prev_line - (INTVAL) (delta >> 1) - 1
+                  : st->prev_line + (INTVAL) (delta >> 1);
+
+    if (!st->depth)
+        fail("profile did not specify an initial context");
+
+    top        = &st->stack[st->depth - 1];
+    top->line  = st->prev_line;
+    st->total_time += time;
+    add_cost(st, top, 0, 1, time);
+
+    for (i = 0; i + 1 < st->depth; ++i)
+        add_cost(st, &st->stack[i], st->stack[i].callee, 0, time);
+}
+
+/*
+
+=item C<static void read_profile(pprof_state *st)>
+
+Read every record of the profile.
+
+=cut
+
+*/
+
+static void
+read_profile(ARGMOD(pprof_state *st))
+{
+    ASSERT_ARGS(read_profile)
+
+    char magic[PPROF_BINARY_MAGIC_LEN];
+    int  tag;
+
+    if (fread(magic, 1, PPROF_BINARY_MAGIC_LEN, st->in) != PPROF_BINARY_MAGIC_LEN
+    ||  memcmp(magic, PPROF_BINARY_MAGIC, PPROF_BINARY_MAGIC_LEN) != 0)
+        fail("not a binary profile; use tools/dev/pprof2cg.pl for text profiles");
+
+    while ((tag = getc(st->in)) != EOF) {
+        switch (tag) {
+          case PPROF_BINARY_STRING:
+            read_string(st);
+            break;
+          case PPROF_BINARY_VERSION:
+            if (read_varint(st->in) != 2)
+                fail("profile was generated by an incompatible version of the profiling runcore");
+            break;
+          case PPROF_BINARY_CLI:
+            st->cli = (UINTVAL) read_varint(st->in);
+            break;
+          case PPROF_BINARY_CONTEXT_SWITCH:
+            context_switch(st);
+            break;
+          case PPROF_BINARY_OP:
+            op(st);
+            break;
+          case PPROF_BINARY_ANNOTATION:
+            /* annotations are ignored, as in pprof2cg.pl */
+            (void) read_varint(st->in);
+            (void) read_varint(st->in);
+            break;
+          case PPROF_BINARY_END_OF_RUNLOOP:
+            st->depth = 0;
+            break;
+          default:
+            fail("unrecognized record in profile");
+        }
+    }
+}
+
+/*
+
+=item C<static int compare_costs(const void *a, const void *b)>
+
+C<qsort> comparator ordering costs by file, sub, line and callee, with a
+line's own cost before its calls.
+
+=cut
+
+*/
+
+static int
+compare_costs(ARGIN(const void *a), ARGIN(const void *b))
+{
+    ASSERT_ARGS(compare_costs)
+
+    const pprof_cost * const x = *(const pprof_cost * const *) a;
+    const pprof_cost * const y = *(const pprof_cost * const *) b;
+
+    if (x->file != y->file)
+        return x->file < y->file ? -1 : 1;
+    if (x->ns != y->ns)
+        return x->ns < y->ns ? -1 : 1;
+    if (x->line != y->line)
+        return x->line < y->line ? -1 : 1;
+    if (x->callee != y->callee)
+        return x->callee < y->callee ? -1 : 1;
+    return 0;
+}
+
+/*
+
+=item C<static void write_callgrind(const pprof_state *st, FILE *out)>
+
+Write the collected costs as a Callgrind profile.
+
+=cut
+
+*/
+
+static void
+write_callgrind(ARGIN(const pprof_state *st), ARGMOD(FILE *out))
+{
+    ASSERT_ARGS(write_callgrind)
+
+    pprof_cost ** const costs = mem_internal_allocate_n_zeroed_typed(st->cost_count + 1,
+                                        pprof_cost *);
+    UINTVAL             count = 0;
+    UINTVAL             file  = 0;
+    UINTVAL             ns    = 0;
+    UINTVAL             i;
+
+    for (i = 0; i < st->bucket_count; ++i) {
+        pprof_cost *c;
+        for (c = st->buckets[i]; c; c = c->next)
+            costs[count++] = c;
+    }
+
+    qsort(costs, count, sizeof (pprof_cost *), compare_costs);
+
+    fprintf(out,
+        "version: 1\n"
+        "creator: parrot pprof2cg\n"
+        "cmd: %s\n"
+        "\n"
+        "part: 1\n"
+        "desc: Timerange: Basic block 0 - %lu\n"
+        "desc: Trigger: Program termination\n"
+        "positions: line\n"
+        "events: Ir\n"
+        "summary: %lu\n"
+        "\n",
+        st->cli ? lookup_string(st, st->cli) : "",
+        (unsigned long) st->total_time, (unsigned long) st->total_time);
+
+    for (i = 0; i < count; ++i) {
+        const pprof_cost * const c = costs[i];
+
+        if (c->file != file) {
+            fprintf(out, "fl=%s\n", lookup_string(st, c->file));
+            file = c->file;
+            ns   = 0;
+        }
+        if (c->ns != ns) {
+            fprintf(out, "\nfn=%s\n", lookup_string(st, c->ns));
+            ns = c->ns;
+        }
+
+        if (c->callee) {
+            fprintf(out, "cfn=%s\n", lookup_string(st, c->callee));
+            fprintf(out, "calls=%lu %ld\n", (unsigned long) c->hits, (long) c->line);
+        }
+        fprintf(out, "%ld %lu\n", (long) c->line, (unsigned long) c->time);
+    }
+
+    fprintf(out, "totals: %lu\n", (unsigned long) st->total_time);
+    mem_internal_free(costs);
+}
+
+/*
+
+=item C<int main(int argc, const char **argv)>
+
+Convert the profile named on the command line.
+
+=cut
+
+*/
+
+int
+main(int argc, const char **argv)
+{
+    pprof_state  st;
+    char        *out_name;
+    FILE        *out;
+    UINTVAL      i;
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s filename [outfile]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&st, 0, sizeof (st));
+    st.string_alloc = 256;
+    st.strings      = mem_internal_allocate_n_zeroed_typed(st.string_alloc, char *);
+    st.stack_alloc  = 64;
+    st.stack        = mem_internal_allocate_n_zeroed_typed(st.stack_alloc, pprof_frame);
+    st.bucket_count = 1024;
+    st.buckets      = mem_internal_allocate_n_zeroed_typed(st.bucket_count, pprof_cost *);
+
+    st.in = fopen(argv[1], "rb");
+    if (!st.in) {
+        fprintf(stderr, "pprof2cg: couldn't open %s for reading\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    read_profile(&st);
+    fclose(st.in);
+
+    if (argc == 3)
+        out_name = mem_sys_strdup(argv[2]);
+    else {
+        const char * const pos = strstr(argv[1], "pprof");
+        const size_t       len = strlen(argv[1]);
+
+        out_name = (char *) mem_internal_allocate(len + 5);
+        if (pos) {
+            const size_t prefix = pos - argv[1];
+            memcpy(out_name, argv[1], prefix);
+            strcpy(out_name + prefix, "out");
+            strcpy(out_name + prefix + 3, pos + 5);
+        }
+        else
+            sprintf(out_name, "%s.out", argv[1]);
+    }
+
+    out = fopen(out_name, "w");
+    if (!out) {
+        fprintf(stderr, "pprof2cg: couldn't open %s for writing\n", out_name);
+        return EXIT_FAILURE;
+    }
+
+    write_callgrind(&st, out);
+    fclose(out);
+
+    printf("%s can now be used with kcachegrind or other callgrind-compatible tools.\n",
+        out_name);
+
+    for (i = 0; i < st.bucket_count; ++i) {
+        pprof_cost *c = st.buckets[i];
+        while (c) {
+            pprof_cost * const next = c->next;
+            mem_internal_free(c);
+            c = next;
+        }
+    }
+    for (i = 0; i < st.string_alloc; ++i)
+        if (st.strings[i])
+            mem_internal_free(st.strings[i]);
+
+    mem_internal_free(st.buckets);
+    mem_internal_free(st.strings);
+    mem_internal_free(st.stack);
+    mem_internal_free(out_name);
+
+    return EXIT_SUCCESS;
+}
+
+/*
+
+=back
+
+=head1 SEE ALSO
+
+F<tools/dev/pprof2cg.pl>, F<src/runcore/profiling.c>
+
+=cut
+
+*/
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
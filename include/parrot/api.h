@@ -139,6 +139,13 @@ Parrot_Int Parrot_api_get_exception_backtrace(
         __attribute__nonnull__(3)
         FUNC_MODIFIES(*bt);
 
+PARROT_API
+Parrot_Int Parrot_api_get_metrics(
+    Parrot_PMC interp_pmc,
+    ARGOUT(Parrot_PMC *metrics))
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*metrics);
+
 PARROT_API
 Parrot_Int Parrot_api_get_result(
     Parrot_PMC interp_pmc,
@@ -264,6 +271,8 @@ Parrot_Int Parrot_api_wrap_pointer(
 #define ASSERT_ARGS_Parrot_api_get_exception_backtrace \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(bt))
+#define ASSERT_ARGS_Parrot_api_get_metrics __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(metrics))
 #define ASSERT_ARGS_Parrot_api_get_result __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(is_error) \
     , PARROT_ASSERT_ARG(exception) \
@@ -329,6 +338,15 @@ Parrot_Int Parrot_api_load_bytecode_file(
         __attribute__nonnull__(3)
         FUNC_MODIFIES(* pbc);
 
+PARROT_API
+Parrot_Int Parrot_api_load_snapshot_file(
+    Parrot_PMC interp_pmc,
+    ARGIN(Parrot_String filename),
+    ARGOUT(Parrot_PMC * pbc))
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(* pbc);
+
 PARROT_API
 Parrot_Int Parrot_api_ready_bytecode(
     Parrot_PMC interp_pmc,
@@ -357,6 +375,14 @@ Parrot_Int Parrot_api_write_bytecode_to_file(
     Parrot_PMC pbc,
     Parrot_String filename);
 
+PARROT_API
+Parrot_Int Parrot_api_write_snapshot(
+    Parrot_PMC interp_pmc,
+    ARGIN(Parrot_PMC pbc),
+    ARGIN(Parrot_String filename))
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
 #define ASSERT_ARGS_Parrot_api_disassemble_bytecode \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
 #define ASSERT_ARGS_Parrot_api_load_bytecode_bytes \
@@ -366,6 +392,9 @@ Parrot_Int Parrot_api_write_bytecode_to_file(
 #define ASSERT_ARGS_Parrot_api_load_bytecode_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(filename) \
     , PARROT_ASSERT_ARG(pbc))
+#define ASSERT_ARGS_Parrot_api_load_snapshot_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(filename) \
+    , PARROT_ASSERT_ARG(pbc))
 #define ASSERT_ARGS_Parrot_api_ready_bytecode __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(main_sub))
 #define ASSERT_ARGS_Parrot_api_run_bytecode __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
@@ -374,6 +403,9 @@ Parrot_Int Parrot_api_write_bytecode_to_file(
        PARROT_ASSERT_ARG(bc))
 #define ASSERT_ARGS_Parrot_api_write_bytecode_to_file \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
+#define ASSERT_ARGS_Parrot_api_write_snapshot __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(pbc) \
+    , PARROT_ASSERT_ARG(filename))
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 /* HEADERIZER END: src/embed/bytecode.c */
 
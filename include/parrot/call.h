@@ -36,7 +36,8 @@ typedef struct parrot_runloop_t {
 typedef parrot_runloop_t Parrot_runloop;
 
 typedef enum {
-    CALLSIGNATURE_is_exception_FLAG      = PObj_private0_FLAG /* last element */
+    CALLSIGNATURE_is_exception_FLAG      = PObj_private0_FLAG,
+    CALLSIGNATURE_is_escaped_FLAG        = PObj_private1_FLAG /* last element */
 } callsignature_flags_enum;
 
 #define CALLSIGNATURE_get_FLAGS(o) (PObj_get_FLAGS(o))
@@ -49,6 +50,12 @@ typedef enum {
 #define CALLSIGNATURE_is_exception_SET(o)   CALLSIGNATURE_flag_SET(is_exception, (o))
 #define CALLSIGNATURE_is_exception_CLEAR(o) CALLSIGNATURE_flag_CLEAR(is_exception, (o))
 
+/* Mark if the Context may be resumed or inspected after it returned, so its
+ * register frame can't be recycled on return */
+#define CALLSIGNATURE_is_escaped_TEST(o)  CALLSIGNATURE_flag_TEST(is_escaped, (o))
+#define CALLSIGNATURE_is_escaped_SET(o)   CALLSIGNATURE_flag_SET(is_escaped, (o))
+#define CALLSIGNATURE_is_escaped_CLEAR(o) CALLSIGNATURE_flag_CLEAR(is_escaped, (o))
+
 /* HEADERIZER BEGIN: src/call/pcc.c */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
@@ -503,6 +510,13 @@ PMC * Parrot_pcc_init_context(PARROT_INTERP,
     ARGIN_NULLOK(PMC *old))
         __attribute__nonnull__(2);
 
+void Parrot_pcc_recycle_registers(PARROT_INTERP,
+    ARGIN(PMC *ctx),
+    ARGIN(PMC *callee))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
 PARROT_WARN_UNUSED_RESULT
 PARROT_CANNOT_RETURN_NULL
 PMC * Parrot_pcc_unproxy_context(PARROT_INTERP, ARGIN(PMC * proxy))
@@ -573,6 +587,10 @@ PMC * Parrot_set_new_context(PARROT_INTERP,
     , PARROT_ASSERT_ARG(pmcctx))
 #define ASSERT_ARGS_Parrot_pcc_init_context __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(ctx))
+#define ASSERT_ARGS_Parrot_pcc_recycle_registers __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(ctx) \
+    , PARROT_ASSERT_ARG(callee))
 #define ASSERT_ARGS_Parrot_pcc_unproxy_context __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(proxy))
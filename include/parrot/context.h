@@ -22,10 +22,22 @@ typedef union {
     INTVAL       *regs_i;
 } Regs_ni;
 
+/* A handler pushed with C<push_eh LABEL> that has not been turned into an
+ * ExceptionHandler PMC yet.  See Parrot_cx_add_label_handler_local. */
+typedef struct Parrot_pending_handler {
+    opcode_t          *address;     /* the handler's label */
+    PackFile_ByteCode *seg;         /* the segment it is in */
+    INTVAL             runloop_id;  /* the runloop that pushed it */
+} Parrot_pending_handler;
+
 #include "pmc/pmc_callcontext.h"
 
 typedef struct Parrot_CallContext_attributes Parrot_Context;
 
+/* how many label handlers a context can hold before making PMCs of them */
+#define PARROT_PENDING_HANDLERS \
+    (sizeof (((Parrot_Context *)NULL)->pending_handlers) / sizeof (Parrot_pending_handler))
+
 #define CONTEXT_STRUCT(c) (PMC_data_typed((c), Parrot_Context *))
 
 /*
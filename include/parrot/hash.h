@@ -110,7 +110,15 @@ do {                                                                        \
 
 typedef void (*value_free)(ARGFREE(void *));
 
-/* To avoid creating OrderedHashItem PMC we reuse FixedPMCArray PMC */
+/* One entry of an OrderedHash, in insertion order. A NULL key marks a
+ * deleted entry until the entries are compacted */
+typedef struct OrderedHashEntry {
+    STRING *key;        /* the key of the lookup hash */
+    PMC    *key_pmc;    /* the key as it was stored, for iterators */
+    PMC    *value;
+} OrderedHashEntry;
+
+/* A frozen OrderedHash keeps its entries as FixedPMCArray items of a Hash */
 /* So, there is indexes to avoid using of "magick constants" */
 enum ORDERED_HASH_ITEM_PART {
     ORDERED_HASH_ITEM_KEY   = 0,
@@ -17,10 +17,15 @@
 /* preallocate freeze image for aggregates with this estimation */
 #define FREEZE_BYTES_PER_ITEM 9
 
+/* images streamed to or from a handle are written and read in blocks of
+ * about this many bytes */
+#define FREEZE_CHUNK_SIZE 65536
+
 enum {
     enum_PackID_normal      = 0,
     enum_PackID_seen        = 1,
-    enum_PackID_pbc_backref = 2
+    enum_PackID_pbc_backref = 2,
+    enum_PackID_extern      = 3     /* index into PMCs both sides already have */
 };
 
 #endif /* PARROT_IMAGEIO_H_GUARD */
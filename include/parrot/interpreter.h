@@ -63,7 +63,9 @@ typedef enum {
     PARROT_PROFILING_CORE   = 0x160,        /* used by parrot debugger */
     PARROT_SUBPROF_SUB_CORE = 0x200,        /* sub profiler core, sub mode */
     PARROT_SUBPROF_HLL_CORE = 0x201,        /* sub profiler core, hll mode */
-    PARROT_SUBPROF_OPS_CORE = 0x202         /* sub profiler core, ops mode */
+    PARROT_SUBPROF_OPS_CORE = 0x202,        /* sub profiler core, ops mode */
+    PARROT_SAMPLING_CORE    = 0x210,        /* sampling profiler core */
+    PARROT_JIT_CORE         = 0x220         /* compiles hot subs to native code */
 } Parrot_Run_core_t;
 /* &end_gen */
 
@@ -165,6 +167,8 @@ struct parrot_interp_t {
     struct GC_Subsystem *gc_sys;              /* functions and data specific
                                                  to current GC subsystem*/
 
+    struct Parrot_Metrics *metrics;           /* always-on VM counters */
+
     PMC     *gc_registry;                     /* root set of registered PMCs */
 
     PMC     *class_hash;                      /* Hash of classes */
@@ -50,6 +50,8 @@ struct longopt_opt_info {
 #define OPT_GC_MIN_THRESHOLD      135
 #define OPT_GC_NURSERY_SIZE       136
 #define OPT_NUMTHREADS            137
+#define OPT_SNAPSHOT_OUT          138
+#define OPT_SNAPSHOT_IN           139
 
 /* HEADERIZER BEGIN: src/longopt.c */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
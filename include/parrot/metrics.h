@@ -0,0 +1,115 @@
+/* metrics.h
+ *  Copyright (C) 2012, Parrot Foundation.
+ *  Overview:
+ *     Always-on VM counters and histograms
+ *  Notes:
+ *     Counters are bumped directly by the subsystems that own them, so adding
+ *     one means adding an entry to Parrot_metric_counter here and a matching
+ *     name to counter_names in src/metrics.c.
+ */
+
+#ifndef PARROT_METRICS_H_GUARD
+#define PARROT_METRICS_H_GUARD
+
+#define PARROT_CACHE_LINE_SIZE        64
+#define PARROT_METRICS_HIST_BUCKETS   32
+
+typedef enum Parrot_metric_counter {
+    METRIC_GC_RUNS,
+    METRIC_GC_SURVIVED_GEN0,        /* objects that lived through a collection */
+    METRIC_GC_SURVIVED_GEN1,        /* of their generation, for each of the */
+    METRIC_GC_SURVIVED_GEN2,        /* generational collector's generations */
+    METRIC_GC_SURVIVED_GEN3,
+    METRIC_GC_FREED_GEN0,           /* objects found dead in each generation */
+    METRIC_GC_FREED_GEN1,
+    METRIC_GC_FREED_GEN2,
+    METRIC_GC_FREED_GEN3,
+    METRIC_PMC_ALLOCS,
+    METRIC_STRING_ALLOCS,
+    METRIC_CONTEXTS_CREATED,
+    METRIC_METHOD_CACHE_HITS,
+    METRIC_METHOD_CACHE_MISSES,
+    METRIC_TASKS_SCHEDULED,
+    METRIC_IO_READ_CALLS,
+    METRIC_IO_WRITE_CALLS,
+    METRIC_IO_BYTES_READ,
+    METRIC_IO_BYTES_WRITTEN,
+    METRIC_COUNTER_MAX
+} Parrot_metric_counter;
+
+#define METRIC_GC_GENERATIONS (METRIC_GC_FREED_GEN0 - METRIC_GC_SURVIVED_GEN0)
+
+typedef enum Parrot_metric_histogram {
+    METRIC_GC_PAUSE_NS,
+    METRIC_TASK_QUEUE_DEPTH,
+    METRIC_HISTOGRAM_MAX
+} Parrot_metric_histogram;
+
+/* Each counter gets a cache line of its own, so a monitoring thread polling
+ * one interpreter's metrics never shares a line with the counters that
+ * interpreter is busy updating. */
+typedef union Parrot_metric_slot {
+    UHUGEINTVAL value;
+    char        pad[PARROT_CACHE_LINE_SIZE];
+} Parrot_metric_slot;
+
+/* bucket 0 counts zeros and bucket i counts values in [2**(i-1), 2**i);
+ * the last bucket also takes everything larger */
+typedef struct Parrot_metric_hist {
+    UHUGEINTVAL count;
+    UHUGEINTVAL sum;
+    UHUGEINTVAL buckets[PARROT_METRICS_HIST_BUCKETS];
+} Parrot_metric_hist;
+
+typedef struct Parrot_Metrics {
+    Parrot_metric_slot counters[METRIC_COUNTER_MAX];
+    Parrot_metric_hist histograms[METRIC_HISTOGRAM_MAX];
+    void              *alloc_base;  /* unaligned block to free */
+} Parrot_Metrics;
+
+#define PARROT_METRIC_ADD(interp, c, n) \
+    ((interp)->metrics->counters[(c)].value += (UHUGEINTVAL)(n))
+#define PARROT_METRIC_INC(interp, c) \
+    PARROT_METRIC_ADD((interp), (c), 1)
+
+/* HEADERIZER BEGIN: src/metrics.c */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+PARROT_EXPORT
+void Parrot_metrics_observe(PARROT_INTERP,
+    Parrot_metric_histogram which,
+    UHUGEINTVAL value)
+        __attribute__nonnull__(1);
+
+PARROT_EXPORT
+PARROT_CANNOT_RETURN_NULL
+PMC * Parrot_metrics_snapshot(PARROT_INTERP, ARGIN(Interp *from))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+void Parrot_metrics_destroy(PARROT_INTERP)
+        __attribute__nonnull__(1);
+
+PARROT_MALLOC
+PARROT_CANNOT_RETURN_NULL
+Parrot_Metrics * Parrot_metrics_new(void);
+
+#define ASSERT_ARGS_Parrot_metrics_observe __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp))
+#define ASSERT_ARGS_Parrot_metrics_snapshot __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(from))
+#define ASSERT_ARGS_Parrot_metrics_destroy __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp))
+#define ASSERT_ARGS_Parrot_metrics_new __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: src/metrics.c */
+
+#endif /* PARROT_METRICS_H_GUARD */
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
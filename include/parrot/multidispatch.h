@@ -16,7 +16,9 @@
 #include "parrot/parrot.h"
 
 #define PARROT_MMD_MAX_CLASS_DEPTH 1000
-#define Parrot_mmd_cache_destroy(x, y)
+
+/* Longest type tuple the MMD caches remember; longer calls are not cached */
+#define PARROT_MMD_CACHE_MAX_TYPES 8
 
 /* function typedefs */
 typedef PMC*    (*mmd_f_p_ppp)(PARROT_INTERP, PMC *, PMC *, PMC *);
@@ -54,7 +56,21 @@ typedef struct _multi_func_list {
     funcptr_t func_ptr;
 } multi_func_list;
 
-#define MMD_Cache PMC
+/* One cached dispatch: the type ids of the arguments and the chosen candidate */
+typedef struct _MMD_Cache_entry {
+    char   *name;                               /* dispatched name, or NULL */
+    PMC    *chosen;                             /* NULL for an empty slot */
+    UINTVAL hash;
+    INTVAL  num_types;
+    INTVAL  types[PARROT_MMD_CACHE_MAX_TYPES];
+} MMD_Cache_entry;
+
+/* Open addressed table of MMD_Cache_entry, keyed by (name, type ids) */
+typedef struct _MMD_Cache {
+    MMD_Cache_entry *entries;
+    UINTVAL          size;                      /* number of slots, power of 2 */
+    UINTVAL          used;
+} MMD_Cache;
 
 /* HEADERIZER BEGIN: src/multidispatch.c */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
@@ -101,16 +117,25 @@ PARROT_CANNOT_RETURN_NULL
 MMD_Cache * Parrot_mmd_cache_create(PARROT_INTERP)
         __attribute__nonnull__(1);
 
+PARROT_EXPORT
+void Parrot_mmd_cache_destroy(PARROT_INTERP, ARGFREE(MMD_Cache *cache))
+        __attribute__nonnull__(1);
+
+PARROT_EXPORT
+void Parrot_mmd_cache_invalidate(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*cache);
+
 PARROT_EXPORT
 PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 PMC * Parrot_mmd_cache_lookup_by_types(PARROT_INTERP,
     ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name),
+    ARGIN_NULLOK(const char *name),
     ARGIN(PMC *types))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        __attribute__nonnull__(3)
         __attribute__nonnull__(4)
         FUNC_MODIFIES(*cache);
 
@@ -119,11 +144,10 @@ PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 PMC * Parrot_mmd_cache_lookup_by_values(PARROT_INTERP,
     ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name),
+    ARGIN_NULLOK(const char *name),
     ARGIN(PMC *values))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        __attribute__nonnull__(3)
         __attribute__nonnull__(4)
         FUNC_MODIFIES(*cache);
 
@@ -136,27 +160,23 @@ void Parrot_mmd_cache_mark(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
 PARROT_EXPORT
 void Parrot_mmd_cache_store_by_types(PARROT_INTERP,
     ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name),
+    ARGIN_NULLOK(const char *name),
     ARGIN(PMC *types),
-    ARGIN(PMC *chosen))
+    ARGIN_NULLOK(PMC *chosen))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        __attribute__nonnull__(3)
         __attribute__nonnull__(4)
-        __attribute__nonnull__(5)
         FUNC_MODIFIES(*cache);
 
 PARROT_EXPORT
 void Parrot_mmd_cache_store_by_values(PARROT_INTERP,
     ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name),
+    ARGIN_NULLOK(const char *name),
     ARGIN(PMC *values),
-    ARGIN(PMC *chosen))
+    ARGIN_NULLOK(PMC *chosen))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        __attribute__nonnull__(3)
         __attribute__nonnull__(4)
-        __attribute__nonnull__(5)
         FUNC_MODIFIES(*cache);
 
 PARROT_EXPORT
@@ -222,17 +242,20 @@ PMC * Parrot_mmd_sort_manhattan_by_sig_pmc(PARROT_INTERP,
     , PARROT_ASSERT_ARG(sig_obj))
 #define ASSERT_ARGS_Parrot_mmd_cache_create __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp))
+#define ASSERT_ARGS_Parrot_mmd_cache_destroy __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp))
+#define ASSERT_ARGS_Parrot_mmd_cache_invalidate __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(cache))
 #define ASSERT_ARGS_Parrot_mmd_cache_lookup_by_types \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(cache) \
-    , PARROT_ASSERT_ARG(name) \
     , PARROT_ASSERT_ARG(types))
 #define ASSERT_ARGS_Parrot_mmd_cache_lookup_by_values \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(cache) \
-    , PARROT_ASSERT_ARG(name) \
     , PARROT_ASSERT_ARG(values))
 #define ASSERT_ARGS_Parrot_mmd_cache_mark __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
@@ -241,16 +264,12 @@ PMC * Parrot_mmd_sort_manhattan_by_sig_pmc(PARROT_INTERP,
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(cache) \
-    , PARROT_ASSERT_ARG(name) \
-    , PARROT_ASSERT_ARG(types) \
-    , PARROT_ASSERT_ARG(chosen))
+    , PARROT_ASSERT_ARG(types))
 #define ASSERT_ARGS_Parrot_mmd_cache_store_by_values \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(cache) \
-    , PARROT_ASSERT_ARG(name) \
-    , PARROT_ASSERT_ARG(values) \
-    , PARROT_ASSERT_ARG(chosen))
+    , PARROT_ASSERT_ARG(values))
 #define ASSERT_ARGS_Parrot_mmd_find_multi_from_long_sig \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
@@ -206,6 +206,9 @@ typedef struct PackFile_ByteCode_OpMapping {
     PackFile_ByteCode_OpMappingEntry *libs;   /* opcode libraries used by this segment */
 } PackFile_ByteCode_OpMapping;
 
+/* op tables shared by the unpacked segments with the same op mapping */
+typedef struct PackFile_OpTables PackFile_OpTables;
+
 struct PackFile_ByteCode {
     PackFile_Segment              base;
     struct PackFile_Debug        *debugs;
@@ -217,8 +220,10 @@ struct PackFile_ByteCode {
     op_func_t                    *op_func_table;   /* opcode dispatch table */
     op_func_t                    *save_func_table; /* for when we hijack op_func_table */
     op_info_t                   **op_info_table;
+    PackFile_OpTables            *op_tables;       /* owner of the tables, if shared */
     size_t                        n_libdeps;       /* number of library dependancies */
     STRING                      **libdeps;         /* names of prerequisite libraries */
+    struct Parrot_jit_segment    *jit;             /* native code of the jit runcore */
 };
 
 typedef struct PackFile_DebugFilenameMapping {
@@ -231,6 +236,14 @@ typedef struct PackFile_Debug {
     opcode_t                num_mappings;
     PackFile_DebugFilenameMapping *mappings;
     PackFile_ByteCode      *code;   /* where this segment belongs to */
+
+    /* Lookup caches, rebuilt or revalidated on use */
+    opcode_t               *op_offsets;     /* bytecode offset of each op */
+    size_t                  num_op_offsets;
+    const opcode_t         *op_offsets_code; /* code the offsets were built for */
+    size_t                  op_offsets_size;
+    size_t                  last_op;        /* index of the last op found */
+    opcode_t                last_mapping;   /* index of the last mapping found */
 } PackFile_Debug;
 
 #define ANN_ENTRY_OFF 0
@@ -252,6 +265,7 @@ typedef struct PackFile_Annotations_Key {
     pf_ann_key_type_t type;
     UINTVAL           start;
     UINTVAL           len;
+    UINTVAL           last_hit; /* entry found by the last lookup */
 } PackFile_Annotations_Key;
 
 typedef struct PackFile_Annotations {
@@ -259,6 +273,7 @@ typedef struct PackFile_Annotations {
     PackFile_ByteCode           *code;
     opcode_t                     num_keys;
     PackFile_Annotations_Key    *keys;
+    opcode_t                     last_key;  /* index of the last key looked up */
 } PackFile_Annotations;
 
 typedef struct PackFile_Directory {
@@ -583,10 +598,11 @@ PARROT_EXPORT
 PARROT_WARN_UNUSED_RESULT
 PARROT_CANNOT_RETURN_NULL
 STRING * Parrot_debug_pc_to_filename(PARROT_INTERP,
-    ARGIN(const PackFile_Debug *debug),
+    ARGMOD(PackFile_Debug *debug),
     opcode_t pc)
         __attribute__nonnull__(1)
-        __attribute__nonnull__(2);
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*debug);
 
 PARROT_EXPORT
 void Parrot_load_bytecode(PARROT_INTERP,
@@ -748,11 +764,12 @@ PackFile_ByteCode * Parrot_switch_to_cs(PARROT_INTERP,
 
 PARROT_CANNOT_RETURN_NULL
 PMC * PackFile_Annotations_lookup(PARROT_INTERP,
-    ARGIN(PackFile_Annotations *self),
+    ARGMOD(PackFile_Annotations *self),
     opcode_t offset,
     ARGIN_NULLOK(STRING *name))
         __attribute__nonnull__(1)
-        __attribute__nonnull__(2);
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*self);
 
 PARROT_CANNOT_RETURN_NULL
 PARROT_WARN_UNUSED_RESULT
@@ -772,6 +789,14 @@ PMC * Parrot_pf_all_tags_list(PARROT_INTERP, ARGIN(PMC * pfpmc))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+PARROT_WARN_UNUSED_RESULT
+INTVAL Parrot_pf_debug_op_index(PARROT_INTERP,
+    ARGMOD(PackFile_Debug *debug),
+    opcode_t offset)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*debug);
+
 PARROT_PURE_FUNCTION
 PARROT_CANNOT_RETURN_NULL
 PackFile_ByteCode * Parrot_pf_get_current_code_segment(PARROT_INTERP)
@@ -912,6 +937,9 @@ void Parrot_pf_mark_packfile(PARROT_INTERP, ARGMOD_NULLOK(PackFile * pf))
 #define ASSERT_ARGS_Parrot_pf_all_tags_list __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(pfpmc))
+#define ASSERT_ARGS_Parrot_pf_debug_op_index __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(debug))
 #define ASSERT_ARGS_Parrot_pf_get_current_code_segment \
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp))
@@ -1157,6 +1185,7 @@ const opcode_t * PackFile_Annotations_unpack(PARROT_INTERP,
         __attribute__nonnull__(3)
         FUNC_MODIFIES(*seg);
 
+void Parrot_pf_init_op_tables_cache(void);
 void pf_register_standard_funcs(PARROT_INTERP, ARGMOD(PackFile *pf))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
@@ -1215,12 +1244,43 @@ void pf_register_standard_funcs(PARROT_INTERP, ARGMOD(PackFile *pf))
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(seg) \
     , PARROT_ASSERT_ARG(cursor))
+#define ASSERT_ARGS_Parrot_pf_init_op_tables_cache \
+     __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
 #define ASSERT_ARGS_pf_register_standard_funcs __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(pf))
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 /* HEADERIZER END: src/packfile/segments.c */
 
+/* HEADERIZER BEGIN: src/packfile/snapshot.c */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+PARROT_EXPORT
+PARROT_CANNOT_RETURN_NULL
+PMC * Parrot_pf_read_snapshot(PARROT_INTERP,
+    ARGIN(STRING *path),
+    ARGIN_NULLOK(PMC *view))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+PARROT_EXPORT
+void Parrot_pf_write_snapshot(PARROT_INTERP,
+    ARGIN(PMC *pbc),
+    ARGIN(STRING *path))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+#define ASSERT_ARGS_Parrot_pf_read_snapshot __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(path))
+#define ASSERT_ARGS_Parrot_pf_write_snapshot __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(pbc) \
+    , PARROT_ASSERT_ARG(path))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: src/packfile/snapshot.c */
+
 
 #endif /* PARROT_PACKFILE_H_GUARD */
 
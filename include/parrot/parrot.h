@@ -274,6 +274,7 @@ typedef struct PackFile_ByteCode PackFile_ByteCode;
 #include "parrot/library.h"
 #include "parrot/namespace.h"
 #include "parrot/hll.h"
+#include "parrot/metrics.h"
 #include "parrot/pbcversion.h"
 #include "parrot/disassemble.h"
 
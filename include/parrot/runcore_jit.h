@@ -0,0 +1,79 @@
+/* runcore_jit.h
+ *  Copyright (C) 2012, Parrot Foundation.
+ *  Overview:
+ *     Data structures for the jit runcore.
+ */
+
+#ifndef PARROT_RUNCORE_JIT_H_GUARD
+#define PARROT_RUNCORE_JIT_H_GUARD
+
+struct         jit_runcore_t;
+typedef struct jit_runcore_t Parrot_jit_runcore_t;
+
+#include "parrot/parrot.h"
+#include "parrot/op.h"
+#include "parrot/runcore_api.h"
+
+/* entries and backward branches a sub sees before it is compiled */
+#define JIT_DEFAULT_THRESHOLD 100
+
+struct jit_runcore_t {
+    STRING                      *name;
+    int                          id;
+    oplib_init_f                 opinit;
+    Parrot_runcore_runops_fn_t   runops;
+    Parrot_runcore_destroy_fn_t  destroy;
+    Parrot_runcore_prepare_fn_t  prepare_run;
+    INTVAL                       flags;
+
+    /* end of common members */
+    UINTVAL      threshold;     /* hotness at which a sub is compiled */
+    op_lib_t    *core_lib;      /* ops with a native template come from here */
+};
+
+/* One sub of a bytecode segment, as far as the jit runcore is concerned */
+typedef struct Parrot_jit_sub {
+    opcode_t    *start;         /* first op of the sub */
+    opcode_t    *end;           /* one past its last op */
+    UINTVAL      hotness;       /* entries and backward branches seen so far */
+    INTVAL       failed;        /* set if the sub cannot be compiled */
+    void       **entries;       /* native code of each op, by offset from start */
+    char        *code;          /* executable memory holding the native code */
+    size_t       code_size;
+} Parrot_jit_sub;
+
+/* The subs of a bytecode segment, sorted by address. The native code only
+ * serves the interpreter which compiled it */
+typedef struct Parrot_jit_segment {
+    Interp         *interp;
+    size_t          n_subs;
+    Parrot_jit_sub *subs;
+} Parrot_jit_segment;
+
+/* HEADERIZER BEGIN: src/runcore/jit.c */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+void Parrot_jit_free_segment(PARROT_INTERP, ARGMOD(PackFile_ByteCode *seg))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*seg);
+
+void Parrot_runcore_jit_init(PARROT_INTERP)
+        __attribute__nonnull__(1);
+
+#define ASSERT_ARGS_Parrot_jit_free_segment __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(seg))
+#define ASSERT_ARGS_Parrot_runcore_jit_init __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: src/runcore/jit.c */
+
+#endif /* PARROT_RUNCORE_JIT_H_GUARD */
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
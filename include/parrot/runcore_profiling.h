@@ -38,6 +38,29 @@ typedef enum Parrot_profiling_line {
     PPROF_LINE_END_OF_RUNLOOP
 } Parrot_profiling_line;
 
+/* Binary output: an 8 byte magic followed by records, each of which is a tag
+ * byte and a fixed sequence of unsigned LEB128 varints.  Strings are sent once
+ * as a PPROF_BINARY_STRING record and then referred to by id. */
+#define PPROF_BINARY_MAGIC     "PPROFBIN"
+#define PPROF_BINARY_MAGIC_LEN 8
+
+typedef enum Parrot_profiling_binary_tag {
+    PPROF_BINARY_STRING = 1,        /* id, length, bytes */
+    PPROF_BINARY_VERSION,           /* version */
+    PPROF_BINARY_CLI,               /* string id */
+    PPROF_BINARY_CONTEXT_SWITCH,    /* ns id, file id, sub addr, ctx addr */
+    PPROF_BINARY_OP,                /* op name id, zigzag line delta, time */
+    PPROF_BINARY_ANNOTATION,        /* name id, value id */
+    PPROF_BINARY_END_OF_RUNLOOP
+} Parrot_profiling_binary_tag;
+
+/* the binary writer fills PPROF_RING_CHUNKS buffers of PPROF_RING_CHUNK_SIZE
+ * bytes in turn while a flusher thread writes out the full ones */
+#define PPROF_RING_CHUNKS     8
+#define PPROF_RING_CHUNK_SIZE (1024 * 1024)
+
+typedef struct profiling_ring_t Parrot_profiling_ring;
+
 typedef void (*profiling_store_fn)  (PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t*), ARGIN(PPROF_DATA*), ARGIN_NULLOK(Parrot_profiling_line));
 typedef void (*profiling_init_fn)   (PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t*));
 typedef void (*profiling_destroy_fn)(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t*));
@@ -100,6 +123,13 @@ struct profiling_runcore_t {
     UINTVAL         time_size;  /* how big is the following array */
     UHUGEINTVAL    *time;       /* time spent between DO_OP and start/end of a runcore */
     Hash           *line_cache; /* hash for caching pc -> line mapping */
+
+    /* binary output */
+    Parrot_profiling_ring *ring;
+    Hash           *string_ids; /* C string contents -> id */
+    Hash           *opname_ids; /* op name pointer -> id */
+    UINTVAL         last_string_id;
+    INTVAL          prev_line;
 };
 
 #define Profiling_flag_SET(runcore, flag) \
@@ -0,0 +1,69 @@
+/* runcore_sampling.h
+ *  Copyright (C) 2012, Parrot Foundation.
+ *  Overview:
+ *     Data structures for the sampling profiler runcore.
+ */
+
+#ifndef PARROT_RUNCORE_SAMPLING_H_GUARD
+#define PARROT_RUNCORE_SAMPLING_H_GUARD
+
+struct         sampling_runcore_t;
+typedef struct sampling_runcore_t Parrot_sampling_runcore_t;
+
+#include "parrot/parrot.h"
+#include "parrot/op.h"
+#include "parrot/runcore_api.h"
+
+/* default time between samples, in microseconds of CPU time */
+#define SAMPLING_DEFAULT_INTERVAL 1000
+
+/* deepest call chain recorded for a sample; deeper frames are dropped */
+#define SAMPLING_MAX_DEPTH        256
+
+/* number of UINTVAL slots in the sample buffer */
+#define SAMPLING_BUFFER_SIZE      (64 * 1024)
+
+struct sampling_runcore_t {
+    STRING                      *name;
+    int                          id;
+    oplib_init_f                 opinit;
+    Parrot_runcore_runops_fn_t   runops;
+    Parrot_runcore_destroy_fn_t  destroy;
+    Parrot_runcore_prepare_fn_t  prepare_run;
+    INTVAL                       flags;
+
+    /* end of common members */
+    FILE        *profile_fd;
+    STRING      *profile_filename;
+    UINTVAL      interval;      /* microseconds between samples */
+    UINTVAL      samples;       /* samples taken so far */
+    UINTVAL     *buffer;        /* [depth, frame ids leaf to root] per sample */
+    size_t       buffer_used;
+    Hash        *frame_ids;     /* pc -> 1-based index into frames */
+    char       **frames;        /* printable label of each distinct pc */
+    size_t       frame_count;
+    size_t       frame_alloc;
+    Hash        *stacks;        /* folded stack -> sample count */
+    char        *fold_buf;      /* scratch space for building folded stacks */
+    size_t       fold_size;
+};
+
+/* HEADERIZER BEGIN: src/runcore/sampling.c */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+void Parrot_runcore_sampling_init(PARROT_INTERP)
+        __attribute__nonnull__(1);
+
+#define ASSERT_ARGS_Parrot_runcore_sampling_init __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: src/runcore/sampling.c */
+
+#endif /* PARROT_RUNCORE_SAMPLING_H_GUARD */
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
@@ -1,4 +1,4 @@
-# Copyright (C) 2005-2009, Parrot Foundation.
+# Copyright (C) 2005-2012, Parrot Foundation.
 #
 # Parrot MD5 library; Nick Glencross <nickg@glencros.demon.co.uk>
 #                     Improvements from Leo and Jens Rieks
@@ -31,8 +31,9 @@ or using the Object interface:
 
 =head1 DESCRIPTION
 
-This is a pure Parrot MD5 hash routine. You should run it with the JIT
-core if possible.
+Calculates MD5 checksums with the C<Digest> dynpmc, keeping the interface of
+the original pure Parrot implementation.  New code can use C<Digest> directly,
+which also accepts ByteBuffers and data in several pieces.
 
 =head1 SUBROUTINES
 
@@ -56,7 +57,7 @@ The MD5 class defines the following subroutines, which are very similar to the s
 
 .HLL 'parrot'
 
-.loadlib 'bit_ops'
+.loadlib 'digest'
 
 ###########################################################################
 # Interface definition
@@ -126,76 +127,39 @@ Uses the Integer array from _md5sum to print the checksum. Returns the checksum
 .sub _md5sum
     .param string str
 
-    .local pmc context
+    .local pmc digest, bytes, context
+    digest = new ['Digest']
+    digest.'reset'('md5')
+    digest.'update'(str)
+    bytes = digest.'final_bytes'()
+
+    # MD5 words are little-endian
     context = new 'FixedIntegerArray'
     context = 4
-
-    .local pmc buffer
-    buffer = _md5_create_buffer (str)
-
-    _md5_init (context)
-    _md5_process_buffer (context, buffer)
+    .local int i, word
+    i = 0
+  words:
+    $I0  = i * 4
+    word = bytes[$I0]
+    inc $I0
+    $I1  = bytes[$I0]
+    $I1 <<= 8
+    word |= $I1
+    inc $I0
+    $I1  = bytes[$I0]
+    $I1 <<= 16
+    word |= $I1
+    inc $I0
+    $I1  = bytes[$I0]
+    $I1 <<= 24
+    word |= $I1
+    context[i] = word
+    inc i
+    if i < 4 goto words
 
     .return (context)
 .end
 
-
-###########################################################################
-# Low-level macros used in MD5
-
-.macro FF (b,c,d)
-    tmp  = .c ~ .d
-    tmp &= .b
-    tmp ~= .d
-.endm
-
-.macro FH (b,c,d)
-    tmp  = .b ~ .c
-    tmp ~= .d
-.endm
-
-.macro FI (b,c,d)
-    tmp  = ~.d
-    tmp |= .b
-    tmp ~= .c
-.endm
-
-###########################################################################
-# Higher level MD5 operations
-
-.macro common (a, b, k, s, T)
-    .a += tmp
-    .a += .T
-    tmp = .k + idx
-    tmp = buffer[tmp]
-    .a += tmp
-    .a &= 0xffffffff
-    tmp = rot .a, .s, 32
-    .a  = .b + tmp
-    .a &= 0xffffffff
-.endm
-
-
-.macro OP1 (aa,bb,cc,dd, kk, ss, TT)
-    .FF     (.bb,.cc,.dd)
-    .common (.aa, .bb, .kk, .ss, .TT)
-.endm
-
-.macro OP2 (aa,bb,cc,dd, kk, ss, TT)
-    .FF     (.dd,.bb,.cc)
-    .common (.aa, .bb, .kk, .ss, .TT)
-.endm
-
-.macro OP3 (aa,bb,cc,dd, kk, ss, TT)
-    .FH     (.bb,.cc,.dd)
-    .common (.aa, .bb, .kk, .ss, .TT)
-.endm
-
-.macro OP4 (aa,bb,cc,dd, kk, ss, TT)
-    .FI     (.bb,.cc,.dd)
-    .common (.aa, .bb, .kk, .ss, .TT)
-.endm
-
 ###########################################################################
 
 # Swap the bytes which make up a word
@@ -221,228 +185,6 @@ Uses the Integer array from _md5sum to print the checksum. Returns the checksum
 
 ###########################################################################
 
-# Set the initial MD5 constants
-
-.sub _md5_init
-    .param pmc context
-
-    # Initial MD5 constants
-    context[0] = 0x67452301
-    context[1] = 0xefcdab89
-    context[2] = 0x98badcfe
-    context[3] = 0x10325476
-
-.end
-
-###########################################################################
-# Create an internal scratchpad buffer
-
-.sub _md5_create_buffer
-    .param string str
-
-    .local pmc buffer
-    buffer = new 'FixedIntegerArray'
-
-    .local int counter
-    .local int subcounter
-    .local int slow_counter
-
-    .local int word, len
-
-     len = length str
-
-     $I1 = len - 1
-
-     # Work out how many words to allocate
-     .local int words
-     words  = len + 8
-     words |= 63
-     inc words
-     words /= 4
-
-     buffer = words
-
-     word         = 0
-     counter      = 0
-     subcounter   = 0
-     slow_counter = 0
-
-create_buffer_loop:
-
-     $I5 = counter + subcounter
-
-     if $I5 > len goto create_buffer_break
-
-     # MD5 pad character, which goes last
-     $I4 = 0x80
-
-     if $I5 > $I1 goto string_char
-     $I4 = ord str, $I5
-
-string_char:
-
-     word <<= 8
-     word  |= $I4
-
-     inc subcounter
-     if subcounter != 4 goto create_buffer_loop
-
-     .swap (word)
-
-     buffer[slow_counter] = word
-
-     word       = 0
-     counter   += 4
-     subcounter = 0
-     inc slow_counter
-
-     goto create_buffer_loop
-
-create_buffer_break:
-
-     # Check for a partial word
-
-     if subcounter == 0 goto complete
-     subcounter = 4 - subcounter
-     $I0    = 8*subcounter
-     word <<= $I0
-
-     .swap (word)
-
-     buffer[slow_counter] = word
-
-complete:
-
-     # The number of bits in the string go into the last two words
-
-     $I0 = len >>> 29
-     dec words
-     buffer[words] = $I0
-
-     $I0 = len << 3
-     dec words
-     buffer[words] = $I0
-
-     .return (buffer)
-
-.end
-
-###########################################################################
-
-.sub _md5_process_buffer
-    .param pmc  context
-    .param pmc  buffer
-
-    .local int A, B, C, D
-    .local int A_save, B_save, C_save, D_save
-
-    .local int tmp, idx, len
-
-    idx = 0
-    len = elements buffer
-
-    A = context[0]
-    B = context[1]
-    C = context[2]
-    D = context[3]
-
-loop:
-
-    A_save = A
-    B_save = B
-    C_save = C
-    D_save = D
-
-    # Round 1.
-    .OP1 (A, B, C, D, 0,  7, 0xd76aa478)
-    .OP1 (D, A, B, C, 1, 12, 0xe8c7b756)
-    .OP1 (C, D, A, B, 2, 17, 0x242070db)
-    .OP1 (B, C, D, A, 3, 22, 0xc1bdceee)
-    .OP1 (A, B, C, D, 4,  7, 0xf57c0faf)
-    .OP1 (D, A, B, C, 5, 12, 0x4787c62a)
-    .OP1 (C, D, A, B, 6, 17, 0xa8304613)
-    .OP1 (B, C, D, A, 7, 22, 0xfd469501)
-    .OP1 (A, B, C, D, 8,  7, 0x698098d8)
-    .OP1 (D, A, B, C, 9, 12, 0x8b44f7af)
-    .OP1 (C, D, A, B, 10,17, 0xffff5bb1)
-    .OP1 (B, C, D, A, 11,22, 0x895cd7be)
-    .OP1 (A, B, C, D, 12, 7, 0x6b901122)
-    .OP1 (D, A, B, C, 13,12, 0xfd987193)
-    .OP1 (C, D, A, B, 14,17, 0xa679438e)
-    .OP1 (B, C, D, A, 15,22, 0x49b40821)
-
-    # Round 2.
-    .OP2 (A, B, C, D,  1,  5, 0xf61e2562)
-    .OP2 (D, A, B, C,  6,  9, 0xc040b340)
-    .OP2 (C, D, A, B, 11, 14, 0x265e5a51)
-    .OP2 (B, C, D, A,  0, 20, 0xe9b6c7aa)
-    .OP2 (A, B, C, D,  5,  5, 0xd62f105d)
-    .OP2 (D, A, B, C, 10,  9, 0x02441453)
-    .OP2 (C, D, A, B, 15, 14, 0xd8a1e681)
-    .OP2 (B, C, D, A,  4, 20, 0xe7d3fbc8)
-    .OP2 (A, B, C, D,  9,  5, 0x21e1cde6)
-    .OP2 (D, A, B, C, 14,  9, 0xc33707d6)
-    .OP2 (C, D, A, B,  3, 14, 0xf4d50d87)
-    .OP2 (B, C, D, A,  8, 20, 0x455a14ed)
-    .OP2 (A, B, C, D, 13,  5, 0xa9e3e905)
-    .OP2 (D, A, B, C,  2,  9, 0xfcefa3f8)
-    .OP2 (C, D, A, B,  7, 14, 0x676f02d9)
-    .OP2 (B, C, D, A, 12, 20, 0x8d2a4c8a)
-
-    # Round 3.
-    .OP3 (A, B, C, D,  5,  4, 0xfffa3942)
-    .OP3 (D, A, B, C,  8, 11, 0x8771f681)
-    .OP3 (C, D, A, B, 11, 16, 0x6d9d6122)
-    .OP3 (B, C, D, A, 14, 23, 0xfde5380c)
-    .OP3 (A, B, C, D,  1,  4, 0xa4beea44)
-    .OP3 (D, A, B, C,  4, 11, 0x4bdecfa9)
-    .OP3 (C, D, A, B,  7, 16, 0xf6bb4b60)
-    .OP3 (B, C, D, A, 10, 23, 0xbebfbc70)
-    .OP3 (A, B, C, D, 13,  4, 0x289b7ec6)
-    .OP3 (D, A, B, C,  0, 11, 0xeaa127fa)
-    .OP3 (C, D, A, B,  3, 16, 0xd4ef3085)
-    .OP3 (B, C, D, A,  6, 23, 0x04881d05)
-    .OP3 (A, B, C, D,  9,  4, 0xd9d4d039)
-    .OP3 (D, A, B, C, 12, 11, 0xe6db99e5)
-    .OP3 (C, D, A, B, 15, 16, 0x1fa27cf8)
-    .OP3 (B, C, D, A,  2, 23, 0xc4ac5665)
-
-    # Round 4.
-    .OP4 (A, B, C, D,  0,  6, 0xf4292244)
-    .OP4 (D, A, B, C,  7, 10, 0x432aff97)
-    .OP4 (C, D, A, B, 14, 15, 0xab9423a7)
-    .OP4 (B, C, D, A,  5, 21, 0xfc93a039)
-    .OP4 (A, B, C, D, 12,  6, 0x655b59c3)
-    .OP4 (D, A, B, C,  3, 10, 0x8f0ccc92)
-    .OP4 (C, D, A, B, 10, 15, 0xffeff47d)
-    .OP4 (B, C, D, A,  1, 21, 0x85845dd1)
-    .OP4 (A, B, C, D,  8,  6, 0x6fa87e4f)
-    .OP4 (D, A, B, C, 15, 10, 0xfe2ce6e0)
-    .OP4 (C, D, A, B,  6, 15, 0xa3014314)
-    .OP4 (B, C, D, A, 13, 21, 0x4e0811a1)
-    .OP4 (A, B, C, D,  4,  6, 0xf7537e82)
-    .OP4 (D, A, B, C, 11, 10, 0xbd3af235)
-    .OP4 (C, D, A, B,  2, 15, 0x2ad7d2bb)
-    .OP4 (B, C, D, A,  9, 21, 0xeb86d391)
-
-    A += A_save
-    B += B_save
-    C += C_save
-    D += D_save
-
-    idx += 16
-
-    if idx < len goto loop
-
-    context[0] = A
-    context[1] = B
-    context[2] = C
-    context[3] = D
-
-.end
-
-###########################################################################
-
 # Format four hex values
 
 .sub _md5_format_vals
@@ -497,11 +239,9 @@ loop:
     .return ($S0)
 .end
 
+=head1 SEE ALSO
 
-=head1 BUGS
-
-Still has some limitations on input buffer size, largely due to memory
-consumption which should be resolved soon.
+F<src/dynpmc/digest.pmc>
 
 =cut
 
@@ -13,6 +13,9 @@ Use the C<_json> method to generate a JSON representation of a PMC.
 
 To generate a PMC from a JSON string, see L<compilers/data_json>.
 
+The C<JSONCodec> dynpmc (F<src/dynpmc/jsoncodec.pmc>) parses and emits JSON
+in C, with the same layout as C<_json> but with strict JSON string escapes.
+
 =cut
 
 =head1 FUNCTIONS
@@ -52,6 +52,11 @@ typedef struct pcc_funcs_ptr {
     pmc_func_t      pmc_constant;
 } pcc_funcs_ptr;
 
+/* get_params/get_results signatures are classified on first use; the result
+ * is cached in the private flags of the (constant) signature PMC. */
+#define PCC_SIG_CLASSIFIED_FLAG      PObj_private6_FLAG
+#define PCC_SIG_POSITIONAL_ONLY_FLAG PObj_private7_FLAG
+
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
@@ -97,6 +102,15 @@ static void fill_params(PARROT_INTERP,
         __attribute__nonnull__(5)
         FUNC_MODIFIES(*call_object);
 
+static INTVAL fill_positional_params_from_op(PARROT_INTERP,
+    ARGIN(PMC *call_object),
+    ARGIN(PMC *raw_sig),
+    ARGIN(const opcode_t *raw_params))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4);
+
 PARROT_WARN_UNUSED_RESULT
 static INTVAL intval_constant_from_op(PARROT_INTERP,
     ARGIN(const opcode_t *raw_params),
@@ -258,6 +272,12 @@ static STRING** string_param_from_op(PARROT_INTERP,
     , PARROT_ASSERT_ARG(raw_sig) \
     , PARROT_ASSERT_ARG(arg_info) \
     , PARROT_ASSERT_ARG(accessor))
+#define ASSERT_ARGS_fill_positional_params_from_op \
+     __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(call_object) \
+    , PARROT_ASSERT_ARG(raw_sig) \
+    , PARROT_ASSERT_ARG(raw_params))
 #define ASSERT_ARGS_intval_constant_from_op __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(raw_params))
 #define ASSERT_ARGS_intval_constant_from_varargs __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -1322,11 +1342,93 @@ Parrot_pcc_fill_params_from_op(PARROT_INTERP, ARGMOD_NULLOK(PMC *call_object),
         (pmc_func_t)pmc_constant_from_op,
     };
 
+    if (!PMC_IS_NULL(call_object)
+    &&  fill_positional_params_from_op(interp, call_object, raw_sig, raw_params))
+        return;
+
     fill_params(interp, call_object, raw_sig, raw_params, &function_pointers, direction);
 }
 
 /*
 
+=item C<static INTVAL fill_positional_params_from_op(PARROT_INTERP, PMC
+*call_object, PMC *raw_sig, const opcode_t *raw_params)>
+
+Fast path of C<Parrot_pcc_fill_params_from_op> for the most common call shape:
+a C<get_params> or C<get_results> made only of required positional
+parameters, matched by exactly as many positional arguments and no named
+ones.  The arguments are copied straight into the registers of the current
+context, without going through the accessor functions of C<fill_params>.
+
+Returns 0 without touching any register if the call has another shape, so
+that C<fill_params> handles it, including all error reporting.
+
+=cut
+
+*/
+
+static INTVAL
+fill_positional_params_from_op(PARROT_INTERP, ARGIN(PMC *call_object),
+        ARGIN(PMC *raw_sig), ARGIN(const opcode_t *raw_params))
+{
+    ASSERT_ARGS(fill_positional_params_from_op)
+    INTVAL *param_flags     = NULL;
+    INTVAL  param_count     = 0;
+    INTVAL  positional_args = 0;
+    INTVAL  i;
+    Hash   *named           = NULL;
+
+    GETATTR_FixedIntegerArray_size(interp, raw_sig, param_count);
+    GETATTR_FixedIntegerArray_int_array(interp, raw_sig, param_flags);
+
+    if (!(PObj_get_FLAGS(raw_sig) & PCC_SIG_CLASSIFIED_FLAG)) {
+        /* anything but the type bits needs the full treatment */
+        for (i = 0; i < param_count; ++i)
+            if (param_flags[i] & ~PARROT_ARG_TYPE_MASK)
+                break;
+
+        if (i == param_count)
+            PObj_get_FLAGS(raw_sig) |= PCC_SIG_POSITIONAL_ONLY_FLAG;
+        PObj_get_FLAGS(raw_sig) |= PCC_SIG_CLASSIFIED_FLAG;
+    }
+
+    if (!(PObj_get_FLAGS(raw_sig) & PCC_SIG_POSITIONAL_ONLY_FLAG))
+        return 0;
+
+    GETATTR_CallContext_num_positionals(interp, call_object, positional_args);
+    GETATTR_CallContext_hash(interp, call_object, named);
+
+    if (positional_args != param_count || (named && named->entries))
+        return 0;
+
+    for (i = 0; i < param_count; ++i) {
+        const INTVAL raw_index = raw_params[i + 2];
+
+        switch (PARROT_ARG_TYPE_MASK_MASK(param_flags[i])) {
+          case PARROT_ARG_INTVAL:
+            REG_INT(interp, raw_index) =
+                VTABLE_get_integer_keyed_int(interp, call_object, i);
+            break;
+          case PARROT_ARG_FLOATVAL:
+            REG_NUM(interp, raw_index) =
+                VTABLE_get_number_keyed_int(interp, call_object, i);
+            break;
+          case PARROT_ARG_STRING:
+            REG_STR(interp, raw_index) =
+                VTABLE_get_string_keyed_int(interp, call_object, i);
+            break;
+          default: /* PARROT_ARG_PMC */
+            REG_PMC(interp, raw_index) =
+                VTABLE_get_pmc_keyed_int(interp, call_object, i);
+            break;
+        }
+    }
+
+    return 1;
+}
+
+/*
+
 =item C<void Parrot_pcc_fill_params_from_c_args(PARROT_INTERP, PMC *call_object,
 const char *signature, ...)>
 
@@ -252,6 +252,7 @@ init_context(ARGMOD(PMC *pmcctx), ARGIN_NULLOK(PMC *pmcold))
     ctx->outer_ctx         = NULL;
     ctx->current_cont      = NULL;
     ctx->handlers          = PMCNULL;
+    ctx->num_pending_handlers = 0;
     ctx->caller_ctx        = NULL;
     ctx->current_sig       = PMCNULL;
     ctx->current_sub       = PMCNULL;
@@ -519,6 +520,50 @@ Parrot_pcc_free_registers(PARROT_INTERP, ARGIN(PMC *pmcctx))
 }
 
 
+/*
+
+=item C<void Parrot_pcc_recycle_registers(PARROT_INTERP, PMC *ctx, PMC *callee)>
+
+Returns the register frame of C<callee> to the fixed size allocator as soon as
+C<callee> has returned to C<ctx>, instead of waiting for the GC to destroy the
+CallContext.  The next call of the same frame size gets the block back from
+the allocator's free list.
+
+The frame is only released if nothing can reach its registers any more: the
+context must not be flagged as escaped (see C<CALLSIGNATURE_is_escaped_SET>),
+must have no LexPad, and must belong to a plain, non-outer Sub.  Coroutines
+and HLL subclasses of Sub keep their frames until GC.
+
+=cut
+
+*/
+
+void
+Parrot_pcc_recycle_registers(PARROT_INTERP, ARGIN(PMC *ctx), ARGIN(PMC *callee))
+{
+    ASSERT_ARGS(Parrot_pcc_recycle_registers)
+    Parrot_CallContext_attributes * const c = PARROT_CALLCONTEXT(callee);
+    PMC * const sub = c->current_sub;
+
+    if (c->caller_ctx != ctx
+    ||  !c->registers
+    ||  CALLSIGNATURE_is_escaped_TEST(callee)
+    ||  !PMC_IS_NULL(c->lex_pad)
+    ||  PMC_IS_NULL(sub)
+    ||  sub->vtable->base_type != enum_class_Sub
+    ||  PObj_get_FLAGS(sub) & SUB_FLAG_IS_OUTER)
+        return;
+
+    Parrot_pcc_free_registers(interp, callee);
+
+    c->registers                = NULL;
+    c->n_regs_used[REGNO_INT]   = 0;
+    c->n_regs_used[REGNO_NUM]   = 0;
+    c->n_regs_used[REGNO_STR]   = 0;
+    c->n_regs_used[REGNO_PMC]   = 0;
+}
+
+
 /*
 
 =item C<PMC * Parrot_alloc_context(PARROT_INTERP, const UINTVAL
@@ -886,7 +931,11 @@ Parrot_pcc_reuse_continuation(PARROT_INTERP, ARGIN(PMC *call_context), ARGIN_NUL
     }
 
     if (!reuse) {
+        /* A return continuation alone doesn't let the caller escape */
+        const UINTVAL escaped = CALLSIGNATURE_is_escaped_TEST(call_context);
         c->continuation = Parrot_pmc_new(interp, enum_class_Continuation);
+        if (!escaped)
+            CALLSIGNATURE_is_escaped_CLEAR(call_context);
     }
 
     VTABLE_set_pointer(interp, c->continuation, next);
@@ -938,7 +987,26 @@ Parrot_pcc_unproxy_context(PARROT_INTERP, ARGIN(PMC * proxy))
     ctx->caller_ctx = PMCNULL;      /* TODO: Double-check this */
     ctx->outer_ctx = PMCNULL;
     ctx->lex_pad = Parrot_thread_create_proxy(target_interp, interp, target_ctx->lex_pad);
-    ctx->handlers = Parrot_thread_create_proxy(target_interp, interp, target_ctx->handlers);
+
+    /* the labels pushed in the target that are no handler PMCs yet become
+     * PMCs here, so they go to a list of our own */
+    mem_copy_n_typed(ctx->pending_handlers, target_ctx->pending_handlers,
+            PARROT_PENDING_HANDLERS, Parrot_pending_handler);
+    ctx->num_pending_handlers = target_ctx->num_pending_handlers;
+
+    if (ctx->num_pending_handlers && !PMC_IS_NULL(target_ctx->handlers)) {
+        const INTVAL n = VTABLE_elements(target_interp, target_ctx->handlers);
+        INTVAL       i;
+
+        ctx->handlers = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+        for (i = 0; i < n; ++i)
+            VTABLE_push_pmc(interp, ctx->handlers,
+                Parrot_thread_create_proxy(target_interp, interp,
+                    VTABLE_get_pmc_keyed_int(target_interp, target_ctx->handlers, i)));
+    }
+    else
+        ctx->handlers = Parrot_thread_create_proxy(target_interp, interp, target_ctx->handlers);
+
     ctx->current_cont = PMCNULL;
     ctx->current_namespace = PMCNULL;
     ctx->current_sig = PMCNULL;
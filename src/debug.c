@@ -63,6 +63,12 @@ typedef struct DebuggerCmdList DebuggerCmdList;
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC * capture_backtrace(PARROT_INTERP, ARGIN(PMC *ctx))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
 static void chop_newline(ARGMOD(char * buf))
         __attribute__nonnull__(1)
         FUNC_MODIFIES(* buf);
@@ -179,6 +185,12 @@ static void display_breakpoint(
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static STRING * format_backtrace(PARROT_INTERP, ARGIN(PMC *bt))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
 PARROT_WARN_UNUSED_RESULT
 PARROT_CANNOT_RETURN_NULL
 PARROT_OBSERVER
@@ -238,6 +250,9 @@ PARROT_PURE_FUNCTION
 static const char * skip_whitespace(ARGIN(const char *cmd))
         __attribute__nonnull__(1);
 
+#define ASSERT_ARGS_capture_backtrace __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(ctx))
 #define ASSERT_ARGS_chop_newline __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(buf))
 #define ASSERT_ARGS_close_script_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -320,6 +335,9 @@ static const char * skip_whitespace(ARGIN(const char *cmd))
 #define ASSERT_ARGS_display_breakpoint __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(pdb) \
     , PARROT_ASSERT_ARG(breakpoint))
+#define ASSERT_ARGS_format_backtrace __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(bt))
 #define ASSERT_ARGS_GDB_P __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(s))
@@ -3588,6 +3606,61 @@ Parrot_dbg_get_exception_backtrace(PARROT_INTERP, ARGMOD(PMC * exception))
 
 /*
 
+=item C<PMC * Parrot_dbg_capture_exception_backtrace(PARROT_INTERP, PMC *
+exception)>
+
+Records the call chain of the given exception without formatting it, for
+C<Parrot_dbg_format_backtrace> to turn into a string if anybody ever asks.
+Returns PMCNULL if the exception has no context to start from.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+PMC *
+Parrot_dbg_capture_exception_backtrace(PARROT_INTERP, ARGMOD(PMC * exception))
+{
+    ASSERT_ARGS(Parrot_dbg_capture_exception_backtrace)
+
+    PMC * const ctx = get_exception_context(interp, exception);
+
+    if (PMC_IS_NULL(ctx))
+        return PMCNULL;
+    else
+        return capture_backtrace(interp, ctx);
+}
+
+/*
+
+=item C<STRING * Parrot_dbg_format_backtrace(PARROT_INTERP, PMC *bt)>
+
+Formats a backtrace recorded by C<Parrot_dbg_capture_exception_backtrace>.
+Anything else, such as a String stored by user code, is simply stringified.
+A missing backtrace gives a NULL STRING.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+STRING *
+Parrot_dbg_format_backtrace(PARROT_INTERP, ARGIN_NULLOK(PMC *bt))
+{
+    ASSERT_ARGS(Parrot_dbg_format_backtrace)
+
+    if (PMC_IS_NULL(bt))
+        return STRINGNULL;
+    else if (bt->vtable->base_type == enum_class_FixedPMCArray)
+        return format_backtrace(interp, bt);
+    else
+        return VTABLE_get_string(interp, bt);
+}
+
+/*
+
 =item C<static PMC * get_exception_context(PARROT_INTERP, PMC * exception)>
 
 Returns the context in which the exception was generated.
@@ -3652,15 +3725,77 @@ static STRING *
 PDB_get_continuation_backtrace(PARROT_INTERP, ARGIN(PMC *ctx))
 {
     ASSERT_ARGS(PDB_get_continuation_backtrace)
-    PMC * const output = Parrot_pmc_new(interp, enum_class_StringBuilder);
-    UINTVAL rec_level  = 0;
+    return format_backtrace(interp, capture_backtrace(interp, ctx));
+}
+
+/*
+
+=item C<static PMC * capture_backtrace(PARROT_INTERP, PMC *ctx)>
+
+Records the call chain starting at C<ctx> as a pair of arrays: the contexts,
+and the pc each of them had reached.  Frames still running will carry on from
+there, so their pcs are copied now; nothing else is looked up until the
+backtrace is formatted.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC *
+capture_backtrace(PARROT_INTERP, ARGIN(PMC *ctx))
+{
+    ASSERT_ARGS(capture_backtrace)
+    PMC * const bt     = Parrot_pmc_new_init_int(interp, enum_class_FixedPMCArray, 2);
+    PMC * const frames = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    PMC * const pcs    = Parrot_pmc_new(interp, enum_class_ResizableIntegerArray);
     UINTVAL loop_count = 0;
-    PMC    *prev_ctx   = PMCNULL;
-    int     is_top     = 1;
 
-    /* backtrace: follow the continuation chain */
-    while (ctx && (loop_count < RECURSION_LIMIT)) {
-        STRING * const info_str = Parrot_sub_Context_infostr(interp, ctx, is_top);
+    VTABLE_set_pmc_keyed_int(interp, bt, 0, frames);
+    VTABLE_set_pmc_keyed_int(interp, bt, 1, pcs);
+
+    while (!PMC_IS_NULL(ctx) && (loop_count < RECURSION_LIMIT)) {
+        VTABLE_push_pmc(interp, frames, ctx);
+        VTABLE_push_integer(interp, pcs, PTR2INTVAL(Parrot_pcc_get_pc(interp, ctx)));
+        ++loop_count;
+        ctx = Parrot_pcc_get_caller_ctx(interp, ctx);
+    }
+
+    return bt;
+}
+
+/*
+
+=item C<static STRING * format_backtrace(PARROT_INTERP, PMC *bt)>
+
+Formats a call chain recorded by C<capture_backtrace>, looking up sub names,
+source lines and annotations for each frame.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static STRING *
+format_backtrace(PARROT_INTERP, ARGIN(PMC *bt))
+{
+    ASSERT_ARGS(format_backtrace)
+    PMC * const output = Parrot_pmc_new(interp, enum_class_StringBuilder);
+    PMC * const frames = VTABLE_get_pmc_keyed_int(interp, bt, 0);
+    PMC * const pcs    = VTABLE_get_pmc_keyed_int(interp, bt, 1);
+    const INTVAL depth = VTABLE_elements(interp, frames);
+    UINTVAL   rec_level = 0;
+    PMC      *prev_ctx  = PMCNULL;
+    opcode_t *prev_pc   = NULL;
+    INTVAL    i;
+
+    for (i = 0; i < depth; ++i) {
+        PMC * const ctx = VTABLE_get_pmc_keyed_int(interp, frames, i);
+        opcode_t * const pc =
+            INTVAL2PTR(opcode_t *, VTABLE_get_integer_keyed_int(interp, pcs, i));
+        STRING * const info_str = Parrot_sub_Context_infostr_at(interp, ctx, pc, i == 0);
         if (!info_str)
             break;
 
@@ -3669,7 +3804,7 @@ PDB_get_continuation_backtrace(PARROT_INTERP, ARGIN(PMC *ctx))
             ++rec_level;
         }
         else if (!PMC_IS_NULL(prev_ctx)
-        &&       Parrot_pcc_get_pc(interp,  ctx) == Parrot_pcc_get_pc(interp,  prev_ctx)
+        &&       pc == prev_pc
         &&       Parrot_pcc_get_sub(interp, ctx) == Parrot_pcc_get_sub(interp, prev_ctx)) {
             ++rec_level;
         }
@@ -3687,8 +3822,7 @@ PDB_get_continuation_backtrace(PARROT_INTERP, ARGIN(PMC *ctx))
             VTABLE_push_string(interp, output, info_str);
             if (seg->annotations) {
                 PMC * const annot = PackFile_Annotations_lookup(interp, seg->annotations,
-                        Parrot_pcc_get_pc(interp, ctx) - seg->base.data,
-                        NULL);
+                        pc - seg->base.data, NULL);
 
                 if (!PMC_IS_NULL(annot)) {
                     PMC * const pfile = VTABLE_get_pmc_keyed_str(interp, annot,
@@ -3706,10 +3840,8 @@ PDB_get_continuation_backtrace(PARROT_INTERP, ARGIN(PMC *ctx))
             }
             VTABLE_push_string(interp, output, CONST_STRING(interp, "\n"));
         }
-        ++loop_count;
-        is_top   = 0;
         prev_ctx = ctx;
-        ctx      = Parrot_pcc_get_caller_ctx(interp, ctx);
+        prev_pc  = pc;
     }
 
     if (rec_level != 0) {
@@ -187,8 +187,10 @@ Parrot_api_set_runcore(Parrot_PMC interp_pmc, ARGIN(const char * corename),
     else {
         if (STREQ(corename, "slow") || STREQ(corename, "bounds"))
             Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "slow"));
-        else if (STREQ(corename, "fast") || STREQ(corename, "jit") || STREQ(corename, "function"))
+        else if (STREQ(corename, "fast") || STREQ(corename, "function"))
             Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "fast"));
+        else if (STREQ(corename, "jit"))
+            Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "jit"));
         else if (STREQ(corename, "subprof_sub"))
             Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "subprof_sub"));
         else if (STREQ(corename, "subprof_hll") || STREQ(corename, "subprof"))
@@ -201,6 +203,8 @@ Parrot_api_set_runcore(Parrot_PMC interp_pmc, ARGIN(const char * corename),
             Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "slow"));
         else if (STREQ(corename, "profiling"))
             Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "profiling"));
+        else if (STREQ(corename, "sampling"))
+            Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "sampling"));
         else if (STREQ(corename, "gcdebug"))
             Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "gcdebug"));
         else
@@ -486,6 +490,30 @@ Parrot_api_get_runtime_path(Parrot_PMC interp_pmc,
 
 /*
 
+=item C<Parrot_Int Parrot_api_get_metrics(Parrot_PMC interp_pmc, Parrot_PMC
+*metrics)>
+
+Stores in C<metrics> a Hash with a snapshot of the C<interp_pmc>'s VM
+counters and histograms, as returned by the C<metrics> method of
+C<ParrotInterpreter>. This function returns a true value if this call is
+successful and false value otherwise.
+
+=cut
+
+*/
+
+PARROT_API
+Parrot_Int
+Parrot_api_get_metrics(Parrot_PMC interp_pmc, ARGOUT(Parrot_PMC *metrics))
+{
+    ASSERT_ARGS(Parrot_api_get_metrics)
+    EMBED_API_CALLIN(interp_pmc, interp)
+    *metrics = Parrot_metrics_snapshot(interp, interp);
+    EMBED_API_CALLOUT(interp_pmc, interp);
+}
+
+/*
+
 =item C<Parrot_Int Parrot_api_set_configuration_hash(Parrot_PMC interp_pmc,
 Parrot_PMC confighash)>
 
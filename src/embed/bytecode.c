@@ -242,6 +242,56 @@ Parrot_api_write_bytecode_to_file(Parrot_PMC interp_pmc, Parrot_PMC pbc,
 
 /*
 
+=item C<Parrot_Int Parrot_api_write_snapshot(Parrot_PMC interp_pmc, Parrot_PMC
+pbc, Parrot_String filename)>
+
+Run the C<:init> subs of the bytecode C<pbc> and write a snapshot of the
+interpreter to the file C<filename>, from which
+C<Parrot_api_load_snapshot_file> can start the program without running them
+again. This function returns a true value if this call is successful and false
+value otherwise.
+
+=cut
+
+*/
+
+PARROT_API
+Parrot_Int
+Parrot_api_write_snapshot(Parrot_PMC interp_pmc, ARGIN(Parrot_PMC pbc),
+        ARGIN(Parrot_String filename))
+{
+    ASSERT_ARGS(Parrot_api_write_snapshot)
+    EMBED_API_CALLIN(interp_pmc, interp)
+    Parrot_pf_write_snapshot(interp, pbc, filename);
+    EMBED_API_CALLOUT(interp_pmc, interp)
+}
+
+/*
+
+=item C<Parrot_Int Parrot_api_load_snapshot_file(Parrot_PMC interp_pmc,
+Parrot_String filename, Parrot_PMC * pbc)>
+
+Restore the snapshot in the file C<filename> into a new interpreter and store
+its program in C<pbc>, ready for C<Parrot_api_run_bytecode>. This function
+returns a true value if this call is successful and false value otherwise.
+
+=cut
+
+*/
+
+PARROT_API
+Parrot_Int
+Parrot_api_load_snapshot_file(Parrot_PMC interp_pmc,
+        ARGIN(Parrot_String filename), ARGOUT(Parrot_PMC * pbc))
+{
+    ASSERT_ARGS(Parrot_api_load_snapshot_file)
+    EMBED_API_CALLIN(interp_pmc, interp)
+    *pbc = Parrot_pf_read_snapshot(interp, filename, PMCNULL);
+    EMBED_API_CALLOUT(interp_pmc, interp)
+}
+
+/*
+
 =back
 
 =cut
@@ -24,6 +24,7 @@ to the appropriate handler asynchronously.
 #include "events.str"
 #include "pmc/pmc_arrayiterator.h"
 #include "pmc/pmc_exception.h"
+#include "pmc/pmc_continuation.h"
 
 
 /* HEADERIZER HFILE: include/parrot/events.h */
@@ -45,6 +46,7 @@ void
 Parrot_cx_add_handler_local(PARROT_INTERP, ARGIN(PMC *handler))
 {
     ASSERT_ARGS(Parrot_cx_add_handler_local)
+    Parrot_cx_realize_handlers_local(interp, interp->ctx);
     if (PMC_IS_NULL(Parrot_pcc_get_handlers(interp, interp->ctx)))
         Parrot_pcc_set_handlers(interp, interp->ctx,
                                 Parrot_pmc_new(interp, enum_class_ResizablePMCArray));
@@ -55,6 +57,94 @@ Parrot_cx_add_handler_local(PARROT_INTERP, ARGIN(PMC *handler))
 
 /*
 
+=item C<void Parrot_cx_add_label_handler_local(PARROT_INTERP, opcode_t
+*address)>
+
+Add a handler for all exceptions, continuing at C<address>, to the current
+context's list of handlers.  This is what C<push_eh LABEL> does, and it
+allocates nothing: the label is only recorded in the context.  It is turned
+into an ExceptionHandler PMC by C<Parrot_cx_realize_handlers_local> when a
+handler search or some other user of the list needs it, which for the usual
+protected region that is left without an exception is never.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_cx_add_label_handler_local(PARROT_INTERP, ARGIN(opcode_t *address))
+{
+    ASSERT_ARGS(Parrot_cx_add_label_handler_local)
+    Parrot_Context * const ctx = CONTEXT_STRUCT(interp->ctx);
+    Parrot_pending_handler *pending;
+
+    if (ctx->num_pending_handlers == PARROT_PENDING_HANDLERS)
+        Parrot_cx_realize_handlers_local(interp, interp->ctx);
+
+    pending             = &ctx->pending_handlers[ctx->num_pending_handlers++];
+    pending->address    = address;
+    pending->seg        = interp->code;
+    pending->runloop_id = interp->current_runloop_id;
+
+    /* the frame can be resumed through the handler after it returned, as
+     * it could through an ExceptionHandler PMC */
+    CALLSIGNATURE_is_escaped_SET(interp->ctx);
+}
+
+/*
+
+=item C<void Parrot_cx_realize_handlers_local(PARROT_INTERP, PMC *ctx)>
+
+Create ExceptionHandler PMCs for the labels recorded in C<ctx> by
+C<Parrot_cx_add_label_handler_local>, and put them at the front of its list
+of handlers.  The recorded labels are always newer than the handler PMCs
+already in the list.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_cx_realize_handlers_local(PARROT_INTERP, ARGIN(PMC *ctx))
+{
+    ASSERT_ARGS(Parrot_cx_realize_handlers_local)
+    Parrot_Context * const c = CONTEXT_STRUCT(ctx);
+    PMC    *handlers;
+    UINTVAL i;
+
+    if (!c->num_pending_handlers)
+        return;
+
+    handlers = Parrot_pcc_get_handlers(interp, ctx);
+    if (PMC_IS_NULL(handlers)) {
+        handlers = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+        Parrot_pcc_set_handlers(interp, ctx, handlers);
+    }
+
+    /* oldest first, so that the newest ends up at the front */
+    for (i = 0; i < c->num_pending_handlers; ++i) {
+        const Parrot_pending_handler * const pending = &c->pending_handlers[i];
+        PMC * const eh = Parrot_pmc_new(interp, enum_class_ExceptionHandler);
+        Parrot_Continuation_attributes * const cont = PARROT_CONTINUATION(eh);
+
+        /* make it look as if it had been created by ctx itself */
+        cont->to_ctx         = ctx;
+        cont->from_ctx       = ctx;
+        cont->to_call_object = Parrot_pcc_get_signature(interp, ctx);
+        cont->seg            = pending->seg;
+        cont->address        = pending->address;
+        cont->runloop_id     = pending->runloop_id;
+
+        VTABLE_unshift_pmc(interp, handlers, eh);
+    }
+
+    c->num_pending_handlers = 0;
+}
+
+/*
+
 =item C<void Parrot_cx_delete_handler_local(PARROT_INTERP)>
 
 Remove the top task handler from the context's list of handlers.
@@ -68,8 +158,16 @@ void
 Parrot_cx_delete_handler_local(PARROT_INTERP)
 {
     ASSERT_ARGS(Parrot_cx_delete_handler_local)
-    PMC *handlers  = Parrot_pcc_get_handlers(interp, interp->ctx);
+    Parrot_Context * const ctx = CONTEXT_STRUCT(interp->ctx);
+    PMC *handlers;
 
+    /* the newest handler may never have been more than a label */
+    if (ctx->num_pending_handlers) {
+        --ctx->num_pending_handlers;
+        return;
+    }
+
+    handlers = Parrot_pcc_get_handlers(interp, interp->ctx);
     if (PMC_IS_NULL(handlers))
         Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
             "No handler to delete.");
@@ -101,6 +199,10 @@ Parrot_cx_delete_upto_handler_local(PARROT_INTERP, ARGIN(PMC *handler))
 {
     ASSERT_ARGS(Parrot_cx_delete_upto_handler_local)
     PMC *handlers  = Parrot_pcc_get_handlers(interp, interp->ctx);
+
+    /* handlers still waiting as labels are newer than any handler PMC */
+    CONTEXT_STRUCT(interp->ctx)->num_pending_handlers = 0;
+
     if (!PMC_IS_NULL(handlers)) {
         while (VTABLE_elements(interp, handlers)) {
             PMC * const cand = VTABLE_get_pmc_keyed_int(interp, handlers, 0);
@@ -130,11 +232,12 @@ Parrot_cx_count_handlers_local(PARROT_INTERP)
 {
     ASSERT_ARGS(Parrot_cx_count_handlers_local)
     PMC * const handlers = Parrot_pcc_get_handlers(interp, interp->ctx);
+    const INTVAL pending = CONTEXT_STRUCT(interp->ctx)->num_pending_handlers;
 
     if (PMC_IS_NULL(handlers))
-        return 0;
+        return pending;
 
-    return VTABLE_elements(interp, handlers);
+    return pending + VTABLE_elements(interp, handlers);
 }
 
 
@@ -306,6 +409,7 @@ Parrot_cx_find_handler_local(PARROT_INTERP, ARGIN(PMC *task))
         context = Parrot_pcc_get_caller_ctx(interp, keep_context);
         keep_context = NULL;
         if (context) {
+            Parrot_cx_realize_handlers_local(interp, context);
             handlers = Parrot_pcc_get_handlers(interp, context);
             elements = !PMC_IS_NULL(handlers) ? VTABLE_elements(interp, handlers) : 0;
             pos = 0;
@@ -325,6 +429,7 @@ Parrot_cx_find_handler_local(PARROT_INTERP, ARGIN(PMC *task))
         }
         if (handled == -1) {
             context = (PMC *)VTABLE_get_pointer(interp, task);
+            Parrot_cx_realize_handlers_local(interp, context);
             handlers = Parrot_pcc_get_handlers(interp, context);
             elements = !PMC_IS_NULL(handlers) ? VTABLE_elements(interp, handlers) : 0;
             if (task->vtable->base_type == enum_class_Exception)
@@ -339,6 +444,7 @@ Parrot_cx_find_handler_local(PARROT_INTERP, ARGIN(PMC *task))
         }
         else {
             context = CURRENT_CONTEXT(interp);
+            Parrot_cx_realize_handlers_local(interp, context);
             handlers = Parrot_pcc_get_handlers(interp, context);
             elements = !PMC_IS_NULL(handlers) ? VTABLE_elements(interp, handlers) : 0;
             pos = 0;
@@ -380,6 +486,7 @@ Parrot_cx_find_handler_local(PARROT_INTERP, ARGIN(PMC *task))
         /* Continue the search in the next context up the chain. */
         context = Parrot_pcc_get_caller_ctx(interp, context);
         if (context) {
+            Parrot_cx_realize_handlers_local(interp, context);
             handlers = Parrot_pcc_get_handlers(interp, context);
             elements = !PMC_IS_NULL(handlers) ? VTABLE_elements(interp, handlers) : 0;
             pos = 0;
@@ -661,6 +661,9 @@ Parrot_print_backtrace(void)
 
 Update an exception PMC so that it can be rethrown.
 
+The backtrace of the previous throw is only recorded here, not formatted:
+rethrown exceptions are usually caught again without anybody looking at it.
+
 =cut
 
 */
@@ -669,15 +672,15 @@ static void
 Parrot_ex_update_for_rethrow(PARROT_INTERP, ARGMOD(PMC * ex))
 {
     ASSERT_ARGS(Parrot_ex_update_for_rethrow)
-    STRING * const bt_strings_str = CONST_STRING(interp, "bt_strings");
-    PMC * bt_strings = VTABLE_get_attr_str(interp, ex, bt_strings_str);
-    STRING * const prev_backtrace = Parrot_dbg_get_exception_backtrace(interp, ex);
+    STRING * const bt_records_str = CONST_STRING(interp, "bt_records");
+    PMC * bt_records = VTABLE_get_attr_str(interp, ex, bt_records_str);
+    PMC * const prev_backtrace = Parrot_dbg_capture_exception_backtrace(interp, ex);
 
-    if (PMC_IS_NULL(bt_strings)) {
-        bt_strings = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
-        VTABLE_set_attr_str(interp, ex, bt_strings_str, bt_strings);
+    if (PMC_IS_NULL(bt_records)) {
+        bt_records = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+        VTABLE_set_attr_str(interp, ex, bt_records_str, bt_records);
     }
-    VTABLE_push_string(interp, bt_strings, prev_backtrace);
+    VTABLE_push_pmc(interp, bt_records, prev_backtrace);
 
     Parrot_ex_mark_unhandled(interp, ex);
 }
@@ -700,7 +703,7 @@ Parrot_ex_build_complete_backtrace_string(PARROT_INTERP, ARGIN(PMC * ex))
 {
     ASSERT_ARGS(Parrot_ex_build_complete_backtrace_string)
     STRING * const cur_bt = Parrot_dbg_get_exception_backtrace(interp, ex);
-    PMC * const all_bt = VTABLE_get_attr_str(interp, ex, CONST_STRING(interp, "bt_strings"));
+    PMC * const all_bt = VTABLE_get_attr_str(interp, ex, CONST_STRING(interp, "bt_records"));
     INTVAL elems, i;
     PMC * builder;
     if (PMC_IS_NULL(all_bt))
@@ -710,7 +713,8 @@ Parrot_ex_build_complete_backtrace_string(PARROT_INTERP, ARGIN(PMC * ex))
     builder = Parrot_pmc_new(interp, enum_class_StringBuilder);
     VTABLE_push_string(interp, builder, cur_bt);
     for (i = elems - 1; i >= 0; i--) {
-        STRING * const i_bt = VTABLE_get_string_keyed_int(interp, all_bt, i);
+        STRING * const i_bt = Parrot_dbg_format_backtrace(interp,
+                                    VTABLE_get_pmc_keyed_int(interp, all_bt, i));
         if (STRING_IS_NULL(i_bt))
             continue;
         VTABLE_push_string(interp, builder, CONST_STRING(interp, "\nthrown from:\n"));
@@ -322,6 +322,7 @@ Parrot_gc_new_pmc_header(PARROT_INTERP, UINTVAL flags)
 #ifdef THREAD_DEBUG
     pmc->orig_interp    = interp;
 #endif
+    PARROT_METRIC_INC(interp, METRIC_PMC_ALLOCS);
 
     return pmc;
 }
@@ -373,6 +374,7 @@ Parrot_gc_new_string_header(PARROT_INTERP, UINTVAL flags)
     string->strstart        = NULL;
     PObj_get_FLAGS(string) |=
         flags | PObj_is_string_FLAG | PObj_is_COWable_FLAG;
+    PARROT_METRIC_INC(interp, METRIC_STRING_ALLOCS);
 
     return string;
 }
@@ -780,6 +780,7 @@ gc_gms_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
     ASSERT_ARGS(gc_gms_mark_and_sweep)
     MarkSweep_GC * const self = (MarkSweep_GC *)interp->gc_sys->gc_private;
     int gen = -1;
+    UHUGEINTVAL started;
 
     if (interp->thread_data)
         LOCK(interp->thread_data->interp_lock);
@@ -801,6 +802,8 @@ gc_gms_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
     self->work_list = Parrot_pa_new(interp);
 
     interp->gc_sys->stats.gc_mark_runs++;
+    PARROT_METRIC_INC(interp, METRIC_GC_RUNS);
+    started = Parrot_hires_get_time();
 
     gc_gms_print_stats(interp, "Before");
 
@@ -878,6 +881,8 @@ gc_gms_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
     Parrot_pa_destroy(interp, self->work_list);
     self->work_list = NULL;
 
+    Parrot_metrics_observe(interp, METRIC_GC_PAUSE_NS, Parrot_hires_get_time() - started);
+
     gc_gms_validate_objects(interp);
 
 DONE:
@@ -1085,6 +1090,8 @@ gc_gms_sweep_pools(PARROT_INTERP, ARGMOD(MarkSweep_GC *self))
     for (i = self->gen_to_collect; i >= 0; i--) {
         /* Don't move to generation beyond last */
         const int move_to_old = (i + 1) != MAX_GENERATIONS;
+        UINTVAL   survived    = 0;
+        UINTVAL   freed       = 0;
 
         POINTER_ARRAY_ITER(self->objects[i],
             pmc_alloc_struct * const item = (pmc_alloc_struct *)ptr;
@@ -1096,6 +1103,7 @@ gc_gms_sweep_pools(PARROT_INTERP, ARGMOD(MarkSweep_GC *self))
             /* Paint live objects white */
             if (PObj_live_TEST(pmc) || PObj_constant_TEST(pmc)) {
                 PObj_live_CLEAR(pmc);
+                ++survived;
 
                 if (move_to_old) {
                     SET_GEN_FLAGS(pmc, i + 1);
@@ -1115,6 +1123,7 @@ gc_gms_sweep_pools(PARROT_INTERP, ARGMOD(MarkSweep_GC *self))
             }
             else {
                 Parrot_pa_remove(interp, self->objects[i], item->ptr);
+                ++freed;
 
                 interp->gc_sys->stats.memory_used -= sizeof (PMC);
 
@@ -1141,6 +1150,7 @@ gc_gms_sweep_pools(PARROT_INTERP, ARGMOD(MarkSweep_GC *self))
             /* Paint live objects white */
             if (PObj_live_TEST(str) || PObj_constant_TEST(str)) {
                 PObj_live_CLEAR(str);
+                ++survived;
                 if (move_to_old) {
                     Parrot_pa_remove(interp, self->strings[i], item->ptr);
                     item->ptr = Parrot_pa_insert(self->strings[i + 1], item);
@@ -1150,6 +1160,7 @@ gc_gms_sweep_pools(PARROT_INTERP, ARGMOD(MarkSweep_GC *self))
 
             else {
                 Parrot_pa_remove(interp, self->strings[i], item->ptr);
+                ++freed;
                 if (Buffer_bufstart(str) && !PObj_external_TEST(str))
                     Parrot_gc_str_free_buffer_storage(
                         interp, &self->string_gc, (Parrot_Buffer*)str);
@@ -1160,6 +1171,9 @@ gc_gms_sweep_pools(PARROT_INTERP, ARGMOD(MarkSweep_GC *self))
 
                 Parrot_gc_pool_free(interp, self->string_allocator, ptr);
             });
+
+        PARROT_METRIC_ADD(interp, METRIC_GC_SURVIVED_GEN0 + i, survived);
+        PARROT_METRIC_ADD(interp, METRIC_GC_FREED_GEN0 + i, freed);
     }
 
 }
@@ -589,6 +589,7 @@ gc_ms_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
     ASSERT_ARGS(gc_ms_mark_and_sweep)
     Memory_Pools * const mem_pools = (Memory_Pools *)interp->gc_sys->gc_private;
     int total_free = 0;
+    UHUGEINTVAL started;
 
     if (mem_pools->gc_mark_block_level)
         return;
@@ -606,6 +607,7 @@ gc_ms_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
 
     ++mem_pools->gc_mark_block_level;
     mem_pools->lazy_gc = flags & GC_lazy_FLAG;
+    started = Parrot_hires_get_time();
 
     /* tell the threading system that we're doing GC mark */
     Parrot_gc_run_init(interp, mem_pools);
@@ -635,6 +637,9 @@ gc_ms_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
 
     /* Note it */
     ++interp->gc_sys->stats.gc_mark_runs;
+    PARROT_METRIC_INC(interp, METRIC_GC_RUNS);
+    PARROT_METRIC_ADD(interp, METRIC_GC_FREED_GEN0, total_free);
+    Parrot_metrics_observe(interp, METRIC_GC_PAUSE_NS, Parrot_hires_get_time() - started);
 
     --mem_pools->gc_mark_block_level;
     interp->gc_sys->stats.mem_used_last_collect = interp->gc_sys->stats.memory_used;
@@ -1044,6 +1044,7 @@ gc_ms2_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
     MarkSweep_GC * const self = (MarkSweep_GC *)interp->gc_sys->gc_private;
     GC_Statistics       *stats;
     size_t               threshold;
+    UHUGEINTVAL          started;
 
     /* GC is blocked */
     if (self->gc_mark_block_level)
@@ -1054,6 +1055,7 @@ gc_ms2_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
         return;
 
     ++self->gc_mark_block_level;
+    started = Parrot_hires_get_time();
     gc_ms2_mark_live_objects(interp, self, flags);
 
     /* At this point of time new_objects contains only live PMCs */
@@ -1094,6 +1096,9 @@ gc_ms2_mark_and_sweep(PARROT_INTERP, UINTVAL flags)
 
     self->gc_threshold = stats->mem_used_last_collect + threshold;
 
+    PARROT_METRIC_INC(interp, METRIC_GC_RUNS);
+    Parrot_metrics_observe(interp, METRIC_GC_PAUSE_NS, Parrot_hires_get_time() - started);
+
     self->gc_mark_block_level--;
     self->num_early_gc_PMCs = 0;
 }
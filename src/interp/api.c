@@ -21,6 +21,7 @@ Functions related to managing the Parrot interpreter
 #include "parrot/runcore_api.h"
 #include "parrot/oplib/core_ops.h"
 #include "pmc/pmc_callcontext.h"
+#include "pmc/pmc_continuation.h"
 #include "../gc/gc_private.h"
 #include "api.str"
 #include "pmc/pmc_parrotinterpreter.h"
@@ -225,7 +226,8 @@ Parrot_interp_allocate_interpreter(ARGIN_NULLOK(Interp *parent), INTVAL flags)
     interp->current_runloop_id    = 0;
     interp->current_runloop_level = 0;
 
-    interp->gc_sys = mem_internal_allocate_zeroed_typed(GC_Subsystem);
+    interp->gc_sys  = mem_internal_allocate_zeroed_typed(GC_Subsystem);
+    interp->metrics = Parrot_metrics_new();
 
     /* Done. Return and be done with it */
     return interp;
@@ -286,7 +288,6 @@ Parrot_interp_initialize_interpreter(PARROT_INTERP, ARGIN(Parrot_GC_Init_Args *a
 
     /* Set up MMD; MMD cache for builtins. */
     interp->op_mmd_cache = Parrot_mmd_cache_create(interp);
-    Parrot_pmc_gc_register(interp, interp->op_mmd_cache);
 
     Parrot_gbl_init_world_once(interp);
 
@@ -319,6 +320,8 @@ Parrot_interp_initialize_interpreter(PARROT_INTERP, ARGIN(Parrot_GC_Init_Args *a
     Parrot_runcore_init(interp);
 
     /* Load the core op func and info tables */
+    if (!interp->parent_interpreter)
+        Parrot_pf_init_op_tables_cache();
     interp->all_op_libs         = NULL;
     interp->evc_func_table      = NULL;
     interp->evc_func_table_size = 0;
@@ -474,6 +477,10 @@ Parrot_interp_really_destroy(PARROT_INTERP, SHIM(int exit_code), SHIM(void *arg)
     /* cache structure */
     destroy_object_cache(interp);
 
+    /* MMD cache for builtins */
+    Parrot_mmd_cache_destroy(interp, interp->op_mmd_cache);
+    interp->op_mmd_cache = NULL;
+
     if (interp->evc_func_table) {
         mem_gc_free(interp, interp->evc_func_table);
         interp->evc_func_table      = NULL;
@@ -495,6 +502,7 @@ Parrot_interp_really_destroy(PARROT_INTERP, SHIM(int exit_code), SHIM(void *arg)
 
         /* Finalize GC */
         Parrot_gc_finalize(interp);
+        Parrot_metrics_destroy(interp);
 
         mem_internal_free(interp);
     }
@@ -504,6 +512,7 @@ Parrot_interp_really_destroy(PARROT_INTERP, SHIM(int exit_code), SHIM(void *arg)
 
         /* Finalize GC */
         Parrot_gc_finalize(interp);
+        Parrot_metrics_destroy(interp);
         mem_internal_free(interp);
     }
 }
@@ -891,6 +900,12 @@ Parrot_interp_info_p(PARROT_INTERP, INTVAL what)
         break;
       case CURRENT_CONT:
         result = Parrot_pcc_get_continuation(interp, CURRENT_CONTEXT(interp));
+        if (!PMC_IS_NULL(result)) {
+            /* the caller's frame may be resumed after it returned */
+            PMC * const to_ctx = PARROT_CONTINUATION(result)->to_ctx;
+            if (!PMC_IS_NULL(to_ctx))
+                CALLSIGNATURE_is_escaped_SET(to_ctx);
+        }
         break;
       case CURRENT_LEXPAD:
         result = Parrot_pcc_get_lex_pad(interp, CURRENT_CONTEXT(interp));
@@ -1289,6 +1304,12 @@ Parrot_interp_set_run_core(PARROT_INTERP, Parrot_Run_core_t core)
       case PARROT_SUBPROF_OPS_CORE:
         Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "subprof_ops"));
         break;
+      case PARROT_SAMPLING_CORE:
+        Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "sampling"));
+        break;
+      case PARROT_JIT_CORE:
+        Parrot_runcore_switch(interp, Parrot_str_new_constant(interp, "jit"));
+        break;
       default:
         Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_UNIMPLEMENTED,
                 "Invalid runcore requested\n");
@@ -259,6 +259,8 @@ io_pipe_read_b(PARROT_INTERP, ARGMOD(PMC *handle), ARGOUT(char *buffer), size_t
     ASSERT_ARGS(io_pipe_read_b)
     const PIOHANDLE os_handle = io_filehandle_get_os_handle(interp, handle);
     const size_t bytes_read = Parrot_io_internal_read(interp, os_handle, buffer, byte_length);
+    PARROT_METRIC_INC(interp, METRIC_IO_READ_CALLS);
+    PARROT_METRIC_ADD(interp, METRIC_IO_BYTES_READ, bytes_read);
     if (bytes_read == 0) {
         INTVAL flags;
         GETATTR_FileHandle_flags(interp, handle, flags);
@@ -284,7 +286,11 @@ io_pipe_write_b(PARROT_INTERP, ARGMOD(PMC *handle), ARGIN(char *buffer), size_t
 {
     ASSERT_ARGS(io_pipe_write_b)
     const PIOHANDLE os_handle = io_filehandle_get_os_handle(interp, handle);
-    return Parrot_io_internal_write(interp, os_handle, buffer, byte_length);
+    const INTVAL    written   = Parrot_io_internal_write(interp, os_handle, buffer, byte_length);
+    PARROT_METRIC_INC(interp, METRIC_IO_WRITE_CALLS);
+    if (written > 0)
+        PARROT_METRIC_ADD(interp, METRIC_IO_BYTES_WRITTEN, written);
+    return written;
 }
 
 /*
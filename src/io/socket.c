@@ -262,8 +262,13 @@ io_socket_read_b(PARROT_INTERP, ARGMOD(PMC *handle), ARGOUT(char *buffer), size_
 {
     ASSERT_ARGS(io_socket_read_b)
     PIOHANDLE os_handle;
+    INTVAL    received;
     GETATTR_Socket_os_handle(interp, handle, os_handle);
-    return Parrot_io_internal_recv(interp, os_handle, buffer, byte_length);
+    received = Parrot_io_internal_recv(interp, os_handle, buffer, byte_length);
+    PARROT_METRIC_INC(interp, METRIC_IO_READ_CALLS);
+    if (received > 0)
+        PARROT_METRIC_ADD(interp, METRIC_IO_BYTES_READ, received);
+    return received;
 }
 
 /*
@@ -282,8 +287,13 @@ io_socket_write_b(PARROT_INTERP, ARGMOD(PMC *handle), ARGIN(char *buffer), size_
 {
     ASSERT_ARGS(io_socket_write_b)
     PIOHANDLE os_handle;
+    INTVAL    sent;
     GETATTR_Socket_os_handle(interp, handle, os_handle);
-    return Parrot_io_internal_send(interp, os_handle, buffer, byte_length);
+    sent = Parrot_io_internal_send(interp, os_handle, buffer, byte_length);
+    PARROT_METRIC_INC(interp, METRIC_IO_WRITE_CALLS);
+    if (sent > 0)
+        PARROT_METRIC_ADD(interp, METRIC_IO_BYTES_WRITTEN, sent);
+    return sent;
 }
 
 /*
@@ -0,0 +1,232 @@
+/*
+Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+src/metrics.c - Always-on VM metrics
+
+=head1 DESCRIPTION
+
+Every interpreter carries a small block of counters and histograms that the
+GC, the call machinery, the method cache, the scheduler and the IO layer
+update as they work.  Updating a counter is a single add, so they are always
+enabled; nothing needs a profiling runcore to be collected.
+
+Counters are bumped with the C<PARROT_METRIC_INC> and C<PARROT_METRIC_ADD>
+macros from F<include/parrot/metrics.h> and histograms are fed with
+C<Parrot_metrics_observe>.  C<Parrot_metrics_snapshot> copies the current
+values, together with the GC's own statistics, into a Hash which is available
+from PIR through the C<metrics> method of C<ParrotInterpreter> and to embedders
+through C<Parrot_api_get_metrics>.
+
+=head2 Functions
+
+=over 4
+
+=cut
+
+*/
+
+#include "parrot/parrot.h"
+#include "parrot/metrics.h"
+
+/* HEADERIZER HFILE: include/parrot/metrics.h */
+
+/* HEADERIZER BEGIN: static */
+/* HEADERIZER END: static */
+
+/* names of the counters, in Parrot_metric_counter order */
+static const char * const counter_names[METRIC_COUNTER_MAX] = {
+    "gc_runs",
+    "gc_survived_gen0",
+    "gc_survived_gen1",
+    "gc_survived_gen2",
+    "gc_survived_gen3",
+    "gc_freed_gen0",
+    "gc_freed_gen1",
+    "gc_freed_gen2",
+    "gc_freed_gen3",
+    "pmc_allocs",
+    "string_allocs",
+    "contexts_created",
+    "method_cache_hits",
+    "method_cache_misses",
+    "tasks_scheduled",
+    "io_read_calls",
+    "io_write_calls",
+    "io_bytes_read",
+    "io_bytes_written"
+};
+
+/* names of the histograms, in Parrot_metric_histogram order */
+static const char * const histogram_names[METRIC_HISTOGRAM_MAX] = {
+    "gc_pause_ns",
+    "task_queue_depth"
+};
+
+/*
+
+=item C<Parrot_Metrics * Parrot_metrics_new(void)>
+
+Allocate a zeroed metrics block, aligned to a cache line.
+
+=cut
+
+*/
+
+PARROT_MALLOC
+PARROT_CANNOT_RETURN_NULL
+Parrot_Metrics *
+Parrot_metrics_new(void)
+{
+    ASSERT_ARGS(Parrot_metrics_new)
+
+    char * const base = (char *)mem_internal_allocate_zeroed(
+                            sizeof (Parrot_Metrics) + PARROT_CACHE_LINE_SIZE);
+    const size_t skew = (size_t)base % PARROT_CACHE_LINE_SIZE;
+    Parrot_Metrics * const metrics = (Parrot_Metrics *)
+                            (base + (skew ? PARROT_CACHE_LINE_SIZE - skew : 0));
+
+    metrics->alloc_base = base;
+    return metrics;
+}
+
+/*
+
+=item C<void Parrot_metrics_destroy(PARROT_INTERP)>
+
+Free the interpreter's metrics block.
+
+=cut
+
+*/
+
+void
+Parrot_metrics_destroy(PARROT_INTERP)
+{
+    ASSERT_ARGS(Parrot_metrics_destroy)
+
+    if (interp->metrics) {
+        mem_internal_free(interp->metrics->alloc_base);
+        interp->metrics = NULL;
+    }
+}
+
+/*
+
+=item C<void Parrot_metrics_observe(PARROT_INTERP, Parrot_metric_histogram
+which, UHUGEINTVAL value)>
+
+Record C<value> in the histogram C<which>.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_metrics_observe(PARROT_INTERP, Parrot_metric_histogram which, UHUGEINTVAL value)
+{
+    ASSERT_ARGS(Parrot_metrics_observe)
+
+    Parrot_metric_hist * const hist = &interp->metrics->histograms[which];
+    UHUGEINTVAL                rest = value;
+    unsigned int               bucket = 0;
+
+    while (rest && bucket < PARROT_METRICS_HIST_BUCKETS - 1) {
+        rest >>= 1;
+        ++bucket;
+    }
+
+    ++hist->count;
+    hist->sum += value;
+    ++hist->buckets[bucket];
+}
+
+/*
+
+=item C<PMC * Parrot_metrics_snapshot(PARROT_INTERP, Interp *from)>
+
+Return a Hash holding the current metrics of C<from>, created in C<interp>.
+Each counter is stored under its name as an integer.  Each histogram is
+stored as a Hash with the keys C<count>, C<sum> and C<buckets>, the last
+being a FixedIntegerArray.  The GC's own statistics are included as
+C<gc_memory_allocated>, C<gc_memory_used>, C<gc_active_pmcs> and
+C<gc_active_buffers>.
+
+The values are read without synchronization, so a snapshot of a running
+interpreter in another thread may be slightly out of date.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_CANNOT_RETURN_NULL
+PMC *
+Parrot_metrics_snapshot(PARROT_INTERP, ARGIN(Interp *from))
+{
+    ASSERT_ARGS(Parrot_metrics_snapshot)
+
+    PMC * const snapshot = Parrot_pmc_new(interp, enum_class_Hash);
+    int i;
+
+    for (i = 0; i < METRIC_COUNTER_MAX; ++i)
+        VTABLE_set_integer_keyed_str(interp, snapshot,
+            Parrot_str_new_constant(interp, counter_names[i]),
+            (INTVAL)from->metrics->counters[i].value);
+
+    for (i = 0; i < METRIC_HISTOGRAM_MAX; ++i) {
+        const Parrot_metric_hist * const hist = &from->metrics->histograms[i];
+        PMC * const entry   = Parrot_pmc_new(interp, enum_class_Hash);
+        PMC * const buckets = Parrot_pmc_new_init_int(interp,
+                                enum_class_FixedIntegerArray, PARROT_METRICS_HIST_BUCKETS);
+        int b;
+
+        for (b = 0; b < PARROT_METRICS_HIST_BUCKETS; ++b)
+            VTABLE_set_integer_keyed_int(interp, buckets, b, (INTVAL)hist->buckets[b]);
+
+        VTABLE_set_integer_keyed_str(interp, entry,
+            Parrot_str_new_constant(interp, "count"), (INTVAL)hist->count);
+        VTABLE_set_integer_keyed_str(interp, entry,
+            Parrot_str_new_constant(interp, "sum"), (INTVAL)hist->sum);
+        VTABLE_set_pmc_keyed_str(interp, entry,
+            Parrot_str_new_constant(interp, "buckets"), buckets);
+        VTABLE_set_pmc_keyed_str(interp, snapshot,
+            Parrot_str_new_constant(interp, histogram_names[i]), entry);
+    }
+
+    VTABLE_set_integer_keyed_str(interp, snapshot,
+        Parrot_str_new_constant(interp, "gc_memory_allocated"),
+        (INTVAL)Parrot_gc_total_memory_allocated(from));
+    VTABLE_set_integer_keyed_str(interp, snapshot,
+        Parrot_str_new_constant(interp, "gc_memory_used"),
+        (INTVAL)Parrot_gc_total_memory_used(from));
+    VTABLE_set_integer_keyed_str(interp, snapshot,
+        Parrot_str_new_constant(interp, "gc_active_pmcs"),
+        (INTVAL)Parrot_gc_active_pmcs(from));
+    VTABLE_set_integer_keyed_str(interp, snapshot,
+        Parrot_str_new_constant(interp, "gc_active_buffers"),
+        (INTVAL)Parrot_gc_active_sized_buffers(from));
+
+    return snapshot;
+}
+
+/*
+
+=back
+
+=head1 SEE ALSO
+
+F<include/parrot/metrics.h>, F<src/pmc/parrotinterpreter.pmc>
+
+=cut
+
+*/
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
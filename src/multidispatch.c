@@ -81,23 +81,73 @@ static PMC* mmd_build_type_tuple_from_type_list(PARROT_INTERP,
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+static void mmd_cache_clear(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*cache);
+
 PARROT_WARN_UNUSED_RESULT
-PARROT_CAN_RETURN_NULL
-static STRING * mmd_cache_key_from_types(PARROT_INTERP,
-    ARGIN(const char *name),
-    ARGIN(PMC *types))
+PARROT_CANNOT_RETURN_NULL
+static MMD_Cache_entry * mmd_cache_find(
+    ARGIN(MMD_Cache *cache),
+    ARGIN_NULLOK(const char *name),
+    UINTVAL hash,
+    ARGIN(const INTVAL *type_ids),
+    INTVAL num_types)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(4);
+
+static void mmd_cache_grow(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
+        FUNC_MODIFIES(*cache);
+
+PARROT_PURE_FUNCTION
+PARROT_WARN_UNUSED_RESULT
+static UINTVAL mmd_cache_hash(
+    ARGIN_NULLOK(const char *name),
+    ARGIN(const INTVAL *type_ids),
+    INTVAL num_types)
+        __attribute__nonnull__(2);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC * mmd_cache_lookup(
+    ARGIN(MMD_Cache *cache),
+    ARGIN_NULLOK(const char *name),
+    ARGIN(const INTVAL *type_ids),
+    INTVAL num_types)
+        __attribute__nonnull__(1)
         __attribute__nonnull__(3);
 
+static void mmd_cache_store(PARROT_INTERP,
+    ARGMOD(MMD_Cache *cache),
+    ARGIN_NULLOK(const char *name),
+    ARGIN(const INTVAL *type_ids),
+    INTVAL num_types,
+    ARGIN_NULLOK(PMC *chosen))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(4)
+        FUNC_MODIFIES(*cache);
+
 PARROT_WARN_UNUSED_RESULT
-PARROT_CAN_RETURN_NULL
-static STRING * mmd_cache_key_from_values(PARROT_INTERP,
-    ARGIN(const char *name),
-    ARGIN(PMC *values))
+static INTVAL mmd_cache_types_from_tuple(PARROT_INTERP,
+    ARGIN(PMC *types),
+    ARGOUT(INTVAL *type_ids))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2)
-        __attribute__nonnull__(3);
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*type_ids);
+
+PARROT_WARN_UNUSED_RESULT
+static INTVAL mmd_cache_types_from_values(PARROT_INTERP,
+    ARGIN(PMC *values),
+    ARGOUT(INTVAL *type_ids))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*type_ids);
 
 PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
@@ -167,14 +217,32 @@ static PMC * Parrot_mmd_sort_candidates(PARROT_INTERP,
      __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(type_list))
-#define ASSERT_ARGS_mmd_cache_key_from_types __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+#define ASSERT_ARGS_mmd_cache_clear __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
-    , PARROT_ASSERT_ARG(name) \
-    , PARROT_ASSERT_ARG(types))
-#define ASSERT_ARGS_mmd_cache_key_from_values __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+    , PARROT_ASSERT_ARG(cache))
+#define ASSERT_ARGS_mmd_cache_find __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(cache) \
+    , PARROT_ASSERT_ARG(type_ids))
+#define ASSERT_ARGS_mmd_cache_grow __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
-    , PARROT_ASSERT_ARG(name) \
-    , PARROT_ASSERT_ARG(values))
+    , PARROT_ASSERT_ARG(cache))
+#define ASSERT_ARGS_mmd_cache_hash __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(type_ids))
+#define ASSERT_ARGS_mmd_cache_lookup __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(cache) \
+    , PARROT_ASSERT_ARG(type_ids))
+#define ASSERT_ARGS_mmd_cache_store __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(cache) \
+    , PARROT_ASSERT_ARG(type_ids))
+#define ASSERT_ARGS_mmd_cache_types_from_tuple __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(types) \
+    , PARROT_ASSERT_ARG(type_ids))
+#define ASSERT_ARGS_mmd_cache_types_from_values __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(values) \
+    , PARROT_ASSERT_ARG(type_ids))
 #define ASSERT_ARGS_mmd_cvt_to_types __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(multi_sig))
@@ -208,6 +276,9 @@ static PMC * Parrot_mmd_sort_candidates(PARROT_INTERP,
 
 #define MMD_DEBUG 0
 
+/* Number of slots of a fresh MMD cache; must be a power of 2 */
+#define MMD_CACHE_INITIAL_SIZE 16
+
 /*
 
 =item C<PMC* Parrot_mmd_find_multi_from_sig_obj(PARROT_INTERP, STRING *name, PMC
@@ -1080,6 +1151,10 @@ Parrot_mmd_add_multi_list_from_c_args(PARROT_INTERP,
 
 Creates and returns a new MMD cache.
 
+The cache is an open addressed table keyed on the dispatched name and the
+tuple of argument type ids, so a lookup neither allocates nor builds a key
+STRING.  Candidate sorting only runs on a miss.
+
 =cut
 
 */
@@ -1090,156 +1165,368 @@ MMD_Cache *
 Parrot_mmd_cache_create(PARROT_INTERP)
 {
     ASSERT_ARGS(Parrot_mmd_cache_create)
-    /* String hash. */
-    PMC *cache = Parrot_pmc_new(interp, enum_class_Hash);
+    MMD_Cache * const cache = mem_gc_allocate_zeroed_typed(interp, MMD_Cache);
+
+    cache->size    = MMD_CACHE_INITIAL_SIZE;
+    cache->entries = mem_gc_allocate_n_zeroed_typed(interp,
+                        MMD_CACHE_INITIAL_SIZE, MMD_Cache_entry);
+
     return cache;
 }
 
 /*
 
-=item C<static STRING * mmd_cache_key_from_values(PARROT_INTERP, const char
-*name, PMC *values)>
+=item C<void Parrot_mmd_cache_destroy(PARROT_INTERP, MMD_Cache *cache)>
+
+Frees an MMD cache and all its entries.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_mmd_cache_destroy(PARROT_INTERP, ARGFREE(MMD_Cache *cache))
+{
+    ASSERT_ARGS(Parrot_mmd_cache_destroy)
+
+    if (cache) {
+        mmd_cache_clear(interp, cache);
+        mem_gc_free(interp, cache->entries);
+        mem_gc_free(interp, cache);
+    }
+}
+
+/*
+
+=item C<void Parrot_mmd_cache_invalidate(PARROT_INTERP, MMD_Cache *cache)>
+
+Forgets all entries of an MMD cache, e.g. after a candidate was added.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_mmd_cache_invalidate(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
+{
+    ASSERT_ARGS(Parrot_mmd_cache_invalidate)
+    mmd_cache_clear(interp, cache);
+}
+
+/*
+
+=item C<static void mmd_cache_clear(PARROT_INTERP, MMD_Cache *cache)>
+
+Empties all slots of an MMD cache, keeping its size.
+
+=cut
+
+*/
+
+static void
+mmd_cache_clear(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
+{
+    ASSERT_ARGS(mmd_cache_clear)
+    UINTVAL i;
+
+    for (i = 0; i < cache->size; ++i) {
+        MMD_Cache_entry * const e = cache->entries + i;
+        if (e->name)
+            mem_sys_free(e->name);
+    }
+
+    memset(cache->entries, 0, cache->size * sizeof (MMD_Cache_entry));
+    cache->used = 0;
+}
+
+/*
+
+=item C<static INTVAL mmd_cache_types_from_tuple(PARROT_INTERP, PMC *types,
+INTVAL *type_ids)>
 
-Generates an MMD cache key from an array of values.
+Copies the type ids of a type tuple into C<type_ids>.  Returns their number,
+or -1 if the tuple can't be cached (too long, or containing an unknown type).
 
 =cut
 
 */
 
 PARROT_WARN_UNUSED_RESULT
-PARROT_CAN_RETURN_NULL
-static STRING *
-mmd_cache_key_from_values(PARROT_INTERP, ARGIN(const char *name),
-    ARGIN(PMC *values))
+static INTVAL
+mmd_cache_types_from_tuple(PARROT_INTERP, ARGIN(PMC *types), ARGOUT(INTVAL *type_ids))
 {
-    ASSERT_ARGS(mmd_cache_key_from_values)
-    /* Build array of type IDs, which we'll then use as a string to key into
-     * the hash. */
+    ASSERT_ARGS(mmd_cache_types_from_tuple)
+    const INTVAL num_types = VTABLE_elements(interp, types);
+    INTVAL       i;
+
+    if (num_types > PARROT_MMD_CACHE_MAX_TYPES)
+        return -1;
+
+    for (i = 0; i < num_types; ++i) {
+        const INTVAL id = VTABLE_get_integer_keyed_int(interp, types, i);
+
+        if (id == 0)
+            return -1;
+
+        type_ids[i] = id;
+    }
+
+    return num_types;
+}
+
+/*
+
+=item C<static INTVAL mmd_cache_types_from_values(PARROT_INTERP, PMC *values,
+INTVAL *type_ids)>
+
+Copies the types of an array of values into C<type_ids>.  Returns their
+number, or -1 if the values can't be cached.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static INTVAL
+mmd_cache_types_from_values(PARROT_INTERP, ARGIN(PMC *values), ARGOUT(INTVAL *type_ids))
+{
+    ASSERT_ARGS(mmd_cache_types_from_values)
     const INTVAL num_values = VTABLE_elements(interp, values);
-    const INTVAL name_len   = name ? strlen(name) + 1: 0;
-    const size_t id_size    = num_values * sizeof (INTVAL) + name_len;
-    INTVAL *type_ids        = mem_gc_allocate_n_typed(interp, num_values + name_len, INTVAL);
-    STRING *key;
-    INTVAL  i;
+    INTVAL       i;
+
+    if (num_values > PARROT_MMD_CACHE_MAX_TYPES)
+        return -1;
 
     for (i = 0; i < num_values; ++i) {
         const INTVAL id = VTABLE_type(interp, VTABLE_get_pmc_keyed_int(interp, values, i));
-        if (id == 0) {
-            mem_gc_free(interp, type_ids);
-            return NULL;
-        }
+
+        if (id == 0)
+            return -1;
 
         type_ids[i] = id;
     }
 
-    if (name)
-        strcpy((char *)(type_ids + num_values), name);
+    return num_values;
+}
+
+/*
 
-    key = Parrot_str_new_init(interp, (char *)type_ids, id_size,
-            Parrot_binary_encoding_ptr, 0);
-    mem_gc_free(interp, type_ids);
+=item C<static UINTVAL mmd_cache_hash(const char *name, const INTVAL *type_ids,
+INTVAL num_types)>
 
-    return key;
+Hashes a cache key (FNV-1a over the type ids and the name).
+
+=cut
+
+*/
+
+PARROT_PURE_FUNCTION
+PARROT_WARN_UNUSED_RESULT
+static UINTVAL
+mmd_cache_hash(ARGIN_NULLOK(const char *name), ARGIN(const INTVAL *type_ids),
+        INTVAL num_types)
+{
+    ASSERT_ARGS(mmd_cache_hash)
+    UINTVAL h = 2166136261U;
+    INTVAL  i;
+
+    for (i = 0; i < num_types; ++i) {
+        h ^= (UINTVAL)type_ids[i];
+        h *= 16777619U;
+    }
+
+    if (name)
+        for (; *name; ++name) {
+            h ^= (unsigned char)*name;
+            h *= 16777619U;
+        }
+
+    return h;
 }
 
 /*
 
-=item C<PMC * Parrot_mmd_cache_lookup_by_values(PARROT_INTERP, MMD_Cache *cache,
-const char *name, PMC *values)>
+=item C<static MMD_Cache_entry * mmd_cache_find(MMD_Cache *cache, const char
+*name, UINTVAL hash, const INTVAL *type_ids, INTVAL num_types)>
 
-Takes an array of values for the call and does a lookup in the MMD cache.
+Returns the slot holding the given key, or the empty slot where it belongs.
 
 =cut
 
 */
 
-PARROT_EXPORT
 PARROT_WARN_UNUSED_RESULT
-PARROT_CAN_RETURN_NULL
-PMC *
-Parrot_mmd_cache_lookup_by_values(PARROT_INTERP, ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name), ARGIN(PMC *values))
+PARROT_CANNOT_RETURN_NULL
+static MMD_Cache_entry *
+mmd_cache_find(ARGIN(MMD_Cache *cache), ARGIN_NULLOK(const char *name),
+        UINTVAL hash, ARGIN(const INTVAL *type_ids), INTVAL num_types)
 {
-    ASSERT_ARGS(Parrot_mmd_cache_lookup_by_values)
-    STRING * const key = mmd_cache_key_from_values(interp, name, values);
+    ASSERT_ARGS(mmd_cache_find)
+    const UINTVAL mask = cache->size - 1;
+    UINTVAL       i    = hash & mask;
 
-    if (key)
-        return VTABLE_get_pmc_keyed_str(interp, cache, key);
+    for (;; i = (i + 1) & mask) {
+        MMD_Cache_entry * const e = cache->entries + i;
 
-    return PMCNULL;
+        if (!e->chosen)
+            return e;
+
+        if (e->hash == hash
+        &&  e->num_types == num_types
+        &&  memcmp(e->types, type_ids, num_types * sizeof (INTVAL)) == 0
+        &&  (name ? e->name && STREQ(e->name, name) : !e->name))
+            return e;
+    }
 }
 
 /*
 
-=item C<void Parrot_mmd_cache_store_by_values(PARROT_INTERP, MMD_Cache *cache,
-const char *name, PMC *values, PMC *chosen)>
+=item C<static void mmd_cache_grow(PARROT_INTERP, MMD_Cache *cache)>
 
-Takes an array of values for the call along with a chosen candidate and puts
-it into the cache.
+Doubles the number of slots of an MMD cache and rehashes its entries.
 
 =cut
 
 */
 
-PARROT_EXPORT
-void
-Parrot_mmd_cache_store_by_values(PARROT_INTERP, ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name), ARGIN(PMC *values), ARGIN(PMC *chosen))
+static void
+mmd_cache_grow(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
 {
-    ASSERT_ARGS(Parrot_mmd_cache_store_by_values)
-    STRING * const key = mmd_cache_key_from_values(interp, name, values);
+    ASSERT_ARGS(mmd_cache_grow)
+    MMD_Cache_entry * const old_entries = cache->entries;
+    const UINTVAL           old_size    = cache->size;
+    UINTVAL                 i;
+
+    cache->size   *= 2;
+    cache->entries = mem_gc_allocate_n_zeroed_typed(interp, cache->size, MMD_Cache_entry);
+
+    for (i = 0; i < old_size; ++i) {
+        MMD_Cache_entry * const e = old_entries + i;
 
-    if (key)
-        VTABLE_set_pmc_keyed_str(interp, cache, key, chosen);
+        if (e->chosen)
+            *mmd_cache_find(cache, e->name, e->hash, e->types, e->num_types) = *e;
+    }
+
+    mem_gc_free(interp, old_entries);
 }
 
 /*
 
-=item C<static STRING * mmd_cache_key_from_types(PARROT_INTERP, const char
-*name, PMC *types)>
+=item C<static PMC * mmd_cache_lookup(MMD_Cache *cache, const char *name, const
+INTVAL *type_ids, INTVAL num_types)>
 
-Generates an MMD cache key from an array of types.
+Returns the candidate cached for the given key, or PMCNULL.
 
 =cut
 
 */
 
 PARROT_WARN_UNUSED_RESULT
-PARROT_CAN_RETURN_NULL
-static STRING *
-mmd_cache_key_from_types(PARROT_INTERP, ARGIN(const char *name),
-    ARGIN(PMC *types))
+PARROT_CANNOT_RETURN_NULL
+static PMC *
+mmd_cache_lookup(ARGIN(MMD_Cache *cache), ARGIN_NULLOK(const char *name),
+        ARGIN(const INTVAL *type_ids), INTVAL num_types)
 {
-    ASSERT_ARGS(mmd_cache_key_from_types)
-    /* Build array of type IDs, which we'll then use as a string to key into
-     * the hash. */
-    const INTVAL num_types  = VTABLE_elements(interp, types);
-    const INTVAL name_len   = name ? strlen(name) + 1: 0;
-    const size_t id_size    = num_types * sizeof (INTVAL) + name_len;
-    INTVAL * const type_ids = mem_gc_allocate_n_typed(interp, num_types + name_len, INTVAL);
-
-    STRING *key;
-    INTVAL  i;
+    ASSERT_ARGS(mmd_cache_lookup)
+    const UINTVAL hash = mmd_cache_hash(name, type_ids, num_types);
+    const MMD_Cache_entry * const e =
+        mmd_cache_find(cache, name, hash, type_ids, num_types);
 
-    for (i = 0; i < num_types; ++i) {
-        const INTVAL id = VTABLE_get_integer_keyed_int(interp, types, i);
+    return e->chosen ? e->chosen : PMCNULL;
+}
 
-        if (id == 0) {
-            mem_gc_free(interp, type_ids);
-            return NULL;
-        }
+/*
 
-        type_ids[i] = id;
+=item C<static void mmd_cache_store(PARROT_INTERP, MMD_Cache *cache, const char
+*name, const INTVAL *type_ids, INTVAL num_types, PMC *chosen)>
+
+Stores the candidate chosen for the given key, growing the table to keep it
+at most half full. A NULL C<chosen> is not stored.
+
+=cut
+
+*/
+
+static void
+mmd_cache_store(PARROT_INTERP, ARGMOD(MMD_Cache *cache), ARGIN_NULLOK(const char *name),
+        ARGIN(const INTVAL *type_ids), INTVAL num_types, ARGIN_NULLOK(PMC *chosen))
+{
+    ASSERT_ARGS(mmd_cache_store)
+    const UINTVAL    hash = mmd_cache_hash(name, type_ids, num_types);
+    MMD_Cache_entry *e;
+
+    if (PMC_IS_NULL(chosen))
+        return;
+
+    if (2 * (cache->used + 1) > cache->size)
+        mmd_cache_grow(interp, cache);
+
+    e = mmd_cache_find(cache, name, hash, type_ids, num_types);
+
+    if (!e->chosen) {
+        ++cache->used;
+        e->name      = name ? mem_sys_strdup(name) : NULL;
+        e->hash      = hash;
+        e->num_types = num_types;
+        memcpy(e->types, type_ids, num_types * sizeof (INTVAL));
     }
 
-    if (name)
-        strcpy((char *)(type_ids + num_types), name);
+    e->chosen = chosen;
+}
+
+/*
+
+=item C<PMC * Parrot_mmd_cache_lookup_by_values(PARROT_INTERP, MMD_Cache *cache,
+const char *name, PMC *values)>
+
+Takes an array of values for the call and does a lookup in the MMD cache.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+PMC *
+Parrot_mmd_cache_lookup_by_values(PARROT_INTERP, ARGMOD(MMD_Cache *cache),
+    ARGIN_NULLOK(const char *name), ARGIN(PMC *values))
+{
+    ASSERT_ARGS(Parrot_mmd_cache_lookup_by_values)
+    INTVAL       type_ids[PARROT_MMD_CACHE_MAX_TYPES];
+    const INTVAL num_types = mmd_cache_types_from_values(interp, values, type_ids);
 
-    key = Parrot_str_new_init(interp, (char *)type_ids, id_size,
-            Parrot_binary_encoding_ptr, 0);
+    if (num_types < 0)
+        return PMCNULL;
 
-    mem_gc_free(interp, type_ids);
-    return key;
+    return mmd_cache_lookup(cache, name, type_ids, num_types);
+}
+
+/*
+
+=item C<void Parrot_mmd_cache_store_by_values(PARROT_INTERP, MMD_Cache *cache,
+const char *name, PMC *values, PMC *chosen)>
+
+Takes an array of values for the call along with a chosen candidate and puts
+it into the cache.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_mmd_cache_store_by_values(PARROT_INTERP, ARGMOD(MMD_Cache *cache),
+    ARGIN_NULLOK(const char *name), ARGIN(PMC *values), ARGIN_NULLOK(PMC *chosen))
+{
+    ASSERT_ARGS(Parrot_mmd_cache_store_by_values)
+    INTVAL       type_ids[PARROT_MMD_CACHE_MAX_TYPES];
+    const INTVAL num_types = mmd_cache_types_from_values(interp, values, type_ids);
+
+    if (num_types >= 0)
+        mmd_cache_store(interp, cache, name, type_ids, num_types, chosen);
 }
 
 /*
@@ -1258,15 +1545,16 @@ PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 PMC *
 Parrot_mmd_cache_lookup_by_types(PARROT_INTERP, ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name), ARGIN(PMC *types))
+    ARGIN_NULLOK(const char *name), ARGIN(PMC *types))
 {
     ASSERT_ARGS(Parrot_mmd_cache_lookup_by_types)
-    STRING * const key = mmd_cache_key_from_types(interp, name, types);
+    INTVAL       type_ids[PARROT_MMD_CACHE_MAX_TYPES];
+    const INTVAL num_types = mmd_cache_types_from_tuple(interp, types, type_ids);
 
-    if (key)
-        return VTABLE_get_pmc_keyed_str(interp, cache, key);
+    if (num_types < 0)
+        return PMCNULL;
 
-    return PMCNULL;
+    return mmd_cache_lookup(cache, name, type_ids, num_types);
 }
 
 /*
@@ -1285,13 +1573,14 @@ tied to an individual multi can be null.
 PARROT_EXPORT
 void
 Parrot_mmd_cache_store_by_types(PARROT_INTERP, ARGMOD(MMD_Cache *cache),
-    ARGIN(const char *name), ARGIN(PMC *types), ARGIN(PMC *chosen))
+    ARGIN_NULLOK(const char *name), ARGIN(PMC *types), ARGIN_NULLOK(PMC *chosen))
 {
     ASSERT_ARGS(Parrot_mmd_cache_store_by_types)
-    STRING * const key = mmd_cache_key_from_types(interp, name, types);
+    INTVAL       type_ids[PARROT_MMD_CACHE_MAX_TYPES];
+    const INTVAL num_types = mmd_cache_types_from_tuple(interp, types, type_ids);
 
-    if (key)
-        VTABLE_set_pmc_keyed_str(interp, cache, key, chosen);
+    if (num_types >= 0)
+        mmd_cache_store(interp, cache, name, type_ids, num_types, chosen);
 }
 
 /*
@@ -1309,10 +1598,15 @@ void
 Parrot_mmd_cache_mark(PARROT_INTERP, ARGMOD(MMD_Cache *cache))
 {
     ASSERT_ARGS(Parrot_mmd_cache_mark)
-    /* As a small future optimization, note that we only *really* need to mark
-    * keys - the candidates will be referenced outside the cache, provided it's
-    * invalidated properly. */
-    Parrot_gc_mark_PMC_alive(interp, cache);
+    UINTVAL i;
+
+    /* The candidates are usually referenced outside the cache too, but a
+     * MultiSub may lose a candidate before its cache gets invalidated. */
+    for (i = 0; i < cache->size; ++i) {
+        PMC * const chosen = cache->entries[i].chosen;
+        if (chosen)
+            Parrot_gc_mark_PMC_alive(interp, chosen);
+    }
 }
 
 /*
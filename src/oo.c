@@ -1047,7 +1047,10 @@ Parrot_find_method_with_cache(PARROT_INTERP, ARGIN(PMC *_class), ARGIN(STRING *m
         e->pmc      = Parrot_find_method_direct(interp, _class, method_name);
         e->next     = NULL;
         e->strstart = Buffer_bufstart(method_name);
+        PARROT_METRIC_INC(interp, METRIC_METHOD_CACHE_MISSES);
     }
+    else
+        PARROT_METRIC_INC(interp, METRIC_METHOD_CACHE_HITS);
 
     return e->pmc;
 
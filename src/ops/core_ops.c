@@ -67,6 +67,113 @@ extern op_lib_t core_op_lib;
 #include "../io/io_private.h"
 
 
+#include "pmc/pmc_integer.h"
+#include "pmc/pmc_float.h"
+
+/* The add, sub and mul ops on PMCs compute on the values of core Integers and
+ * Floats directly, instead of dispatching on the types of both operands, in
+ * the cases where the vtable would give the same result. Anything else takes
+ * the vtable, as does an Integer result which overflows into a BigInt. */
+
+typedef enum { MATH_ADD, MATH_SUB, MATH_MUL } math_op_t;
+
+/* Sets *i or *n to the value of p. Returns 1 for an Integer, 0 for a Float
+ * and -1 for anything else */
+static int
+math_value(ARGIN(const PMC *p), ARGOUT(INTVAL *i), ARGOUT(FLOATVAL *n))
+{
+    *i = 0;
+    *n = 0.0;
+
+    if (p->vtable->base_type == enum_class_Integer) {
+        *i = PARROT_INTEGER(p)->iv;
+        return 1;
+    }
+
+    if (p->vtable->base_type == enum_class_Float) {
+        *n = PARROT_FLOAT(p)->fv;
+        return 0;
+    }
+
+    return -1;
+}
+
+/* Sets *c to a op b. Returns 0 if that overflows, with the checks of the
+ * Integer PMC */
+static int
+math_int(math_op_t op, INTVAL a, INTVAL b, ARGOUT(INTVAL *c))
+{
+    switch (op) {
+      case MATH_ADD:
+        *c = (INTVAL)((UINTVAL)a + (UINTVAL)b);
+        return (*c ^ a) >= 0 || (*c ^ b) >= 0;
+      case MATH_SUB:
+        *c = (INTVAL)((UINTVAL)a - (UINTVAL)b);
+        return (*c ^ a) >= 0 || (*c ^ ~b) >= 0;
+      default:
+        *c = (INTVAL)((UINTVAL)a * (UINTVAL)b);
+        return (double)*c == (double)a * (double)b;
+    }
+}
+
+static FLOATVAL
+math_num(math_op_t op, FLOATVAL a, FLOATVAL b)
+{
+    return op == MATH_ADD ? a + b
+         : op == MATH_SUB ? a - b
+         :                  a * b;
+}
+
+/* Returns a new PMC holding a op b, where b is the INTVAL bi if b_is_int or
+ * else the FLOATVAL bn, or NULL if the vtable of a has to compute it */
+PARROT_CAN_RETURN_NULL
+static PMC *
+math_new(PARROT_INTERP, math_op_t op, ARGIN(const PMC *a),
+        int b_is_int, INTVAL bi, FLOATVAL bn)
+{
+    if (a->vtable->base_type == enum_class_Integer) {
+        INTVAL c;
+
+        if (b_is_int && math_int(op, PARROT_INTEGER(a)->iv, bi, &c))
+            return Parrot_pmc_new_init_int(interp, enum_class_Integer, c);
+    }
+    else if (a->vtable->base_type == enum_class_Float) {
+        PMC * const c = Parrot_pmc_new(interp, enum_class_Float);
+
+        PARROT_FLOAT(c)->fv = math_num(op, PARROT_FLOAT(a)->fv,
+                                b_is_int ? (FLOATVAL)bi : bn);
+        return c;
+    }
+
+    return NULL;
+}
+
+/* Sets a to a op b like math_new. Returns 0 if the vtable of a has to */
+static int
+math_assign(math_op_t op, ARGMOD(PMC *a), int b_is_int, INTVAL bi, FLOATVAL bn)
+{
+    if (a->vtable->flags & VTABLE_IS_READONLY_FLAG)
+        return 0;
+
+    if (a->vtable->base_type == enum_class_Integer) {
+        INTVAL c;
+
+        if (b_is_int && math_int(op, PARROT_INTEGER(a)->iv, bi, &c)) {
+            PARROT_INTEGER(a)->iv = c;
+            return 1;
+        }
+    }
+    else if (a->vtable->base_type == enum_class_Float) {
+        PARROT_FLOAT(a)->fv = math_num(op, PARROT_FLOAT(a)->fv,
+                                b_is_int ? (FLOATVAL)bi : bn);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+
 #if PARROT_HAS_ICU
 #  include <unicode/uchar.h>
 #endif
@@ -14005,6 +14112,10 @@ Parrot_get_results_pc(opcode_t *cur_opcode, PARROT_INTERP) {
     INTVAL   argc;
 
     Parrot_pcc_fill_params_from_op(interp, call_object, signature, raw_params, PARROT_ERRORS_RESULT_COUNT_FLAG);
+    if ((!PMC_IS_NULL(call_object))) {
+        Parrot_pcc_recycle_registers(interp, ctx, call_object);
+    }
+
     GETATTR_FixedIntegerArray_size(interp, signature, argc);
     Parrot_pcc_set_signature(interp, CURRENT_CONTEXT(interp), PMCNULL);
     return cur_opcode + (argc + 2);
@@ -14088,10 +14199,7 @@ Parrot_addhandler_p(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_push_eh_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    PMC  * const  eh = Parrot_pmc_new(interp, enum_class_ExceptionHandler);
-
-    VTABLE_set_pointer(interp, eh, (CUR_OPCODE + ICONST(1)));
-    Parrot_cx_add_handler_local(interp, eh);
+    Parrot_cx_add_label_handler_local(interp, (CUR_OPCODE + ICONST(1)));
     return cur_opcode + 2;
 }
 
@@ -17294,31 +17402,50 @@ Parrot_add_n_nc(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_add_p_p(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_add(interp, PREG(1), PREG(2));
+    INTVAL          i;
+    FLOATVAL        n;
+    const int       is_int = math_value(PREG(2), (&i), (&n));
+
+    if (((is_int < 0) || (!math_assign(MATH_ADD, PREG(1), is_int, i, n)))) {
+        VTABLE_i_add(interp, PREG(1), PREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_add_p_i(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_add_int(interp, PREG(1), IREG(2));
+    if ((!math_assign(MATH_ADD, PREG(1), 1, IREG(2), 0.0))) {
+        VTABLE_i_add_int(interp, PREG(1), IREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_add_p_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_add_int(interp, PREG(1), ICONST(2));
+    if ((!math_assign(MATH_ADD, PREG(1), 1, ICONST(2), 0.0))) {
+        VTABLE_i_add_int(interp, PREG(1), ICONST(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_add_p_n(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_add_float(interp, PREG(1), NREG(2));
+    if ((!math_assign(MATH_ADD, PREG(1), 0, 0, NREG(2)))) {
+        VTABLE_i_add_float(interp, PREG(1), NREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_add_p_nc(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_add_float(interp, PREG(1), NCONST(2));
+    if ((!math_assign(MATH_ADD, PREG(1), 0, 0, NCONST(2)))) {
+        VTABLE_i_add_float(interp, PREG(1), NCONST(2));
+    }
+
     return cur_opcode + 3;
 }
 
@@ -17360,31 +17487,44 @@ Parrot_add_n_n_nc(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_add_p_p_p(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_add(interp, PREG(2), PREG(3), PREG(1));
+    INTVAL            i;
+    FLOATVAL          n;
+    const int         is_int = math_value(PREG(3), (&i), (&n));
+    PMC      * const  c = (is_int < 0) ? NULL : math_new(interp, MATH_ADD, PREG(2), is_int, i, n);
+
+    PREG(1) = c ? c : VTABLE_add(interp, PREG(2), PREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_add_p_p_i(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_add_int(interp, PREG(2), IREG(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_ADD, PREG(2), 1, IREG(3), 0.0);
+
+    PREG(1) = c ? c : VTABLE_add_int(interp, PREG(2), IREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_add_p_p_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_add_int(interp, PREG(2), ICONST(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_ADD, PREG(2), 1, ICONST(3), 0.0);
+
+    PREG(1) = c ? c : VTABLE_add_int(interp, PREG(2), ICONST(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_add_p_p_n(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_add_float(interp, PREG(2), NREG(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_ADD, PREG(2), 0, 0, NREG(3));
+
+    PREG(1) = c ? c : VTABLE_add_float(interp, PREG(2), NREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_add_p_p_nc(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_add_float(interp, PREG(2), NCONST(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_ADD, PREG(2), 0, 0, NCONST(3));
+
+    PREG(1) = c ? c : VTABLE_add_float(interp, PREG(2), NCONST(3), PREG(1));
     return cur_opcode + 4;
 }
 
@@ -18048,31 +18188,50 @@ Parrot_mul_n_nc(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_mul_p_p(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_multiply(interp, PREG(1), PREG(2));
+    INTVAL          i;
+    FLOATVAL        n;
+    const int       is_int = math_value(PREG(2), (&i), (&n));
+
+    if ((((is_int < 0) || (PREG(1)->vtable->base_type == enum_class_Integer)) || (!math_assign(MATH_MUL, PREG(1), is_int, i, n)))) {
+        VTABLE_i_multiply(interp, PREG(1), PREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_mul_p_i(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_multiply_int(interp, PREG(1), IREG(2));
+    if ((!math_assign(MATH_MUL, PREG(1), 1, IREG(2), 0.0))) {
+        VTABLE_i_multiply_int(interp, PREG(1), IREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_mul_p_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_multiply_int(interp, PREG(1), ICONST(2));
+    if ((!math_assign(MATH_MUL, PREG(1), 1, ICONST(2), 0.0))) {
+        VTABLE_i_multiply_int(interp, PREG(1), ICONST(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_mul_p_n(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_multiply_float(interp, PREG(1), NREG(2));
+    if ((!math_assign(MATH_MUL, PREG(1), 0, 0, NREG(2)))) {
+        VTABLE_i_multiply_float(interp, PREG(1), NREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_mul_p_nc(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_multiply_float(interp, PREG(1), NCONST(2));
+    if ((!math_assign(MATH_MUL, PREG(1), 0, 0, NCONST(2)))) {
+        VTABLE_i_multiply_float(interp, PREG(1), NCONST(2));
+    }
+
     return cur_opcode + 3;
 }
 
@@ -18114,31 +18273,44 @@ Parrot_mul_n_n_nc(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_mul_p_p_p(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_multiply(interp, PREG(2), PREG(3), PREG(1));
+    INTVAL            i;
+    FLOATVAL          n;
+    const int         is_int = math_value(PREG(3), (&i), (&n));
+    PMC      * const  c = (is_int < 0) ? NULL : math_new(interp, MATH_MUL, PREG(2), is_int, i, n);
+
+    PREG(1) = c ? c : VTABLE_multiply(interp, PREG(2), PREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_mul_p_p_i(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_multiply_int(interp, PREG(2), IREG(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_MUL, PREG(2), 1, IREG(3), 0.0);
+
+    PREG(1) = c ? c : VTABLE_multiply_int(interp, PREG(2), IREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_mul_p_p_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_multiply_int(interp, PREG(2), ICONST(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_MUL, PREG(2), 1, ICONST(3), 0.0);
+
+    PREG(1) = c ? c : VTABLE_multiply_int(interp, PREG(2), ICONST(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_mul_p_p_n(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_multiply_float(interp, PREG(2), NREG(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_MUL, PREG(2), 0, 0, NREG(3));
+
+    PREG(1) = c ? c : VTABLE_multiply_float(interp, PREG(2), NREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_mul_p_p_nc(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_multiply_float(interp, PREG(2), NCONST(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_MUL, PREG(2), 0, 0, NCONST(3));
+
+    PREG(1) = c ? c : VTABLE_multiply_float(interp, PREG(2), NCONST(3), PREG(1));
     return cur_opcode + 4;
 }
 
@@ -18205,31 +18377,50 @@ Parrot_sub_n_nc(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_sub_p_p(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_subtract(interp, PREG(1), PREG(2));
+    INTVAL          i;
+    FLOATVAL        n;
+    const int       is_int = math_value(PREG(2), (&i), (&n));
+
+    if (((is_int < 0) || (!math_assign(MATH_SUB, PREG(1), is_int, i, n)))) {
+        VTABLE_i_subtract(interp, PREG(1), PREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_sub_p_i(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_subtract_int(interp, PREG(1), IREG(2));
+    if ((!math_assign(MATH_SUB, PREG(1), 1, IREG(2), 0.0))) {
+        VTABLE_i_subtract_int(interp, PREG(1), IREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_sub_p_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_subtract_int(interp, PREG(1), ICONST(2));
+    if ((!math_assign(MATH_SUB, PREG(1), 1, ICONST(2), 0.0))) {
+        VTABLE_i_subtract_int(interp, PREG(1), ICONST(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_sub_p_n(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_subtract_float(interp, PREG(1), NREG(2));
+    if ((!math_assign(MATH_SUB, PREG(1), 0, 0, NREG(2)))) {
+        VTABLE_i_subtract_float(interp, PREG(1), NREG(2));
+    }
+
     return cur_opcode + 3;
 }
 
 opcode_t *
 Parrot_sub_p_nc(opcode_t *cur_opcode, PARROT_INTERP) {
-    VTABLE_i_subtract_float(interp, PREG(1), NCONST(2));
+    if ((!math_assign(MATH_SUB, PREG(1), 0, 0, NCONST(2)))) {
+        VTABLE_i_subtract_float(interp, PREG(1), NCONST(2));
+    }
+
     return cur_opcode + 3;
 }
 
@@ -18271,31 +18462,44 @@ Parrot_sub_n_n_nc(opcode_t *cur_opcode, PARROT_INTERP) {
 
 opcode_t *
 Parrot_sub_p_p_p(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_subtract(interp, PREG(2), PREG(3), PREG(1));
+    INTVAL            i;
+    FLOATVAL          n;
+    const int         is_int = math_value(PREG(3), (&i), (&n));
+    PMC      * const  c = (is_int < 0) ? NULL : math_new(interp, MATH_SUB, PREG(2), is_int, i, n);
+
+    PREG(1) = c ? c : VTABLE_subtract(interp, PREG(2), PREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_sub_p_p_i(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_subtract_int(interp, PREG(2), IREG(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_SUB, PREG(2), 1, IREG(3), 0.0);
+
+    PREG(1) = c ? c : VTABLE_subtract_int(interp, PREG(2), IREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_sub_p_p_ic(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_subtract_int(interp, PREG(2), ICONST(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_SUB, PREG(2), 1, ICONST(3), 0.0);
+
+    PREG(1) = c ? c : VTABLE_subtract_int(interp, PREG(2), ICONST(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_sub_p_p_n(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_subtract_float(interp, PREG(2), NREG(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_SUB, PREG(2), 0, 0, NREG(3));
+
+    PREG(1) = c ? c : VTABLE_subtract_float(interp, PREG(2), NREG(3), PREG(1));
     return cur_opcode + 4;
 }
 
 opcode_t *
 Parrot_sub_p_p_nc(opcode_t *cur_opcode, PARROT_INTERP) {
-    PREG(1) = VTABLE_subtract_float(interp, PREG(2), NCONST(3), PREG(1));
+    PMC  * const  c = math_new(interp, MATH_SUB, PREG(2), 0, 0, NCONST(3));
+
+    PREG(1) = c ? c : VTABLE_subtract_float(interp, PREG(2), NCONST(3), PREG(1));
     return cur_opcode + 4;
 }
 
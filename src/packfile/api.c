@@ -27,6 +27,7 @@ format of bytecode.
 */
 
 #include "pf_private.h"
+#include "parrot/oplib/ops.h"
 #include "api.str"
 #include "pmc/pmc_sub.h"
 #include "pmc/pmc_packfileview.h"
@@ -36,6 +37,22 @@ format of bytecode.
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
+PARROT_CANNOT_RETURN_NULL
+static PMC * annotation_value(PARROT_INTERP,
+    ARGMOD(PackFile_Annotations *self),
+    ARGMOD(PackFile_Annotations_Key *key),
+    opcode_t offset)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*self)
+        FUNC_MODIFIES(*key);
+
+static void build_op_offsets(PARROT_INTERP, ARGMOD(PackFile_Debug *debug))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*debug);
+
 static void compile_file(PARROT_INTERP, ARGIN(STRING *path), INTVAL is_pasm)
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
@@ -70,14 +87,14 @@ static INTVAL find_const_iter(PARROT_INTERP,
         __attribute__nonnull__(2)
         FUNC_MODIFIES(*seg);
 
-PARROT_PURE_FUNCTION
 PARROT_WARN_UNUSED_RESULT
 static INTVAL find_pf_ann_idx(
     ARGIN(PackFile_Annotations *pfa),
-    ARGIN(PackFile_Annotations_Key *key),
+    ARGMOD(PackFile_Annotations_Key *key),
     UINTVAL offs)
         __attribute__nonnull__(1)
-        __attribute__nonnull__(2);
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*key);
 
 static void load_file(PARROT_INTERP, ARGIN(STRING *path))
         __attribute__nonnull__(1)
@@ -161,6 +178,13 @@ static int sub_pragma(PARROT_INTERP,
         __attribute__nonnull__(1)
         __attribute__nonnull__(3);
 
+#define ASSERT_ARGS_annotation_value __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(self) \
+    , PARROT_ASSERT_ARG(key))
+#define ASSERT_ARGS_build_op_offsets __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(debug))
 #define ASSERT_ARGS_compile_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(path))
@@ -1690,7 +1714,8 @@ Parrot_new_debug_seg(PARROT_INTERP, ARGMOD(PackFile_ByteCode *cs), size_t size)
         cs->debugs       = debug;
     }
 
-    debug->base.size = size;
+    debug->base.size       = size;
+    debug->op_offsets_code = NULL;  /* code is being rewritten */
 
     return debug;
 }
@@ -1749,7 +1774,7 @@ Parrot_debug_add_mapping(PARROT_INTERP, ARGMOD(PackFile_Debug *debug),
             if (debug->mappings[i].offset > offset) {
                 insert_pos = i;
                 memmove(debug->mappings + i + 1, debug->mappings + i,
-                    debug->num_mappings - i);
+                    (debug->num_mappings - i) * sizeof (PackFile_DebugFilenameMapping));
                 break;
             }
         }
@@ -1790,11 +1815,14 @@ Parrot_debug_add_mapping(PARROT_INTERP, ARGMOD(PackFile_Debug *debug),
 
 /*
 
-=item C<STRING * Parrot_debug_pc_to_filename(PARROT_INTERP, const PackFile_Debug
+=item C<STRING * Parrot_debug_pc_to_filename(PARROT_INTERP, PackFile_Debug
 *debug, opcode_t pc)>
 
 Returns the filename of the source for the given position in the bytecode.
 
+The mappings are kept sorted by offset, so this is a binary search, after
+checking the mapping which answered the previous call.
+
 Deprecated: This function should either be renamed to Parrot_pf_*, or should
 not be exposed through this API. TT #2140
 
@@ -1806,25 +1834,135 @@ PARROT_EXPORT
 PARROT_WARN_UNUSED_RESULT
 PARROT_CANNOT_RETURN_NULL
 STRING *
-Parrot_debug_pc_to_filename(PARROT_INTERP, ARGIN(const PackFile_Debug *debug),
+Parrot_debug_pc_to_filename(PARROT_INTERP, ARGMOD(PackFile_Debug *debug),
     opcode_t pc)
 {
     ASSERT_ARGS(Parrot_debug_pc_to_filename)
-    /* Look through mappings until we find one that maps the passed
-       bytecode offset. */
-
-    int i;
-    for (i = 0; i < debug->num_mappings; ++i) {
-        /* If this is the last mapping or the current position is
-           between this mapping and the next one, return a filename. */
-       if (i + 1 == debug->num_mappings
-       || (debug->mappings[i].offset     <= pc
-       &&  debug->mappings[i + 1].offset >  pc))
-            return debug->code->const_table->str.constants[debug->mappings[i].filename];
+    const PackFile_DebugFilenameMapping * const mappings = debug->mappings;
+    const opcode_t                              last     = debug->last_mapping;
+    opcode_t                                    lo, hi;
+
+    /* No mappings == no filename. */
+    if (!debug->num_mappings)
+        return CONST_STRING(interp, "(unknown file)");
+
+    if (last < debug->num_mappings
+    &&  mappings[last].offset <= pc
+    && (last + 1 == debug->num_mappings || mappings[last + 1].offset > pc))
+        return debug->code->const_table->str.constants[mappings[last].filename];
+
+    /* Find the last mapping starting at or before pc; positions before the
+       first mapping belong to it. */
+    lo = 0;
+    hi = debug->num_mappings;
+    while (hi - lo > 1) {
+        const opcode_t mid = lo + (hi - lo) / 2;
+
+        if (mappings[mid].offset <= pc)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    debug->last_mapping = lo;
+    return debug->code->const_table->str.constants[mappings[lo].filename];
+}
+
+
+/*
+
+=item C<INTVAL Parrot_pf_debug_op_index(PARROT_INTERP, PackFile_Debug *debug,
+opcode_t offset)>
+
+Returns the index into the debug segment's line data of the first op at or
+after the bytecode C<offset>, or -1 if there is no such op with line data.
+
+The offset of every op of the code segment is computed on first use and then
+binary searched; the table is rebuilt whenever the code segment changes.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+INTVAL
+Parrot_pf_debug_op_index(PARROT_INTERP, ARGMOD(PackFile_Debug *debug), opcode_t offset)
+{
+    ASSERT_ARGS(Parrot_pf_debug_op_index)
+    PackFile_ByteCode * const code = debug->code;
+    const opcode_t           *offsets;
+    size_t                    lo, hi;
+
+    if (debug->op_offsets_code != code->base.data
+    ||  debug->op_offsets_size != code->base.size)
+        build_op_offsets(interp, debug);
+
+    offsets = debug->op_offsets;
+    lo      = debug->last_op;
+    hi      = debug->num_op_offsets;
+
+    if (!(lo < hi
+    &&    offsets[lo] >= offset
+    &&   (lo == 0 || offsets[lo - 1] < offset))) {
+        /* find the first op at or after offset */
+        lo = 0;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+
+            if (offsets[mid] < offset)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+
+        if (lo == debug->num_op_offsets)
+            return -1;
+
+        debug->last_op = lo;
+    }
+
+    return lo < debug->base.size ? (INTVAL)lo : -1;
+}
+
+
+/*
+
+=item C<static void build_op_offsets(PARROT_INTERP, PackFile_Debug *debug)>
+
+Records the bytecode offset of each op of the debug segment's code segment.
+
+=cut
+
+*/
+
+static void
+build_op_offsets(PARROT_INTERP, ARGMOD(PackFile_Debug *debug))
+{
+    ASSERT_ARGS(build_op_offsets)
+    PackFile_ByteCode * const code = debug->code;
+    const size_t              size = code->base.size;
+    opcode_t                 *pc   = code->base.data;
+    size_t                    n, i;
+
+    /* an op takes at least one opcode_t, so size is enough room */
+    debug->op_offsets = mem_gc_realloc_n_typed(interp, debug->op_offsets,
+                            size ? size : 1, opcode_t);
+
+    for (i = n = 0; n < size; ++i) {
+        op_info_t * const op_info  = code->op_info_table[*pc];
+        opcode_t          var_args = 0;
+
+        debug->op_offsets[i] = n;
+
+        ADD_OP_VAR_PART(interp, code, pc, var_args);
+        n  += op_info->op_count + var_args;
+        pc += op_info->op_count + var_args;
     }
 
-    /* Otherwise, no mappings == no filename. */
-    return CONST_STRING(interp, "(unknown file)");
+    debug->num_op_offsets  = i;
+    debug->op_offsets_code = code->base.data;
+    debug->op_offsets_size = size;
+    debug->last_op         = 0;
 }
 
 
@@ -1883,44 +2021,48 @@ Parrot_switch_to_cs(PARROT_INTERP, ARGIN(PackFile_ByteCode *new_cs), int really)
 =item C<static INTVAL find_pf_ann_idx(PackFile_Annotations *pfa,
 PackFile_Annotations_Key *key, UINTVAL offs)>
 
-Find the index of the active annotation at the given offset.
+Find the index of the active annotation at the given offset, which is the last
+entry of C<key> at an offset below C<offs>, or -1 if there is none. The entry
+found by the previous lookup is tried first, since successive lookups tend to
+be for nearby offsets.
 
 =cut
 
 */
 
 
-PARROT_PURE_FUNCTION
 PARROT_WARN_UNUSED_RESULT
 static INTVAL
 find_pf_ann_idx(ARGIN(PackFile_Annotations *pfa),
-                ARGIN(PackFile_Annotations_Key *key), UINTVAL offs)
+                ARGMOD(PackFile_Annotations_Key *key), UINTVAL offs)
 {
     ASSERT_ARGS(find_pf_ann_idx)
-    UINTVAL hi, lo;
-
-    lo = key->start;
-    hi = key->start + key->len;
-
-    while (1) {
-        const UINTVAL mid = (lo + hi) / 2;
-        const UINTVAL mid_val = pfa->base.data[mid * 2 + ANN_ENTRY_OFF];
+    const opcode_t * const data = pfa->base.data;
+    const UINTVAL          end  = key->start + key->len;
+    const UINTVAL          last = key->last_hit;
+    UINTVAL                lo   = key->start;
+    UINTVAL                hi   = end;
+
+    if (last >= lo && last < hi
+    && (UINTVAL)data[last * 2 + ANN_ENTRY_OFF] < offs
+    && (last + 1 == hi || (UINTVAL)data[(last + 1) * 2 + ANN_ENTRY_OFF] >= offs))
+        return last;
+
+    /* find the first entry at or after offs */
+    while (lo < hi) {
+        const UINTVAL mid = lo + (hi - lo) / 2;
 
-        if (mid_val < offs) {
-            if (lo == mid)
-                return mid; /* end of range search */
-            lo = mid;
-        }
-        else if (mid_val > offs) {
-            if (hi == key->start)
-                return -1; /* bottomed out */
+        if ((UINTVAL)data[mid * 2 + ANN_ENTRY_OFF] < offs)
+            lo = mid + 1;
+        else
             hi = mid;
-        }
-        else {
-            /* exact match: retrun prior annotation */
-            return mid - 1;
-        }
     }
+
+    if (lo == key->start)
+        return -1;
+
+    key->last_hit = lo - 1;
+    return lo - 1;
 }
 
 /*
@@ -1979,6 +2121,7 @@ PackFile_Annotations_add_entry(PARROT_INTERP, ARGMOD(PackFile_Annotations *self)
                                     0 :
                                     self->keys[key_id - 1].start + self->keys[key_id -1].len;
         self->keys[key_id].len   = 0;
+        self->keys[key_id].last_hit = 0;
     }
     else {
         /* Ensure key types are compatible. */
@@ -1989,10 +2132,10 @@ PackFile_Annotations_add_entry(PARROT_INTERP, ARGMOD(PackFile_Annotations *self)
                 self->code->const_table->str.constants[self->keys[key_id].name]);
     }
 
-    /* Lookup position where value will be inserted. */
-    idx = self->keys[key_id].len == 0  ?
-          self->keys[key_id].start * 2 :
-          (UINTVAL)(find_pf_ann_idx(self, &self->keys[key_id], offset) + 1) * 2;
+    /* Lookup position where value will be inserted: after the last entry
+     * below offset, or at the start of the key's entries. */
+    idx = find_pf_ann_idx(self, &self->keys[key_id], offset);
+    idx = (idx < 0 ? (INTVAL)self->keys[key_id].start : idx + 1) * 2;
 
     /* Extend segment data and shift subsequent data by 2. */
     self->base.data = (opcode_t *)mem_sys_realloc(self->base.data,
@@ -2019,7 +2162,8 @@ Looks up the annotation(s) in force at the given bytecode offset. If just one
 particular annotation is required, it can be passed as C<name>, and the value
 will be returned (or a NULL PMC if no annotation of that name is in force).
 Otherwise, a Hash will be returned of the all annotations. If there are none in
-force, an empty hash will be returned.
+force, an empty hash will be returned. C<self> remembers the key and entries
+found, to start the next lookup from them.
 
 Deprecated: This function should either be renamed to Parrot_pf_*, or should
 not be exposed through this API. TT #2140
@@ -2030,59 +2174,77 @@ not be exposed through this API. TT #2140
 
 PARROT_CANNOT_RETURN_NULL
 PMC *
-PackFile_Annotations_lookup(PARROT_INTERP, ARGIN(PackFile_Annotations *self),
+PackFile_Annotations_lookup(PARROT_INTERP, ARGMOD(PackFile_Annotations *self),
         opcode_t offset, ARGIN_NULLOK(STRING *name))
 {
     ASSERT_ARGS(PackFile_Annotations_lookup)
+    STRING ** const names = self->code->const_table->str.constants;
+    INTVAL i;
 
     if (STRING_IS_NULL(name)) {
         /* find all annotations for this offset */
         PMC * const result = Parrot_pmc_new(interp, enum_class_Hash);
-        INTVAL i;
         for (i = 0; i < self->num_keys; i++) {
-            STRING * const k = self->code->const_table->str.constants[self->keys[i].name];
-            PMC    * const v = PackFile_Annotations_lookup(interp, self, offset, k);
+            PMC * const v = annotation_value(interp, self, &self->keys[i], offset);
             if (!PMC_IS_NULL(v))
-                VTABLE_set_pmc_keyed_str(interp, result, k, v);
+                VTABLE_set_pmc_keyed_str(interp, result, names[self->keys[i].name], v);
         }
 
         return result;
     }
 
-    else {
-        PackFile_Annotations_Key *key = NULL;
-        INTVAL i;
-        opcode_t val;
+    /* The same key tends to be asked for over and over, so try it first. */
+    if (self->last_key < self->num_keys
+    &&  STRING_equal(interp, names[self->keys[self->last_key].name], name))
+        return annotation_value(interp, self, &self->keys[self->last_key], offset);
 
-        for (i = 0; i < self->num_keys; i++) {
-            STRING * const test_key = self->code->const_table->str.constants[self->keys[i].name];
-            if (STRING_equal(interp, test_key, name)) {
-                key = &self->keys[i];
-                break;
-            }
+    for (i = 0; i < self->num_keys; i++) {
+        if (STRING_equal(interp, names[self->keys[i].name], name)) {
+            self->last_key = i;
+            return annotation_value(interp, self, &self->keys[i], offset);
         }
+    }
+
+    return PMCNULL; /* no such key */
+}
+
+/*
 
-        if (!key)
-            return PMCNULL; /* no such key */
+=item C<static PMC * annotation_value(PARROT_INTERP, PackFile_Annotations *self,
+PackFile_Annotations_Key *key, opcode_t offset)>
 
-        i = find_pf_ann_idx(self, key, offset);
+Returns the value of the annotation C<key> in force at the given bytecode
+offset, or a NULL PMC if there is none. C<key> is one of the keys of C<self>,
+and remembers the entry found for the next lookup.
 
-        if (i < 0)
-            return PMCNULL; /* no active entry */
+=cut
 
-        val = self->base.data[i * 2 + ANN_ENTRY_VAL];
+*/
 
-        switch (key->type) {
-          case PF_ANNOTATION_KEY_TYPE_INT:
-            return Parrot_pmc_box_integer(interp, val);
-          case PF_ANNOTATION_KEY_TYPE_STR:
-            return Parrot_pmc_box_string(interp, self->code->const_table->str.constants[val]);
-          case PF_ANNOTATION_KEY_TYPE_PMC:
-            return self->code->const_table->pmc.constants[val];
-          default:
-            Parrot_warn(interp, PARROT_WARNINGS_ALL_FLAG, "unexpected annotation type found");
-            return PMCNULL;
-        }
+PARROT_CANNOT_RETURN_NULL
+static PMC *
+annotation_value(PARROT_INTERP, ARGMOD(PackFile_Annotations *self),
+        ARGMOD(PackFile_Annotations_Key *key), opcode_t offset)
+{
+    ASSERT_ARGS(annotation_value)
+    const INTVAL i = find_pf_ann_idx(self, key, offset);
+    opcode_t     val;
+
+    if (i < 0)
+        return PMCNULL; /* no active entry */
+
+    val = self->base.data[i * 2 + ANN_ENTRY_VAL];
+
+    switch (key->type) {
+      case PF_ANNOTATION_KEY_TYPE_INT:
+        return Parrot_pmc_box_integer(interp, val);
+      case PF_ANNOTATION_KEY_TYPE_STR:
+        return Parrot_pmc_box_string(interp, self->code->const_table->str.constants[val]);
+      case PF_ANNOTATION_KEY_TYPE_PMC:
+        return self->code->const_table->pmc.constants[val];
+      default:
+        Parrot_warn(interp, PARROT_WARNINGS_ALL_FLAG, "unexpected annotation type found");
+        return PMCNULL;
     }
 }
 
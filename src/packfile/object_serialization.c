@@ -23,6 +23,8 @@ individual action vtable (freeze/thaw) is then called for all todo-PMCs.
 
 #include "parrot/parrot.h"
 #include "pmc/pmc_callcontext.h"
+#include "pmc/pmc_imageiofreeze.h"
+#include "pmc/pmc_imageiothaw.h"
 #include "object_serialization.str"
 
 /* when thawing a string longer then this size, we first do a GC run and then
@@ -59,6 +61,57 @@ Parrot_freeze(PARROT_INTERP, ARGIN(PMC *pmc))
 }
 
 
+/*
+
+=item C<void Parrot_freeze_to_handle(PARROT_INTERP, PMC *pmc, PMC *handle)>
+
+Freeze C<pmc> and write the image to the IO handle C<handle> as it is built,
+one chunk at a time, instead of returning it as a string.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_freeze_to_handle(PARROT_INTERP, ARGIN(PMC *pmc), ARGIN(PMC *handle))
+{
+    ASSERT_ARGS(Parrot_freeze_to_handle)
+    PMC * const image = Parrot_pmc_new_init(interp, enum_class_ImageIOFreeze, handle);
+    VTABLE_set_pmc(interp, image, pmc);
+}
+
+
+/*
+
+=item C<STRING * Parrot_freeze_with_externs(PARROT_INTERP, PMC *pmc, PMC
+*externs, PMC **seen)>
+
+Freeze C<pmc>, writing any PMC of the array C<externs> it refers to as its
+index in that array instead of freezing it. The image must be thawed with
+C<Parrot_thaw_with_externs> and an array holding the matching PMCs. The Hash
+PMC of all PMCs reached, externs included, is returned in C<seen>.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+STRING *
+Parrot_freeze_with_externs(PARROT_INTERP, ARGIN(PMC *pmc), ARGIN(PMC *externs),
+    ARGOUT(PMC **seen))
+{
+    ASSERT_ARGS(Parrot_freeze_with_externs)
+    PMC * const image = Parrot_pmc_new(interp, enum_class_ImageIOFreeze);
+    SETATTR_ImageIOFreeze_externs(interp, image, externs);
+    VTABLE_set_pmc(interp, image, pmc);
+    GETATTR_ImageIOFreeze_seen(interp, image, *seen);
+    return VTABLE_get_string(interp, image);
+}
+
+
 /*
 
 =item C<opcode_t * Parrot_freeze_pbc(PARROT_INTERP, PMC *pmc, const
@@ -242,6 +295,79 @@ Parrot_thaw(PARROT_INTERP, ARGIN(STRING *image))
 }
 
 
+/*
+
+=item C<PMC * Parrot_thaw_from_handle(PARROT_INTERP, PMC *handle)>
+
+Thaw a PMC from an image read from the IO handle C<handle> one chunk at a
+time. The image should be the last thing on the handle, as up to a chunk
+past its end may be consumed.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+PMC *
+Parrot_thaw_from_handle(PARROT_INTERP, ARGIN(PMC *handle))
+{
+    ASSERT_ARGS(Parrot_thaw_from_handle)
+
+    PMC        *result;
+    PMC * const info = Parrot_pmc_new(interp, enum_class_ImageIOThaw);
+
+    /* see Parrot_thaw */
+    Parrot_block_GC_mark(interp);
+    Parrot_block_GC_sweep(interp);
+
+    VTABLE_set_pmc(interp, info, handle);
+    result = VTABLE_get_pmc(interp, info);
+
+    Parrot_unblock_GC_mark(interp);
+    Parrot_unblock_GC_sweep(interp);
+
+    return result;
+}
+
+/*
+
+=item C<PMC * Parrot_thaw_with_externs(PARROT_INTERP, STRING *image, PMC
+*externs)>
+
+Thaw a PMC frozen by C<Parrot_freeze_with_externs>, taking the PMCs it refers
+to by index from the array C<externs>.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+PMC *
+Parrot_thaw_with_externs(PARROT_INTERP, ARGIN(STRING *image), ARGIN(PMC *externs))
+{
+    ASSERT_ARGS(Parrot_thaw_with_externs)
+
+    PMC        *result;
+    PMC * const info = Parrot_pmc_new(interp, enum_class_ImageIOThaw);
+
+    /* see Parrot_thaw */
+    Parrot_block_GC_mark(interp);
+    Parrot_block_GC_sweep(interp);
+
+    SETATTR_ImageIOThaw_externs(interp, info, externs);
+    VTABLE_set_string_native(interp, info, image);
+    result = VTABLE_get_pmc(interp, info);
+
+    Parrot_unblock_GC_mark(interp);
+    Parrot_unblock_GC_sweep(interp);
+
+    return result;
+}
+
 /*
 
 =item C<PMC* Parrot_thaw_pbc(PARROT_INTERP, PackFile_ConstTable *ct, const
@@ -17,9 +17,29 @@ Functions in this file represent behaviors for different PackFile segments.
 
 #include "parrot/parrot.h"
 #include "pf_private.h"
+#include "parrot/runcore_jit.h"
 #include "pmc/pmc_parrotlibrary.h"
 #include "segments.str"
 
+/* The op tables of unpacked segments are kept once per process for each
+ * distinct op mapping, and never change. Every segment using them holds a
+ * reference. */
+struct PackFile_OpTables {
+    PackFile_OpTables           *next;      /* next tables in the same bucket */
+    UINTVAL                      hash;
+    UINTVAL                      refs;
+    PackFile_ByteCode_OpMapping  mapping;   /* the op mapping they are built from */
+    size_t                       op_count;
+    op_func_t                   *op_func_table;
+    op_info_t                  **op_info_table;
+};
+
+#define OP_TABLES_BUCKETS 64
+
+static PackFile_OpTables *op_tables_cache[OP_TABLES_BUCKETS];
+static Parrot_mutex       op_tables_lock;
+static int                op_tables_lock_ready;
+
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
@@ -70,6 +90,13 @@ PARROT_CANNOT_RETURN_NULL
 static PackFile_Segment * const_new(PARROT_INTERP)
         __attribute__nonnull__(1);
 
+static void copy_op_mapping(
+    ARGOUT(PackFile_ByteCode_OpMapping *dest),
+    ARGIN(const PackFile_ByteCode_OpMapping *src))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*dest);
+
 static void default_destroy(PARROT_INTERP,
     ARGFREE_NOTNULL(PackFile_Segment *self))
         __attribute__nonnull__(1)
@@ -146,6 +173,33 @@ static const opcode_t * directory_unpack(PARROT_INTERP,
         __attribute__nonnull__(3)
         FUNC_MODIFIES(*segp);
 
+PARROT_WARN_UNUSED_RESULT
+static int fill_op_tables(
+    ARGIN(const PackFile_ByteCode_OpMapping *mapping),
+    ARGOUT(op_func_t *func_table),
+    ARGOUT(op_info_t **info_table))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*func_table)
+        FUNC_MODIFIES(*info_table);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static PackFile_OpTables * find_op_tables(
+    ARGIN(const PackFile_ByteCode_OpMapping *mapping),
+    UINTVAL hash)
+        __attribute__nonnull__(1);
+
+static void free_op_tables(ARGFREE_NOTNULL(PackFile_OpTables *tables))
+        __attribute__nonnull__(1);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_PURE_FUNCTION
+static UINTVAL hash_op_mapping(
+    ARGIN(const PackFile_ByteCode_OpMapping *mapping))
+        __attribute__nonnull__(1);
+
 static void make_code_pointers(ARGMOD(PackFile_Segment *seg))
         __attribute__nonnull__(1)
         FUNC_MODIFIES(*seg);
@@ -200,6 +254,10 @@ static const opcode_t * pf_debug_unpack(PARROT_INTERP,
         __attribute__nonnull__(3)
         FUNC_MODIFIES(*self);
 
+static void release_op_tables(ARGMOD(PackFile_ByteCode *byte_code))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*byte_code);
+
 static void segment_init(
     ARGOUT(PackFile_Segment *self),
     ARGIN(PackFile *pf),
@@ -209,6 +267,12 @@ static void segment_init(
         __attribute__nonnull__(3)
         FUNC_MODIFIES(*self);
 
+static void share_op_tables(PARROT_INTERP,
+    ARGMOD(PackFile_ByteCode *byte_code))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*byte_code);
+
 static void sort_segs(ARGMOD(PackFile_Directory *dir))
         __attribute__nonnull__(1)
         FUNC_MODIFIES(*dir);
@@ -232,6 +296,9 @@ static void sort_segs(ARGMOD(PackFile_Directory *dir))
     , PARROT_ASSERT_ARG(self))
 #define ASSERT_ARGS_const_new __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp))
+#define ASSERT_ARGS_copy_op_mapping __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(dest) \
+    , PARROT_ASSERT_ARG(src))
 #define ASSERT_ARGS_default_destroy __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(self))
@@ -266,6 +333,16 @@ static void sort_segs(ARGMOD(PackFile_Directory *dir))
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(segp) \
     , PARROT_ASSERT_ARG(cursor))
+#define ASSERT_ARGS_fill_op_tables __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(mapping) \
+    , PARROT_ASSERT_ARG(func_table) \
+    , PARROT_ASSERT_ARG(info_table))
+#define ASSERT_ARGS_find_op_tables __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(mapping))
+#define ASSERT_ARGS_free_op_tables __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(tables))
+#define ASSERT_ARGS_hash_op_mapping __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(mapping))
 #define ASSERT_ARGS_make_code_pointers __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(seg))
 #define ASSERT_ARGS_PackFile_Constant_unpack_pmc __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
@@ -290,10 +367,15 @@ static void sort_segs(ARGMOD(PackFile_Directory *dir))
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(self) \
     , PARROT_ASSERT_ARG(cursor))
+#define ASSERT_ARGS_release_op_tables __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(byte_code))
 #define ASSERT_ARGS_segment_init __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(self) \
     , PARROT_ASSERT_ARG(pf) \
     , PARROT_ASSERT_ARG(name))
+#define ASSERT_ARGS_share_op_tables __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(byte_code))
 #define ASSERT_ARGS_sort_segs __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(dir))
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
@@ -1698,10 +1780,14 @@ byte_code_destroy(PARROT_INTERP, ARGMOD(PackFile_Segment *self))
     ASSERT_ARGS(byte_code_destroy)
     PackFile_ByteCode * const byte_code = (PackFile_ByteCode *)self;
 
-    if (byte_code->op_func_table)
-        mem_gc_free(interp, byte_code->op_func_table);
-    if (byte_code->op_info_table)
-        mem_gc_free(interp, byte_code->op_info_table);
+    if (byte_code->op_tables)
+        release_op_tables(byte_code);
+    else {
+        if (byte_code->op_func_table)
+            mem_gc_free(interp, byte_code->op_func_table);
+        if (byte_code->op_info_table)
+            mem_gc_free(interp, byte_code->op_info_table);
+    }
     if (byte_code->op_mapping.libs) {
         const opcode_t n_libs = byte_code->op_mapping.n_libs;
         opcode_t i;
@@ -1720,6 +1806,9 @@ byte_code_destroy(PARROT_INTERP, ARGMOD(PackFile_Segment *self))
     if (byte_code->annotations)
         PackFile_Annotations_destroy(interp, (PackFile_Segment *)byte_code->annotations);
 
+    if (byte_code->jit)
+        Parrot_jit_free_segment(interp, byte_code);
+
     byte_code->annotations     = NULL;
     byte_code->const_table     = NULL;
     byte_code->debugs          = NULL;
@@ -1875,11 +1964,6 @@ byte_code_unpack(PARROT_INTERP, ARGMOD(PackFile_Segment *self), ARGIN(const opco
                                         byte_code->n_libdeps, STRING *);
 
     byte_code->op_count          = PF_fetch_opcode(self->pf, &cursor);
-    byte_code->op_func_table     = mem_gc_allocate_n_zeroed_typed(interp,
-                                        byte_code->op_count, op_func_t);
-    byte_code->op_info_table     = mem_gc_allocate_n_zeroed_typed(interp,
-                                        byte_code->op_count, op_info_t *);
-
 
     byte_code->op_mapping.n_libs = PF_fetch_opcode(self->pf, &cursor);
     byte_code->op_mapping.libs   = mem_gc_allocate_n_zeroed_typed(interp,
@@ -1961,14 +2045,8 @@ byte_code_unpack(PARROT_INTERP, ARGMOD(PackFile_Segment *self), ARGIN(const opco
                         " Found %d, expected 0 to %d",
                         entry->lib->name, idx, byte_code->op_count - 1);
 
-                if (byte_code->op_func_table[idx])
-                    Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
-                        "duplicate entries in optable");
-
-                entry->table_ops[j]           = idx;
-                entry->lib_ops[j]             = op;
-                byte_code->op_func_table[idx] = entry->lib->op_func_table[op];
-                byte_code->op_info_table[idx] = &entry->lib->op_info_table[op];
+                entry->table_ops[j] = idx;
+                entry->lib_ops[j]   = op;
             }
         }
     }
@@ -1978,11 +2056,335 @@ byte_code_unpack(PARROT_INTERP, ARGMOD(PackFile_Segment *self), ARGIN(const opco
             "wrong number of ops decoded for optable. Decoded %d, but expected %d",
             total_ops, byte_code->op_count);
 
+    share_op_tables(interp, byte_code);
+
     return cursor;
 }
 
 /*
 
+=item C<void Parrot_pf_init_op_tables_cache(void)>
+
+Prepares the cache of op tables shared between unpacked segments. Called once,
+for the first interpreter.
+
+=cut
+
+*/
+
+void
+Parrot_pf_init_op_tables_cache(void)
+{
+    ASSERT_ARGS(Parrot_pf_init_op_tables_cache)
+
+    if (!op_tables_lock_ready) {
+        MUTEX_INIT(op_tables_lock);
+        op_tables_lock_ready = 1;
+    }
+}
+
+/*
+
+=item C<static void share_op_tables(PARROT_INTERP, PackFile_ByteCode
+*byte_code)>
+
+Gives C<byte_code> the op tables of its op mapping, as just unpacked. They are
+looked up in the cache by the mapping itself, and only built and added to the
+cache if there are none yet.
+
+=cut
+
+*/
+
+static void
+share_op_tables(PARROT_INTERP, ARGMOD(PackFile_ByteCode *byte_code))
+{
+    ASSERT_ARGS(share_op_tables)
+    const size_t       op_count = byte_code->op_count;
+    PackFile_OpTables *tables, *cached;
+    UINTVAL            hash;
+
+    if (!op_tables_lock_ready || !op_count) {
+        byte_code->op_func_table = mem_gc_allocate_n_zeroed_typed(interp,
+                                        op_count, op_func_t);
+        byte_code->op_info_table = mem_gc_allocate_n_zeroed_typed(interp,
+                                        op_count, op_info_t *);
+
+        if (!fill_op_tables(&byte_code->op_mapping,
+                byte_code->op_func_table, byte_code->op_info_table))
+            Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+                "duplicate entries in optable");
+        return;
+    }
+
+    hash = hash_op_mapping(&byte_code->op_mapping);
+
+    LOCK(op_tables_lock);
+    tables = find_op_tables(&byte_code->op_mapping, hash);
+    if (tables)
+        ++tables->refs;
+    UNLOCK(op_tables_lock);
+
+    if (!tables) {
+        tables                = mem_internal_allocate_zeroed_typed(PackFile_OpTables);
+        tables->hash          = hash;
+        tables->op_count      = op_count;
+        tables->op_func_table = mem_internal_allocate_n_zeroed_typed(op_count, op_func_t);
+        tables->op_info_table = mem_internal_allocate_n_zeroed_typed(op_count, op_info_t *);
+        copy_op_mapping(&tables->mapping, &byte_code->op_mapping);
+
+        if (!fill_op_tables(&tables->mapping,
+                tables->op_func_table, tables->op_info_table)) {
+            free_op_tables(tables);
+            Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+                "duplicate entries in optable");
+        }
+
+        /* another thread may have built the same tables meanwhile */
+        LOCK(op_tables_lock);
+        cached = find_op_tables(&byte_code->op_mapping, hash);
+        if (cached) {
+            ++cached->refs;
+            UNLOCK(op_tables_lock);
+            free_op_tables(tables);
+            tables = cached;
+        }
+        else {
+            tables->refs = 1;
+            tables->next = op_tables_cache[hash % OP_TABLES_BUCKETS];
+            op_tables_cache[hash % OP_TABLES_BUCKETS] = tables;
+            UNLOCK(op_tables_lock);
+        }
+    }
+
+    byte_code->op_tables     = tables;
+    byte_code->op_func_table = tables->op_func_table;
+    byte_code->op_info_table = tables->op_info_table;
+}
+
+/*
+
+=item C<static int fill_op_tables(const PackFile_ByteCode_OpMapping *mapping,
+op_func_t *func_table, op_info_t **info_table)>
+
+Fills the zeroed op tables C<func_table> and C<info_table> from the ops of
+C<mapping>, whose indices are already known to be in range. Returns FALSE if
+an index is mapped twice.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+fill_op_tables(ARGIN(const PackFile_ByteCode_OpMapping *mapping),
+        ARGOUT(op_func_t *func_table), ARGOUT(op_info_t **info_table))
+{
+    ASSERT_ARGS(fill_op_tables)
+    opcode_t i;
+
+    for (i = 0; i < mapping->n_libs; i++) {
+        const PackFile_ByteCode_OpMappingEntry * const entry = &mapping->libs[i];
+        opcode_t j;
+
+        for (j = 0; j < entry->n_ops; j++) {
+            const opcode_t idx = entry->table_ops[j];
+            const opcode_t op  = entry->lib_ops[j];
+
+            if (func_table[idx])
+                return 0;
+
+            func_table[idx] = entry->lib->op_func_table[op];
+            info_table[idx] = &entry->lib->op_info_table[op];
+        }
+    }
+
+    return 1;
+}
+
+/*
+
+=item C<static UINTVAL hash_op_mapping(const PackFile_ByteCode_OpMapping
+*mapping)>
+
+Hashes the names and versions of the op libraries in C<mapping> and the ops it
+maps.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_PURE_FUNCTION
+static UINTVAL
+hash_op_mapping(ARGIN(const PackFile_ByteCode_OpMapping *mapping))
+{
+    ASSERT_ARGS(hash_op_mapping)
+    UINTVAL  hash = mapping->n_libs;
+    opcode_t i;
+
+    for (i = 0; i < mapping->n_libs; i++) {
+        const PackFile_ByteCode_OpMappingEntry * const entry = &mapping->libs[i];
+        const char *name;
+        opcode_t    j;
+
+        for (name = entry->lib->name; *name; ++name)
+            hash = hash * 33 + (unsigned char)*name;
+
+        hash = hash * 33 + entry->lib->bc_major_version;
+        hash = hash * 33 + entry->lib->bc_minor_version;
+
+        for (j = 0; j < entry->n_ops; j++)
+            hash = (hash * 33 + entry->table_ops[j]) * 33 + entry->lib_ops[j];
+    }
+
+    return hash;
+}
+
+/*
+
+=item C<static PackFile_OpTables * find_op_tables(const
+PackFile_ByteCode_OpMapping *mapping, UINTVAL hash)>
+
+Returns the cached op tables built from the same op mapping as C<mapping>,
+whose hash is C<hash>, or NULL. The caller holds the lock of the cache.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static PackFile_OpTables *
+find_op_tables(ARGIN(const PackFile_ByteCode_OpMapping *mapping), UINTVAL hash)
+{
+    ASSERT_ARGS(find_op_tables)
+    PackFile_OpTables *tables;
+
+    for (tables = op_tables_cache[hash % OP_TABLES_BUCKETS]; tables; tables = tables->next) {
+        opcode_t i;
+
+        if (tables->hash != hash || tables->mapping.n_libs != mapping->n_libs)
+            continue;
+
+        for (i = 0; i < mapping->n_libs; i++) {
+            const PackFile_ByteCode_OpMappingEntry * const a = &tables->mapping.libs[i];
+            const PackFile_ByteCode_OpMappingEntry * const b = &mapping->libs[i];
+
+            if (!STREQ(a->lib->name, b->lib->name)
+            ||  a->lib->bc_major_version != b->lib->bc_major_version
+            ||  a->lib->bc_minor_version != b->lib->bc_minor_version
+            ||  a->n_ops != b->n_ops
+            ||  memcmp(a->table_ops, b->table_ops, a->n_ops * sizeof (opcode_t))
+            ||  memcmp(a->lib_ops, b->lib_ops, a->n_ops * sizeof (opcode_t)))
+                break;
+        }
+
+        if (i == mapping->n_libs)
+            return tables;
+    }
+
+    return NULL;
+}
+
+/*
+
+=item C<static void copy_op_mapping(PackFile_ByteCode_OpMapping *dest, const
+PackFile_ByteCode_OpMapping *src)>
+
+Copies the op mapping C<src> into C<dest>, in memory not owned by any
+interpreter.
+
+=cut
+
+*/
+
+static void
+copy_op_mapping(ARGOUT(PackFile_ByteCode_OpMapping *dest),
+        ARGIN(const PackFile_ByteCode_OpMapping *src))
+{
+    ASSERT_ARGS(copy_op_mapping)
+    opcode_t i;
+
+    dest->n_libs = src->n_libs;
+    dest->libs   = mem_internal_allocate_n_zeroed_typed(src->n_libs,
+                        PackFile_ByteCode_OpMappingEntry);
+
+    for (i = 0; i < src->n_libs; i++) {
+        PackFile_ByteCode_OpMappingEntry * const entry = &dest->libs[i];
+
+        entry->lib       = src->libs[i].lib;
+        entry->n_ops     = src->libs[i].n_ops;
+        entry->table_ops = mem_internal_allocate_n_zeroed_typed(entry->n_ops, opcode_t);
+        entry->lib_ops   = mem_internal_allocate_n_zeroed_typed(entry->n_ops, opcode_t);
+        mem_copy_n_typed(entry->table_ops, src->libs[i].table_ops, entry->n_ops, opcode_t);
+        mem_copy_n_typed(entry->lib_ops, src->libs[i].lib_ops, entry->n_ops, opcode_t);
+    }
+}
+
+/*
+
+=item C<static void free_op_tables(PackFile_OpTables *tables)>
+
+Frees C<tables>, which are not in the cache.
+
+=cut
+
+*/
+
+static void
+free_op_tables(ARGFREE_NOTNULL(PackFile_OpTables *tables))
+{
+    ASSERT_ARGS(free_op_tables)
+    opcode_t i;
+
+    for (i = 0; i < tables->mapping.n_libs; i++) {
+        mem_internal_free(tables->mapping.libs[i].table_ops);
+        mem_internal_free(tables->mapping.libs[i].lib_ops);
+    }
+
+    mem_internal_free(tables->mapping.libs);
+    mem_internal_free(tables->op_func_table);
+    mem_internal_free(tables->op_info_table);
+    mem_internal_free(tables);
+}
+
+/*
+
+=item C<static void release_op_tables(PackFile_ByteCode *byte_code)>
+
+Drops the reference of C<byte_code> to its shared op tables, freeing them when
+it was the last one.
+
+=cut
+
+*/
+
+static void
+release_op_tables(ARGMOD(PackFile_ByteCode *byte_code))
+{
+    ASSERT_ARGS(release_op_tables)
+    PackFile_OpTables * const tables = byte_code->op_tables;
+
+    LOCK(op_tables_lock);
+
+    if (--tables->refs == 0) {
+        PackFile_OpTables **link = &op_tables_cache[tables->hash % OP_TABLES_BUCKETS];
+
+        while (*link != tables)
+            link = &(*link)->next;
+        *link = tables->next;
+
+        free_op_tables(tables);
+    }
+
+    UNLOCK(op_tables_lock);
+
+    byte_code->op_tables = NULL;
+}
+
+/*
+
 =back
 
 =head2 Debug Info
@@ -2007,6 +2409,10 @@ pf_debug_destroy(PARROT_INTERP, ARGMOD(PackFile_Segment *self))
     mem_gc_free(interp, debug->mappings);
     debug->mappings     = NULL;
     debug->num_mappings = 0;
+
+    mem_gc_free(interp, debug->op_offsets);
+    debug->op_offsets      = NULL;
+    debug->op_offsets_code = NULL;
 }
 
 
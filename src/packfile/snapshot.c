@@ -0,0 +1,1654 @@
+/*
+Copyright (C) 2012, Parrot Foundation.
+This program is free software. It is subject to the same license as
+Parrot itself.
+
+=head1 NAME
+
+src/packfile/snapshot.c - Interpreter snapshots
+
+=head1 DESCRIPTION
+
+A snapshot records an interpreter after a program's C<:init> subs, and the
+C<:load> subs of everything they loaded, have run, so that later runs of the
+program can start from that state instead of repeating the work.
+
+After a header giving the word size and byte order, the file holds a series of
+buffers:
+
+=over 4
+
+=item * the manifest, frozen with C<Parrot_freeze>, which names everything that
+must exist before the rest can be restored: HLLs, namespaces, PMC types and
+classes in type number order, dynamic libraries and bytecode files;
+
+=item * each bytecode file, packed as it stands after initialization, so that
+the flags which stop C<:init> and C<:load> subs from running twice are kept;
+
+=item * the state, frozen with C<Parrot_freeze_with_externs>: what classes,
+namespaces, the compiler registry, HLL type maps and the library search paths
+hold.
+
+=back
+
+Restoring recreates what the manifest names in order, so that every type gets
+the number it had, unpacks the bytecode in place from the file, which is
+mapped where the platform allows it, and thaws the state. Namespaces, classes,
+bytecode constants, libraries and the interpreter globals exist on both sides,
+so the state refers to them by position in a list both sides build the same
+way, and only holds what initialization created.
+
+A snapshot can only be restored by the build of Parrot that wrote it, into an
+interpreter which has not loaded anything yet. Closures and code compiled at
+run time cannot be kept, nor can PMCs which do not freeze, such as
+filehandles; writing a snapshot which refers to them fails.
+
+=head2 Functions
+
+=over 4
+
+=cut
+
+*/
+
+#include "pf_private.h"
+#include "pmc/pmc_class.h"
+#include "pmc/pmc_namespace.h"
+#include "pmc/pmc_packfileview.h"
+#include "pmc/pmc_sub.h"
+#include "snapshot.str"
+
+/* HEADERIZER HFILE: include/parrot/packfile.h */
+
+/* the magic is followed by sizeof (opcode_t), PARROT_BIGENDIAN and padding */
+#define SNAPSHOT_MAGIC        "\376PARSNAP\r\n\032\n"
+#define SNAPSHOT_MAGIC_LENGTH 12
+#define SNAPSHOT_HEADER_SIZE  16
+
+/* slots of the manifest */
+typedef enum {
+    MANIFEST_version = 0,   /* PARROT_VERSION of the writer */
+    MANIFEST_core_types,    /* enum_class_core_max of the writer */
+    MANIFEST_hlls,          /* HLL names, by id */
+    MANIFEST_namespaces,    /* paths from the root namespace */
+    MANIFEST_type_names,    /* whoami of each type after the core ones */
+    MANIFEST_type_classes,  /* namespace index of each class type, or -1 */
+    MANIFEST_class_types,   /* type of each class PMC itself, or 0 */
+    MANIFEST_proxy_nses,    /* namespace index of each PMCProxy class */
+    MANIFEST_proxy_types,   /* name of the type each PMCProxy stands for */
+    MANIFEST_compilers,     /* compilers registered before initialization */
+    MANIFEST_libraries,     /* keys of the loaded dynamic libraries */
+    MANIFEST_packfiles,     /* path, loaded bytecode key and called tags */
+    MANIFEST_MAX
+} snapshot_manifest_enum;
+
+/* slots of the state */
+typedef enum {
+    STATE_global_nses = 0,  /* namespace, name and value of each global */
+    STATE_global_names,
+    STATE_global_values,
+    STATE_classes,          /* CLASS_* slots of each class */
+    STATE_compilers,        /* compilers registered by initialization */
+    STATE_typemaps,         /* HLL id, core type, HLL type triples */
+    STATE_pbc_libs,         /* the bytecode libraries loaded */
+    STATE_lib_paths,        /* the library search path arrays */
+    STATE_MAX
+} snapshot_state_enum;
+
+/* slots of a class in the state */
+typedef enum {
+    CLASS_parents = 0,
+    CLASS_roles,
+    CLASS_attrib_metadata,
+    CLASS_methods,
+    CLASS_vtable_overrides,
+    CLASS_resolve_method,
+    CLASS_instantiated,
+    CLASS_MAX
+} snapshot_class_enum;
+
+/* slots of a bytecode file in the manifest */
+typedef enum {
+    PACKFILE_path = 0,
+    PACKFILE_key,           /* key in IGLOBALS_LOADED_PBCS, or empty */
+    PACKFILE_tags,          /* the tags marked initialized, or null */
+    PACKFILE_MAX
+} snapshot_packfile_enum;
+
+/* the PMCs which both sides have, in the order both sides list them */
+typedef struct snapshot_t {
+    PMC *namespaces;        /* NameSpaces, the root namespace first */
+    PMC *classes;           /* classes, by type number */
+    PMC *proxies;           /* PMCProxy classes */
+    PMC *compilers;         /* compilers registered before initialization */
+    PMC *libraries;         /* ParrotLibrary PMCs */
+    PMC *packfiles;         /* PackfileViews, the program first */
+} snapshot_t;
+
+/* HEADERIZER BEGIN: static */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC * build_externs(PARROT_INTERP, ARGIN(const snapshot_t *snap))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static void check_manifest(PARROT_INTERP,
+    ARGIN(STRING *path),
+    ARGIN(PMC *manifest))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+static void check_seen(PARROT_INTERP, ARGIN(PMC *seen), ARGIN(PMC *externs))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+static void collect_manifest(PARROT_INTERP,
+    ARGIN(PMC *pbc),
+    ARGMOD(PMC *manifest),
+    ARGMOD(PMC *state),
+    ARGMOD(snapshot_t *snap))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        __attribute__nonnull__(5)
+        FUNC_MODIFIES(*manifest)
+        FUNC_MODIFIES(*state)
+        FUNC_MODIFIES(*snap);
+
+static void collect_state(PARROT_INTERP,
+    ARGMOD(PMC *state),
+    ARGIN(snapshot_t *snap))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*state);
+
+static void copy_hash(PARROT_INTERP, ARGIN(PMC *from), ARGMOD(PMC *to))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*to);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC * describe_packfile(PARROT_INTERP,
+    ARGIN(PMC *view),
+    ARGIN(STRING *key))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+PARROT_WARN_UNUSED_RESULT
+static int has_captured_lexicals(PARROT_INTERP, ARGIN(PMC *sub_pmc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+PARROT_WARN_UNUSED_RESULT
+static int is_builtin(PARROT_INTERP, ARGIN(PMC *var))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+PARROT_WARN_UNUSED_RESULT
+static int is_class_type(PARROT_INTERP,
+    ARGIN_NULLOK(PMC *_class),
+    INTVAL type)
+        __attribute__nonnull__(1);
+
+static void list_hash(PARROT_INTERP,
+    ARGIN(PMC *hash),
+    ARGMOD(PMC *keys),
+    ARGMOD(PMC *values))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        FUNC_MODIFIES(*keys)
+        FUNC_MODIFIES(*values);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static const char * map_snapshot(PARROT_INTERP,
+    ARGIN(STRING *path),
+    ARGOUT(size_t *size))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*size);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static STRING * next_buffer(PARROT_INTERP,
+    ARGIN(STRING *path),
+    ARGMOD(const opcode_t **cursor),
+    ARGIN(const opcode_t *end))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        FUNC_MODIFIES(*cursor);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static STRING * packfile_key(PARROT_INTERP,
+    ARGIN(PMC *pbc),
+    ARGIN(PMC *keys),
+    ARGIN(PMC *views))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC * restore_packfile(PARROT_INTERP,
+    ARGIN(STRING *image),
+    ARGIN(PMC *entry),
+    ARGIN_NULLOK(PMC *view))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+static void restore_proxies(PARROT_INTERP,
+    ARGIN(PMC *manifest),
+    ARGMOD(snapshot_t *snap))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*snap);
+
+static void restore_state(PARROT_INTERP,
+    ARGIN(PMC *state),
+    ARGIN(snapshot_t *snap))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+static void restore_types(PARROT_INTERP,
+    ARGIN(PMC *manifest),
+    ARGMOD(snapshot_t *snap))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*snap);
+
+static void walk_namespace(PARROT_INTERP,
+    ARGIN(PMC *ns),
+    ARGIN(PMC *path),
+    ARGMOD(PMC *paths),
+    ARGMOD(Hash *ns_ids),
+    ARGMOD(snapshot_t *snap),
+    ARGMOD(PMC *state))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        __attribute__nonnull__(5)
+        __attribute__nonnull__(6)
+        __attribute__nonnull__(7)
+        FUNC_MODIFIES(*paths)
+        FUNC_MODIFIES(*ns_ids)
+        FUNC_MODIFIES(*snap)
+        FUNC_MODIFIES(*state);
+
+static void write_snapshot_file(PARROT_INTERP,
+    ARGIN(STRING *path),
+    ARGIN(PMC *images))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+#define ASSERT_ARGS_build_externs __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(snap))
+#define ASSERT_ARGS_check_manifest __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(path) \
+    , PARROT_ASSERT_ARG(manifest))
+#define ASSERT_ARGS_check_seen __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(seen) \
+    , PARROT_ASSERT_ARG(externs))
+#define ASSERT_ARGS_collect_manifest __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(pbc) \
+    , PARROT_ASSERT_ARG(manifest) \
+    , PARROT_ASSERT_ARG(state) \
+    , PARROT_ASSERT_ARG(snap))
+#define ASSERT_ARGS_collect_state __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(state) \
+    , PARROT_ASSERT_ARG(snap))
+#define ASSERT_ARGS_copy_hash __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(from) \
+    , PARROT_ASSERT_ARG(to))
+#define ASSERT_ARGS_describe_packfile __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(view) \
+    , PARROT_ASSERT_ARG(key))
+#define ASSERT_ARGS_has_captured_lexicals __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(sub_pmc))
+#define ASSERT_ARGS_is_builtin __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(var))
+#define ASSERT_ARGS_is_class_type __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp))
+#define ASSERT_ARGS_list_hash __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(hash) \
+    , PARROT_ASSERT_ARG(keys) \
+    , PARROT_ASSERT_ARG(values))
+#define ASSERT_ARGS_map_snapshot __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(path) \
+    , PARROT_ASSERT_ARG(size))
+#define ASSERT_ARGS_next_buffer __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(path) \
+    , PARROT_ASSERT_ARG(cursor) \
+    , PARROT_ASSERT_ARG(end))
+#define ASSERT_ARGS_packfile_key __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(pbc) \
+    , PARROT_ASSERT_ARG(keys) \
+    , PARROT_ASSERT_ARG(views))
+#define ASSERT_ARGS_restore_packfile __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(image) \
+    , PARROT_ASSERT_ARG(entry))
+#define ASSERT_ARGS_restore_proxies __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(manifest) \
+    , PARROT_ASSERT_ARG(snap))
+#define ASSERT_ARGS_restore_state __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(state) \
+    , PARROT_ASSERT_ARG(snap))
+#define ASSERT_ARGS_restore_types __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(manifest) \
+    , PARROT_ASSERT_ARG(snap))
+#define ASSERT_ARGS_walk_namespace __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(ns) \
+    , PARROT_ASSERT_ARG(path) \
+    , PARROT_ASSERT_ARG(paths) \
+    , PARROT_ASSERT_ARG(ns_ids) \
+    , PARROT_ASSERT_ARG(snap) \
+    , PARROT_ASSERT_ARG(state))
+#define ASSERT_ARGS_write_snapshot_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(path) \
+    , PARROT_ASSERT_ARG(images))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: static */
+
+/*
+
+=item C<void Parrot_pf_write_snapshot(PARROT_INTERP, PMC *pbc, STRING *path)>
+
+Run the C<:init> subs of the program C<pbc> unless that was done already, but
+not its C<:main> sub, then write a snapshot of the interpreter to the file
+C<path>. Throws an exception, without writing anything, if the interpreter
+holds anything a snapshot cannot keep.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+void
+Parrot_pf_write_snapshot(PARROT_INTERP, ARGIN(PMC *pbc), ARGIN(STRING *path))
+{
+    ASSERT_ARGS(Parrot_pf_write_snapshot)
+    PackFile * const pf       = (PackFile *)VTABLE_get_pointer(interp, pbc);
+    PMC      * const images   = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC      * const manifest = Parrot_pmc_new_init_int(interp,
+                                    enum_class_FixedPMCArray, MANIFEST_MAX);
+    PMC      * const state    = Parrot_pmc_new_init_int(interp,
+                                    enum_class_FixedPMCArray, STATE_MAX);
+    STRING   * const init     = CONST_STRING(interp, "init");
+    STRING   * const is_init  = CONST_STRING(interp, "is_initialized");
+    STRING   * const mark     = CONST_STRING(interp, "mark_initialized");
+    PMC      *compiler_names, *externs, *seen;
+    snapshot_t snap;
+    INTVAL     i, n, initialized;
+
+    if (!pf || !pf->cur_cs)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_UNEXPECTED_NULL,
+            "Could not get packfile.");
+
+    snap.namespaces = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.classes    = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.proxies    = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.compilers  = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.libraries  = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.packfiles  = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+
+    /* what is registered now is there again when the snapshot is read */
+    compiler_names = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    list_hash(interp, VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+            IGLOBALS_COMPREG_HASH), compiler_names, snap.compilers);
+
+    Parrot_pcc_invoke_method_from_c_args(interp, pbc, is_init, "S->I", init, &initialized);
+    if (!initialized) {
+        PMC * const current_pf = Parrot_pf_get_current_packfile(interp);
+
+        Parrot_pf_set_current_packfile(interp, pbc);
+        Parrot_pf_prepare_packfile_init(interp, pbc);
+        Parrot_pcc_invoke_method_from_c_args(interp, pbc, mark, "S->", init);
+
+        if (!PMC_IS_NULL(current_pf))
+            Parrot_pf_set_current_packfile(interp, current_pf);
+    }
+
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_compilers, compiler_names);
+    collect_manifest(interp, pbc, manifest, state, &snap);
+    collect_state(interp, state, &snap);
+
+    externs = build_externs(interp, &snap);
+
+    VTABLE_push_string(interp, images, Parrot_freeze(interp, manifest));
+
+    n = VTABLE_elements(interp, snap.packfiles);
+    for (i = 0; i < n; ++i) {
+        PMC * const view = VTABLE_get_pmc_keyed_int(interp, snap.packfiles, i);
+        VTABLE_push_string(interp, images, Parrot_pf_serialize(interp,
+                (PackFile *)VTABLE_get_pointer(interp, view)));
+    }
+
+    VTABLE_push_string(interp, images,
+            Parrot_freeze_with_externs(interp, state, externs, &seen));
+    check_seen(interp, seen, externs);
+
+    write_snapshot_file(interp, path, images);
+}
+
+/*
+
+=item C<PMC * Parrot_pf_read_snapshot(PARROT_INTERP, STRING *path, PMC *view)>
+
+Restore the snapshot in the file C<path> into the interpreter, which must not
+have loaded any libraries or bytecode yet, and return the program, ready to be
+run: its C<:init> subs have already run and do not run again. The program is
+put in the empty PackfileView C<view> if one is given.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_CANNOT_RETURN_NULL
+PMC *
+Parrot_pf_read_snapshot(PARROT_INTERP, ARGIN(STRING *path), ARGIN_NULLOK(PMC *view))
+{
+    ASSERT_ARGS(Parrot_pf_read_snapshot)
+    size_t          size;
+    const char     *bytes;
+    const opcode_t *cursor, *end;
+    PMC            *manifest, *packfiles, *externs, *state;
+    snapshot_t      snap;
+    INTVAL          i, n;
+
+    if (interp->n_vtable_max != enum_class_core_max)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+            "A snapshot must be read before any library is loaded");
+
+    bytes  = map_snapshot(interp, path, &size);
+    cursor = (const opcode_t *)(bytes + SNAPSHOT_HEADER_SIZE);
+    end    = (const opcode_t *)(bytes + size);
+
+    manifest = Parrot_thaw(interp, next_buffer(interp, path, &cursor, end));
+    check_manifest(interp, path, manifest);
+
+    snap.namespaces = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.classes    = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.proxies    = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.compilers  = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.libraries  = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    snap.packfiles  = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+
+    restore_types(interp, manifest, &snap);
+
+    /* unpack in place: the bytecode points into the file from now on */
+    packfiles = VTABLE_get_pmc_keyed_int(interp, manifest, MANIFEST_packfiles);
+    n         = VTABLE_elements(interp, packfiles);
+    for (i = 0; i < n; ++i) {
+        STRING * const image = next_buffer(interp, path, &cursor, end);
+        VTABLE_push_pmc(interp, snap.packfiles, restore_packfile(interp, image,
+                VTABLE_get_pmc_keyed_int(interp, packfiles, i), i ? PMCNULL : view));
+    }
+
+    restore_proxies(interp, manifest, &snap);
+
+    {
+        PMC * const names = VTABLE_get_pmc_keyed_int(interp, manifest,
+                                MANIFEST_compilers);
+        PMC * const compregs = VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+                                IGLOBALS_COMPREG_HASH);
+        n = VTABLE_elements(interp, names);
+        for (i = 0; i < n; ++i)
+            VTABLE_push_pmc(interp, snap.compilers, VTABLE_get_pmc_keyed_str(interp,
+                    compregs, VTABLE_get_string_keyed_int(interp, names, i)));
+    }
+
+    externs = build_externs(interp, &snap);
+    state   = Parrot_thaw_with_externs(interp,
+                    next_buffer(interp, path, &cursor, end), externs);
+
+    if (cursor != end)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "Snapshot '%Ss' has trailing data", path);
+
+    restore_state(interp, state, &snap);
+
+    return VTABLE_get_pmc_keyed_int(interp, snap.packfiles, 0);
+}
+
+/*
+
+=back
+
+=head2 Writing
+
+=over 4
+
+=item C<static void list_hash(PARROT_INTERP, PMC *hash, PMC *keys, PMC *values)>
+
+Append the keys of the string keyed C<hash> to the array C<keys> and its
+values to the array C<values>, in the order they were added.
+
+=cut
+
+*/
+
+static void
+list_hash(PARROT_INTERP, ARGIN(PMC *hash), ARGMOD(PMC *keys), ARGMOD(PMC *values))
+{
+    ASSERT_ARGS(list_hash)
+    const Hash * const h = (const Hash *)VTABLE_get_pointer(interp, hash);
+
+    parrot_hash_iterate_linear(h,
+        VTABLE_push_string(interp, keys, (STRING *)_bucket->key);
+        VTABLE_push_pmc(interp, values, (PMC *)_bucket->value););
+}
+
+/*
+
+=item C<static void walk_namespace(PARROT_INTERP, PMC *ns, PMC *path, PMC
+*paths, Hash *ns_ids, snapshot_t *snap, PMC *state)>
+
+Add C<ns>, at C<path> from the root namespace, and every namespace nested in
+it to the namespaces of C<snap> and their paths to C<paths>, numbering them in
+C<ns_ids>. The variables they hold are added to the globals of C<state>.
+
+A namespace stored in another one under a different name is an alias; only
+the one it is nested in walks it, and the others list it as a global. Subs
+written in C are left out, as registering their type installs them again.
+
+=cut
+
+*/
+
+static void
+walk_namespace(PARROT_INTERP, ARGIN(PMC *ns), ARGIN(PMC *path), ARGMOD(PMC *paths),
+        ARGMOD(Hash *ns_ids), ARGMOD(snapshot_t *snap), ARGMOD(PMC *state))
+{
+    ASSERT_ARGS(walk_namespace)
+    PMC * const global_nses   = VTABLE_get_pmc_keyed_int(interp, state,
+                                    STATE_global_nses);
+    PMC * const global_names  = VTABLE_get_pmc_keyed_int(interp, state,
+                                    STATE_global_names);
+    PMC * const global_values = VTABLE_get_pmc_keyed_int(interp, state,
+                                    STATE_global_values);
+    const Hash * const hash   = (const Hash *)VTABLE_get_pointer(interp, ns);
+
+    Parrot_hash_put(interp, ns_ids, ns,
+            (void *)(VTABLE_elements(interp, snap->namespaces) + 1));
+    VTABLE_push_pmc(interp, snap->namespaces, ns);
+    VTABLE_push_pmc(interp, paths, path);
+
+    parrot_hash_iterate_linear(hash,
+        STRING * const name  = (STRING *)_bucket->key;
+        PMC    * const child = VTABLE_get_pmc_keyed_str(interp, ns, name);
+        PMC    * const var   = (PMC *)VTABLE_get_pointer_keyed_str(interp, ns, name);
+        const int nested     = !PMC_IS_NULL(child)
+                            && child->vtable->base_type == enum_class_NameSpace
+                            && PARROT_NAMESPACE(child)->parent == ns;
+
+        if (nested) {
+            PMC * const child_path = VTABLE_clone(interp, path);
+            VTABLE_push_string(interp, child_path, name);
+            walk_namespace(interp, child, child_path, paths, ns_ids, snap, state);
+        }
+
+        if (!PMC_IS_NULL(var) && !(nested && var == child)
+        &&  !is_builtin(interp, var)) {
+            VTABLE_push_pmc(interp, global_nses, ns);
+            VTABLE_push_string(interp, global_names, name);
+            VTABLE_push_pmc(interp, global_values, var);
+        });
+}
+
+/*
+
+=item C<static int is_builtin(PARROT_INTERP, PMC *var)>
+
+Tell whether C<var> is a method written in C, or a multi sub made of nothing
+else.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+is_builtin(PARROT_INTERP, ARGIN(PMC *var))
+{
+    ASSERT_ARGS(is_builtin)
+
+    if (var->vtable->base_type == enum_class_NativePCCMethod)
+        return 1;
+
+    if (var->vtable->base_type == enum_class_MultiSub) {
+        const INTVAL n = VTABLE_elements(interp, var);
+        INTVAL       i;
+
+        for (i = 0; i < n; ++i)
+            if (!is_builtin(interp, VTABLE_get_pmc_keyed_int(interp, var, i)))
+                return 0;
+
+        return n > 0;
+    }
+
+    return 0;
+}
+
+/*
+
+=item C<static void collect_manifest(PARROT_INTERP, PMC *pbc, PMC *manifest, PMC
+*state, snapshot_t *snap)>
+
+Fill in the C<manifest> of the interpreter after initialization, and list the
+PMCs it names in C<snap>. The globals found on the way go to C<state>.
+
+=cut
+
+*/
+
+static void
+collect_manifest(PARROT_INTERP, ARGIN(PMC *pbc), ARGMOD(PMC *manifest),
+        ARGMOD(PMC *state), ARGMOD(snapshot_t *snap))
+{
+    ASSERT_ARGS(collect_manifest)
+    Hash * const ns_ids      = Parrot_hash_new_pointer_hash(interp);
+    PMC  * const hlls        = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC  * const paths       = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    PMC  * const type_names  = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC  * const type_nses   = Parrot_pmc_new(interp, enum_class_ResizableIntegerArray);
+    PMC  * const class_types = Parrot_pmc_new(interp, enum_class_ResizableIntegerArray);
+    PMC  * const proxy_nses  = Parrot_pmc_new(interp, enum_class_ResizableIntegerArray);
+    PMC  * const proxy_types = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC  * const libraries   = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC  * const packfiles   = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    PMC  * const loaded      = VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+                                    IGLOBALS_LOADED_PBCS);
+    PMC  * const loaded_keys = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC  * const loaded_pbcs = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    INTVAL i, n;
+
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_global_nses,
+            Parrot_pmc_new(interp, enum_class_ResizablePMCArray));
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_global_names,
+            Parrot_pmc_new(interp, enum_class_ResizableStringArray));
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_global_values,
+            Parrot_pmc_new(interp, enum_class_ResizablePMCArray));
+
+    n = VTABLE_elements(interp, interp->HLL_info);
+    for (i = 0; i < n; ++i)
+        VTABLE_push_string(interp, hlls, Parrot_hll_get_HLL_name(interp, i));
+
+    walk_namespace(interp, interp->root_namespace,
+            Parrot_pmc_new(interp, enum_class_ResizableStringArray),
+            paths, ns_ids, snap, state);
+
+    /* the PMCProxy classes made so far */
+    n = VTABLE_elements(interp, snap->namespaces);
+    for (i = 0; i < n; ++i) {
+        PMC * const ns     = VTABLE_get_pmc_keyed_int(interp, snap->namespaces, i);
+        PMC * const _class = VTABLE_get_class(interp, ns);
+
+        if (!PMC_IS_NULL(_class) && _class->vtable->base_type == enum_class_PMCProxy) {
+            VTABLE_push_integer(interp, proxy_nses, i);
+            VTABLE_push_string(interp, proxy_types,
+                    interp->vtables[PARROT_CLASS(_class)->id]->whoami);
+            VTABLE_push_pmc(interp, snap->proxies, _class);
+        }
+    }
+
+    /* every type after the core ones, dynpmc or class, in order */
+    for (i = enum_class_core_max; i < interp->n_vtable_max; ++i) {
+        const VTABLE * const vtable = interp->vtables[i];
+        PMC                 *_class;
+
+        if (!vtable)
+            Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+                "Cannot snapshot: PMC type %d was never registered", (int)i);
+
+        _class = vtable->pmc_class;
+        VTABLE_push_string(interp, type_names, vtable->whoami);
+
+        if (is_class_type(interp, _class, i)) {
+            const INTVAL ns_id = (INTVAL)Parrot_hash_get(interp, ns_ids,
+                                    PARROT_CLASS(_class)->_namespace);
+
+            if (!ns_id)
+                Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+                    "Cannot snapshot class '%Ss': its namespace is not reachable",
+                    vtable->whoami);
+
+            VTABLE_push_integer(interp, type_nses, ns_id - 1);
+            VTABLE_push_integer(interp, class_types, _class->vtable->base_type);
+            VTABLE_push_pmc(interp, snap->classes, _class);
+        }
+        else {
+            VTABLE_push_integer(interp, type_nses, -1);
+            VTABLE_push_integer(interp, class_types, 0);
+        }
+    }
+
+    Parrot_hash_destroy(interp, ns_ids);
+
+    list_hash(interp, VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+            IGLOBALS_DYN_LIBS), libraries, snap->libraries);
+
+    /* the program first, then the bytecode it loaded */
+    list_hash(interp, loaded, loaded_keys, loaded_pbcs);
+    VTABLE_push_pmc(interp, snap->packfiles, pbc);
+    VTABLE_push_pmc(interp, packfiles, describe_packfile(interp, pbc,
+            packfile_key(interp, pbc, loaded_keys, loaded_pbcs)));
+
+    n = VTABLE_elements(interp, loaded_pbcs);
+    for (i = 0; i < n; ++i) {
+        PMC * const view = VTABLE_get_pmc_keyed_int(interp, loaded_pbcs, i);
+
+        if (VTABLE_get_pointer(interp, view) != VTABLE_get_pointer(interp, pbc)) {
+            VTABLE_push_pmc(interp, snap->packfiles, view);
+            VTABLE_push_pmc(interp, packfiles, describe_packfile(interp, view,
+                    VTABLE_get_string_keyed_int(interp, loaded_keys, i)));
+        }
+    }
+
+    VTABLE_set_string_keyed_int(interp, manifest, MANIFEST_version,
+            Parrot_str_new_constant(interp, PARROT_VERSION));
+    VTABLE_set_integer_keyed_int(interp, manifest, MANIFEST_core_types,
+            enum_class_core_max);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_hlls, hlls);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_namespaces, paths);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_type_names, type_names);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_type_classes, type_nses);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_class_types, class_types);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_proxy_nses, proxy_nses);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_proxy_types, proxy_types);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_libraries, libraries);
+    VTABLE_set_pmc_keyed_int(interp, manifest, MANIFEST_packfiles, packfiles);
+}
+
+/*
+
+=item C<static int is_class_type(PARROT_INTERP, PMC *_class, INTVAL type)>
+
+Tell whether C<_class>, the class of PMC type C<type>, is a class that type
+was registered for, as opposed to a PMC type or a PMCProxy.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+is_class_type(PARROT_INTERP, ARGIN_NULLOK(PMC *_class), INTVAL type)
+{
+    ASSERT_ARGS(is_class_type)
+    STRING * const class_str = CONST_STRING(interp, "Class");
+
+    return !PMC_IS_NULL(_class)
+        && _class->vtable->base_type != enum_class_PMCProxy
+        && VTABLE_isa(interp, _class, class_str)
+        && PARROT_CLASS(_class)->id == type;
+}
+
+/*
+
+=item C<static STRING * packfile_key(PARROT_INTERP, PMC *pbc, PMC *keys, PMC
+*views)>
+
+Return the key C<pbc> is registered under among the loaded bytecode files,
+listed in C<keys> and C<views>, or an empty string.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static STRING *
+packfile_key(PARROT_INTERP, ARGIN(PMC *pbc), ARGIN(PMC *keys), ARGIN(PMC *views))
+{
+    ASSERT_ARGS(packfile_key)
+    const INTVAL n = VTABLE_elements(interp, views);
+    INTVAL       i;
+
+    for (i = 0; i < n; ++i) {
+        PMC * const view = VTABLE_get_pmc_keyed_int(interp, views, i);
+        if (VTABLE_get_pointer(interp, view) == VTABLE_get_pointer(interp, pbc))
+            return VTABLE_get_string_keyed_int(interp, keys, i);
+    }
+
+    return CONST_STRING(interp, "");
+}
+
+/*
+
+=item C<static PMC * describe_packfile(PARROT_INTERP, PMC *view, STRING *key)>
+
+Return the manifest entry for the bytecode file C<view>, registered among the
+loaded bytecode under C<key> if that is not empty.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC *
+describe_packfile(PARROT_INTERP, ARGIN(PMC *view), ARGIN(STRING *key))
+{
+    ASSERT_ARGS(describe_packfile)
+    PMC * const entry = Parrot_pmc_new_init_int(interp, enum_class_FixedPMCArray,
+                            PACKFILE_MAX);
+    STRING     *path  = CONST_STRING(interp, "");
+    PMC        *tags  = PMCNULL;
+
+    if (view->vtable->base_type == enum_class_PackfileView) {
+        if (!STRING_IS_NULL(PARROT_PACKFILEVIEW(view)->path))
+            path = PARROT_PACKFILEVIEW(view)->path;
+        tags = PARROT_PACKFILEVIEW(view)->called_tags;
+    }
+
+    VTABLE_set_string_keyed_int(interp, entry, PACKFILE_path, path);
+    VTABLE_set_string_keyed_int(interp, entry, PACKFILE_key, key);
+    VTABLE_set_pmc_keyed_int(interp, entry, PACKFILE_tags, tags);
+
+    return entry;
+}
+
+/*
+
+=item C<static void collect_state(PARROT_INTERP, PMC *state, snapshot_t *snap)>
+
+Fill in the rest of C<state>: the contents of the classes in C<snap>, the
+compilers registered since the ones listed there, the HLL type maps, and the
+bytecode libraries and library paths.
+
+=cut
+
+*/
+
+static void
+collect_state(PARROT_INTERP, ARGMOD(PMC *state), ARGIN(snapshot_t *snap))
+{
+    ASSERT_ARGS(collect_state)
+    PMC * const classes   = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    PMC * const compilers = Parrot_pmc_new(interp, enum_class_Hash);
+    PMC * const typemaps  = Parrot_pmc_new(interp, enum_class_ResizableIntegerArray);
+    PMC * const pbc_libs  = Parrot_pmc_new(interp, enum_class_Hash);
+    PMC * const lib_paths = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    PMC * const compregs  = VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+                                IGLOBALS_COMPREG_HASH);
+    PMC * const libs      = VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+                                IGLOBALS_PBC_LIBS);
+    PMC * const paths     = VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+                                IGLOBALS_LIB_PATHS);
+    PMC * const names     = Parrot_pmc_new(interp, enum_class_ResizableStringArray);
+    PMC * const values    = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    INTVAL i, n;
+
+    n = VTABLE_elements(interp, snap->classes);
+    for (i = 0; i < n; ++i) {
+        PMC * const _class = VTABLE_get_pmc_keyed_int(interp, snap->classes, i);
+        Parrot_Class_attributes * const attrs = PARROT_CLASS(_class);
+        PMC * const entry  = Parrot_pmc_new_init_int(interp, enum_class_FixedPMCArray,
+                                CLASS_MAX);
+
+        VTABLE_set_pmc_keyed_int(interp, entry, CLASS_parents, attrs->parents);
+        VTABLE_set_pmc_keyed_int(interp, entry, CLASS_roles, attrs->roles);
+        VTABLE_set_pmc_keyed_int(interp, entry, CLASS_attrib_metadata,
+                attrs->attrib_metadata);
+        VTABLE_set_pmc_keyed_int(interp, entry, CLASS_methods, attrs->methods);
+        VTABLE_set_pmc_keyed_int(interp, entry, CLASS_vtable_overrides,
+                attrs->vtable_overrides);
+        VTABLE_set_pmc_keyed_int(interp, entry, CLASS_resolve_method,
+                attrs->resolve_method);
+        VTABLE_set_integer_keyed_int(interp, entry, CLASS_instantiated,
+                attrs->instantiated);
+        VTABLE_push_pmc(interp, classes, entry);
+    }
+
+    /* compilers which were not registered, or were replaced */
+    list_hash(interp, compregs, names, values);
+    n = VTABLE_elements(interp, names);
+    for (i = 0; i < n; ++i) {
+        STRING * const name  = VTABLE_get_string_keyed_int(interp, names, i);
+        PMC    * const value = VTABLE_get_pmc_keyed_int(interp, values, i);
+        INTVAL j;
+
+        for (j = VTABLE_elements(interp, snap->compilers) - 1; j >= 0; --j)
+            if (VTABLE_get_pmc_keyed_int(interp, snap->compilers, j) == value)
+                break;
+
+        if (j < 0)
+            VTABLE_set_pmc_keyed_str(interp, compilers, name, value);
+    }
+
+    n = VTABLE_elements(interp, interp->HLL_info);
+    for (i = 0; i < n; ++i) {
+        PMC * const entry   = VTABLE_get_pmc_keyed_int(interp, interp->HLL_info, i);
+        PMC * const typemap = VTABLE_get_pmc_keyed_int(interp, entry, e_HLL_typemap);
+
+        if (!PMC_IS_NULL(typemap)) {
+            const INTVAL types = VTABLE_elements(interp, typemap);
+            INTVAL core;
+
+            for (core = 0; core < types; ++core) {
+                const INTVAL type = VTABLE_get_integer_keyed_int(interp, typemap, core);
+
+                if (type != core) {
+                    VTABLE_push_integer(interp, typemaps, i);
+                    VTABLE_push_integer(interp, typemaps, core);
+                    VTABLE_push_integer(interp, typemaps, type);
+                }
+            }
+        }
+    }
+
+    VTABLE_set_integer_native(interp, names, 0);
+    VTABLE_set_integer_native(interp, values, 0);
+    list_hash(interp, libs, names, values);
+    n = VTABLE_elements(interp, names);
+    for (i = 0; i < n; ++i)
+        VTABLE_set_pmc_keyed_str(interp, pbc_libs,
+                VTABLE_get_string_keyed_int(interp, names, i),
+                VTABLE_get_pmc_keyed_int(interp, values, i));
+
+    n = VTABLE_elements(interp, paths);
+    for (i = 0; i < n; ++i)
+        VTABLE_push_pmc(interp, lib_paths, VTABLE_get_pmc_keyed_int(interp, paths, i));
+
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_classes, classes);
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_compilers, compilers);
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_typemaps, typemaps);
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_pbc_libs, pbc_libs);
+    VTABLE_set_pmc_keyed_int(interp, state, STATE_lib_paths, lib_paths);
+}
+
+/*
+
+=item C<static void check_seen(PARROT_INTERP, PMC *seen, PMC *externs)>
+
+Throw an exception if any PMC of the Hash C<seen>, all that the state refers
+to, cannot be kept: any PMC which would not thaw, and any bytecode Sub which
+has captured the lexicals of a frame that ran during initialization. Other
+Subs have already been refused by the freezing.
+
+=cut
+
+*/
+
+static void
+check_seen(PARROT_INTERP, ARGIN(PMC *seen), ARGIN(PMC *externs))
+{
+    ASSERT_ARGS(check_seen)
+    const Hash * const hash      = (const Hash *)VTABLE_get_pointer(interp, seen);
+    Hash       * const is_extern = Parrot_hash_new_pointer_hash(interp);
+    STRING     * const sub_str   = CONST_STRING(interp, "Sub");
+    const VTABLE * const unfrozen = interp->vtables[enum_class_default];
+    const INTVAL n               = VTABLE_elements(interp, externs);
+    STRING     *error            = STRINGNULL;
+    INTVAL      i;
+
+    for (i = 0; i < n; ++i) {
+        PMC * const pmc = VTABLE_get_pmc_keyed_int(interp, externs, i);
+        if (!PMC_IS_NULL(pmc))
+            Parrot_hash_put(interp, is_extern, pmc, pmc);
+    }
+
+    parrot_hash_iterate(hash,
+        PMC * const pmc = (PMC *)_bucket->key;
+        const int   sub = !PObj_is_object_TEST(pmc)
+                       && VTABLE_isa(interp, pmc, sub_str);
+
+        if (!STRING_IS_NULL(error))
+            break;
+        else if (Parrot_hash_exists(interp, is_extern, pmc)) {
+            if (sub && has_captured_lexicals(interp, pmc))
+                error = Parrot_sprintf_c(interp,
+                    "Cannot snapshot sub '%Ss': it has captured lexicals",
+                    VTABLE_get_string(interp, pmc));
+        }
+        else if (pmc->vtable->freeze == unfrozen->freeze && pmc->vtable->attr_size)
+            error = Parrot_sprintf_c(interp,
+                "Cannot snapshot a %Ss: it cannot be frozen",
+                pmc->vtable->whoami););
+
+    Parrot_hash_destroy(interp, is_extern);
+
+    if (!STRING_IS_NULL(error))
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+            "%Ss", error);
+}
+
+/*
+
+=item C<static int has_captured_lexicals(PARROT_INTERP, PMC *sub_pmc)>
+
+Tell whether the Sub C<sub_pmc> refers to lexicals that a snapshot would lose,
+because it captured them with C<capture_lex> or C<newclosure>, or because its
+C<:outer> sub has run and would lend them to it.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static int
+has_captured_lexicals(PARROT_INTERP, ARGIN(PMC *sub_pmc))
+{
+    ASSERT_ARGS(has_captured_lexicals)
+    Parrot_Sub_attributes *sub;
+
+    PMC_get_sub(interp, sub_pmc, sub);
+
+    if (!PMC_IS_NULL(sub->outer_ctx))
+        return 1;
+
+    if (!PMC_IS_NULL(sub->outer_sub)) {
+        Parrot_Sub_attributes *outer;
+        PMC_get_sub(interp, sub->outer_sub, outer);
+
+        return !PMC_IS_NULL(outer->ctx) && !PMC_IS_NULL(outer->lex_info);
+    }
+
+    return 0;
+}
+
+/*
+
+=item C<static void write_snapshot_file(PARROT_INTERP, STRING *path, PMC
+*images)>
+
+Write the header and the binary strings of the array C<images> to the file
+C<path>.
+
+=cut
+
+*/
+
+static void
+write_snapshot_file(PARROT_INTERP, ARGIN(STRING *path), ARGIN(PMC *images))
+{
+    ASSERT_ARGS(write_snapshot_file)
+    const INTVAL n     = VTABLE_elements(interp, images);
+    size_t       words = SNAPSHOT_HEADER_SIZE / sizeof (opcode_t);
+    opcode_t    *packed, *cursor;
+    unsigned char *header;
+    PIOHANDLE    io;
+    INTVAL       i;
+
+    for (i = 0; i < n; ++i)
+        words += PF_size_buf(VTABLE_get_string_keyed_int(interp, images, i));
+
+    packed = mem_gc_allocate_n_zeroed_typed(interp, words, opcode_t);
+    header = (unsigned char *)packed;
+    memcpy(header, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LENGTH);
+    header[SNAPSHOT_MAGIC_LENGTH]     = sizeof (opcode_t);
+    header[SNAPSHOT_MAGIC_LENGTH + 1] = PARROT_BIGENDIAN;
+
+    cursor = packed + SNAPSHOT_HEADER_SIZE / sizeof (opcode_t);
+    for (i = 0; i < n; ++i)
+        cursor = PF_store_buf(cursor, VTABLE_get_string_keyed_int(interp, images, i));
+
+    io = Parrot_io_internal_open(interp, path, PIO_F_WRITE | PIO_F_TRUNC);
+    if (io == PIO_INVALID_HANDLE) {
+        mem_gc_free(interp, packed);
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_PIO_ERROR,
+            "Cannot open output file %Ss", path);
+    }
+
+    Parrot_io_internal_write(interp, io, (char *)packed, words * sizeof (opcode_t));
+    Parrot_io_internal_close(interp, io);
+    mem_gc_free(interp, packed);
+}
+
+/*
+
+=item C<static PMC * build_externs(PARROT_INTERP, const snapshot_t *snap)>
+
+Return the array of PMCs the state refers to by position: those listed in
+C<snap>, the interpreter globals except for the program's arguments, and each
+bytecode file followed by its PMC constants.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC *
+build_externs(PARROT_INTERP, ARGIN(const snapshot_t *snap))
+{
+    ASSERT_ARGS(build_externs)
+    PMC * const externs = Parrot_pmc_new(interp, enum_class_ResizablePMCArray);
+    PMC * const lists[] = { snap->namespaces, snap->classes, snap->proxies,
+                            snap->compilers, snap->libraries };
+    INTVAL      i, n;
+    size_t      l;
+
+    for (l = 0; l < sizeof (lists) / sizeof (lists[0]); ++l) {
+        n = VTABLE_elements(interp, lists[l]);
+        for (i = 0; i < n; ++i)
+            VTABLE_push_pmc(interp, externs, VTABLE_get_pmc_keyed_int(interp, lists[l], i));
+    }
+
+    for (i = 0; i < IGLOBALS_SIZE; ++i)
+        VTABLE_push_pmc(interp, externs, i == IGLOBALS_ARGV_LIST
+                ? PMCNULL
+                : VTABLE_get_pmc_keyed_int(interp, interp->iglobals, i));
+
+    n = VTABLE_elements(interp, snap->packfiles);
+    for (i = 0; i < n; ++i) {
+        PMC      * const view = VTABLE_get_pmc_keyed_int(interp, snap->packfiles, i);
+        PackFile * const pf   = (PackFile *)VTABLE_get_pointer(interp, view);
+        size_t           s;
+
+        VTABLE_push_pmc(interp, externs, view);
+
+        for (s = 0; s < pf->directory.num_segments; ++s) {
+            PackFile_Segment * const seg = pf->directory.segments[s];
+
+            if (seg->type == PF_CONST_SEG) {
+                const PackFile_ConstTable * const ct = (PackFile_ConstTable *)seg;
+                opcode_t c;
+
+                for (c = 0; c < ct->pmc.const_count; ++c)
+                    VTABLE_push_pmc(interp, externs, ct->pmc.constants[c]);
+            }
+        }
+    }
+
+    return externs;
+}
+
+/*
+
+=back
+
+=head2 Reading
+
+=over 4
+
+=item C<static const char * map_snapshot(PARROT_INTERP, STRING *path, size_t
+*size)>
+
+Map the snapshot file C<path> into memory, or read it where that is not
+possible, check its header and return its contents and C<size>. The memory is
+never released, since the bytecode is unpacked in place.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static const char *
+map_snapshot(PARROT_INTERP, ARGIN(STRING *path), ARGOUT(size_t *size))
+{
+    ASSERT_ARGS(map_snapshot)
+    char     *bytes = NULL;
+    INTVAL    length;
+    PIOHANDLE io;
+
+    if (!Parrot_file_stat_intval(interp, path, STAT_EXISTS))
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+            "Can't stat %Ss, code %i.\n", path, errno);
+
+    length = Parrot_file_stat_intval(interp, path, STAT_FILESIZE);
+    if (length < SNAPSHOT_HEADER_SIZE || length % sizeof (opcode_t))
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "'%Ss' is not a Parrot snapshot", path);
+
+    io = Parrot_io_internal_open(interp, path, PIO_F_READ);
+    if (io == PIO_INVALID_HANDLE)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+            "Can't open %Ss, code %i.\n", path, errno);
+
+#ifdef PARROT_HAS_HEADER_SYSMMAN
+    /* private, so that unpacking may fix up the bytecode in place */
+    bytes = (char *)mmap(NULL, (size_t)length, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE, io, (off_t)0);
+
+    if (bytes == (void *)MAP_FAILED)
+        bytes = NULL;
+#endif
+
+    if (!bytes) {
+        size_t got = 0;
+
+        bytes = mem_gc_allocate_n_typed(interp, length, char);
+        while (got < (size_t)length) {
+            const size_t r = Parrot_io_internal_read(interp, io, bytes + got,
+                                (size_t)length - got);
+            if (!r)
+                break;
+            got += r;
+        }
+
+        if (got < (size_t)length) {
+            Parrot_io_internal_close(interp, io);
+            Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_PIO_ERROR,
+                "Can't read %Ss", path);
+        }
+    }
+
+    Parrot_io_internal_close(interp, io);
+
+    if (memcmp(bytes, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LENGTH) != 0)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "'%Ss' is not a Parrot snapshot", path);
+
+    if (bytes[SNAPSHOT_MAGIC_LENGTH]     != sizeof (opcode_t)
+    ||  bytes[SNAPSHOT_MAGIC_LENGTH + 1] != PARROT_BIGENDIAN)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "Snapshot '%Ss' was written on another platform", path);
+
+    *size = (size_t)length;
+    return bytes;
+}
+
+/*
+
+=item C<static STRING * next_buffer(PARROT_INTERP, STRING *path, const opcode_t
+**cursor, const opcode_t *end)>
+
+Return the buffer at C<cursor> in the snapshot C<path> as a binary string
+which points into the file, and move C<cursor> past it.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static STRING *
+next_buffer(PARROT_INTERP, ARGIN(STRING *path), ARGMOD(const opcode_t **cursor),
+        ARGIN(const opcode_t *end))
+{
+    ASSERT_ARGS(next_buffer)
+    const size_t left = (const char *)end - (const char *)*cursor;
+
+    if (left < sizeof (opcode_t)
+    ||  (size_t)**cursor > left - sizeof (opcode_t))
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "Snapshot '%Ss' is truncated", path);
+
+    return PF_fetch_buf(interp, NULL, cursor);
+}
+
+/*
+
+=item C<static void check_manifest(PARROT_INTERP, STRING *path, PMC *manifest)>
+
+Throw an exception unless the snapshot C<path>, with the given C<manifest>,
+was written by this build of Parrot.
+
+=cut
+
+*/
+
+static void
+check_manifest(PARROT_INTERP, ARGIN(STRING *path), ARGIN(PMC *manifest))
+{
+    ASSERT_ARGS(check_manifest)
+
+    if (VTABLE_elements(interp, manifest) != MANIFEST_MAX
+    ||  !STRING_equal(interp, Parrot_str_new_constant(interp, PARROT_VERSION),
+            VTABLE_get_string_keyed_int(interp, manifest, MANIFEST_version))
+    ||  VTABLE_get_integer_keyed_int(interp, manifest, MANIFEST_core_types)
+            != enum_class_core_max)
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "Snapshot '%Ss' was written by another build of Parrot", path);
+}
+
+/*
+
+=item C<static void restore_types(PARROT_INTERP, PMC *manifest, snapshot_t
+*snap)>
+
+Register the HLLs and create the namespaces of the C<manifest>, then load its
+libraries and create its classes, so that each type gets the number it had.
+The namespaces, classes and libraries are listed in C<snap>.
+
+=cut
+
+*/
+
+static void
+restore_types(PARROT_INTERP, ARGIN(PMC *manifest), ARGMOD(snapshot_t *snap))
+{
+    ASSERT_ARGS(restore_types)
+    PMC * const hlls        = VTABLE_get_pmc_keyed_int(interp, manifest, MANIFEST_hlls);
+    PMC * const paths       = VTABLE_get_pmc_keyed_int(interp, manifest,
+                                MANIFEST_namespaces);
+    PMC * const type_names  = VTABLE_get_pmc_keyed_int(interp, manifest,
+                                MANIFEST_type_names);
+    PMC * const type_nses   = VTABLE_get_pmc_keyed_int(interp, manifest,
+                                MANIFEST_type_classes);
+    PMC * const class_types = VTABLE_get_pmc_keyed_int(interp, manifest,
+                                MANIFEST_class_types);
+    PMC * const libraries   = VTABLE_get_pmc_keyed_int(interp, manifest,
+                                MANIFEST_libraries);
+    const INTVAL n_libs     = VTABLE_elements(interp, libraries);
+    INTVAL       lib        = 0;
+    INTVAL       i, n;
+
+    n = VTABLE_elements(interp, hlls);
+    for (i = 0; i < n; ++i) {
+        STRING * const name = VTABLE_get_string_keyed_int(interp, hlls, i);
+        if (Parrot_hll_register_HLL(interp, name) != i)
+            Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+                "Cannot restore HLL '%Ss' as number %d", name, (int)i);
+    }
+
+    VTABLE_push_pmc(interp, snap->namespaces, interp->root_namespace);
+    n = VTABLE_elements(interp, paths);
+    for (i = 1; i < n; ++i)
+        VTABLE_push_pmc(interp, snap->namespaces, Parrot_ns_make_namespace_keyed(interp,
+                interp->root_namespace, VTABLE_get_pmc_keyed_int(interp, paths, i)));
+
+    n = VTABLE_elements(interp, type_names);
+    for (i = 0; i < n; ++i) {
+        const INTVAL   type  = enum_class_core_max + i;
+        const INTVAL   ns_id = VTABLE_get_integer_keyed_int(interp, type_nses, i);
+        STRING * const name  = VTABLE_get_string_keyed_int(interp, type_names, i);
+
+        if (ns_id >= 0) {
+            PMC * const ns = VTABLE_get_pmc_keyed_int(interp, snap->namespaces, ns_id);
+            PMC        *_class;
+
+            if (interp->n_vtable_max != type)
+                Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+                    "Cannot restore class '%Ss' as type %d", name, (int)type);
+
+            _class = Parrot_pmc_new_init(interp,
+                        VTABLE_get_integer_keyed_int(interp, class_types, i), ns);
+            VTABLE_push_pmc(interp, snap->classes, _class);
+        }
+        else {
+            /* the library which registered it is the next one not loaded yet */
+            while (interp->n_vtable_max <= type && lib < n_libs)
+                VTABLE_push_pmc(interp, snap->libraries, Parrot_dyn_load_lib(interp,
+                        VTABLE_get_string_keyed_int(interp, libraries, lib++), PMCNULL));
+        }
+
+        if (interp->n_vtable_max <= type
+        ||  !STRING_equal(interp, interp->vtables[type]->whoami, name))
+            Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+                "Cannot restore PMC type '%Ss' as type %d", name, (int)type);
+    }
+
+    for (; lib < n_libs; ++lib)
+        VTABLE_push_pmc(interp, snap->libraries, Parrot_dyn_load_lib(interp,
+                VTABLE_get_string_keyed_int(interp, libraries, lib), PMCNULL));
+}
+
+/*
+
+=item C<static PMC * restore_packfile(PARROT_INTERP, STRING *image, PMC *entry,
+PMC *view)>
+
+Unpack the bytecode file C<image>, described by the manifest C<entry>, and
+return its PackfileView, registered among the loaded bytecode as it was. That
+is C<view> if it is not null.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CANNOT_RETURN_NULL
+static PMC *
+restore_packfile(PARROT_INTERP, ARGIN(STRING *image), ARGIN(PMC *entry),
+        ARGIN_NULLOK(PMC *view))
+{
+    ASSERT_ARGS(restore_packfile)
+    STRING * const path = VTABLE_get_string_keyed_int(interp, entry, PACKFILE_path);
+    STRING * const key  = VTABLE_get_string_keyed_int(interp, entry, PACKFILE_key);
+    PMC    * const tags = VTABLE_get_pmc_keyed_int(interp, entry, PACKFILE_tags);
+    PackFile * const pf = Parrot_pf_new(interp, 0);
+
+    pf->options = 0;
+    if (!PackFile_unpack(interp, pf, (const opcode_t *)image->strstart, image->bufused))
+        Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_MALFORMED_PACKFILE,
+            "Can't unpack packfile %Ss.\n", path);
+
+    if (PMC_IS_NULL(view))
+        view = Parrot_pf_get_packfile_pmc(interp, pf, path);
+    else {
+        VTABLE_set_pointer(interp, view, pf);
+        pf->view = view;
+        VTABLE_set_string_native(interp, view, path);
+    }
+
+    if (!STRING_IS_EMPTY(key))
+        VTABLE_set_pmc_keyed_str(interp, VTABLE_get_pmc_keyed_int(interp,
+                interp->iglobals, IGLOBALS_LOADED_PBCS), key, view);
+
+    if (!PMC_IS_NULL(tags)) {
+        STRING * const method = CONST_STRING(interp, "mark_initialized");
+        const INTVAL   n      = VTABLE_elements(interp, tags);
+        INTVAL         i;
+
+        for (i = 0; i < n; ++i)
+            Parrot_pcc_invoke_method_from_c_args(interp, view, method, "S->",
+                    VTABLE_get_string_keyed_int(interp, tags, i));
+    }
+
+    return view;
+}
+
+/*
+
+=item C<static void restore_proxies(PARROT_INTERP, PMC *manifest, snapshot_t
+*snap)>
+
+Create the PMCProxy classes of the C<manifest> which do not exist yet, and
+list them all in C<snap>.
+
+=cut
+
+*/
+
+static void
+restore_proxies(PARROT_INTERP, ARGIN(PMC *manifest), ARGMOD(snapshot_t *snap))
+{
+    ASSERT_ARGS(restore_proxies)
+    PMC * const nses  = VTABLE_get_pmc_keyed_int(interp, manifest, MANIFEST_proxy_nses);
+    PMC * const types = VTABLE_get_pmc_keyed_int(interp, manifest, MANIFEST_proxy_types);
+    const INTVAL n    = VTABLE_elements(interp, nses);
+    INTVAL       i;
+
+    for (i = 0; i < n; ++i) {
+        PMC    * const ns   = VTABLE_get_pmc_keyed_int(interp, snap->namespaces,
+                                VTABLE_get_integer_keyed_int(interp, nses, i));
+        STRING * const name = VTABLE_get_string_keyed_int(interp, types, i);
+        PMC           *proxy = VTABLE_get_class(interp, ns);
+
+        if (PMC_IS_NULL(proxy)) {
+            const INTVAL type = Parrot_pmc_get_type_str(interp, name);
+
+            if (type <= 0)
+                Parrot_ex_throw_from_c_args(interp, NULL, EXCEPTION_INVALID_OPERATION,
+                    "Cannot restore the class of PMC type '%Ss'", name);
+
+            proxy = Parrot_pmc_new_init_int(interp, enum_class_PMCProxy, type);
+            if (!PMC_IS_NULL(VTABLE_get_class(interp, ns)))
+                proxy = VTABLE_get_class(interp, ns);
+        }
+
+        VTABLE_push_pmc(interp, snap->proxies, proxy);
+    }
+}
+
+/*
+
+=item C<static void restore_state(PARROT_INTERP, PMC *state, snapshot_t *snap)>
+
+Put the thawed C<state> in place: fill in the classes of C<snap>, set the
+globals which differ from what the bytecode installed, and register the
+compilers, HLL type maps, bytecode libraries and library paths.
+
+=cut
+
+*/
+
+static void
+restore_state(PARROT_INTERP, ARGIN(PMC *state), ARGIN(snapshot_t *snap))
+{
+    ASSERT_ARGS(restore_state)
+    PMC * const classes   = VTABLE_get_pmc_keyed_int(interp, state, STATE_classes);
+    PMC * const nses      = VTABLE_get_pmc_keyed_int(interp, state, STATE_global_nses);
+    PMC * const names     = VTABLE_get_pmc_keyed_int(interp, state, STATE_global_names);
+    PMC * const values    = VTABLE_get_pmc_keyed_int(interp, state, STATE_global_values);
+    PMC * const typemaps  = VTABLE_get_pmc_keyed_int(interp, state, STATE_typemaps);
+    PMC * const lib_paths = VTABLE_get_pmc_keyed_int(interp, state, STATE_lib_paths);
+    PMC * const paths     = VTABLE_get_pmc_keyed_int(interp, interp->iglobals,
+                                IGLOBALS_LIB_PATHS);
+    INTVAL i, n;
+
+    n = VTABLE_elements(interp, classes);
+    for (i = 0; i < n; ++i) {
+        PMC * const _class = VTABLE_get_pmc_keyed_int(interp, snap->classes, i);
+        PMC * const entry  = VTABLE_get_pmc_keyed_int(interp, classes, i);
+        Parrot_Class_attributes * const attrs = PARROT_CLASS(_class);
+
+        attrs->parents          = VTABLE_get_pmc_keyed_int(interp, entry, CLASS_parents);
+        attrs->roles            = VTABLE_get_pmc_keyed_int(interp, entry, CLASS_roles);
+        attrs->attrib_metadata  = VTABLE_get_pmc_keyed_int(interp, entry,
+                                    CLASS_attrib_metadata);
+        attrs->methods          = VTABLE_get_pmc_keyed_int(interp, entry, CLASS_methods);
+        attrs->vtable_overrides = VTABLE_get_pmc_keyed_int(interp, entry,
+                                    CLASS_vtable_overrides);
+        attrs->resolve_method   = VTABLE_get_pmc_keyed_int(interp, entry,
+                                    CLASS_resolve_method);
+        attrs->instantiated     = VTABLE_get_integer_keyed_int(interp, entry,
+                                    CLASS_instantiated);
+
+        /* work out the MRO and attribute index again, as thawing does */
+        VTABLE_thawfinish(interp, _class, PMCNULL);
+        interp->vtables[attrs->id]->mro = attrs->all_parents;
+        PARROT_GC_WRITE_BARRIER(interp, _class);
+    }
+
+    n = VTABLE_elements(interp, names);
+    for (i = 0; i < n; ++i) {
+        PMC    * const ns    = VTABLE_get_pmc_keyed_int(interp, nses, i);
+        STRING * const name  = VTABLE_get_string_keyed_int(interp, names, i);
+        PMC    * const value = VTABLE_get_pmc_keyed_int(interp, values, i);
+
+        if (Parrot_ns_get_global(interp, ns, name) != value)
+            Parrot_ns_set_global(interp, ns, name, value);
+    }
+
+    copy_hash(interp, VTABLE_get_pmc_keyed_int(interp, state, STATE_compilers),
+            VTABLE_get_pmc_keyed_int(interp, interp->iglobals, IGLOBALS_COMPREG_HASH));
+    copy_hash(interp, VTABLE_get_pmc_keyed_int(interp, state, STATE_pbc_libs),
+            VTABLE_get_pmc_keyed_int(interp, interp->iglobals, IGLOBALS_PBC_LIBS));
+
+    n = VTABLE_elements(interp, typemaps);
+    for (i = 0; i + 2 < n; i += 3)
+        Parrot_hll_register_HLL_type(interp,
+                VTABLE_get_integer_keyed_int(interp, typemaps, i),
+                VTABLE_get_integer_keyed_int(interp, typemaps, i + 1),
+                VTABLE_get_integer_keyed_int(interp, typemaps, i + 2));
+
+    /* add the paths initialization added after any given to this interpreter */
+    n = VTABLE_elements(interp, lib_paths);
+    for (i = 0; i < n && i < VTABLE_elements(interp, paths); ++i) {
+        PMC * const saved  = VTABLE_get_pmc_keyed_int(interp, lib_paths, i);
+        PMC * const actual = VTABLE_get_pmc_keyed_int(interp, paths, i);
+        const INTVAL count = VTABLE_elements(interp, saved);
+        INTVAL j;
+
+        for (j = 0; j < count; ++j) {
+            STRING * const dir   = VTABLE_get_string_keyed_int(interp, saved, j);
+            const INTVAL   known = VTABLE_elements(interp, actual);
+            INTVAL k;
+
+            for (k = 0; k < known; ++k)
+                if (STRING_equal(interp, dir,
+                        VTABLE_get_string_keyed_int(interp, actual, k)))
+                    break;
+
+            if (k == known)
+                VTABLE_push_string(interp, actual, dir);
+        }
+    }
+}
+
+/*
+
+=item C<static void copy_hash(PARROT_INTERP, PMC *from, PMC *to)>
+
+Store every entry of the string keyed hash C<from> in C<to>.
+
+=cut
+
+*/
+
+static void
+copy_hash(PARROT_INTERP, ARGIN(PMC *from), ARGMOD(PMC *to))
+{
+    ASSERT_ARGS(copy_hash)
+    const Hash * const h = (const Hash *)VTABLE_get_pointer(interp, from);
+
+    parrot_hash_iterate_linear(h,
+        VTABLE_set_pmc_keyed_str(interp, to, (STRING *)_bucket->key,
+                (PMC *)_bucket->value););
+}
+
+/*
+
+=back
+
+=head1 SEE ALSO
+
+F<src/packfile/object_serialization.c>, F<src/packfile/api.c>,
+F<frontend/parrot/main.c>.
+
+=cut
+
+*/
+
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
@@ -21,6 +21,8 @@ The base vtable calling functions
 #include "pmc.str"
 #include "pmc/pmc_class.h"
 #include "pmc/pmc_integer.h"
+#include "pmc/pmc_float.h"
+#include "pmc/pmc_string.h"
 #include "pmc/pmc_callcontext.h"
 #include "pmc/pmc_proxy.h"
 
@@ -831,6 +833,11 @@ Parrot_pmc_get_type_str(PARROT_INTERP, ARGIN_NULLOK(STRING *name))
 
 Boxes a STRING C<string> into a String PMC.
 
+A core String, Float or Integer gets its value through its attribute
+accessor or C<init_int> from this and the other boxing functions, rather than
+through a C<set_*_native> vtable call; the HLL may map the type to another one
+which needs that call.
+
 =cut
 
 */
@@ -842,9 +849,13 @@ PMC *
 Parrot_pmc_box_string(PARROT_INTERP, ARGIN_NULLOK(STRING *string))
 {
     ASSERT_ARGS(Parrot_pmc_box_string)
-    PMC * const ret = Parrot_pmc_new(interp,
-                        Parrot_hll_get_ctx_HLL_type(interp, enum_class_String));
-    VTABLE_set_string_native(interp, ret, string);
+    const INTVAL type = Parrot_hll_get_ctx_HLL_type(interp, enum_class_String);
+    PMC * const  ret  = Parrot_pmc_new(interp, type);
+
+    if (type == enum_class_String)
+        SETATTR_String_str_val(interp, ret, string ? string : STRINGNULL);
+    else
+        VTABLE_set_string_native(interp, ret, string);
 
     return ret;
 }
@@ -867,9 +878,14 @@ PMC*
 Parrot_pmc_box_number(PARROT_INTERP, FLOATVAL value)
 {
     ASSERT_ARGS(Parrot_pmc_box_number)
-    PMC * const ret = Parrot_pmc_new(interp,
-                                     Parrot_hll_get_ctx_HLL_type(interp, enum_class_Float));
-    VTABLE_set_number_native(interp, ret, value);
+    const INTVAL type = Parrot_hll_get_ctx_HLL_type(interp, enum_class_Float);
+    PMC * const  ret  = Parrot_pmc_new(interp, type);
+
+    if (type == enum_class_Float)
+        SETATTR_Float_fv(interp, ret, value);
+    else
+        VTABLE_set_number_native(interp, ret, value);
+
     return ret;
 }
 
@@ -891,9 +907,16 @@ PMC*
 Parrot_pmc_box_integer(PARROT_INTERP, INTVAL value)
 {
     ASSERT_ARGS(Parrot_pmc_box_integer)
-    PMC * const ret = Parrot_pmc_new(interp,
-                                     Parrot_hll_get_ctx_HLL_type(interp, enum_class_Integer));
-    VTABLE_set_integer_native(interp, ret, value);
+    const INTVAL type = Parrot_hll_get_ctx_HLL_type(interp, enum_class_Integer);
+    PMC         *ret;
+
+    if (type == enum_class_Integer)
+        ret = Parrot_pmc_new_init_int(interp, type, value);
+    else {
+        ret = Parrot_pmc_new(interp, type);
+        VTABLE_set_integer_native(interp, ret, value);
+    }
+
     return ret;
 }
 
@@ -0,0 +1,1650 @@
+/*
+Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+src/runcore/jit.c - Parrot's tiered jit runcore
+
+=head1 DESCRIPTION
+
+The C<jit> runcore starts out running ops just like the fast core.  Along the
+way it counts, for every sub, how often the sub is entered and how often it
+branches backwards.  Once that count reaches C<PARROT_JIT_THRESHOLD> (100 by
+default), the sub is translated to native code and later runs of it jump
+straight into that code.
+
+The native code of a sub is stitched together op by op.  A small set of ops
+on integer and number registers (C<set>, C<add>, C<sub>, C<mul>, C<inc>,
+C<dec>, the compare-and-branch ops and C<if>/C<unless>) have a machine code
+template which works on the register file directly, through a pointer kept
+in a machine register.  Every other op is a call to its op function, as
+compiled from the F<.ops> files, followed by a check of the pc it returns:
+the next op and the op's constant branch targets are reached with direct
+jumps, anything else (calls, returns, exceptions, C<end>) leaves the native
+code and is dispatched by the runloop, which enters the native code of the
+new position again if there is any.
+
+Before each op function call the current pc is stored in the context, as the
+fast core does.  Backward jumps in the native code give way to the runloop
+when events are pending, so that the event checking op table gets to run.
+
+The native code is kept with the bytecode segment and freed with it.  Only the
+interpreter which compiled it uses it; any other interpreter running the same
+segment interprets it.
+
+Native code is only generated for x86-64 with the System V calling
+convention, 8 byte C<INTVAL>s and C<FLOATVAL>s, and C<mmap>.  Elsewhere the
+C<jit> runcore is the same as the fast core.
+
+=head2 Functions
+
+=over 4
+
+=cut
+
+*/
+
+#include "parrot/runcore_api.h"
+#include "parrot/runcore_jit.h"
+#include "parrot/oplib/core_ops.h"
+#include "parrot/oplib/ops.h"
+
+#include "jit.str"
+
+#include "pmc/pmc_sub.h"
+#include "pmc/pmc_callcontext.h"
+
+#if defined(__x86_64__) && !defined(_WIN32) && defined(PARROT_HAS_HEADER_SYSMMAN) \
+ && INTVAL_SIZE == 8 && NUMVAL_SIZE == 8 && OPCODE_T_SIZE == 8
+#  include <sys/mman.h>
+#  if defined(MAP_ANONYMOUS)
+#    define JIT_NATIVE 1
+#  endif
+#endif
+
+/* the native code of a sub is called through its first bytes as this */
+typedef opcode_t *(*jit_enter_fn)(PARROT_INTERP, void *native);
+
+/* the ops of a sub which have a native template */
+typedef enum jit_template {
+    JIT_NONE,
+    JIT_SET,
+    JIT_ADD,
+    JIT_SUB,
+    JIT_MUL,
+    JIT_INC,
+    JIT_DEC,
+    JIT_EQ,
+    JIT_NE,
+    JIT_LT,
+    JIT_LE,
+    JIT_GT,
+    JIT_GE,
+    JIT_IF,
+    JIT_UNLESS
+} jit_template;
+
+/* a jump to an op whose native code is not placed yet */
+typedef struct jit_fixup {
+    size_t at;                  /* position of the rel32 to patch */
+    size_t op;                  /* offset of the target op in the sub */
+} jit_fixup;
+
+/* the native code of a sub while it is being generated */
+typedef struct jit_buffer {
+    char            *code;
+    size_t           size;
+    size_t           alloc;
+    size_t           exit;      /* position of the code leaving the sub */
+    size_t          *native;    /* position of the code of each op */
+    char            *ops;       /* JIT_OP_* flags of each offset in the sub */
+    jit_fixup       *fixups;
+    size_t           n_fixups;
+    size_t           fixups_alloc;
+    int              bp_loaded; /* is the register file pointer up to date? */
+} jit_buffer;
+
+#define JIT_OP_START  1         /* an op starts here */
+#define JIT_OP_TARGET 2         /* an op starts here and is branched to */
+
+/* machine registers */
+#define JIT_RAX  0
+#define JIT_RCX  1
+#define JIT_RBX  3
+#define JIT_RSI  6
+#define JIT_RDI  7
+#define JIT_R12 12
+#define JIT_XMM0 0
+#define JIT_XMM1 1
+
+/* condition codes of jcc */
+#define JIT_CC_NONE -1
+#define JIT_CC_B   0x2
+#define JIT_CC_AE  0x3
+#define JIT_CC_E   0x4
+#define JIT_CC_NE  0x5
+#define JIT_CC_BE  0x6
+#define JIT_CC_A   0x7
+#define JIT_CC_P   0xA
+#define JIT_CC_L   0xC
+#define JIT_CC_GE  0xD
+#define JIT_CC_LE  0xE
+#define JIT_CC_G   0xF
+
+/* The interpreter lives in r12 and the register file pointer (bp) in rbx;
+ * integer register n is at rbx + 8n and number register n at rbx - 8 - 8n */
+#define JIT_REG_INTERP JIT_R12
+#define JIT_REG_BP     JIT_RBX
+#define JIT_INT_DISP(n) ((INTVAL)(n) * (INTVAL)sizeof (INTVAL))
+#define JIT_NUM_DISP(n) (-((INTVAL)(n) + 1) * (INTVAL)sizeof (FLOATVAL))
+
+/* HEADERIZER HFILE: include/parrot/runcore_jit.h */
+
+/* HEADERIZER BEGIN: static */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+PARROT_CANNOT_RETURN_NULL
+static Parrot_jit_segment * build_jit_segment(PARROT_INTERP,
+    ARGMOD(PackFile_ByteCode *seg))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*seg);
+
+PARROT_PURE_FUNCTION
+static int compare_jit_subs(ARGIN(const void *a), ARGIN(const void *b))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static int compile_jit_sub(PARROT_INTERP,
+    ARGIN(Parrot_jit_runcore_t *runcore),
+    ARGIN(PackFile_ByteCode *seg),
+    ARGMOD(Parrot_jit_sub *sub))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        FUNC_MODIFIES(*sub);
+
+static void emit_byte(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    unsigned int byte)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_entry_and_exit(PARROT_INTERP, ARGMOD(jit_buffer *buf))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_goto(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    ARGIN(const Parrot_jit_sub *sub),
+    size_t from,
+    INTVAL target)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*buf);
+
+static void emit_int32(PARROT_INTERP, ARGMOD(jit_buffer *buf), INTVAL value)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_int64(PARROT_INTERP, ARGMOD(jit_buffer *buf), INTVAL value)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_int_arg(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    unsigned int opcode,
+    int reg,
+    ARGIN(const opcode_t *pc),
+    ARGIN(const op_info_t *info),
+    int k)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(5)
+        __attribute__nonnull__(6)
+        FUNC_MODIFIES(*buf);
+
+static size_t emit_jump(PARROT_INTERP, ARGMOD(jit_buffer *buf), int cc)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_load_bp(PARROT_INTERP, ARGMOD(jit_buffer *buf))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_mov_imm(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    int reg,
+    INTVAL value)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_num_arg(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    unsigned int prefix,
+    unsigned int opcode,
+    ARGIN(const PackFile_ByteCode *seg),
+    ARGIN(const opcode_t *pc),
+    ARGIN(const op_info_t *info),
+    int k)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(5)
+        __attribute__nonnull__(6)
+        __attribute__nonnull__(7)
+        FUNC_MODIFIES(*buf);
+
+static void emit_op_call(PARROT_INTERP,
+    ARGIN(Parrot_jit_runcore_t *runcore),
+    ARGMOD(jit_buffer *buf),
+    ARGIN(const PackFile_ByteCode *seg),
+    ARGIN(const Parrot_jit_sub *sub),
+    size_t i)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        __attribute__nonnull__(5)
+        FUNC_MODIFIES(*buf);
+
+static void emit_op_mem(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    unsigned int prefix,
+    int wide,
+    unsigned int opcode,
+    int reg,
+    int base,
+    INTVAL disp)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_op_reg(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    unsigned int prefix,
+    int wide,
+    unsigned int opcode,
+    int reg,
+    int rm)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static void emit_opcode(PARROT_INTERP,
+    ARGMOD(jit_buffer *buf),
+    unsigned int prefix,
+    int wide,
+    unsigned int opcode,
+    int reg,
+    int rm)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*buf);
+
+static int emit_template(PARROT_INTERP,
+    ARGIN(Parrot_jit_runcore_t *runcore),
+    ARGMOD(jit_buffer *buf),
+    ARGIN(const PackFile_ByteCode *seg),
+    ARGIN(const Parrot_jit_sub *sub),
+    size_t i)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4)
+        __attribute__nonnull__(5)
+        FUNC_MODIFIES(*buf);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static Parrot_jit_sub * find_jit_sub(PARROT_INTERP,
+    ARGMOD(PackFile_ByteCode *seg),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*seg);
+
+PARROT_CAN_RETURN_NULL
+static void * init_jit_core(PARROT_INTERP,
+    ARGIN(Parrot_jit_runcore_t *runcore),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+PARROT_WARN_UNUSED_RESULT
+static size_t jit_op_size(PARROT_INTERP,
+    ARGIN(Parrot_jit_runcore_t *runcore),
+    ARGIN(const PackFile_ByteCode *seg),
+    ARGIN(const opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4);
+
+PARROT_WARN_UNUSED_RESULT
+static jit_template jit_template_for(
+    ARGIN(const Parrot_jit_runcore_t *runcore),
+    ARGIN(const op_info_t *info),
+    ARGOUT(int *is_num))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        FUNC_MODIFIES(*is_num);
+
+static void patch_jump(ARGMOD(jit_buffer *buf), size_t at, size_t to)
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*buf);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static opcode_t * runops_jit_core(PARROT_INTERP,
+    ARGIN(Parrot_jit_runcore_t *runcore),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+#define ASSERT_ARGS_build_jit_segment __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(seg))
+#define ASSERT_ARGS_compare_jit_subs __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(a) \
+    , PARROT_ASSERT_ARG(b))
+#define ASSERT_ARGS_compile_jit_sub __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(seg) \
+    , PARROT_ASSERT_ARG(sub))
+#define ASSERT_ARGS_emit_byte __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_entry_and_exit __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_goto __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf) \
+    , PARROT_ASSERT_ARG(sub))
+#define ASSERT_ARGS_emit_int32 __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_int64 __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_int_arg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf) \
+    , PARROT_ASSERT_ARG(pc) \
+    , PARROT_ASSERT_ARG(info))
+#define ASSERT_ARGS_emit_jump __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_load_bp __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_mov_imm __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_num_arg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf) \
+    , PARROT_ASSERT_ARG(seg) \
+    , PARROT_ASSERT_ARG(pc) \
+    , PARROT_ASSERT_ARG(info))
+#define ASSERT_ARGS_emit_op_call __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(buf) \
+    , PARROT_ASSERT_ARG(seg) \
+    , PARROT_ASSERT_ARG(sub))
+#define ASSERT_ARGS_emit_op_mem __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_op_reg __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_opcode __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_emit_template __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(buf) \
+    , PARROT_ASSERT_ARG(seg) \
+    , PARROT_ASSERT_ARG(sub))
+#define ASSERT_ARGS_find_jit_sub __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(seg) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_init_jit_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_jit_op_size __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(seg) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_jit_template_for __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(info) \
+    , PARROT_ASSERT_ARG(is_num))
+#define ASSERT_ARGS_patch_jump __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(buf))
+#define ASSERT_ARGS_runops_jit_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(pc))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: static */
+
+/*
+
+=item C<void Parrot_runcore_jit_init(PARROT_INTERP)>
+
+Registers the jit runcore with Parrot.
+
+=cut
+
+*/
+
+void
+Parrot_runcore_jit_init(PARROT_INTERP)
+{
+    ASSERT_ARGS(Parrot_runcore_jit_init)
+
+    Parrot_jit_runcore_t * const coredata =
+            mem_gc_allocate_zeroed_typed(interp, Parrot_jit_runcore_t);
+
+    coredata->name        = CONST_STRING(interp, "jit");
+    coredata->id          = PARROT_JIT_CORE;
+    coredata->opinit      = PARROT_CORE_OPLIB_INIT;
+    coredata->runops      = (Parrot_runcore_runops_fn_t) init_jit_core;
+    coredata->destroy     = NULL;
+    coredata->prepare_run = NULL;
+    coredata->flags       = 0;
+
+    PARROT_RUNCORE_FUNC_TABLE_SET(coredata);
+
+    Parrot_runcore_register(interp, (Parrot_runcore_t *) coredata);
+}
+
+
+/*
+
+=item C<void Parrot_jit_free_segment(PARROT_INTERP, PackFile_ByteCode *seg)>
+
+Frees the native code of the subs of C<seg>.
+
+=cut
+
+*/
+
+void
+Parrot_jit_free_segment(PARROT_INTERP, ARGMOD(PackFile_ByteCode *seg))
+{
+    ASSERT_ARGS(Parrot_jit_free_segment)
+    Parrot_jit_segment * const jit = seg->jit;
+    size_t i;
+
+    if (!jit)
+        return;
+
+    for (i = 0; i < jit->n_subs; ++i) {
+        Parrot_jit_sub * const sub = &jit->subs[i];
+
+        if (sub->entries)
+            mem_gc_free(interp, sub->entries);
+#ifdef JIT_NATIVE
+        if (sub->code)
+            munmap(sub->code, sub->code_size);
+#endif
+    }
+
+    if (jit->subs)
+        mem_gc_free(interp, jit->subs);
+
+    mem_gc_free(interp, jit);
+    seg->jit = NULL;
+}
+
+
+/*
+
+=item C<static void * init_jit_core(PARROT_INTERP, Parrot_jit_runcore_t
+*runcore, opcode_t *pc)>
+
+Reads the threshold from the environment, then runs the ops starting at
+C<pc>.
+
+=cut
+
+*/
+
+PARROT_CAN_RETURN_NULL
+static void *
+init_jit_core(PARROT_INTERP, ARGIN(Parrot_jit_runcore_t *runcore), ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(init_jit_core)
+
+    STRING * const threshold_env = CONST_STRING(interp, "PARROT_JIT_THRESHOLD");
+    STRING * const threshold_str = Parrot_getenv(interp, threshold_env);
+
+    runcore->runops    = (Parrot_runcore_runops_fn_t) runops_jit_core;
+    runcore->core_lib  = PARROT_CORE_OPLIB_INIT(interp, 1);
+    runcore->threshold = JIT_DEFAULT_THRESHOLD;
+
+    if (!STRING_IS_NULL(threshold_str)) {
+        const INTVAL threshold = Parrot_str_to_int(interp, threshold_str);
+        if (threshold > 0)
+            runcore->threshold = threshold;
+    }
+
+    return runops_jit_core(interp, runcore, pc);
+}
+
+
+/*
+
+=item C<static opcode_t * runops_jit_core(PARROT_INTERP, Parrot_jit_runcore_t
+*runcore, opcode_t *pc)>
+
+Runs the Parrot operations starting at C<pc> until there are no more
+operations, in native code where a sub has been compiled, and compiling subs
+once they are hot.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static opcode_t *
+runops_jit_core(PARROT_INTERP, ARGIN(Parrot_jit_runcore_t *runcore), ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(runops_jit_core)
+    PackFile_ByteCode *sub_seg = NULL;
+    Parrot_jit_sub    *sub     = NULL;
+    opcode_t          *prev    = NULL;
+
+    while (pc) {
+        PackFile_ByteCode * const seg = interp->code;
+
+        if (seg != sub_seg || !sub || pc < sub->start || pc >= sub->end) {
+            sub     = find_jit_sub(interp, seg, pc);
+            sub_seg = seg;
+            if (sub)
+                ++sub->hotness;
+        }
+        else if (pc <= prev)
+            ++sub->hotness;
+
+        if (sub && !seg->save_func_table) {
+            if (!sub->entries && !sub->failed && sub->hotness >= runcore->threshold)
+                sub->failed = !compile_jit_sub(interp, runcore, seg, sub);
+
+            if (sub->entries && sub->entries[pc - sub->start]) {
+                const jit_enter_fn enter = (jit_enter_fn)D2FPTR(sub->code);
+                pc   = (enter)(interp, sub->entries[pc - sub->start]);
+                prev = NULL;
+                continue;
+            }
+        }
+
+        prev = pc;
+        Parrot_pcc_set_pc(interp, CURRENT_CONTEXT(interp), pc);
+        DO_OP(pc, interp);
+    }
+
+    return pc;
+}
+
+
+/*
+
+=item C<static Parrot_jit_sub * find_jit_sub(PARROT_INTERP, PackFile_ByteCode
+*seg, opcode_t *pc)>
+
+Returns the sub of C<seg> which C<pc> is in, or NULL if it is in none or the
+native code of C<seg> belongs to another interpreter.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static Parrot_jit_sub *
+find_jit_sub(PARROT_INTERP, ARGMOD(PackFile_ByteCode *seg), ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(find_jit_sub)
+    Parrot_jit_segment *jit = seg->jit;
+    size_t              lo, hi;
+
+    if (!jit)
+        jit = build_jit_segment(interp, seg);
+
+    if (jit->interp != interp)
+        return NULL;
+
+    /* find the last sub starting at or before pc */
+    lo = 0;
+    hi = jit->n_subs;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (jit->subs[mid].start <= pc)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0 || pc >= jit->subs[lo - 1].end)
+        return NULL;
+
+    return &jit->subs[lo - 1];
+}
+
+
+/*
+
+=item C<static Parrot_jit_segment * build_jit_segment(PARROT_INTERP,
+PackFile_ByteCode *seg)>
+
+Collects the subs of C<seg> from its constant table.
+
+=cut
+
+*/
+
+PARROT_CANNOT_RETURN_NULL
+static Parrot_jit_segment *
+build_jit_segment(PARROT_INTERP, ARGMOD(PackFile_ByteCode *seg))
+{
+    ASSERT_ARGS(build_jit_segment)
+    Parrot_jit_segment * const jit = mem_gc_allocate_zeroed_typed(interp, Parrot_jit_segment);
+    PackFile_ConstTable * const ct = seg->const_table;
+    STRING * const SUB = CONST_STRING(interp, "Sub");
+    size_t n = 0;
+    size_t i;
+
+    jit->interp = interp;
+
+    if (ct && ct->pmc.const_count)
+        jit->subs = mem_gc_allocate_n_zeroed_typed(interp, ct->pmc.const_count,
+                        Parrot_jit_sub);
+
+    for (i = 0; ct && i < (size_t)ct->pmc.const_count; ++i) {
+        PMC * const sub_pmc = ct->pmc.constants[i];
+        Parrot_Sub_attributes *sub;
+
+        if (PMC_IS_NULL(sub_pmc) || !VTABLE_isa(interp, sub_pmc, SUB))
+            continue;
+
+        PMC_get_sub(interp, sub_pmc, sub);
+
+        if (sub->seg != seg || sub->start_offs >= sub->end_offs
+        ||  sub->end_offs > seg->base.size)
+            continue;
+
+        jit->subs[n].start = seg->base.data + sub->start_offs;
+        jit->subs[n].end   = seg->base.data + sub->end_offs;
+        ++n;
+    }
+
+    qsort(jit->subs, n, sizeof (Parrot_jit_sub), compare_jit_subs);
+
+    /* keep only the first of overlapping subs */
+    jit->n_subs = 0;
+    for (i = 0; i < n; ++i) {
+        if (jit->n_subs && jit->subs[i].start < jit->subs[jit->n_subs - 1].end)
+            continue;
+        jit->subs[jit->n_subs++] = jit->subs[i];
+    }
+
+    seg->jit = jit;
+    return jit;
+}
+
+
+/*
+
+=item C<static int compare_jit_subs(const void *a, const void *b)>
+
+Orders subs by their first op, for C<qsort>.
+
+=cut
+
+*/
+
+PARROT_PURE_FUNCTION
+static int
+compare_jit_subs(ARGIN(const void *a), ARGIN(const void *b))
+{
+    ASSERT_ARGS(compare_jit_subs)
+    const Parrot_jit_sub * const sub_a = (const Parrot_jit_sub *)a;
+    const Parrot_jit_sub * const sub_b = (const Parrot_jit_sub *)b;
+
+    if (sub_a->start < sub_b->start)
+        return -1;
+    if (sub_a->start > sub_b->start)
+        return 1;
+    return 0;
+}
+
+
+/*
+
+=item C<static size_t jit_op_size(PARROT_INTERP, Parrot_jit_runcore_t *runcore,
+const PackFile_ByteCode *seg, const opcode_t *pc)>
+
+Returns the number of words of the op at C<pc>, including the arguments of the
+ops taking a variable number of them.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static size_t
+jit_op_size(PARROT_INTERP, ARGIN(Parrot_jit_runcore_t *runcore),
+        ARGIN(const PackFile_ByteCode *seg), ARGIN(const opcode_t *pc))
+{
+    ASSERT_ARGS(jit_op_size)
+    const op_info_t * const info = seg->op_info_table[*pc];
+    size_t size = info->op_count;
+
+    if (info->lib == runcore->core_lib) {
+        switch (OP_INFO_OPNUM(info)) {
+          case PARROT_OP_set_args_pc:
+          case PARROT_OP_get_results_pc:
+          case PARROT_OP_get_params_pc:
+          case PARROT_OP_set_returns_pc:
+            size += VTABLE_elements(interp, seg->const_table->pmc.constants[pc[1]]);
+            break;
+          default:
+            break;
+        }
+    }
+
+    return size;
+}
+
+
+/*
+
+=item C<static jit_template jit_template_for(const Parrot_jit_runcore_t
+*runcore, const op_info_t *info, int *is_num)>
+
+Returns the native template of the op described by C<info>, if there is one,
+and sets C<is_num> if it works on number registers.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+static jit_template
+jit_template_for(ARGIN(const Parrot_jit_runcore_t *runcore), ARGIN(const op_info_t *info),
+        ARGOUT(int *is_num))
+{
+    ASSERT_ARGS(jit_template_for)
+    static const struct {
+        const char   *name;
+        jit_template  template_id;
+        int           n_args;
+        int           n_args_alt;
+    } templates[] = {
+        { "set",    JIT_SET,    2, 2 },
+        { "add",    JIT_ADD,    2, 3 },
+        { "sub",    JIT_SUB,    2, 3 },
+        { "mul",    JIT_MUL,    2, 3 },
+        { "inc",    JIT_INC,    1, 1 },
+        { "dec",    JIT_DEC,    1, 1 },
+        { "eq",     JIT_EQ,     3, 3 },
+        { "ne",     JIT_NE,     3, 3 },
+        { "lt",     JIT_LT,     3, 3 },
+        { "le",     JIT_LE,     3, 3 },
+        { "gt",     JIT_GT,     3, 3 },
+        { "ge",     JIT_GE,     3, 3 },
+        { "if",     JIT_IF,     2, 2 },
+        { "unless", JIT_UNLESS, 2, 2 }
+    };
+    const int    n_args = info->op_count - 1;
+    jit_template found  = JIT_NONE;
+    int          has_num = 0;
+    size_t       i;
+    int          k;
+
+    *is_num = 0;
+
+    if (info->lib != runcore->core_lib)
+        return JIT_NONE;
+
+    for (i = 0; i < sizeof (templates) / sizeof (templates[0]); ++i) {
+        if (STREQ(info->name, templates[i].name)
+        && (n_args == templates[i].n_args || n_args == templates[i].n_args_alt)) {
+            found = templates[i].template_id;
+            break;
+        }
+    }
+
+    if (found == JIT_NONE)
+        return JIT_NONE;
+
+    for (k = 0; k < n_args; ++k) {
+        const arg_type_t type = info->types[k];
+
+        if (info->labels[k]) {
+            /* only a constant label as the last argument of a branch */
+            if (found < JIT_EQ || k != n_args - 1 || type != PARROT_ARG_IC)
+                return JIT_NONE;
+        }
+        else if (found >= JIT_EQ && k == n_args - 1)
+            return JIT_NONE;
+        else if (type == PARROT_ARG_N || type == PARROT_ARG_NC)
+            has_num = 1;
+        else if (type != PARROT_ARG_I && type != PARROT_ARG_IC)
+            return JIT_NONE;
+    }
+
+    if (has_num) {
+        /* all number arguments, except the source of set_n_i and set_n_ic */
+        for (k = 0; k < n_args; ++k) {
+            const arg_type_t type = info->types[k];
+
+            if (info->labels[k] || type == PARROT_ARG_N || type == PARROT_ARG_NC)
+                continue;
+            if (found != JIT_SET || k != 1)
+                return JIT_NONE;
+        }
+        *is_num = 1;
+    }
+
+    return found;
+}
+
+
+/*
+
+=item C<static int compile_jit_sub(PARROT_INTERP, Parrot_jit_runcore_t *runcore,
+PackFile_ByteCode *seg, Parrot_jit_sub *sub)>
+
+Generates the native code of C<sub>.  Returns false if that is not possible.
+
+=cut
+
+*/
+
+static int
+compile_jit_sub(PARROT_INTERP, ARGIN(Parrot_jit_runcore_t *runcore),
+        ARGIN(PackFile_ByteCode *seg), ARGMOD(Parrot_jit_sub *sub))
+{
+    ASSERT_ARGS(compile_jit_sub)
+#ifdef JIT_NATIVE
+    const size_t n = sub->end - sub->start;
+    jit_buffer   buf;
+    size_t       i;
+    int          ok = 1;
+    void        *mem;
+
+    memset(&buf, 0, sizeof (buf));
+    buf.native = mem_gc_allocate_n_zeroed_typed(interp, n, size_t);
+    buf.ops    = mem_gc_allocate_n_zeroed_typed(interp, n, char);
+
+    /* find the ops and the targets of their constant branches */
+    for (i = 0; ok && i < n;) {
+        const opcode_t * const pc = sub->start + i;
+        const op_info_t *info;
+        size_t size;
+        int    k;
+
+        if (*pc < 0 || (size_t)*pc >= seg->op_count || !seg->op_info_table[*pc]) {
+            ok = 0;
+            break;
+        }
+
+        info = seg->op_info_table[*pc];
+        size = jit_op_size(interp, runcore, seg, pc);
+
+        if (size < 1 || i + size > n) {
+            ok = 0;
+            break;
+        }
+
+        buf.ops[i] |= JIT_OP_START;
+
+        for (k = 0; k < info->op_count - 1; ++k) {
+            if (info->labels[k] && info->types[k] == PARROT_ARG_IC) {
+                const INTVAL target = (INTVAL)i + pc[k + 1];
+                if (target >= 0 && (size_t)target < n)
+                    buf.ops[target] |= JIT_OP_TARGET;
+            }
+        }
+
+        i += size;
+    }
+
+    /* a branch into the middle of an op is left to the runloop */
+    for (i = 0; ok && i < n; ++i)
+        if (buf.ops[i] == JIT_OP_TARGET)
+            buf.ops[i] = 0;
+
+    if (ok) {
+        emit_entry_and_exit(interp, &buf);
+
+        for (i = 0; ok && i < n; i += jit_op_size(interp, runcore, seg, sub->start + i)) {
+            buf.native[i] = buf.size;
+            if (buf.ops[i] & JIT_OP_TARGET)
+                buf.bp_loaded = 0;
+            if (!emit_template(interp, runcore, &buf, seg, sub, i))
+                emit_op_call(interp, runcore, &buf, seg, sub, i);
+        }
+
+        /* falling off the end of the sub */
+        emit_mov_imm(interp, &buf, JIT_RAX, PTR2INTVAL(sub->end));
+        patch_jump(&buf, emit_jump(interp, &buf, JIT_CC_NONE), buf.exit);
+
+        for (i = 0; i < buf.n_fixups; ++i)
+            patch_jump(&buf, buf.fixups[i].at, buf.native[buf.fixups[i].op]);
+    }
+
+    mem = ok
+        ? mmap(NULL, buf.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)
+        : MAP_FAILED;
+
+    if (mem == MAP_FAILED)
+        ok = 0;
+    else {
+        memcpy(mem, buf.code, buf.size);
+        if (mprotect(mem, buf.size, PROT_READ | PROT_EXEC)) {
+            munmap(mem, buf.size);
+            ok = 0;
+        }
+    }
+
+    if (ok) {
+        sub->code      = (char *)mem;
+        sub->code_size = buf.size;
+        sub->entries   = mem_gc_allocate_n_zeroed_typed(interp, n, void *);
+        for (i = 0; i < n; ++i)
+            if (buf.ops[i] & JIT_OP_START)
+                sub->entries[i] = sub->code + buf.native[i];
+    }
+
+    if (buf.code)
+        mem_gc_free(interp, buf.code);
+    if (buf.fixups)
+        mem_gc_free(interp, buf.fixups);
+    mem_gc_free(interp, buf.native);
+    mem_gc_free(interp, buf.ops);
+
+    return ok;
+#else
+    UNUSED(interp);
+    UNUSED(runcore);
+    UNUSED(seg);
+    UNUSED(sub);
+    return 0;
+#endif
+}
+
+
+/*
+
+=item C<static void emit_byte(PARROT_INTERP, jit_buffer *buf, unsigned int
+byte)>
+
+Appends C<byte> to the native code.
+
+=cut
+
+*/
+
+static void
+emit_byte(PARROT_INTERP, ARGMOD(jit_buffer *buf), unsigned int byte)
+{
+    ASSERT_ARGS(emit_byte)
+
+    if (buf->size == buf->alloc) {
+        const size_t alloc = buf->alloc ? buf->alloc * 2 : 1024;
+        buf->code  = buf->code
+                   ? mem_gc_realloc_n_typed(interp, buf->code, alloc, char)
+                   : mem_gc_allocate_n_typed(interp, alloc, char);
+        buf->alloc = alloc;
+    }
+
+    buf->code[buf->size++] = (char)(byte & 0xff);
+}
+
+
+/*
+
+=item C<static void emit_int32(PARROT_INTERP, jit_buffer *buf, INTVAL value)>
+
+=item C<static void emit_int64(PARROT_INTERP, jit_buffer *buf, INTVAL value)>
+
+Append C<value> to the native code as a little endian 32 or 64 bit number.
+
+=cut
+
+*/
+
+static void
+emit_int32(PARROT_INTERP, ARGMOD(jit_buffer *buf), INTVAL value)
+{
+    ASSERT_ARGS(emit_int32)
+    int i;
+
+    for (i = 0; i < 4; ++i)
+        emit_byte(interp, buf, (unsigned int)((UINTVAL)value >> (8 * i)));
+}
+
+static void
+emit_int64(PARROT_INTERP, ARGMOD(jit_buffer *buf), INTVAL value)
+{
+    ASSERT_ARGS(emit_int64)
+    int i;
+
+    for (i = 0; i < 8; ++i)
+        emit_byte(interp, buf, (unsigned int)((UINTVAL)value >> (8 * i)));
+}
+
+
+/*
+
+=item C<static void emit_opcode(PARROT_INTERP, jit_buffer *buf, unsigned int
+prefix, int wide, unsigned int opcode, int reg, int rm)>
+
+Appends the mandatory C<prefix> (if not 0), the REX prefix for a 64 bit
+operation if C<wide> and for the high halves of C<reg> and C<rm>, and the one
+or two byte C<opcode>.
+
+=cut
+
+*/
+
+static void
+emit_opcode(PARROT_INTERP, ARGMOD(jit_buffer *buf), unsigned int prefix, int wide,
+        unsigned int opcode, int reg, int rm)
+{
+    ASSERT_ARGS(emit_opcode)
+    const unsigned int rex = 0x40 | (wide ? 0x08 : 0) | ((reg & 8) ? 0x04 : 0)
+                                  | ((rm & 8) ? 0x01 : 0);
+
+    if (prefix)
+        emit_byte(interp, buf, prefix);
+    if (rex != 0x40)
+        emit_byte(interp, buf, rex);
+    if (opcode > 0xff)
+        emit_byte(interp, buf, opcode >> 8);
+    emit_byte(interp, buf, opcode & 0xff);
+}
+
+
+/*
+
+=item C<static void emit_op_mem(PARROT_INTERP, jit_buffer *buf, unsigned int
+prefix, int wide, unsigned int opcode, int reg, int base, INTVAL disp)>
+
+Appends an instruction with the register (or opcode extension) C<reg> and the
+memory operand C<[base + disp]>.
+
+=cut
+
+*/
+
+static void
+emit_op_mem(PARROT_INTERP, ARGMOD(jit_buffer *buf), unsigned int prefix, int wide,
+        unsigned int opcode, int reg, int base, INTVAL disp)
+{
+    ASSERT_ARGS(emit_op_mem)
+    const unsigned int mod = disp == 0 && (base & 7) != 5 ? 0
+                           : disp >= -128 && disp <= 127  ? 1
+                           : 2;
+
+    emit_opcode(interp, buf, prefix, wide, opcode, reg, base);
+    emit_byte(interp, buf, (mod << 6) | ((reg & 7) << 3) | (base & 7));
+
+    /* rsp and r12 as a base need a SIB byte */
+    if ((base & 7) == 4)
+        emit_byte(interp, buf, 0x24);
+
+    if (mod == 1)
+        emit_byte(interp, buf, (unsigned int)disp);
+    else if (mod == 2)
+        emit_int32(interp, buf, disp);
+}
+
+
+/*
+
+=item C<static void emit_op_reg(PARROT_INTERP, jit_buffer *buf, unsigned int
+prefix, int wide, unsigned int opcode, int reg, int rm)>
+
+Appends an instruction with the registers C<reg> and C<rm>.
+
+=cut
+
+*/
+
+static void
+emit_op_reg(PARROT_INTERP, ARGMOD(jit_buffer *buf), unsigned int prefix, int wide,
+        unsigned int opcode, int reg, int rm)
+{
+    ASSERT_ARGS(emit_op_reg)
+
+    emit_opcode(interp, buf, prefix, wide, opcode, reg, rm);
+    emit_byte(interp, buf, 0xc0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+
+/*
+
+=item C<static void emit_mov_imm(PARROT_INTERP, jit_buffer *buf, int reg, INTVAL
+value)>
+
+Appends C<mov reg, value>.
+
+=cut
+
+*/
+
+static void
+emit_mov_imm(PARROT_INTERP, ARGMOD(jit_buffer *buf), int reg, INTVAL value)
+{
+    ASSERT_ARGS(emit_mov_imm)
+
+    emit_opcode(interp, buf, 0, 1, 0xb8 + (reg & 7), 0, reg);
+    emit_int64(interp, buf, value);
+}
+
+
+/*
+
+=item C<static size_t emit_jump(PARROT_INTERP, jit_buffer *buf, int cc)>
+
+Appends a jump, conditional on C<cc> unless that is C<JIT_CC_NONE>, and
+returns the position of its displacement for C<patch_jump>.
+
+=item C<static void patch_jump(jit_buffer *buf, size_t at, size_t to)>
+
+Makes the jump whose displacement is at C<at> go to C<to>.
+
+=cut
+
+*/
+
+static size_t
+emit_jump(PARROT_INTERP, ARGMOD(jit_buffer *buf), int cc)
+{
+    ASSERT_ARGS(emit_jump)
+
+    if (cc == JIT_CC_NONE)
+        emit_byte(interp, buf, 0xe9);
+    else {
+        emit_byte(interp, buf, 0x0f);
+        emit_byte(interp, buf, 0x80 + cc);
+    }
+
+    emit_int32(interp, buf, 0);
+    return buf->size - 4;
+}
+
+static void
+patch_jump(ARGMOD(jit_buffer *buf), size_t at, size_t to)
+{
+    ASSERT_ARGS(patch_jump)
+    const INTVAL rel = (INTVAL)to - (INTVAL)(at + 4);
+    int i;
+
+    for (i = 0; i < 4; ++i)
+        buf->code[at + i] = (char)((UINTVAL)rel >> (8 * i));
+}
+
+
+/*
+
+=item C<static void emit_load_bp(PARROT_INTERP, jit_buffer *buf)>
+
+Appends the loading of the register file pointer of the current context.
+
+=cut
+
+*/
+
+static void
+emit_load_bp(PARROT_INTERP, ARGMOD(jit_buffer *buf))
+{
+    ASSERT_ARGS(emit_load_bp)
+
+    emit_op_mem(interp, buf, 0, 1, 0x8b, JIT_RAX, JIT_REG_INTERP,
+            offsetof(struct parrot_interp_t, ctx));
+    emit_op_mem(interp, buf, 0, 1, 0x8b, JIT_RAX, JIT_RAX, offsetof(PMC, data));
+    emit_op_mem(interp, buf, 0, 1, 0x8b, JIT_REG_BP, JIT_RAX, offsetof(Parrot_Context, bp));
+    buf->bp_loaded = 1;
+}
+
+
+/*
+
+=item C<static void emit_entry_and_exit(PARROT_INTERP, jit_buffer *buf)>
+
+Appends the code which enters the native code of a sub, called as a
+C<jit_enter_fn>, and the code which returns from it with the pc in C<rax>.
+
+=cut
+
+*/
+
+static void
+emit_entry_and_exit(PARROT_INTERP, ARGMOD(jit_buffer *buf))
+{
+    ASSERT_ARGS(emit_entry_and_exit)
+
+    /* save the callee saved registers we use; r13 keeps calls aligned */
+    emit_byte(interp, buf, 0x53);                      /* push rbx */
+    emit_byte(interp, buf, 0x41);
+    emit_byte(interp, buf, 0x54);                      /* push r12 */
+    emit_byte(interp, buf, 0x41);
+    emit_byte(interp, buf, 0x55);                      /* push r13 */
+    emit_op_reg(interp, buf, 0, 1, 0x89, JIT_RDI, JIT_REG_INTERP);
+    emit_load_bp(interp, buf);
+    emit_op_reg(interp, buf, 0, 0, 0xff, 4, JIT_RSI); /* jmp rsi */
+
+    buf->exit = buf->size;
+    emit_byte(interp, buf, 0x41);
+    emit_byte(interp, buf, 0x5d);                      /* pop r13 */
+    emit_byte(interp, buf, 0x41);
+    emit_byte(interp, buf, 0x5c);                      /* pop r12 */
+    emit_byte(interp, buf, 0x5b);                      /* pop rbx */
+    emit_byte(interp, buf, 0xc3);                      /* ret */
+}
+
+
+/*
+
+=item C<static void emit_goto(PARROT_INTERP, jit_buffer *buf, const
+Parrot_jit_sub *sub, size_t from, INTVAL target)>
+
+Appends a jump from the op at offset C<from> to the op at offset C<target>.
+Targets outside the sub leave the native code, and so do backward jumps while
+events are pending.
+
+=cut
+
+*/
+
+static void
+emit_goto(PARROT_INTERP, ARGMOD(jit_buffer *buf), ARGIN(const Parrot_jit_sub *sub),
+        size_t from, INTVAL target)
+{
+    ASSERT_ARGS(emit_goto)
+    const size_t n = sub->end - sub->start;
+
+    if (target < 0 || (size_t)target >= n || !(buf->ops[target] & JIT_OP_START)) {
+        emit_mov_imm(interp, buf, JIT_RAX, PTR2INTVAL(sub->start + target));
+        patch_jump(buf, emit_jump(interp, buf, JIT_CC_NONE), buf->exit);
+        return;
+    }
+
+    if ((size_t)target <= from) {
+        size_t skip;
+
+        /* cmp qword [interp->code->save_func_table], 0 */
+        emit_op_mem(interp, buf, 0, 1, 0x8b, JIT_RCX, JIT_REG_INTERP,
+                offsetof(struct parrot_interp_t, code));
+        emit_op_mem(interp, buf, 0, 1, 0x83, 7, JIT_RCX,
+                offsetof(PackFile_ByteCode, save_func_table));
+        emit_byte(interp, buf, 0);
+        skip = emit_jump(interp, buf, JIT_CC_E);
+        emit_mov_imm(interp, buf, JIT_RAX, PTR2INTVAL(sub->start + target));
+        patch_jump(buf, emit_jump(interp, buf, JIT_CC_NONE), buf->exit);
+        patch_jump(buf, skip, buf->size);
+    }
+
+    if (buf->n_fixups == buf->fixups_alloc) {
+        const size_t alloc = buf->fixups_alloc ? buf->fixups_alloc * 2 : 64;
+        buf->fixups = buf->fixups
+                    ? mem_gc_realloc_n_typed(interp, buf->fixups, alloc, jit_fixup)
+                    : mem_gc_allocate_n_typed(interp, alloc, jit_fixup);
+        buf->fixups_alloc = alloc;
+    }
+
+    buf->fixups[buf->n_fixups].at = emit_jump(interp, buf, JIT_CC_NONE);
+    buf->fixups[buf->n_fixups].op = target;
+    ++buf->n_fixups;
+}
+
+
+/*
+
+=item C<static void emit_op_call(PARROT_INTERP, Parrot_jit_runcore_t *runcore,
+jit_buffer *buf, const PackFile_ByteCode *seg, const Parrot_jit_sub *sub, size_t
+i)>
+
+Appends a call to the op function of the op at offset C<i>, followed by jumps
+to the pc it returns: the next op, one of its constant branch targets, or
+out of the native code.
+
+=cut
+
+*/
+
+static void
+emit_op_call(PARROT_INTERP, ARGIN(Parrot_jit_runcore_t *runcore), ARGMOD(jit_buffer *buf),
+        ARGIN(const PackFile_ByteCode *seg), ARGIN(const Parrot_jit_sub *sub), size_t i)
+{
+    ASSERT_ARGS(emit_op_call)
+    const opcode_t  * const pc   = sub->start + i;
+    const op_info_t * const info = seg->op_info_table[*pc];
+    const opcode_t  * const next = pc + jit_op_size(interp, runcore, seg, pc);
+    int has_labels = 0;
+    int k;
+
+    /* CURRENT_CONTEXT(interp)->current_pc = pc */
+    emit_op_mem(interp, buf, 0, 1, 0x8b, JIT_RAX, JIT_REG_INTERP,
+            offsetof(struct parrot_interp_t, ctx));
+    emit_op_mem(interp, buf, 0, 1, 0x8b, JIT_RAX, JIT_RAX, offsetof(PMC, data));
+    emit_mov_imm(interp, buf, JIT_RDI, PTR2INTVAL(pc));
+    emit_op_mem(interp, buf, 0, 1, 0x89, JIT_RDI, JIT_RAX,
+            offsetof(Parrot_Context, current_pc));
+
+    /* pc = op(pc, interp) */
+    emit_op_reg(interp, buf, 0, 1, 0x89, JIT_REG_INTERP, JIT_RSI);
+    emit_mov_imm(interp, buf, JIT_RAX, PTR2INTVAL(D2FPTR(OP_INFO_OPFUNC(info))));
+    emit_op_reg(interp, buf, 0, 0, 0xff, 2, JIT_RAX);  /* call rax */
+
+    /* the op may have switched contexts */
+    buf->bp_loaded = 0;
+
+    for (k = 0; k < info->op_count - 1; ++k)
+        if (info->labels[k] && info->types[k] == PARROT_ARG_IC)
+            has_labels = 1;
+
+    emit_mov_imm(interp, buf, JIT_RCX, PTR2INTVAL(next));
+    emit_op_reg(interp, buf, 0, 1, 0x3b, JIT_RAX, JIT_RCX);
+
+    if (!has_labels)
+        patch_jump(buf, emit_jump(interp, buf, JIT_CC_NE), buf->exit);
+    else {
+        const size_t to_next = emit_jump(interp, buf, JIT_CC_E);
+
+        for (k = 0; k < info->op_count - 1; ++k) {
+            if (info->labels[k] && info->types[k] == PARROT_ARG_IC) {
+                size_t skip;
+
+                emit_mov_imm(interp, buf, JIT_RCX, PTR2INTVAL(pc + pc[k + 1]));
+                emit_op_reg(interp, buf, 0, 1, 0x3b, JIT_RAX, JIT_RCX);
+                skip = emit_jump(interp, buf, JIT_CC_NE);
+                emit_goto(interp, buf, sub, i, (INTVAL)i + pc[k + 1]);
+                patch_jump(buf, skip, buf->size);
+            }
+        }
+
+        patch_jump(buf, emit_jump(interp, buf, JIT_CC_NONE), buf->exit);
+        patch_jump(buf, to_next, buf->size);
+    }
+}
+
+
+/*
+
+=item C<static void emit_int_arg(PARROT_INTERP, jit_buffer *buf, unsigned int
+opcode, int reg, const opcode_t *pc, const op_info_t *info, int k)>
+
+Appends the instruction C<opcode> (such as C<mov>, C<add> or C<cmp>) of C<reg>
+and the integer argument C<k> of the op at C<pc>, a register or a constant.
+
+=cut
+
+*/
+
+static void
+emit_int_arg(PARROT_INTERP, ARGMOD(jit_buffer *buf), unsigned int opcode, int reg,
+        ARGIN(const opcode_t *pc), ARGIN(const op_info_t *info), int k)
+{
+    ASSERT_ARGS(emit_int_arg)
+
+    if (info->types[k] == PARROT_ARG_IC) {
+        if (opcode == 0x8b)
+            emit_mov_imm(interp, buf, reg, pc[k + 1]);
+        else {
+            emit_mov_imm(interp, buf, JIT_RCX, pc[k + 1]);
+            emit_op_reg(interp, buf, 0, 1, opcode, reg, JIT_RCX);
+        }
+    }
+    else
+        emit_op_mem(interp, buf, 0, 1, opcode, reg, JIT_REG_BP, JIT_INT_DISP(pc[k + 1]));
+}
+
+
+/*
+
+=item C<static void emit_num_arg(PARROT_INTERP, jit_buffer *buf, unsigned int
+prefix, unsigned int opcode, const PackFile_ByteCode *seg, const opcode_t *pc,
+const op_info_t *info, int k)>
+
+Appends the SSE instruction C<opcode> (such as C<movsd>, C<addsd> or
+C<ucomisd>) of C<xmm0> and the number argument C<k> of the op at C<pc>, a
+register or a constant.  An integer argument is converted.
+
+=cut
+
+*/
+
+static void
+emit_num_arg(PARROT_INTERP, ARGMOD(jit_buffer *buf), unsigned int prefix,
+        unsigned int opcode, ARGIN(const PackFile_ByteCode *seg), ARGIN(const opcode_t *pc),
+        ARGIN(const op_info_t *info), int k)
+{
+    ASSERT_ARGS(emit_num_arg)
+    const arg_type_t type = info->types[k];
+
+    if (type == PARROT_ARG_N)
+        emit_op_mem(interp, buf, prefix, 0, opcode, JIT_XMM0, JIT_REG_BP,
+                JIT_NUM_DISP(pc[k + 1]));
+    else if (type == PARROT_ARG_I && opcode == 0x0f10)
+        emit_op_mem(interp, buf, 0xf2, 1, 0x0f2a, JIT_XMM0, JIT_REG_BP,
+                JIT_INT_DISP(pc[k + 1]));                /* cvtsi2sd */
+    else {
+        union { FLOATVAL n; INTVAL i; } bits;
+
+        bits.n = type == PARROT_ARG_NC
+               ? seg->const_table->num.constants[pc[k + 1]]
+               : (FLOATVAL)pc[k + 1];
+
+        /* movq xmm1, rax */
+        emit_mov_imm(interp, buf, JIT_RAX, bits.i);
+        emit_op_reg(interp, buf, 0x66, 1, 0x0f6e, JIT_XMM1, JIT_RAX);
+        emit_op_reg(interp, buf, prefix, 0, opcode, JIT_XMM0, JIT_XMM1);
+    }
+}
+
+
+/*
+
+=item C<static int emit_template(PARROT_INTERP, Parrot_jit_runcore_t *runcore,
+jit_buffer *buf, const PackFile_ByteCode *seg, const Parrot_jit_sub *sub, size_t
+i)>
+
+Appends the native template of the op at offset C<i>, if it has one.  Returns
+false if it has none.
+
+=cut
+
+*/
+
+static int
+emit_template(PARROT_INTERP, ARGIN(Parrot_jit_runcore_t *runcore), ARGMOD(jit_buffer *buf),
+        ARGIN(const PackFile_ByteCode *seg), ARGIN(const Parrot_jit_sub *sub), size_t i)
+{
+    ASSERT_ARGS(emit_template)
+    const opcode_t  * const pc   = sub->start + i;
+    const op_info_t * const info = seg->op_info_table[*pc];
+    const int        n_args      = info->op_count - 1;
+    int              is_num;
+    const jit_template template_id = jit_template_for(runcore, info, &is_num);
+    int              skip_cc     = JIT_CC_NONE;
+    size_t           skip_nan    = 0;
+    int              has_nan     = 0;
+    size_t           skip;
+
+    if (template_id == JIT_NONE)
+        return 0;
+
+    if (!buf->bp_loaded)
+        emit_load_bp(interp, buf);
+
+    if (!is_num) {
+        switch (template_id) {
+          case JIT_SET:
+            emit_int_arg(interp, buf, 0x8b, JIT_RAX, pc, info, 1);
+            emit_op_mem(interp, buf, 0, 1, 0x89, JIT_RAX, JIT_REG_BP, JIT_INT_DISP(pc[1]));
+            return 1;
+          case JIT_ADD:
+          case JIT_SUB:
+          case JIT_MUL:
+            {
+                const unsigned int opcode = template_id == JIT_ADD ? 0x03
+                                          : template_id == JIT_SUB ? 0x2b
+                                          : 0x0faf;
+                emit_int_arg(interp, buf, 0x8b, JIT_RAX, pc, info, n_args - 2);
+                emit_int_arg(interp, buf, opcode, JIT_RAX, pc, info, n_args - 1);
+                emit_op_mem(interp, buf, 0, 1, 0x89, JIT_RAX, JIT_REG_BP, JIT_INT_DISP(pc[1]));
+            }
+            return 1;
+          case JIT_INC:
+          case JIT_DEC:
+            emit_op_mem(interp, buf, 0, 1, 0xff, template_id == JIT_INC ? 0 : 1,
+                    JIT_REG_BP, JIT_INT_DISP(pc[1]));
+            return 1;
+          case JIT_IF:
+          case JIT_UNLESS:
+            emit_op_mem(interp, buf, 0, 1, 0x83, 7, JIT_REG_BP, JIT_INT_DISP(pc[1]));
+            emit_byte(interp, buf, 0);
+            skip_cc = template_id == JIT_IF ? JIT_CC_E : JIT_CC_NE;
+            break;
+          default:
+            emit_int_arg(interp, buf, 0x8b, JIT_RAX, pc, info, 0);
+            emit_int_arg(interp, buf, 0x3b, JIT_RAX, pc, info, 1);
+            skip_cc = template_id == JIT_EQ ? JIT_CC_NE
+                    : template_id == JIT_NE ? JIT_CC_E
+                    : template_id == JIT_LT ? JIT_CC_GE
+                    : template_id == JIT_LE ? JIT_CC_G
+                    : template_id == JIT_GT ? JIT_CC_LE
+                    : JIT_CC_L;
+            break;
+        }
+    }
+    else {
+        switch (template_id) {
+          case JIT_SET:
+            emit_num_arg(interp, buf, 0xf2, 0x0f10, seg, pc, info, 1);
+            emit_op_mem(interp, buf, 0xf2, 0, 0x0f11, JIT_XMM0, JIT_REG_BP,
+                    JIT_NUM_DISP(pc[1]));
+            return 1;
+          case JIT_ADD:
+          case JIT_SUB:
+          case JIT_MUL:
+            {
+                const unsigned int opcode = template_id == JIT_ADD ? 0x0f58
+                                          : template_id == JIT_SUB ? 0x0f5c
+                                          : 0x0f59;
+                emit_num_arg(interp, buf, 0xf2, 0x0f10, seg, pc, info, n_args - 2);
+                emit_num_arg(interp, buf, 0xf2, opcode, seg, pc, info, n_args - 1);
+                emit_op_mem(interp, buf, 0xf2, 0, 0x0f11, JIT_XMM0, JIT_REG_BP,
+                        JIT_NUM_DISP(pc[1]));
+            }
+            return 1;
+          case JIT_INC:
+          case JIT_DEC:
+            {
+                union { FLOATVAL n; INTVAL i; } one;
+                one.n = 1.0;
+                emit_num_arg(interp, buf, 0xf2, 0x0f10, seg, pc, info, 0);
+                emit_mov_imm(interp, buf, JIT_RAX, one.i);
+                emit_op_reg(interp, buf, 0x66, 1, 0x0f6e, JIT_XMM1, JIT_RAX);
+                emit_op_reg(interp, buf, 0xf2, 0, template_id == JIT_INC ? 0x0f58 : 0x0f5c,
+                        JIT_XMM0, JIT_XMM1);
+                emit_op_mem(interp, buf, 0xf2, 0, 0x0f11, JIT_XMM0, JIT_REG_BP,
+                        JIT_NUM_DISP(pc[1]));
+            }
+            return 1;
+          case JIT_IF:
+          case JIT_UNLESS:
+            /* compare with 0.0; NaN is true, as FLOAT_IS_ZERO says it is not 0 */
+            emit_num_arg(interp, buf, 0xf2, 0x0f10, seg, pc, info, 0);
+            emit_op_reg(interp, buf, 0x66, 0, 0x0f57, JIT_XMM1, JIT_XMM1); /* xorpd */
+            emit_op_reg(interp, buf, 0x66, 0, 0x0f2e, JIT_XMM0, JIT_XMM1); /* ucomisd */
+            has_nan = 1;
+            skip_cc = template_id == JIT_IF ? JIT_CC_E : JIT_CC_NE;
+            break;
+          default:
+            {
+                /* a < b and a <= b are tested as b > a and b >= a, which are
+                 * false for NaN like the C comparisons */
+                const int swap = template_id == JIT_LT || template_id == JIT_LE;
+                emit_num_arg(interp, buf, 0xf2, 0x0f10, seg, pc, info, swap ? 1 : 0);
+                emit_num_arg(interp, buf, 0x66, 0x0f2e, seg, pc, info, swap ? 0 : 1);
+                has_nan = template_id == JIT_EQ || template_id == JIT_NE;
+                skip_cc = template_id == JIT_EQ ? JIT_CC_NE
+                        : template_id == JIT_NE ? JIT_CC_E
+                        : template_id == JIT_LT || template_id == JIT_GT ? JIT_CC_BE
+                        : JIT_CC_B;
+            }
+            break;
+        }
+    }
+
+    /* the branch: unordered means not equal */
+    if (has_nan) {
+        if (skip_cc == JIT_CC_NE)
+            skip_nan = emit_jump(interp, buf, JIT_CC_P);
+        else {
+            const size_t take = emit_jump(interp, buf, JIT_CC_P);
+            skip = emit_jump(interp, buf, skip_cc);
+            patch_jump(buf, take, buf->size);
+            emit_goto(interp, buf, sub, i, (INTVAL)i + pc[n_args]);
+            patch_jump(buf, skip, buf->size);
+            return 1;
+        }
+    }
+
+    skip = emit_jump(interp, buf, skip_cc);
+    emit_goto(interp, buf, sub, i, (INTVAL)i + pc[n_args]);
+    patch_jump(buf, skip, buf->size);
+    if (has_nan)
+        patch_jump(buf, skip_nan, buf->size);
+
+    return 1;
+}
+
+
+/*
+
+=back
+
+=head1 SEE ALSO
+
+F<src/runcore/cores.c>, F<docs/running.pod>.
+
+=cut
+
+*/
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
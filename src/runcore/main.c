@@ -19,7 +19,9 @@ The runcore API handles running the operations.
 
 #include "parrot/parrot.h"
 #include "parrot/runcore_api.h"
+#include "parrot/runcore_jit.h"
 #include "parrot/runcore_profiling.h"
+#include "parrot/runcore_sampling.h"
 #include "parrot/runcore_subprof.h"
 #include "parrot/oplib/core_ops.h"
 #include "parrot/oplib/ops.h"
@@ -75,6 +77,8 @@ Parrot_runcore_init(PARROT_INTERP)
     Parrot_runcore_debugger_init(interp);
 
     Parrot_runcore_profiling_init(interp);
+    Parrot_runcore_sampling_init(interp);
+    Parrot_runcore_jit_init(interp);
 
     /* set the default runcore */
     Parrot_runcore_switch(interp, default_core);
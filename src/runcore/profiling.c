@@ -33,15 +33,43 @@ Functions controlling Parrot's profiling runcore.
 #define code_start interp->code->base.data
 #define code_end (interp->code->base.data + interp->code->base.size)
 
+/* buffers for the binary output.  The runcore fills chunks[head]; the chunks
+ * from tail onwards (full of them) are waiting for the flusher thread. */
+struct profiling_ring_t {
+    char          *chunks[PPROF_RING_CHUNKS];
+    size_t         used[PPROF_RING_CHUNKS];
+    unsigned int   head;
+    unsigned int   tail;
+    unsigned int   full;
+    int            done;    /* set once the runcore has queued its last chunk */
+    int            failed;  /* set if a write came up short */
+    FILE          *fd;
+    Parrot_mutex   lock;
+    Parrot_cond    cond;
+    Parrot_thread  flusher;
+};
+
 /* HEADERIZER HFILE: include/parrot/runcore_profiling.h */
 
 /* HEADERIZER BEGIN: static */
 /* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
 
+static UINTVAL binary_string_id(PARROT_INTERP,
+    ARGIN(Parrot_profiling_runcore_t *runcore),
+    ARGIN(const char *str))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
 static void destroy_basic_output(PARROT_INTERP,
     ARGIN(Parrot_profiling_runcore_t *runcore))
         __attribute__nonnull__(2);
 
+static void destroy_binary_output(PARROT_INTERP,
+    ARGIN(Parrot_profiling_runcore_t *runcore))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
 static void destroy_profiling_core(PARROT_INTERP,
     ARGIN(Parrot_profiling_runcore_t *runcore))
         __attribute__nonnull__(1)
@@ -74,11 +102,23 @@ static void init_basic_output(PARROT_INTERP,
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+static void init_binary_output(PARROT_INTERP,
+    ARGIN(Parrot_profiling_runcore_t *runcore))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
 static void init_null_output(PARROT_INTERP,
     ARGIN(Parrot_profiling_runcore_t *runcore))
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+static void init_output_file(PARROT_INTERP,
+    ARGIN(Parrot_profiling_runcore_t *runcore),
+    ARGIN(const char *mode))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
 PARROT_CAN_RETURN_NULL
 static void * init_profiling_core(PARROT_INTERP,
     ARGIN(Parrot_profiling_runcore_t *runcore),
@@ -130,6 +170,14 @@ static void record_values_ascii_pprof(PARROT_INTERP,
         __attribute__nonnull__(2)
         __attribute__nonnull__(3);
 
+static void record_values_binary_pprof(PARROT_INTERP,
+    ARGIN(Parrot_profiling_runcore_t * runcore),
+    ARGIN(PPROF_DATA *pprof_data),
+    ARGIN_NULLOK(Parrot_profiling_line type))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
 static void record_version_and_cli(PARROT_INTERP,
     ARGIN(Parrot_profiling_runcore_t *runcore),
     ARGIN(PPROF_DATA* pprof_data))
@@ -137,6 +185,41 @@ static void record_version_and_cli(PARROT_INTERP,
         __attribute__nonnull__(2)
         __attribute__nonnull__(3);
 
+PARROT_CAN_RETURN_NULL
+static void * ring_flush_loop(ARGMOD(void *arg))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*arg);
+
+static void ring_next_chunk(ARGMOD(Parrot_profiling_ring *ring))
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*ring);
+
+static void ring_write_byte(
+    ARGMOD(Parrot_profiling_ring *ring),
+    unsigned char byte)
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*ring);
+
+static void ring_write_bytes(
+    ARGMOD(Parrot_profiling_ring *ring),
+    ARGIN(const char *data),
+    size_t len)
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        FUNC_MODIFIES(*ring);
+
+static void ring_write_chunk(
+    ARGMOD(Parrot_profiling_ring *ring),
+    unsigned int idx)
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*ring);
+
+static void ring_write_varint(
+    ARGMOD(Parrot_profiling_ring *ring),
+    UHUGEINTVAL value)
+        __attribute__nonnull__(1)
+        FUNC_MODIFIES(*ring);
+
 PARROT_WARN_UNUSED_RESULT
 PARROT_CAN_RETURN_NULL
 static opcode_t * runops_profiling_core(PARROT_INTERP,
@@ -151,8 +234,15 @@ static void store_postop_time(PARROT_INTERP,
         __attribute__nonnull__(1)
         __attribute__nonnull__(2);
 
+#define ASSERT_ARGS_binary_string_id __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(str))
 #define ASSERT_ARGS_destroy_basic_output __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(runcore))
+#define ASSERT_ARGS_destroy_binary_output __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore))
 #define ASSERT_ARGS_destroy_profiling_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(runcore))
@@ -170,9 +260,16 @@ static void store_postop_time(PARROT_INTERP,
 #define ASSERT_ARGS_init_basic_output __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(runcore))
+#define ASSERT_ARGS_init_binary_output __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore))
 #define ASSERT_ARGS_init_null_output __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(runcore))
+#define ASSERT_ARGS_init_output_file __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(mode))
 #define ASSERT_ARGS_init_profiling_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(runcore) \
@@ -199,10 +296,27 @@ static void store_postop_time(PARROT_INTERP,
 #define ASSERT_ARGS_record_values_ascii_pprof __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(runcore) \
     , PARROT_ASSERT_ARG(pprof_data))
+#define ASSERT_ARGS_record_values_binary_pprof __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(pprof_data))
 #define ASSERT_ARGS_record_version_and_cli __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(runcore) \
     , PARROT_ASSERT_ARG(pprof_data))
+#define ASSERT_ARGS_ring_flush_loop __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(arg))
+#define ASSERT_ARGS_ring_next_chunk __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ring))
+#define ASSERT_ARGS_ring_write_byte __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ring))
+#define ASSERT_ARGS_ring_write_bytes __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ring) \
+    , PARROT_ASSERT_ARG(data))
+#define ASSERT_ARGS_ring_write_chunk __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ring))
+#define ASSERT_ARGS_ring_write_varint __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(ring))
 #define ASSERT_ARGS_runops_profiling_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
        PARROT_ASSERT_ARG(interp) \
     , PARROT_ASSERT_ARG(runcore) \
@@ -291,6 +405,11 @@ init_profiling_core(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore), A
             runcore->output.store   = record_values_ascii_pprof;
             runcore->output.destroy = destroy_basic_output;
         }
+        else if (STRING_equal(interp, profile_format_str, CONST_STRING(interp, "binary"))) {
+            runcore->output.init    = init_binary_output;
+            runcore->output.store   = record_values_binary_pprof;
+            runcore->output.destroy = destroy_binary_output;
+        }
         else if (STRING_equal(interp, profile_format_str, CONST_STRING(interp, "none"))) {
             runcore->output.init    = init_null_output;
             runcore->output.store   = NULL;
@@ -298,7 +417,8 @@ init_profiling_core(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore), A
         }
         else {
             Parrot_eprintf(interp, "'%Ss' is not a valid profiling output format.\n", output_str);
-            Parrot_eprintf(interp, "Valid values are pprof and none.  The default is pprof.\n");
+            Parrot_eprintf(interp,
+                "Valid values are pprof, binary and none.  The default is pprof.\n");
             Parrot_x_jump_out(interp, 1);
         }
     }
@@ -493,8 +613,8 @@ ARGIN(PMC *ctx_pmc))
     INTVAL line_num = Parrot_hash_value_to_int(interp, runcore->line_cache,
             Parrot_hash_get(interp, runcore->line_cache, ctx->current_pc));
 
-    /* Parrot_sub_get_line_from_pc eats up about 20-30% of execution time
-     * *with* this cache in place. */
+    /* Parrot_sub_get_line_from_pc is a binary search over the segment's ops,
+     * which is still slower than this cache on every op. */
     if (line_num == 0) {
         line_num = Parrot_sub_get_line_from_pc(interp,
                 Parrot_pcc_get_sub(interp, ctx_pmc), ctx->current_pc);
@@ -789,8 +909,10 @@ destroy_profiling_core(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore)
     char * const filename_cstr = Parrot_str_to_cstring(interp, runcore->profile_filename);
 
     fprintf(stderr, "\nPROFILING RUNCORE: wrote profile to %s\n"
-        "Use tools/dev/pprof2cg.pl to generate Callgrind-compatible "
-        "output from this file.\n", filename_cstr);
+        "Use %s to generate Callgrind-compatible "
+        "output from this file.\n", filename_cstr,
+        runcore->output.store == record_values_binary_pprof
+            ? "pprof2cg" : "tools/dev/pprof2cg.pl");
 
     Parrot_str_free_cstring(filename_cstr);
     Parrot_hash_destroy(interp, runcore->line_cache);
@@ -881,6 +1003,28 @@ init_basic_output(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore))
 {
     ASSERT_ARGS(init_basic_output)
 
+    init_output_file(interp, runcore, "w");
+}
+
+/*
+
+=item C<static void init_output_file(PARROT_INTERP, Parrot_profiling_runcore_t
+*runcore, const char *mode)>
+
+Open the file named by C<PARROT_PROFILING_FILENAME> (or a default name) with
+the given C<fopen> mode and read the environment variables shared by all
+output formats.
+
+=cut
+
+*/
+
+static void
+init_output_file(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore),
+        ARGIN(const char *mode))
+{
+    ASSERT_ARGS(init_output_file)
+
     /* figure out where to write the output */
     char   *profile_filename_cstr;
     STRING * const env_filename_str = Parrot_getenv(interp, CONST_STRING(interp, "PARROT_PROFILING_FILENAME"));
@@ -902,12 +1046,12 @@ init_basic_output(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore))
             runcore->profile_filename = lc_filename;
         }
         else
-            runcore->profile_fd = fopen(profile_filename_cstr, "w");
+            runcore->profile_fd = fopen(profile_filename_cstr, mode);
     }
     else {
         runcore->profile_filename = Parrot_sprintf_c(interp, "parrot.pprof.%d", getpid());
         profile_filename_cstr     = Parrot_str_to_cstring(interp, runcore->profile_filename);
-        runcore->profile_fd       = fopen(profile_filename_cstr, "w");
+        runcore->profile_fd       = fopen(profile_filename_cstr, mode);
     }
 
     /* put profile_filename in the gc root set so it won't get collected */
@@ -953,6 +1097,413 @@ destroy_basic_output(SHIM_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore))
 
 /*
 
+=item C<static void init_binary_output(PARROT_INTERP, Parrot_profiling_runcore_t
+*runcore)>
+
+Perform initialization needed by the binary output methods: open the output
+file, set up the string tables and the ring of output buffers, and start the
+thread that flushes full buffers to disk.
+
+=cut
+
+*/
+
+static void
+init_binary_output(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore))
+{
+    ASSERT_ARGS(init_binary_output)
+
+    Parrot_profiling_ring * const ring = mem_gc_allocate_zeroed_typed(interp,
+                                            Parrot_profiling_ring);
+    int i;
+
+    init_output_file(interp, runcore, "wb");
+
+    for (i = 0; i < PPROF_RING_CHUNKS; ++i)
+        ring->chunks[i] = (char *)mem_sys_allocate(PPROF_RING_CHUNK_SIZE);
+
+    ring->fd                = runcore->profile_fd;
+    runcore->ring           = ring;
+    runcore->string_ids     = Parrot_hash_new_cstring_hash(interp);
+    runcore->opname_ids     = Parrot_hash_new_pointer_hash(interp);
+    runcore->last_string_id = 0;
+    runcore->prev_line      = 0;
+
+#ifdef PARROT_HAS_THREADS
+    MUTEX_INIT(ring->lock);
+    COND_INIT(ring->cond);
+    THREAD_CREATE_JOINABLE(ring->flusher, ring_flush_loop, ring);
+#endif
+
+    ring_write_bytes(ring, PPROF_BINARY_MAGIC, PPROF_BINARY_MAGIC_LEN);
+}
+
+/*
+
+=item C<static void record_values_binary_pprof(PARROT_INTERP,
+Parrot_profiling_runcore_t * runcore, PPROF_DATA *pprof_data,
+Parrot_profiling_line type)>
+
+Record profiling data in the compact binary format described in
+F<include/parrot/runcore_profiling.h>.  Namespace, file and op names are
+interned so that each distinct string is written only once, and line numbers
+are written as the difference from the previous op's line.
+
+=cut
+
+*/
+
+static void
+record_values_binary_pprof(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t * runcore),
+    ARGIN(PPROF_DATA *pprof_data), ARGIN_NULLOK(Parrot_profiling_line type))
+{
+    ASSERT_ARGS(record_values_binary_pprof)
+
+    Parrot_profiling_ring * const ring = runcore->ring;
+
+    switch (type) {
+        case PPROF_LINE_CONTEXT_SWITCH:
+            {
+                const UINTVAL ns_id   = binary_string_id(interp, runcore,
+                                (const char *) pprof_data[PPROF_DATA_NAMESPACE]);
+                const UINTVAL file_id = binary_string_id(interp, runcore,
+                                (const char *) pprof_data[PPROF_DATA_FILENAME]);
+                ring_write_byte(ring, PPROF_BINARY_CONTEXT_SWITCH);
+                ring_write_varint(ring, ns_id);
+                ring_write_varint(ring, file_id);
+                ring_write_varint(ring, (UHUGEINTVAL) pprof_data[PPROF_DATA_SUB_ADDR]);
+                ring_write_varint(ring, (UHUGEINTVAL) pprof_data[PPROF_DATA_CTX_ADDR]);
+            }
+            break;
+
+        case PPROF_LINE_OP:
+            {
+                const char * const opname = (const char *) pprof_data[PPROF_DATA_OPNAME];
+                const INTVAL       line   = (INTVAL) pprof_data[PPROF_DATA_LINE];
+                const PPROF_DATA   time   = pprof_data[PPROF_DATA_TIME];
+                const HUGEINTVAL   delta  = (HUGEINTVAL) line - runcore->prev_line;
+                UINTVAL            op_id  = (UINTVAL) Parrot_hash_get(interp,
+                                                runcore->opname_ids, opname);
+
+                /* op names are static, so a pointer lookup avoids hashing
+                 * the name on every op */
+                if (!op_id) {
+                    DECL_CONST_CAST;
+                    op_id = binary_string_id(interp, runcore, opname);
+                    Parrot_hash_put(interp, runcore->opname_ids,
+                            PARROT_const_cast(void *, opname), (void *) op_id);
+                }
+
+                ring_write_byte(ring, PPROF_BINARY_OP);
+                ring_write_varint(ring, op_id);
+                ring_write_varint(ring, delta < 0
+                        ? ((UHUGEINTVAL) -(delta + 1) << 1) | 1
+                        : (UHUGEINTVAL) delta << 1);
+                ring_write_varint(ring, time < 0 ? 0 : (UHUGEINTVAL) time);
+                runcore->prev_line = line;
+            }
+            break;
+
+        case PPROF_LINE_ANNOTATION:
+            {
+                const UINTVAL name_id  = binary_string_id(interp, runcore,
+                            (const char *) pprof_data[PPROF_DATA_ANNOTATION_NAME]);
+                const UINTVAL value_id = binary_string_id(interp, runcore,
+                            (const char *) pprof_data[PPROF_DATA_ANNOTATION_VALUE]);
+                ring_write_byte(ring, PPROF_BINARY_ANNOTATION);
+                ring_write_varint(ring, name_id);
+                ring_write_varint(ring, value_id);
+            }
+            break;
+
+        case PPROF_LINE_CLI:
+            {
+                const UINTVAL cli_id = binary_string_id(interp, runcore,
+                            (const char *) pprof_data[PPROF_DATA_CLI]);
+                ring_write_byte(ring, PPROF_BINARY_CLI);
+                ring_write_varint(ring, cli_id);
+            }
+            break;
+
+        case PPROF_LINE_VERSION:
+            ring_write_byte(ring, PPROF_BINARY_VERSION);
+            ring_write_varint(ring, (UHUGEINTVAL) pprof_data[PPROF_DATA_VERSION]);
+            break;
+
+        case PPROF_LINE_END_OF_RUNLOOP:
+            ring_write_byte(ring, PPROF_BINARY_END_OF_RUNLOOP);
+            break;
+
+        default:
+            break;
+    } /* switch */
+}
+
+/*
+
+=item C<static void destroy_binary_output(PARROT_INTERP,
+Parrot_profiling_runcore_t *runcore)>
+
+Hand the last partly-filled buffer to the flusher, wait for everything to
+reach the file and free the string tables and the ring. The file is closed
+unless it is C<stdout> or C<stderr>.
+
+=cut
+
+*/
+
+static void
+destroy_binary_output(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore))
+{
+    ASSERT_ARGS(destroy_binary_output)
+
+    Parrot_profiling_ring * const ring = runcore->ring;
+    int i;
+
+    if (ring->used[ring->head])
+        ring_next_chunk(ring);
+
+#ifdef PARROT_HAS_THREADS
+    {
+        void *retval;
+
+        LOCK(ring->lock);
+        ring->done = 1;
+        COND_SIGNAL(ring->cond);
+        UNLOCK(ring->lock);
+
+        JOIN(ring->flusher, retval);
+        UNUSED(retval);
+        MUTEX_DESTROY(ring->lock);
+        COND_DESTROY(ring->cond);
+    }
+#endif
+
+    if (ring->failed)
+        fprintf(stderr, "PROFILING RUNCORE: short write, profile is incomplete\n");
+
+    /* only close the file if init_output_file opened it */
+    if (runcore->profile_fd == stdout || runcore->profile_fd == stderr)
+        fflush(runcore->profile_fd);
+    else
+        fclose(runcore->profile_fd);
+
+    for (i = 0; i < PPROF_RING_CHUNKS; ++i)
+        mem_sys_free(ring->chunks[i]);
+    mem_gc_free(interp, ring);
+    runcore->ring = NULL;
+
+    parrot_hash_iterate(runcore->string_ids,
+        mem_gc_free(interp, _bucket->key););
+    Parrot_hash_destroy(interp, runcore->string_ids);
+    Parrot_hash_destroy(interp, runcore->opname_ids);
+}
+
+/*
+
+=item C<static UINTVAL binary_string_id(PARROT_INTERP,
+Parrot_profiling_runcore_t *runcore, const char *str)>
+
+Return the id of C<str> in the binary output's string table, writing a string
+record the first time a given string is seen.
+
+=cut
+
+*/
+
+static UINTVAL
+binary_string_id(PARROT_INTERP, ARGIN(Parrot_profiling_runcore_t *runcore),
+        ARGIN(const char *str))
+{
+    ASSERT_ARGS(binary_string_id)
+
+    UINTVAL id = (UINTVAL) Parrot_hash_get(interp, runcore->string_ids, str);
+
+    if (!id) {
+        const size_t len = strlen(str);
+        char * const key = mem_gc_allocate_n_typed(interp, len + 1, char);
+
+        memcpy(key, str, len + 1);
+        id = ++runcore->last_string_id;
+        Parrot_hash_put(interp, runcore->string_ids, key, (void *) id);
+
+        ring_write_byte(runcore->ring, PPROF_BINARY_STRING);
+        ring_write_varint(runcore->ring, id);
+        ring_write_varint(runcore->ring, len);
+        ring_write_bytes(runcore->ring, str, len);
+    }
+
+    return id;
+}
+
+/*
+
+=item C<static void ring_write_byte(Parrot_profiling_ring *ring, unsigned char
+byte)>
+
+=item C<static void ring_write_varint(Parrot_profiling_ring *ring, UHUGEINTVAL
+value)>
+
+=item C<static void ring_write_bytes(Parrot_profiling_ring *ring, const char
+*data, size_t len)>
+
+Append a byte, an unsigned LEB128 varint or a run of bytes to the current
+buffer of the ring, moving on to the next buffer as each one fills up.
+
+=cut
+
+*/
+
+static void
+ring_write_byte(ARGMOD(Parrot_profiling_ring *ring), unsigned char byte)
+{
+    ASSERT_ARGS(ring_write_byte)
+
+    if (ring->used[ring->head] == PPROF_RING_CHUNK_SIZE)
+        ring_next_chunk(ring);
+
+    ring->chunks[ring->head][ring->used[ring->head]++] = (char) byte;
+}
+
+static void
+ring_write_varint(ARGMOD(Parrot_profiling_ring *ring), UHUGEINTVAL value)
+{
+    ASSERT_ARGS(ring_write_varint)
+
+    char   buf[(sizeof (UHUGEINTVAL) * 8 + 6) / 7];
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        buf[len++] = (char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (char) value;
+
+    ring_write_bytes(ring, buf, len);
+}
+
+static void
+ring_write_bytes(ARGMOD(Parrot_profiling_ring *ring), ARGIN(const char *data), size_t len)
+{
+    ASSERT_ARGS(ring_write_bytes)
+
+    while (len) {
+        size_t room = PPROF_RING_CHUNK_SIZE - ring->used[ring->head];
+
+        if (!room) {
+            ring_next_chunk(ring);
+            room = PPROF_RING_CHUNK_SIZE;
+        }
+        if (room > len)
+            room = len;
+
+        memcpy(ring->chunks[ring->head] + ring->used[ring->head], data, room);
+        ring->used[ring->head] += room;
+        data                   += room;
+        len                    -= room;
+    }
+}
+
+/*
+
+=item C<static void ring_next_chunk(Parrot_profiling_ring *ring)>
+
+Queue the current buffer for writing and start filling the next one.  If every
+other buffer is still waiting for the flusher, block until one is free.
+Without thread support the buffer is written out directly.
+
+=cut
+
+*/
+
+static void
+ring_next_chunk(ARGMOD(Parrot_profiling_ring *ring))
+{
+    ASSERT_ARGS(ring_next_chunk)
+
+#ifdef PARROT_HAS_THREADS
+    LOCK(ring->lock);
+    while (ring->full == PPROF_RING_CHUNKS - 1)
+        COND_WAIT(ring->cond, ring->lock);
+
+    ++ring->full;
+    ring->head = (ring->head + 1) % PPROF_RING_CHUNKS;
+    COND_SIGNAL(ring->cond);
+    UNLOCK(ring->lock);
+#else
+    ring_write_chunk(ring, ring->head);
+#endif
+
+    ring->used[ring->head] = 0;
+}
+
+/*
+
+=item C<static void ring_write_chunk(Parrot_profiling_ring *ring, unsigned int
+idx)>
+
+Write the contents of buffer C<idx> to the output file.
+
+=cut
+
+*/
+
+static void
+ring_write_chunk(ARGMOD(Parrot_profiling_ring *ring), unsigned int idx)
+{
+    ASSERT_ARGS(ring_write_chunk)
+
+    if (fwrite(ring->chunks[idx], 1, ring->used[idx], ring->fd) != ring->used[idx])
+        ring->failed = 1;
+}
+
+/*
+
+=item C<static void * ring_flush_loop(void *arg)>
+
+Body of the flusher thread: write out full buffers in order until the runcore
+says it is done and nothing is left to write.
+
+=cut
+
+*/
+
+PARROT_CAN_RETURN_NULL
+static void *
+ring_flush_loop(ARGMOD(void *arg))
+{
+    ASSERT_ARGS(ring_flush_loop)
+
+#ifdef PARROT_HAS_THREADS
+    Parrot_profiling_ring * const ring = (Parrot_profiling_ring *) arg;
+
+    LOCK(ring->lock);
+    while (1) {
+        while (!ring->full && !ring->done)
+            COND_WAIT(ring->cond, ring->lock);
+
+        if (!ring->full)
+            break;
+
+        /* the runcore never touches a queued buffer, so write it unlocked */
+        UNLOCK(ring->lock);
+        ring_write_chunk(ring, ring->tail);
+        LOCK(ring->lock);
+
+        ring->tail = (ring->tail + 1) % PPROF_RING_CHUNKS;
+        --ring->full;
+        COND_SIGNAL(ring->cond);
+    }
+    UNLOCK(ring->lock);
+#else
+    UNUSED(arg);
+#endif
+
+    return NULL;
+}
+
+/*
+
 =item C<static void init_null_output(PARROT_INTERP, Parrot_profiling_runcore_t
 *runcore)>
 
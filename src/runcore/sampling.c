@@ -0,0 +1,678 @@
+/*
+Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+src/runcore/sampling.c - Parrot's sampling profiler
+
+=head1 DESCRIPTION
+
+This compilation unit implements a statistical profiler.  Instead of timing
+every op like the C<profiling> runcore or tracking every call like the
+C<subprof> runcores, the C<sampling> runcore runs ops just like the fast core
+and only looks at the interpreter when a timer fires.
+
+Where C<setitimer> is available, an C<ITIMER_PROF> timer delivers C<SIGPROF>
+every C<PARROT_SAMPLING_INTERVAL> microseconds of CPU time (1000 by default).
+The signal handler does nothing but set a flag.  Before the next op the
+runloop notices the flag and copies the call chain into a sample buffer as
+a list of frame ids, one per context.  A frame is the sub running in a
+context together with its current position, labelled with the HLL C<file>
+and C<line> annotations when there are any and the PIR file and line
+otherwise; labels are built once per distinct pc.  Without C<setitimer> a
+sample is taken every C<PARROT_SAMPLING_INTERVAL> ops instead.
+
+When the buffer fills up, and when the interpreter is destroyed, the samples
+are folded into counts per distinct call chain.  At exit, the counts are
+written in the "folded stacks" format understood by F<flamegraph.pl> and
+similar tools: one line per call chain, frames from the outermost to the
+innermost separated by C<;>, followed by a space and the number of samples.
+The output goes to C<PARROT_SAMPLING_FILENAME>, or F<parrot.folded.PID> if
+that is not set; C<stdout> and C<stderr> are recognized as in the profiling
+runcore.
+
+The timer is per process, so only one interpreter should use this runcore
+at a time.
+
+=head2 Functions
+
+=over 4
+
+=cut
+
+*/
+
+#include "parrot/runcore_api.h"
+#include "parrot/runcore_sampling.h"
+#include "parrot/oplib/core_ops.h"
+
+#include "sampling.str"
+
+#include "pmc/pmc_sub.h"
+#include "pmc/pmc_callcontext.h"
+
+#if defined(PARROT_HAS_SETITIMER) && defined(PARROT_HAS_SIGACTION)
+#  include <signal.h>
+#  define SAMPLING_USE_ITIMER 1
+
+/* set by the SIGPROF handler, cleared by the runloop once it took a sample */
+static volatile sig_atomic_t sampling_tick = 0;
+#else
+static volatile int          sampling_tick = 0;
+#endif
+
+/* HEADERIZER HFILE: include/parrot/runcore_sampling.h */
+
+/* HEADERIZER BEGIN: static */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+static void destroy_sampling_core(PARROT_INTERP,
+    ARGIN(Parrot_sampling_runcore_t *runcore))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static void fold_samples(PARROT_INTERP,
+    ARGIN(Parrot_sampling_runcore_t *runcore))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+static UINTVAL get_frame_id(PARROT_INTERP,
+    ARGIN(Parrot_sampling_runcore_t *runcore),
+    ARGIN(PMC *sub),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3)
+        __attribute__nonnull__(4);
+
+PARROT_CAN_RETURN_NULL
+static void * init_sampling_core(PARROT_INTERP,
+    ARGIN(Parrot_sampling_runcore_t *runcore),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+PARROT_MALLOC
+PARROT_CANNOT_RETURN_NULL
+static char * make_frame_label(PARROT_INTERP,
+    ARGIN(PMC *sub_pmc),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static opcode_t * runops_sampling_core(PARROT_INTERP,
+    ARGIN(Parrot_sampling_runcore_t *runcore),
+    ARGIN(opcode_t *pc))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(3);
+
+static void sampling_signal_handler(int sig);
+static void start_sampling_timer(UINTVAL interval);
+static void stop_sampling_timer(void);
+static void take_sample(PARROT_INTERP,
+    ARGIN(Parrot_sampling_runcore_t *runcore))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2);
+
+#define ASSERT_ARGS_destroy_sampling_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore))
+#define ASSERT_ARGS_fold_samples __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore))
+#define ASSERT_ARGS_get_frame_id __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(sub) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_init_sampling_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_make_frame_label __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(sub_pmc) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_runops_sampling_core __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore) \
+    , PARROT_ASSERT_ARG(pc))
+#define ASSERT_ARGS_sampling_signal_handler __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
+#define ASSERT_ARGS_start_sampling_timer __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
+#define ASSERT_ARGS_stop_sampling_timer __attribute__unused__ int _ASSERT_ARGS_CHECK = (0)
+#define ASSERT_ARGS_take_sample __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(runcore))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: static */
+
+/*
+
+=item C<void Parrot_runcore_sampling_init(PARROT_INTERP)>
+
+Registers the sampling runcore with Parrot.
+
+=cut
+
+*/
+
+void
+Parrot_runcore_sampling_init(PARROT_INTERP)
+{
+    ASSERT_ARGS(Parrot_runcore_sampling_init)
+
+    Parrot_sampling_runcore_t * const coredata =
+            mem_gc_allocate_zeroed_typed(interp, Parrot_sampling_runcore_t);
+
+    coredata->name        = CONST_STRING(interp, "sampling");
+    coredata->id          = PARROT_SAMPLING_CORE;
+    coredata->opinit      = PARROT_CORE_OPLIB_INIT;
+    coredata->runops      = (Parrot_runcore_runops_fn_t) init_sampling_core;
+    coredata->destroy     = NULL;
+    coredata->prepare_run = NULL;
+    coredata->flags       = 0;
+
+    PARROT_RUNCORE_FUNC_TABLE_SET(coredata);
+
+    Parrot_runcore_register(interp, (Parrot_runcore_t *) coredata);
+}
+
+
+/*
+
+=item C<static void * init_sampling_core(PARROT_INTERP,
+Parrot_sampling_runcore_t *runcore, opcode_t *pc)>
+
+Reads the configuration from the environment, opens the output file and
+starts the sampling timer, then runs the ops starting at C<pc>.
+
+=cut
+
+*/
+
+PARROT_CAN_RETURN_NULL
+static void *
+init_sampling_core(PARROT_INTERP, ARGIN(Parrot_sampling_runcore_t *runcore),
+        ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(init_sampling_core)
+
+    STRING * const interval_env = CONST_STRING(interp, "PARROT_SAMPLING_INTERVAL");
+    STRING * const filename_env = CONST_STRING(interp, "PARROT_SAMPLING_FILENAME");
+    STRING * const interval_str = Parrot_getenv(interp, interval_env);
+    STRING * const filename_str = Parrot_getenv(interp, filename_env);
+    char   *filename_cstr;
+
+    runcore->runops  = (Parrot_runcore_runops_fn_t)  runops_sampling_core;
+    runcore->destroy = (Parrot_runcore_destroy_fn_t) destroy_sampling_core;
+
+    runcore->interval = SAMPLING_DEFAULT_INTERVAL;
+    if (!STRING_IS_NULL(interval_str)) {
+        const INTVAL interval = Parrot_str_to_int(interp, interval_str);
+        if (interval > 0)
+            runcore->interval = interval;
+    }
+
+    /* figure out where to write the output */
+    if (STRING_IS_NULL(filename_str)) {
+        runcore->profile_filename = Parrot_sprintf_c(interp, "parrot.folded.%d", getpid());
+        filename_cstr             = Parrot_str_to_cstring(interp, runcore->profile_filename);
+        runcore->profile_fd       = fopen(filename_cstr, "w");
+    }
+    else {
+        STRING * const lc_filename = Parrot_str_downcase(interp, filename_str);
+
+        runcore->profile_filename = filename_str;
+        filename_cstr             = Parrot_str_to_cstring(interp, filename_str);
+
+        if (STRING_equal(interp, lc_filename, CONST_STRING(interp, "stderr"))) {
+            runcore->profile_fd       = stderr;
+            runcore->profile_filename = lc_filename;
+        }
+        else if (STRING_equal(interp, lc_filename, CONST_STRING(interp, "stdout"))) {
+            runcore->profile_fd       = stdout;
+            runcore->profile_filename = lc_filename;
+        }
+        else
+            runcore->profile_fd = fopen(filename_cstr, "w");
+    }
+
+    if (!runcore->profile_fd) {
+        fprintf(stderr, "unable to open %s for writing", filename_cstr);
+        Parrot_str_free_cstring(filename_cstr);
+        Parrot_x_jump_out(interp, 1);
+    }
+
+    Parrot_str_free_cstring(filename_cstr);
+
+    /* put profile_filename in the gc root set so it won't get collected */
+    Parrot_str_gc_register(interp, runcore->profile_filename);
+
+    runcore->samples     = 0;
+    runcore->buffer      = mem_gc_allocate_n_typed(interp, SAMPLING_BUFFER_SIZE, UINTVAL);
+    runcore->buffer_used = 0;
+    runcore->frame_ids   = Parrot_hash_new_pointer_hash(interp);
+    runcore->frames      = NULL;
+    runcore->frame_count = 0;
+    runcore->frame_alloc = 0;
+    runcore->stacks      = Parrot_hash_new_cstring_hash(interp);
+    runcore->fold_buf    = NULL;
+    runcore->fold_size   = 0;
+
+    start_sampling_timer(runcore->interval);
+
+    return runops_sampling_core(interp, runcore, pc);
+}
+
+
+/*
+
+=item C<static opcode_t * runops_sampling_core(PARROT_INTERP,
+Parrot_sampling_runcore_t *runcore, opcode_t *pc)>
+
+Runs the Parrot operations starting at C<pc> until there are no more
+operations, taking a sample whenever the sampling timer has fired.
+
+=cut
+
+*/
+
+PARROT_WARN_UNUSED_RESULT
+PARROT_CAN_RETURN_NULL
+static opcode_t *
+runops_sampling_core(PARROT_INTERP, ARGIN(Parrot_sampling_runcore_t *runcore),
+        ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(runops_sampling_core)
+
+#ifndef SAMPLING_USE_ITIMER
+    UINTVAL countdown = runcore->interval;
+#endif
+
+    while (pc) {
+        Parrot_pcc_set_pc(interp, CURRENT_CONTEXT(interp), pc);
+
+#ifndef SAMPLING_USE_ITIMER
+        if (--countdown == 0) {
+            countdown     = runcore->interval;
+            sampling_tick = 1;
+        }
+#endif
+
+        if (sampling_tick) {
+            sampling_tick = 0;
+            take_sample(interp, runcore);
+        }
+
+        DO_OP(pc, interp);
+    }
+
+    return pc;
+}
+
+
+/*
+
+=item C<static void take_sample(PARROT_INTERP, Parrot_sampling_runcore_t
+*runcore)>
+
+Appends the current call chain to the sample buffer, innermost frame first,
+folding the buffer first if the chain might not fit.
+
+=cut
+
+*/
+
+static void
+take_sample(PARROT_INTERP, ARGIN(Parrot_sampling_runcore_t *runcore))
+{
+    ASSERT_ARGS(take_sample)
+
+    PMC     *ctx = CURRENT_CONTEXT(interp);
+    UINTVAL *depth;
+    UINTVAL *frame;
+
+    if (runcore->buffer_used + SAMPLING_MAX_DEPTH + 1 > SAMPLING_BUFFER_SIZE)
+        fold_samples(interp, runcore);
+
+    depth  = runcore->buffer + runcore->buffer_used;
+    frame  = depth + 1;
+    *depth = 0;
+
+    while (ctx && *depth < SAMPLING_MAX_DEPTH) {
+        PMC      * const sub = Parrot_pcc_get_sub(interp, ctx);
+        opcode_t * const pc  = Parrot_pcc_get_pc(interp, ctx);
+
+        if (!PMC_IS_NULL(sub) && pc) {
+            *frame++ = get_frame_id(interp, runcore, sub, pc);
+            ++*depth;
+        }
+
+        ctx = Parrot_pcc_get_caller_ctx(interp, ctx);
+    }
+
+    if (*depth) {
+        runcore->buffer_used += *depth + 1;
+        ++runcore->samples;
+    }
+}
+
+
+/*
+
+=item C<static UINTVAL get_frame_id(PARROT_INTERP, Parrot_sampling_runcore_t
+*runcore, PMC *sub, opcode_t *pc)>
+
+Returns the id of the frame for C<sub> at C<pc>, creating its label the first
+time the pc is seen.
+
+=cut
+
+*/
+
+static UINTVAL
+get_frame_id(PARROT_INTERP, ARGIN(Parrot_sampling_runcore_t *runcore),
+        ARGIN(PMC *sub), ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(get_frame_id)
+
+    UINTVAL id = (UINTVAL)Parrot_hash_get(interp, runcore->frame_ids, pc);
+
+    if (!id) {
+        if (runcore->frame_count == runcore->frame_alloc) {
+            runcore->frame_alloc = runcore->frame_alloc ? runcore->frame_alloc * 2 : 64;
+            runcore->frames      = mem_gc_realloc_n_typed(interp, runcore->frames,
+                                        runcore->frame_alloc, char *);
+        }
+
+        runcore->frames[runcore->frame_count++] = make_frame_label(interp, sub, pc);
+        id = runcore->frame_count;
+        Parrot_hash_put(interp, runcore->frame_ids, pc, (void *)id);
+    }
+
+    return id;
+}
+
+
+/*
+
+=item C<static char * make_frame_label(PARROT_INTERP, PMC *sub_pmc, opcode_t
+*pc)>
+
+Returns a newly allocated label for C<sub_pmc> at C<pc>, of the form
+C<ns::name (file:line)>.  HLL C<file> and C<line> annotations take
+precedence over the PIR debug information.
+
+=cut
+
+*/
+
+PARROT_MALLOC
+PARROT_CANNOT_RETURN_NULL
+static char *
+make_frame_label(PARROT_INTERP, ARGIN(PMC *sub_pmc), ARGIN(opcode_t *pc))
+{
+    ASSERT_ARGS(make_frame_label)
+
+    Parrot_Sub_attributes *sub;
+    STRING                *name = Parrot_sub_full_sub_name(interp, sub_pmc);
+    STRING                *file = STRINGNULL;
+    INTVAL                 line = -1;
+
+    PMC_get_sub(interp, sub_pmc, sub);
+
+    if (sub->seg) {
+        if (sub->seg->annotations) {
+            /* + 1 because the lookup finds the annotation before the offset */
+            const opcode_t offset   = pc - sub->seg->base.data + 1;
+            STRING * const file_key = CONST_STRING(interp, "file");
+            STRING * const line_key = CONST_STRING(interp, "line");
+            PMC    * const hll_file = PackFile_Annotations_lookup(interp,
+                    sub->seg->annotations, offset, file_key);
+            PMC    * const hll_line = PackFile_Annotations_lookup(interp,
+                    sub->seg->annotations, offset, line_key);
+
+            if (!PMC_IS_NULL(hll_file))
+                file = VTABLE_get_string(interp, hll_file);
+            if (!PMC_IS_NULL(hll_line))
+                line = VTABLE_get_integer(interp, hll_line);
+        }
+
+        if (sub->seg->debugs) {
+            if (STRING_IS_NULL(file))
+                file = Parrot_sub_get_filename_from_pc(interp, sub_pmc, pc);
+            if (line < 0)
+                line = Parrot_sub_get_line_from_pc(interp, sub_pmc, pc);
+        }
+    }
+
+    /* ';' separates frames in the output */
+    if (STRING_IS_NULL(name))
+        name = CONST_STRING(interp, "(unknown)");
+    else {
+        STRING * const ns_sep = CONST_STRING(interp, ";");
+        name = Parrot_str_join(interp, CONST_STRING(interp, "::"),
+                Parrot_str_split(interp, ns_sep, name));
+    }
+
+    if (STRING_IS_NULL(file))
+        file = CONST_STRING(interp, "unknown file");
+
+    return Parrot_str_to_cstring(interp,
+            Parrot_sprintf_c(interp, "%Ss (%Ss:%d)", name, file, line));
+}
+
+
+/*
+
+=item C<static void fold_samples(PARROT_INTERP, Parrot_sampling_runcore_t
+*runcore)>
+
+Turns every sample in the sample buffer into its folded stack and adds it to
+the counts, then empties the buffer.
+
+=cut
+
+*/
+
+static void
+fold_samples(PARROT_INTERP, ARGIN(Parrot_sampling_runcore_t *runcore))
+{
+    ASSERT_ARGS(fold_samples)
+
+    size_t pos = 0;
+
+    while (pos < runcore->buffer_used) {
+        const UINTVAL         depth = runcore->buffer[pos];
+        const UINTVAL * const frame = runcore->buffer + pos + 1;
+        size_t                len   = 0;
+        UINTVAL               i;
+        HashBucket           *b;
+
+        for (i = 0; i < depth; ++i)
+            len += strlen(runcore->frames[frame[i] - 1]) + 1;
+
+        if (len > runcore->fold_size) {
+            runcore->fold_size = len * 2;
+            runcore->fold_buf  = mem_gc_realloc_n_typed(interp, runcore->fold_buf,
+                                    runcore->fold_size, char);
+        }
+
+        /* outermost frame first */
+        len = 0;
+        for (i = depth; i > 0; --i) {
+            const char * const label = runcore->frames[frame[i - 1] - 1];
+            const size_t       n     = strlen(label);
+
+            memcpy(runcore->fold_buf + len, label, n);
+            len += n;
+            runcore->fold_buf[len++] = i > 1 ? ';' : '\0';
+        }
+
+        b = Parrot_hash_get_bucket(interp, runcore->stacks, runcore->fold_buf);
+
+        if (b)
+            b->value = (void *)((UINTVAL)b->value + 1);
+        else {
+            char * const key = mem_gc_allocate_n_typed(interp, len, char);
+            memcpy(key, runcore->fold_buf, len);
+            Parrot_hash_put(interp, runcore->stacks, key, (void *)1);
+        }
+
+        pos += depth + 1;
+    }
+
+    runcore->buffer_used = 0;
+}
+
+
+/*
+
+=item C<static void destroy_sampling_core(PARROT_INTERP,
+Parrot_sampling_runcore_t *runcore)>
+
+Stops the timer, writes the folded stacks and frees everything the runcore
+allocated.
+
+=cut
+
+*/
+
+static void
+destroy_sampling_core(PARROT_INTERP, ARGIN(Parrot_sampling_runcore_t *runcore))
+{
+    ASSERT_ARGS(destroy_sampling_core)
+
+    char  *filename_cstr;
+    size_t i;
+
+    stop_sampling_timer();
+    fold_samples(interp, runcore);
+
+    parrot_hash_iterate(runcore->stacks,
+        fprintf(runcore->profile_fd, "%s %lu\n",
+            (const char *)_bucket->key, (unsigned long)(UINTVAL)_bucket->value);
+        mem_gc_free(interp, _bucket->key););
+
+    if (runcore->profile_fd != stdout && runcore->profile_fd != stderr)
+        fclose(runcore->profile_fd);
+    else
+        fflush(runcore->profile_fd);
+
+    filename_cstr = Parrot_str_to_cstring(interp, runcore->profile_filename);
+    fprintf(stderr, "\nSAMPLING RUNCORE: wrote %lu samples to %s\n",
+        (unsigned long)runcore->samples, filename_cstr);
+    Parrot_str_free_cstring(filename_cstr);
+
+    for (i = 0; i < runcore->frame_count; ++i)
+        Parrot_str_free_cstring(runcore->frames[i]);
+
+    Parrot_hash_destroy(interp, runcore->stacks);
+    Parrot_hash_destroy(interp, runcore->frame_ids);
+
+    if (runcore->frames)
+        mem_gc_free(interp, runcore->frames);
+    if (runcore->fold_buf)
+        mem_gc_free(interp, runcore->fold_buf);
+    mem_gc_free(interp, runcore->buffer);
+}
+
+
+/*
+
+=item C<static void sampling_signal_handler(int sig)>
+
+Notes that it is time for another sample.
+
+=cut
+
+*/
+
+static void
+sampling_signal_handler(int sig)
+{
+    ASSERT_ARGS(sampling_signal_handler)
+    UNUSED(sig);
+    sampling_tick = 1;
+}
+
+
+/*
+
+=item C<static void start_sampling_timer(UINTVAL interval)>
+
+Installs the C<SIGPROF> handler and starts a timer firing every C<interval>
+microseconds of CPU time, if the platform has one.
+
+=cut
+
+*/
+
+static void
+start_sampling_timer(UINTVAL interval)
+{
+    ASSERT_ARGS(start_sampling_timer)
+
+#ifdef SAMPLING_USE_ITIMER
+    struct sigaction action;
+    struct itimerval timer;
+
+    memset(&action, 0, sizeof (action));
+    action.sa_handler = sampling_signal_handler;
+    action.sa_flags   = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, NULL);
+
+    timer.it_interval.tv_sec  = interval / 1000000;
+    timer.it_interval.tv_usec = interval % 1000000;
+    timer.it_value            = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, NULL);
+#else
+    UNUSED(interval);
+#endif
+}
+
+
+/*
+
+=item C<static void stop_sampling_timer(void)>
+
+Stops the sampling timer and restores the default C<SIGPROF> handling.
+
+=cut
+
+*/
+
+static void
+stop_sampling_timer(void)
+{
+    ASSERT_ARGS(stop_sampling_timer)
+
+#ifdef SAMPLING_USE_ITIMER
+    struct itimerval timer;
+
+    memset(&timer, 0, sizeof (timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+    signal(SIGPROF, SIG_DFL);
+#endif
+}
+
+/*
+
+=back
+
+=cut
+
+*/
+
+/*
+ * Local variables:
+ *   c-file-style: "parrot"
+ * End:
+ * vim: expandtab shiftwidth=4 cinoptions='\:2=2' :
+ */
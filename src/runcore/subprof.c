@@ -366,18 +366,23 @@ findlineannotations(PARROT_INTERP,
     if (i == ann->num_keys)
         return NULL;    /* no annotations with this key */
 
-    cnt   = 0;
-    first = 0;
-    key   = ann->keys + i;
+    key = ann->keys + i;
+
+    /* the entries are sorted by offset; find the first one in our sub */
+    first = key->start;
+    j     = key->start + key->len;
+    while (first < j) {
+        const size_t mid = first + (j - first) / 2;
+
+        if ((size_t)ann->base.data[mid * 2 + ANN_ENTRY_OFF] < sp->subattrs->start_offs)
+            first = mid + 1;
+        else
+            j = mid;
+    }
 
-    for (j = key->start; j < key->start + key->len; j++) {
-        if ((size_t)ann->base.data[j * 2 + ANN_ENTRY_OFF] < sp->subattrs->start_offs)
-            continue;
+    for (cnt = 0, j = first; j < key->start + key->len; j++, cnt++) {
         if ((size_t)ann->base.data[j * 2 + ANN_ENTRY_OFF] >= sp->subattrs->end_offs)
             break;
-        if (!cnt++) {
-            first = j;
-        }
     }
 
     *cntp = cnt;
@@ -26,6 +26,24 @@ Subroutines, continuations, co-routines and other fun stuff...
 
 /* HEADERIZER HFILE: include/parrot/sub.h */
 
+/* HEADERIZER BEGIN: static */
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+
+static int context_info_at(PARROT_INTERP,
+    ARGIN(PMC *ctx),
+    ARGIN_NULLOK(opcode_t *pc),
+    ARGOUT(Parrot_Context_info *info))
+        __attribute__nonnull__(1)
+        __attribute__nonnull__(2)
+        __attribute__nonnull__(4)
+        FUNC_MODIFIES(*info);
+
+#define ASSERT_ARGS_context_info_at __attribute__unused__ int _ASSERT_ARGS_CHECK = (\
+       PARROT_ASSERT_ARG(interp) \
+    , PARROT_ASSERT_ARG(ctx) \
+    , PARROT_ASSERT_ARG(info))
+/* Don't modify between HEADERIZER BEGIN / HEADERIZER END.  Your changes will be lost. */
+/* HEADERIZER END: static */
 
 /*
 
@@ -102,9 +120,28 @@ Parrot_sub_context_get_info(PARROT_INTERP, ARGIN(PMC *ctx),
     ARGOUT(Parrot_Context_info *info))
 {
     ASSERT_ARGS(Parrot_sub_context_get_info)
+    return context_info_at(interp, ctx, Parrot_pcc_get_pc(interp, ctx), info);
+}
+
+/*
+
+=item C<static int context_info_at(PARROT_INTERP, PMC *ctx, opcode_t *pc,
+Parrot_Context_info *info)>
+
+Does the work of C<Parrot_sub_context_get_info>, describing C<ctx> as if it
+were stopped at C<pc> rather than at its current pc.
+
+=cut
+
+*/
+
+static int
+context_info_at(PARROT_INTERP, ARGIN(PMC *ctx), ARGIN_NULLOK(opcode_t *pc),
+    ARGOUT(Parrot_Context_info *info))
+{
+    ASSERT_ARGS(context_info_at)
     PMC                   *subpmc;
     Parrot_Sub_attributes *sub;
-    opcode_t              *pc;
 
     /* set file/line/pc defaults */
     info->file     = CONST_STRING(interp, "(unknown file)");
@@ -143,8 +180,6 @@ Parrot_sub_context_get_info(PARROT_INTERP, ARGIN(PMC *ctx),
         info->fullname = Parrot_sub_full_sub_name(interp, subpmc);
     }
 
-    pc = Parrot_pcc_get_pc(interp, ctx);
-
     /* return here if there is no current pc */
     if (!pc)
         return 1;
@@ -154,29 +189,20 @@ Parrot_sub_context_get_info(PARROT_INTERP, ARGIN(PMC *ctx),
 
     /* determine the current source file/line */
     if (pc) {
-        const size_t offs = info->pc;
-        size_t i, n;
-        opcode_t *pc = sub->seg->base.data;
         PackFile_Debug * const debug = sub->seg->debugs;
+        INTVAL i;
 
         if (!debug)
             return 0;
-        for (i = n = 0; n < sub->seg->base.size; ++i) {
-            op_info_t * const op_info = sub->seg->op_info_table[*pc];
-            opcode_t var_args = 0;
-
-            if (i >= debug->base.size)
-                return 0;
-            if (n >= offs) {
-                /* set source line and file */
-                info->line = debug->base.data[i];
-                info->file = Parrot_debug_pc_to_filename(interp, debug, i);
-                break;
-            }
-            ADD_OP_VAR_PART(interp, sub->seg, pc, var_args);
-            n  += op_info->op_count + var_args;
-            pc += op_info->op_count + var_args;
-        }
+
+        /* no line data is an error, unless pc is past the end of the code */
+        i = Parrot_pf_debug_op_index(interp, debug, info->pc);
+        if (i < 0)
+            return info->pc >= (opcode_t)sub->seg->base.size;
+
+        /* set source line and file */
+        info->line = debug->base.data[i];
+        info->file = Parrot_debug_pc_to_filename(interp, debug, info->pc);
     }
 
     return 1;
@@ -200,39 +226,22 @@ Parrot_sub_get_line_from_pc(PARROT_INTERP, ARGIN_NULLOK(PMC *subpmc), ARGIN_NULL
 {
     ASSERT_ARGS(Parrot_sub_get_line_from_pc)
     Parrot_Sub_attributes *sub;
-    opcode_t              *base_pc, *debug_ops;
-    size_t                 i, op, current_annotation, debug_size, code_size;
+    PackFile_Debug        *debug;
+    INTVAL                 i;
 
     if (!subpmc || !pc)
         return -1;
 
     PMC_get_sub(interp, subpmc, sub);
 
-    debug_ops          = sub->seg->debugs->base.data;
-    debug_size         = sub->seg->debugs->base.size;
-    code_size          = sub->seg->base.size;
-    base_pc            = sub->seg->base.data;
-    current_annotation = pc - base_pc;
-
     /* assert pc is in correct segment */
-    PARROT_ASSERT(base_pc <= pc && pc <= base_pc + code_size);
-
-    for (i = op = 0; op < code_size; ++i) {
-        op_info_t * const op_info  = sub->seg->op_info_table[*base_pc];
-        opcode_t          var_args = 0;
-
-        if (i >= debug_size)
-            return -1;
+    PARROT_ASSERT(sub->seg->base.data <= pc
+               && pc <= sub->seg->base.data + sub->seg->base.size);
 
-        if (op >= current_annotation)
-            return debug_ops[i];
+    debug = sub->seg->debugs;
+    i     = Parrot_pf_debug_op_index(interp, debug, pc - sub->seg->base.data);
 
-        ADD_OP_VAR_PART(interp, sub->seg, base_pc, var_args);
-        op      += op_info->op_count + var_args;
-        base_pc += op_info->op_count + var_args;
-    }
-
-    return -1;
+    return i < 0 ? -1 : debug->base.data[i];
 }
 
 
@@ -287,12 +296,35 @@ STRING*
 Parrot_sub_Context_infostr(PARROT_INTERP, ARGIN(PMC *ctx), int is_top)
 {
     ASSERT_ARGS(Parrot_sub_Context_infostr)
+    return Parrot_sub_Context_infostr_at(interp, ctx, Parrot_pcc_get_pc(interp, ctx), is_top);
+}
+
+/*
+
+=item C<STRING* Parrot_sub_Context_infostr_at(PARROT_INTERP, PMC *ctx, opcode_t
+*pc, int is_top)>
+
+Like C<Parrot_sub_Context_infostr>, but describes the context at C<pc>, a pc
+recorded earlier, instead of wherever the context has got to since.
+
+=cut
+
+*/
+
+PARROT_EXPORT
+PARROT_CAN_RETURN_NULL
+PARROT_WARN_UNUSED_RESULT
+STRING*
+Parrot_sub_Context_infostr_at(PARROT_INTERP, ARGIN(PMC *ctx), ARGIN_NULLOK(opcode_t *pc),
+        int is_top)
+{
+    ASSERT_ARGS(Parrot_sub_Context_infostr_at)
     Parrot_Context_info info;
     STRING             *res = NULL;
     const char * const  msg = is_top ? "current instr.:" : "called from Sub";
 
     Parrot_block_GC_mark(interp);
-    if (Parrot_sub_context_get_info(interp, ctx, &info)) {
+    if (context_info_at(interp, ctx, pc, &info)) {
 
         res = Parrot_sprintf_c(interp,
             "%s '%Ss' pc %d (%Ss:%d)", msg,
@@ -392,6 +424,9 @@ Parrot_sub_capture_lex(PARROT_INTERP, ARGMOD(PMC *sub_pmc))
 
     PMC_get_sub(interp, Parrot_pcc_get_sub(interp, ctx), current_sub);
 
+    /* closures keep the frame reachable after it returned */
+    CALLSIGNATURE_is_escaped_SET(ctx);
+
     /* MultiSub gets special treatment */
     if (VTABLE_isa(interp, sub_pmc, CONST_STRING(interp, "MultiSub"))) {
 
@@ -76,6 +76,8 @@ FixedPMCArray:\s\d+\.\d+s\n
         There\sare\s\d+\stotal\sPMC\sstructs\n
         There\sare\s\d+\sactive\sBuffer\sstructs\n
         There\sare\s\d+\stotal\sBuffer\sstructs\n$/x,
+    q{digest.pir} => qr/^(?:(?:md5|sha1|sha256)\s+(?:String|ByteBuffer)\s+
+        [0-9a-f]+\s\d+\.\d\sMB\/s\n){6}$/x,
     q{fib.pir}     => qr/^fib\(28\)\s=\s317811$/x,
     q{freeze.pasm} => qr/^constr.time\s\d+\.\d+\n
         freeze\stime\s\d+\.\d+\n
@@ -138,6 +140,8 @@ FixedPMCArray:\s\d+\.\d+s\n
         Copying\sa\stotal\sof\s\d+\sbytes\n
         There\sare\s\d+\sactive\sBuffer\sstructs\n
         There\sare\s\d+\stotal\sBuffer\sstructs\n$/x,
+    q{json.pir} => qr/^(?:(?:emit|parse)\s+(?:JSONCodec|JSON\.pir|data_json)\s+
+        \d+\.\d{3}\ss\s\d+\.\d\d\sMB\/s\n){4}$/x,
 #omitted because they're slow and doesn't exercise anything novel
 #    q{mops.pasm} => qr/^Iterations:\s\s\s\s10000000\n
 #        Estimated\sops:\s20000000\n
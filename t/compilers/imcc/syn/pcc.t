@@ -6,7 +6,7 @@ use warnings;
 use lib qw( . lib ../lib ../../lib );
 use Test::More;
 use Parrot::Config;
-use Parrot::Test tests => 27;
+use Parrot::Test tests => 28;
 
 ##############################
 # Parrot Calling Conventions
@@ -638,6 +638,45 @@ CODE
 hello
 OUT
 
+pir_output_is( <<'CODE', <<'OUT', 'calls find the sub of that name in their namespace');
+.namespace ['A']
+.sub 'helper'
+    .return ('A')
+.end
+
+.sub 'call'
+    $S0 = 'helper'()
+    .return ($S0)
+.end
+
+.namespace ['B']
+.sub 'helper' :subid('b_helper')
+    .return ('B')
+.end
+
+.sub 'call'
+    $S0 = 'helper'()
+    .return ($S0)
+.end
+
+.namespace []
+.sub main :main
+    $P0 = get_hll_global ['A'], 'call'
+    $S0 = $P0()
+    say $S0
+    $P0 = get_hll_global ['B'], 'call'
+    $S0 = $P0()
+    say $S0
+    .const 'Sub' h = 'b_helper'
+    $S0 = h()
+    say $S0
+.end
+CODE
+A
+B
+B
+OUT
+
 # Local Variables:
 #   mode: cperl
 #   cperl-indent-level: 4
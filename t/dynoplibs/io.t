@@ -20,7 +20,7 @@ Tests various io opcodes.
 .sub 'main' :main
     .include 'test_more.pir'
 
-    plan(59)
+    plan(62)
 
     read_on_null()
     test_bad_open()
@@ -37,12 +37,48 @@ Tests various io opcodes.
     printerr_tests()
     stat_tests()
     stdout_tests()
+    freeze_thaw_handle()
 
     # must come after (these don't use test_more)
     open_pipe_for_writing()
     read_invalid_fh()
 .end
 
+.sub 'freeze_thaw_handle'
+    .local pmc orig, ints, handle, copy
+    orig = new ['ResizablePMCArray']
+    ints = new ['FixedIntegerArray']
+    ints = 20000
+    $I0 = 0
+  fill:
+    ints[$I0] = $I0
+    $S0 = $I0
+    $S0 = concat 'item ', $S0
+    push orig, $S0
+    inc $I0
+    if $I0 < 20000 goto fill
+    push orig, ints
+
+    # large enough to be written and read in several chunks
+    handle = new ['StringHandle']
+    handle.'encoding'('binary')
+    handle.'open'('frozen', 'w')
+    freeze handle, orig
+    handle.'close'()
+
+    handle.'open'('frozen', 'r')
+    thaw copy, handle
+    handle.'close'()
+
+    $I0 = elements copy
+    is($I0, 20001, 'thaw from handle - elements')
+    $S0 = copy[19999]
+    is($S0, 'item 19999', 'thaw from handle - strings')
+    $P0 = copy[20000]
+    $I0 = $P0[19999]
+    is($I0, 19999, 'thaw from handle - native array')
+.end
+
 .sub 'test_bad_open'
     null $S0
 
@@ -0,0 +1,197 @@
+#!./parrot
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/dynpmc/digest.t - tests the Digest PMC
+
+=head1 SYNOPSIS
+
+    % prove t/dynpmc/digest.t
+
+=head1 DESCRIPTION
+
+Tests the Digest PMC against the example vectors of RFC 1321 and FIPS 180,
+fed in one piece, in many pieces and as ByteBuffers.
+
+=cut
+
+.loadlib 'digest'
+
+.sub main :main
+    .include 'test_more.pir'
+
+    plan(23)
+
+    test_init()
+    test_known_vectors()
+    test_streaming()
+    test_block_boundaries()
+    test_bytebuffer()
+    test_final_bytes()
+    test_clone()
+    test_reset()
+    test_errors()
+.end
+
+.sub 'digest_of'
+    .param string algorithm
+    .param string data
+    $P0 = new ['Digest']
+    $P0.'reset'(algorithm)
+    $P0.'update'(data)
+    $S0 = $P0.'final'()
+    .return ($S0)
+.end
+
+.sub 'test_init'
+    $P0 = new ['Digest']
+    $S0 = $P0
+    is($S0, 'sha256', 'default algorithm is sha256')
+    $I0 = $P0.'digest_size'()
+    is($I0, 32, 'sha256 digest is 32 bytes')
+
+    $P1 = new ['String']
+    $P1 = 'sha1'
+    $P0 = new ['Digest'], $P1
+    $S0 = $P0
+    is($S0, 'sha1', 'init_pmc selects the algorithm')
+.end
+
+.sub 'test_known_vectors'
+    $S0 = digest_of('md5', '')
+    is($S0, 'd41d8cd98f00b204e9800998ecf8427e', 'md5 of the empty string')
+    $S0 = digest_of('md5', 'message digest')
+    is($S0, 'f96b697d7cb7938d525a2f31aaf161d0', 'md5 of "message digest"')
+    $S0 = digest_of('sha1', 'abc')
+    is($S0, 'a9993e364706816aba3e25717850c26c9cd0d89d', 'sha1 of "abc"')
+    $S0 = digest_of('sha1', 'abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq')
+    is($S0, '84983e441c3bd26ebaae4aa1f95129e5e54670f1', 'sha1 of the two-block vector')
+    $S0 = digest_of('sha256', '')
+    $S1 = 'e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855'
+    is($S0, $S1, 'sha256 of the empty string')
+    $S0 = digest_of('sha256', 'abc')
+    $S1 = 'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad'
+    is($S0, $S1, 'sha256 of "abc"')
+.end
+
+.sub 'test_streaming'
+    .local pmc digest
+    digest = new ['Digest']
+    digest.'reset'('sha1')
+
+    # a million 'a's, in pieces that straddle block boundaries
+    .local string piece
+    piece = repeat 'a', 1000
+    $I0 = 0
+  loop:
+    digest.'update'(piece)
+    inc $I0
+    if $I0 < 1000 goto loop
+
+    $S0 = digest.'final'()
+    is($S0, '34aa973cd4c4daa4f61eeb2bdbad27316534016f', 'sha1 of a million a, streamed')
+
+.end
+
+.sub 'test_block_boundaries'
+    # inputs of 55, 56 and 64 bytes need one, two and two padding blocks
+    $S1 = repeat 'x', 55
+    $S0 = digest_of('md5', $S1)
+    is($S0, '04364420e25c512fd958a70738aa8f72', 'md5 of 55 bytes')
+    $S1 = repeat 'x', 56
+    $S0 = digest_of('md5', $S1)
+    is($S0, '668a72d5ba17f08e62dabcafad6db14b', 'md5 of 56 bytes')
+    $S1 = repeat 'x', 64
+    $S0 = digest_of('sha256', $S1)
+    $S1 = '7ce100971f64e7001e8fe5a51973ecdfe1ced42befe7ee8d5fd6219506b5393c'
+    is($S0, $S1, 'sha256 of 64 bytes')
+.end
+
+.sub 'test_bytebuffer'
+    .local pmc buffer, digest
+    buffer = new ['ByteBuffer']
+    buffer = 'The quick brown fox jumps over the lazy dog'
+    digest = new ['Digest']
+    digest.'reset'('md5')
+    digest.'update'(buffer)
+    $S0 = digest.'final'()
+    is($S0, '9e107d9d372bb6826bd81d3542a419d6', 'md5 of a ByteBuffer')
+
+    # bytes that are not valid UTF-8 are hashed as they are
+    buffer = new ['ByteBuffer']
+    buffer = 2
+    buffer[0] = 0xff
+    buffer[1] = 0x00
+    digest.'reset'()
+    digest.'update'(buffer)
+    $S0 = digest.'final'()
+    is($S0, 'e0e8bfafbb0689563b2fba789c97b3cc', 'md5 of raw bytes')
+.end
+
+.sub 'test_final_bytes'
+    $P0 = new ['Digest']
+    $P0.'reset'('md5')
+    $P0.'update'('abc')
+    $P1 = $P0.'final_bytes'()
+    $I0 = elements $P1
+    is($I0, 16, 'final_bytes returns the whole digest')
+    $I0 = $P1[0]
+    is($I0, 0x90, 'final_bytes starts with the first digest byte')
+    $S0 = $P0.'final'()
+    is($S0, '900150983cd24fb0d6963f7d28e17f72', 'final can be called again')
+.end
+
+.sub 'test_clone'
+    .local pmc prefix, a, b
+    prefix = new ['Digest']
+    prefix.'update'('a')
+    a = clone prefix
+    b = clone prefix
+    a.'update'('bc')
+    b.'update'('b')
+    $S0 = a.'final'()
+    $S1 = 'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad'
+    is($S0, $S1, 'clone keeps the data hashed so far')
+    $S0 = b.'final'()
+    $S1 = digest_of('sha256', 'ab')
+    is($S0, $S1, 'clones are independent')
+.end
+
+.sub 'test_reset'
+    $P0 = new ['Digest']
+    $P0.'update'('junk')
+    $P0.'reset'('sha1')
+    $P0.'update'('abc')
+    $S0 = $P0.'final'()
+    is($S0, 'a9993e364706816aba3e25717850c26c9cd0d89d', 'reset forgets earlier data')
+.end
+
+.sub 'test_errors'
+    $P0 = new ['Digest']
+    $P0.'final'()
+    push_eh update_failed
+    $P0.'update'('more')
+    pop_eh
+    ok(0, 'update after final throws')
+    goto unknown
+  update_failed:
+    pop_eh
+    ok(1, 'update after final throws')
+
+  unknown:
+    push_eh unknown_failed
+    $P0.'reset'('md4')
+    pop_eh
+    ok(0, 'unknown algorithm throws')
+    .return ()
+  unknown_failed:
+    pop_eh
+    ok(1, 'unknown algorithm throws')
+.end
+
+# Local Variables:
+#   mode: pir
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4 ft=pir:
@@ -0,0 +1,364 @@
+#!./parrot
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/dynpmc/jsoncodec.t - tests the JSONCodec PMC
+
+=head1 SYNOPSIS
+
+    % prove t/dynpmc/jsoncodec.t
+
+=head1 DESCRIPTION
+
+Tests parsing JSON into PMCs, in one piece, byte by byte, from a ByteBuffer
+and from a file, parsing into handler events, and emitting JSON in the layout
+of F<runtime/parrot/library/JSON.pir>.
+
+=cut
+
+.loadlib 'jsoncodec'
+
+.sub main :main
+    .include 'test_more.pir'
+    load_bytecode 'JSON.pbc'
+
+    plan(43)
+
+    test_scalars()
+    test_containers()
+    test_strings()
+    test_numbers()
+    test_errors()
+    test_feed()
+    test_bytebuffer()
+    test_file()
+    test_handler()
+    test_emit()
+    test_emit_pretty()
+    test_roundtrip()
+.end
+
+.sub 'parse'
+    .param string text
+    $P0 = new ['JSONCodec']
+    $P1 = $P0.'parse'(text)
+    .return ($P1)
+.end
+
+.sub 'parse_error'
+    .param string text
+    $P0 = new ['JSONCodec']
+    push_eh failed
+    $P0.'parse'(text)
+    pop_eh
+    .return ('')
+  failed:
+    .local pmc e
+    .get_results(e)
+    pop_eh
+    $S0 = e['message']
+    .return ($S0)
+.end
+
+.sub 'test_scalars'
+    $P0 = parse('42')
+    $S0 = typeof $P0
+    is($S0, 'Integer', 'integer')
+    is($P0, 42, '... value')
+
+    $P0 = parse(' "text" ')
+    $S0 = typeof $P0
+    is($S0, 'String', 'string')
+    is($P0, 'text', '... value')
+
+    $P0 = parse('true')
+    $S0 = typeof $P0
+    is($S0, 'Boolean', 'true')
+    ok($P0, '... is true')
+    $P0 = parse('false')
+    nok($P0, 'false')
+
+    $P0 = parse('null')
+    $I0 = isnull $P0
+    ok($I0, 'null')
+.end
+
+.sub 'test_containers'
+    $P0 = parse('{"a" : [1, 2, {"b" : null}], "c" : {}}')
+    $S0 = typeof $P0
+    is($S0, 'Hash', 'object')
+    $P1 = $P0['a']
+    $S0 = typeof $P1
+    is($S0, 'ResizablePMCArray', 'array')
+    $I0 = elements $P1
+    is($I0, 3, '... elements')
+    $P2 = $P1[2]
+    $I0 = exists $P2['b']
+    ok($I0, 'null member exists')
+    $P2 = $P0['c']
+    $I0 = elements $P2
+    is($I0, 0, 'empty object')
+.end
+
+.sub 'test_strings'
+    $P0 = parse('"a\"b\\c\/d\b\f\n\r\t"')
+    $S1 = "a\"b\\c/d\b\f\n\r\t"
+    is($P0, $S1, 'simple escapes')
+
+    $P0 = parse('"caf\u00e9 \u20ac"')
+    $S1 = utf8:"caf\x{e9} \x{20ac}"
+    is($P0, $S1, '\u escapes')
+
+    $P0 = parse('"\ud83d\ude00"')
+    $S0 = $P0
+    $I0 = ord $S0
+    is($I0, 0x1f600, 'surrogate pair')
+
+    $S0 = utf8:"\"na\x{ef}ve\""
+    $P0 = parse($S0)
+    $S1 = utf8:"na\x{ef}ve"
+    is($P0, $S1, 'UTF-8 input')
+.end
+
+.sub 'test_numbers'
+    $P0 = parse('-0.5e1')
+    $S0 = typeof $P0
+    is($S0, 'Float', 'exponent makes a Float')
+    is($P0, -5.0, '... value')
+
+    $P0 = parse('-9223372036854775808')
+    $S0 = typeof $P0
+    is($S0, 'Integer', 'INTVAL minimum is an Integer')
+
+    $P0 = parse('123456789012345678901234567890')
+    $S0 = typeof $P0
+    is($S0, 'Float', 'too big for an INTVAL is a Float')
+.end
+
+.sub 'test_errors'
+    $S0 = parse_error('[1, 2')
+    is($S0, 'JSONCodec: unexpected end of input at byte 5', 'unterminated array')
+    $S0 = parse_error('[1, 2,]')
+    is($S0, "JSONCodec: unexpected ']' at byte 6", 'trailing comma')
+    $S0 = parse_error('01')
+    is($S0, 'JSONCodec: text after the value at byte 1', 'leading zero')
+    $S0 = parse_error('{"a" 1}')
+    is($S0, 'JSONCodec: unexpected character at byte 5', 'missing colon')
+    $S0 = parse_error('"\ud800"')
+    is($S0, 'JSONCodec: unpaired surrogate in \u escape at byte 1', 'lone surrogate')
+.end
+
+.sub 'test_feed'
+    .local string text
+    .local pmc json, value
+    text = '{"key" : ["a\nb", 12345, -1.5e10, true, null, "\u00e9"], "k2" : false}'
+    json = new ['JSONCodec']
+
+    .local int i, n
+    i = 0
+    n = length text
+  loop:
+    if i >= n goto done
+    $S0 = substr text, i, 1
+    json.'feed'($S0)
+    inc i
+    goto loop
+  done:
+    value = json.'finish'()
+
+    $S0 = json.'emit'(value)
+    $P0 = json.'parse'(text)
+    $S1 = json.'emit'($P0)
+    is($S0, $S1, 'byte-by-byte feed gives the same value')
+
+    json.'feed'('[1, 2')
+    json.'feed'('3]')
+    value = json.'finish'()
+    $P0 = value[1]
+    is($P0, 23, 'number split across feeds')
+.end
+
+.sub 'test_bytebuffer'
+    $P0 = new ['ByteBuffer']
+    $P0 = '[1, "two"]'
+    $P1 = new ['JSONCodec']
+    $P2 = $P1.'parse'($P0)
+    $P3 = $P2[1]
+    is($P3, 'two', 'ByteBuffer input')
+.end
+
+.sub 'test_file'
+    .local string name, text
+    .local pmc fh
+    name = 'jsoncodec_test.json'
+    text = '{"list" : ['
+    $I0 = 0
+  build:
+    if $I0 >= 20000 goto built
+    text .= '"item", '
+    inc $I0
+    goto build
+  built:
+    text .= '"last"]}'
+
+    fh = new ['FileHandle']
+    fh.'open'(name, 'w')
+    fh.'print'(text)
+    fh.'close'()
+
+    fh.'open'(name, 'r')
+    $P1 = new ['JSONCodec']
+    $P2 = $P1.'parse'(fh)
+    fh.'close'()
+    $P3 = new ['OS']
+    $P3.'rm'(name)
+
+    $P4 = $P2['list']
+    $I0 = elements $P4
+    is($I0, 20001, 'file input larger than one read')
+.end
+
+.namespace ['JSONCodecTestHandler']
+
+.sub 'start_object' :method
+    self.'log'('{')
+.end
+
+.sub 'end_object' :method
+    self.'log'('}')
+.end
+
+.sub 'start_array' :method
+    self.'log'('[')
+.end
+
+.sub 'end_array' :method
+    self.'log'(']')
+.end
+
+.sub 'key' :method
+    .param string key
+    $S0 = 'key:' . key
+    self.'log'($S0)
+.end
+
+.sub 'value' :method
+    .param pmc value
+    $S0 = 'null'
+    if_null value, log
+    $S0 = value
+  log:
+    self.'log'($S0)
+.end
+
+.sub 'log' :method
+    .param string event
+    $P0 = getattribute self, 'events'
+    push $P0, event
+.end
+
+.namespace []
+
+.sub 'test_handler'
+    .local pmc class, handler, json, events
+    class = newclass 'JSONCodecTestHandler'
+    addattribute class, 'events'
+    handler = new 'JSONCodecTestHandler'
+    events = new ['ResizableStringArray']
+    setattribute handler, 'events', events
+
+    json = new ['JSONCodec']
+    json.'handler'(handler)
+    $P0 = json.'parse'('{"a" : [1, "x", null], "b" : true}')
+    $I0 = isnull $P0
+    ok($I0, 'parse returns nothing with a handler')
+
+    $S0 = join ' ', events
+    is($S0, '{ key:a [ 1 x null ] key:b 1 }', 'handler events')
+
+    $P1 = json.'handler'()
+    $I0 = issame $P1, handler
+    ok($I0, 'handler getter')
+.end
+
+.sub 'test_emit'
+    .local pmc json, data
+    json = new ['JSONCodec']
+
+    $S0 = json.'emit'(1)
+    is($S0, '1', 'emit an integer')
+
+    $P0 = new ['String']
+    $P0 = "tab\tquote\"back\\ctl\x{1}"
+    $S0 = json.'emit'($P0)
+    is($S0, '"tab\tquote\"back\\ctl\u0001"', 'control characters are escaped')
+
+    $P0 = new ['String']
+    $P0 = utf8:"\x{e9}\x{1f600}"
+    $S0 = json.'emit'($P0)
+    is($S0, '"\u00e9\ud83d\ude00"', 'non-ASCII becomes \u escapes')
+
+    $N0 = 1e308
+    $N0 *= 10.0
+    $P0 = new ['Float']
+    $P0 = $N0
+    $S0 = json.'emit'($P0)
+    is($S0, 'null', 'infinity becomes null')
+
+    data = new ['Hash']
+    $P1 = new ['ResizablePMCArray']
+    push $P1, 1
+    push $P1, 'two'
+    $P2 = new ['Boolean']
+    push $P1, $P2
+    data['z'] = $P1
+    data['a'] = 2.5
+    $P3 = null
+    data['m'] = $P3
+    $S0 = json.'emit'(data)
+    $S1 = _json(data)
+    is($S0, $S1, 'compact layout matches _json')
+    is($S0, '{"a":2.5,"m":null,"z":[1,"two",false]}', '... and sorts keys')
+
+    push_eh too_deep
+    push $P1, $P1
+    json.'emit'(data)
+    pop_eh
+    ok(0, 'cyclic structure throws')
+    .return ()
+  too_deep:
+    pop_eh
+    ok(1, 'cyclic structure throws')
+.end
+
+.sub 'test_emit_pretty'
+    .local pmc json, data
+    json = new ['JSONCodec']
+    data = json.'parse'('{"a" : [1, {}, [], {"b" : [true]}], "c" : {}, "d" : [], "e" : "x"}')
+
+    $S0 = json.'emit'(data, 1)
+    $S1 = _json(data, 1)
+    is($S0, $S1, 'pretty layout matches _json')
+
+    $P0 = new ['ResizablePMCArray']
+    $S0 = json.'emit'($P0, 1)
+    $S1 = _json($P0, 1)
+    is($S0, $S1, 'pretty empty array matches _json')
+.end
+
+.sub 'test_roundtrip'
+    .local pmc json, data
+    .local string text
+    json = new ['JSONCodec']
+    text = '{"list":[1,-2,3.25,"\u00e9\n",true,false,null,{"x":[]}],"name":"\ud83d\ude00"}'
+    data = json.'parse'(text)
+    $S0 = json.'emit'(data)
+    is($S0, text, 'parse and emit round trip')
+.end
+
+# Local Variables:
+#   mode: pir
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4 ft=pir:
@@ -0,0 +1,208 @@
+#!./parrot
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/dynpmc/regexnfa.t - tests the RegexNFA PMC
+
+=head1 SYNOPSIS
+
+    % prove t/dynpmc/regexnfa.t
+
+=head1 DESCRIPTION
+
+Tests finding where matches may start with RegexNFA programs, and that PGE
+regexes which use them still match exactly as before.
+
+=cut
+
+.loadlib 'regexnfa'
+
+.sub main :main
+    .include 'test_more.pir'
+    load_bytecode 'PGE.pbc'
+
+    plan(39)
+
+    test_literals()
+    test_classes()
+    test_anchors()
+    test_repetition()
+    test_encodings()
+    test_errors()
+    test_pge()
+.end
+
+.sub 'find'
+    .param string prog
+    .param string target
+    .param int pos     :optional
+    .param int has_pos :opt_flag
+    if has_pos goto have_pos
+    pos = 0
+  have_pos:
+    $P0 = new ['RegexNFA']
+    $P0.'compile'(prog)
+    $I0 = $P0.'find'(target, pos)
+    .return ($I0)
+.end
+
+.sub 'test_literals'
+    $I0 = find('L3:foo', 'a fo foo')
+    is($I0, 5, 'literal')
+    $I0 = find('L3:foo', 'a fo foo', 6)
+    is($I0, -1, '... none after pos')
+    $I0 = find('I3:foo', 'a fo FoO')
+    is($I0, 5, 'ignorecase literal')
+    $I0 = find('|L3:catL3:dog', 'hotdog cat')
+    is($I0, 3, 'leftmost of an alternation')
+    $I0 = find('&2:L1:aL1:b', 'aab')
+    is($I0, 1, 'restarts after a partial match')
+    $I0 = find('e', 'xyz', 2)
+    is($I0, 2, 'empty matches at pos')
+    $I0 = find('F', 'xyz')
+    is($I0, -1, 'fail never matches')
+.end
+
+.sub 'test_classes'
+    $I0 = find('C8,0:', 'abc 42')
+    is($I0, 4, 'digit')
+    $I0 = find('&2:C8,1:C8,0:', '12a4')
+    is($I0, 2, 'not a digit, then a digit')
+    $I0 = find('S3:xyz', 'abcz')
+    is($I0, 3, 'set')
+    $I0 = find('N3:abc', 'abcz')
+    is($I0, 3, 'negated set')
+    $I0 = find('&2:.L1:b', 'bab')
+    is($I0, 1, 'any')
+    $I0 = find("|C4096,0:L2:\r\n", "ab\r\n")
+    is($I0, 2, 'newline')
+.end
+
+.sub 'test_anchors'
+    $I0 = find('&2:A^L1:a', 'ba')
+    is($I0, -1, 'bos')
+    $I0 = find('&2:A^L1:a', 'ab', 1)
+    is($I0, -1, '... not after pos 0')
+    $I0 = find('&2:L1:aA$', 'aba')
+    is($I0, 2, 'eos')
+    $I0 = find("&2:A<L1:b", "ab\nb")
+    is($I0, 3, 'bol')
+    $I0 = find("&2:L1:aA>", "ab\na")
+    is($I0, 3, 'eol')
+    $I0 = find('&2:AbL1:o', 'foo obar')
+    is($I0, 4, 'word boundary')
+    $I0 = find('&2:ABL1:o', 'o foo')
+    is($I0, 3, 'not a word boundary')
+    $I0 = find('&2:A[C8192,0:', '  ab')
+    is($I0, 2, 'left word boundary')
+    $I0 = find('&2:C8192,0:A]', 'ab  ')
+    is($I0, 1, 'right word boundary')
+.end
+
+.sub 'test_repetition'
+    $I0 = find('&3:L1:aQ2,3:L1:bL1:c', 'abc abbbbc abbc')
+    is($I0, 11, 'counted repetition')
+    $I0 = find('&2:Q1,-1:C8,0:L1:x', '12 345x')
+    is($I0, 3, 'unbounded repetition finds the leftmost start')
+
+    .local string text
+    text = repeat 'a', 35
+    text .= 'b'
+    $I0 = find('&2:Q40,40:L1:aL1:b', text)
+    is($I0, 0, 'long repetitions are widened, never narrowed')
+
+    text = repeat 'x', 100000
+    text .= 'needle'
+    $I0 = find('L6:needle', text)
+    is($I0, 100000, 'long target')
+.end
+
+.sub 'test_encodings'
+    $S0 = utf8:"\x{e9}t\x{e9} caf\x{e9}"
+    $I0 = find('L3:caf', $S0)
+    is($I0, 4, 'utf8 target')
+    $I0 = find('&2:L1:fC8192,0:', $S0)
+    is($I0, 6, '... class tests pass non-ASCII codepoints')
+    $I0 = find('I1:a', utf8:"\x{e9}a")
+    is($I0, 0, '... as do case-insensitive literals')
+.end
+
+.sub 'test_errors'
+    .local pmc nfa
+    nfa = new ['RegexNFA']
+    push_eh bad_program
+    nfa.'compile'('&2:L1:a')
+    pop_eh
+    ok(0, 'truncated program throws')
+    goto next
+  bad_program:
+    pop_eh
+    ok(1, 'truncated program throws')
+  next:
+    push_eh too_large
+    nfa.'compile'('Q30,30:Q30,30:Q30,30:L1:a')
+    pop_eh
+    ok(0, 'huge program throws')
+    goto done
+  too_large:
+    pop_eh
+    ok(1, 'huge program throws')
+  done:
+.end
+
+.sub 'match'
+    .param string regex
+    .param string target
+    .param string syntax :optional
+    .param int has_syntax :opt_flag
+    if has_syntax goto have_syntax
+    syntax = 'PGE::Perl6Regex'
+  have_syntax:
+    $P0 = compreg syntax
+    $P1 = $P0(regex)
+    $P2 = $P1(target)
+    $S0 = $P2.'from'()
+    $S1 = $P2.'to'()
+    $S0 = concat $S0, '-'
+    $S0 = concat $S0, $S1
+    .return ($S0, $P2)
+.end
+
+.sub 'test_pge'
+    $S0 = match('b+c', 'aaabbbc')
+    is($S0, '3-7', 'Perl 6 regex skips to a match')
+    $S0 = match('b+c', 'aaabbb')
+    is($S0, '6--2', '... and fails without one')
+    $S0 = match('a(b|c)+', 'xacbz', 'PGE::P5Regex')
+    is($S0, '1-4', 'Perl 5 regex')
+
+    $P0 = compreg 'PGE::Perl6Regex'
+    $P1 = $P0('\d+ x', 'ignorecase'=>1)
+    $P2 = $P1('12 a 34X')
+    $S0 = $P2
+    is($S0, '34X', 'ignorecase and digits')
+
+    .local pmc m
+    ($S0, m) = match('(\d)(\d)', 'a12b34')
+    $S1 = m[1]
+    is($S1, '2', 'captures still work')
+    m.'next'()
+    $S1 = m[0]
+    is($S1, '3', '... and the next match')
+
+    $P1 = $P0('o', 'target'=>'pir')
+    $S0 = $P1
+    $I0 = index $S0, 'L1:o'
+    ok($I0, 'regular regexes carry a program')
+    $P1 = $P0('<alpha> o', 'target'=>'pir')
+    $S0 = $P1
+    $I0 = index $S0, "'!nfa'"
+    is($I0, -1, '... others do not')
+.end
+
+# Local Variables:
+#   mode: pir
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4 ft=pir:
@@ -18,11 +18,12 @@ Test various use cases of the annotate directive.
 .sub main :main
     .include 'test_more.pir'
 
-    plan(33)
+    plan(37)
 
     'no_annotations'()
     'annotations_exception'()
     'annotations_ops'()
+    'annotations_loop'()
     'backtrace_annotations'()
     'parrotinterpreter_annotations'()
     'eval_test'()
@@ -101,6 +102,40 @@ Test various use cases of the annotate directive.
 .end
 
 
+.sub 'annotations_loop'
+    .local int i, lines, cols
+    i     = 0
+    lines = 0
+    cols  = 0
+  loop:
+    .annotate 'line', 10
+    $P0 = annotations 'line'
+    $I0 = $P0
+    lines += $I0
+    $P0 = annotations 'column'
+    $I0 = isnull $P0
+    cols += $I0
+    .annotate 'column', 5
+    .annotate 'line', 11
+    $P0 = annotations 'line'
+    $I0 = $P0
+    lines += $I0
+    $P0 = annotations 'column'
+    $I0 = isnull $P0
+    cols += $I0
+    inc i
+    if i < 3 goto loop
+
+    is (lines, 63, 'annotations found again on every trip round a loop')
+    is (cols, 3, 'annotation not in force before its offset')
+    $P0 = annotations
+    $I0 = $P0['column']
+    is ($I0, 5, 'all annotations after looking up single keys')
+    $I0 = $P0['line']
+    is ($I0, 11, 'all annotations after looking up single keys')
+.end
+
+
 .sub 'backtrace_annotations'
     push_eh failed
     'foo'()
@@ -19,7 +19,7 @@ Test handling C<dest> arg in 3-args arithmetic.
     .include 'test_more.pir'
     .include "iglobals.pasm"
 
-    plan(40)
+    plan(58)
 
     # Don't check BigInt or BigNum without gmp
     .local pmc interp     # a handle to our interpreter object.
@@ -31,14 +31,17 @@ Test handling C<dest> arg in 3-args arithmetic.
 
     run_tests_for('Integer')
     run_tests_for('Float')
+    test_result_types()
+    test_subclass()
 
     if gmp goto do_big_ones
-        skip( 20, "will not test BigInt or BigNum without gmp" )
+        skip( 22, "will not test BigInt or BigNum without gmp" )
         goto end
 
   do_big_ones:
     run_tests_for('BigInt')
     run_tests_for('BigNum')
+    test_overflow()
 
   end:
 .end
@@ -357,6 +360,100 @@ Test handling C<dest> arg in 3-args arithmetic.
   end:
 .end
 
+# The ops compute on core Integers and Floats directly; they must give what
+# the vtables do
+.sub test_result_types
+    $P0 = new 'Integer'
+    $P0 = 7
+    $P1 = new 'Float'
+    $P1 = 0.5
+
+    $P2 = $P0 - 10
+    is( $P2, -3, 'Integer minus int' )
+    $S0 = typeof $P2
+    is( $S0, 'Integer', '... is an Integer' )
+
+    $P2 = $P1 * $P0
+    is( $P2, 3.5, 'Float times Integer' )
+    $S0 = typeof $P2
+    is( $S0, 'Float', '... is a Float' )
+
+    $P2 = $P0 + $P1
+    is( $P2, 7.5, 'Integer plus Float' )
+    $S0 = typeof $P2
+    is( $S0, 'Float', '... is a Float' )
+
+    $P2 = $P1 + 1.25
+    is( $P2, 1.75, 'Float plus num' )
+
+    $P3 = new 'Float'
+    $P3 = 2.0
+    $P3 *= $P0
+    $P3 -= 1
+    is( $P3, 13, 'Float multiplied and decreased in place' )
+
+    $P4 = new 'Integer'
+    $P4 = 5
+    $P4 -= $P0
+    $P4 *= 3
+    is( $P4, -6, 'Integer decreased and multiplied in place' )
+    $S0 = typeof $P4
+    is( $S0, 'Integer', '... is an Integer' )
+
+    $P4 += 0.5
+    is( $P4, -5.5, 'Integer plus num in place' )
+    $S0 = typeof $P4
+    is( $S0, 'Float', '... became a Float' )
+
+    $P5 = new 'Integer'
+    $P5 = 3
+    mul $P5, $P0
+    is( $P5, 21, 'Integer multiplied by Integer in place' )
+    $S0 = typeof $P5
+    is( $S0, 'Float', '... became a Float' )
+.end
+
+.sub test_subclass
+    $P0 = subclass 'Integer', 'AddsOne'
+    $P1 = new 'AddsOne'
+    $P1 = 5
+    $P2 = new 'Integer'
+    $P2 = 2
+
+    $P3 = $P1 + $P2
+    is( $P3, 8, 'overridden add of a subclass of Integer' )
+    $P3 = $P2 + $P1
+    is( $P3, 7, 'Integer plus a subclass of Integer' )
+.end
+
+.sub test_overflow
+    $P0 = new 'Integer'
+    $P0 = 256
+    $I0 = 0
+  loop:
+    $P0 = $P0 * $P0
+    inc $I0
+    if $I0 < 4 goto loop
+
+    is( $P0, '340282366920938463463374607431768211456', 'Integer overflowing into BigInt' )
+    $S0 = typeof $P0
+    is( $S0, 'BigInt', '... is a BigInt' )
+.end
+
+.namespace ['AddsOne']
+
+.sub 'add' :vtable
+    .param pmc value
+    .param pmc dest
+    $I0 = self
+    $I1 = value
+    $I0 += $I1
+    inc $I0
+    dest = new 'Integer'
+    dest = $I0
+    .return (dest)
+.end
+
 # Local Variables:
 #   mode: pir
 #   fill-column: 100
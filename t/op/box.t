@@ -15,7 +15,7 @@ Tests all box operators.
 
 =cut
 
-.const int TESTS = 26
+.const int TESTS = 27
 
 # must set these up before the hll_map calls later
 .sub '__setup' :immediate
@@ -61,6 +61,11 @@ Tests all box operators.
     $I0 = $P0
     is( $I0, 200, 'value preserved when boxing int from reg' )
     isa_ok( $P0, 'Integer', 'int boxed to appropriate base type from reg' )
+
+    $P1 = box 100
+    $P2 = box 100
+    inc $P1
+    is( $P2, 100, 'boxes of the same value are distinct PMCs' )
 .end
 
 .sub 'box_num'
@@ -6,7 +6,7 @@ use warnings;
 use lib qw( . lib ../lib ../../lib );
 
 use Test::More;
-use Parrot::Test tests => 104;
+use Parrot::Test tests => 105;
 
 =head1 NAME
 
@@ -2673,6 +2673,60 @@ CODE
 /Null PMC access/
 OUTPUT
 
+pir_output_is( <<'CODE', <<'OUTPUT', "positional params and results of mixed types" );
+.sub main :main
+    $P0 = box 'pmc'
+    mixed(1, 2.5, 'three', $P0)
+    mixed($P0, 4, 5.5, 'six')
+    $P1 = box 7
+    $P2 = box 8.5
+    $P3 = box '9'
+    mixed($P1, $P2, $P3, 10)
+
+    ($I0, $N0, $S0, $P4) = results()
+    say $I0
+    say $N0
+    say $S0
+    say $P4
+    ($P4, $I0, $N0, $S0) = results()
+    say $P4
+    say $I0
+    say $N0
+    say $S0
+.end
+
+.sub mixed
+    .param int    i
+    .param num    n
+    .param string s
+    .param pmc    p
+    print i
+    print ' '
+    print n
+    print ' '
+    print s
+    print ' '
+    say p
+.end
+
+.sub results
+    $P0 = box 'four'
+    .return (1, 2.5, 'three', $P0)
+.end
+CODE
+1 2.5 three pmc
+0 4 5.5 six
+7 8.5 9 10
+1
+2.5
+three
+four
+1
+2
+0
+four
+OUTPUT
+
 # Local Variables:
 #   mode: cperl
 #   cperl-indent-level: 4
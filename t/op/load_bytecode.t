@@ -5,7 +5,9 @@ use strict;
 use warnings;
 use lib qw( . lib ../lib ../../lib );
 use Test::More;
-use Parrot::Test tests => 3;
+use Parrot::Test tests => 4;
+use Parrot::Config;
+use File::Temp 0.13 qw/tempfile/;
 
 =head1 NAME
 
@@ -45,6 +47,42 @@ CODE
 /"load_bytecode" couldn't find file 'no_file_by_this_name'/
 OUTPUT
 
+# Two libraries using the same ops share their op tables
+my @pbc;
+for my $name (qw( first second )) {
+    my ( $pir_fh, $pir ) = tempfile( UNLINK => 1, SUFFIX => '.pir' );
+    my ( undef, $pbc )   = tempfile( UNLINK => 1, SUFFIX => '.pbc' );
+    print $pir_fh <<"PIR";
+.sub '$name'
+    .param int n
+    \$I0 = n * 2
+    \$S0 = \$I0
+    \$S0 = concat '$name ', \$S0
+    .return (\$S0)
+.end
+PIR
+    close $pir_fh;
+    system(".$PConfig{slash}$PConfig{test_prog}", '-o', $pbc, $pir) == 0
+        or die "Cannot compile $pir: $?";
+    push @pbc, $pbc;
+}
+
+pir_output_is( <<"CODE", <<'OUTPUT', "load_bytecode of libraries with the same ops" );
+.sub main :main
+    load_bytecode '$pbc[0]'
+    load_bytecode '$pbc[1]'
+    \$P0 = get_global 'first'
+    \$S0 = \$P0(1)
+    say \$S0
+    \$P0 = get_global 'second'
+    \$S0 = \$P0(2)
+    say \$S0
+.end
+CODE
+first 2
+second 4
+OUTPUT
+
 # Local Variables:
 #   mode: cperl
 #   cperl-indent-level: 4
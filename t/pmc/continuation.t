@@ -17,7 +17,7 @@ Tests the Continuation PMC.
 
 .sub main :main
     .include 'test_more.pir'
-    plan(9)
+    plan(10)
 
     test_new()
     invoke_with_init()
@@ -25,6 +25,7 @@ Tests the Continuation PMC.
     returns_tt1528()
     experimental_caller()
     get_pointer_and_string()
+    resume_returned_frame()
 .end
 
 .sub test_new
@@ -173,6 +174,37 @@ end:
    dummy:
 .end
 
+.sub 'grab_return'
+    .include 'interpinfo.pasm'
+    $P0 = interpinfo .INTERPINFO_CURRENT_CONT
+    set_global '!saved_cont', $P0
+.end
+
+.sub 'resumable_frame'
+    .local string s
+    s = 'frame kept'
+    'grab_return'()
+    $P0 = get_global '!resumed'
+    inc $P0
+    $P1 = box s
+    set_global '!frame_value', $P1
+.end
+
+.sub resume_returned_frame
+    $P0 = box 0
+    set_global '!resumed', $P0
+    'resumable_frame'()
+    $P0 = get_global '!resumed'
+    if $P0 > 1 goto done
+    # re-enter the frame of 'resumable_frame' after it returned
+    $P1 = get_global '!saved_cont'
+    $P1()
+  done:
+    $P2 = get_global '!frame_value'
+    $S0 = $P2
+    is($S0, 'frame kept', 'registers of a returned frame survive a captured continuation')
+.end
+
 # end of tests.
 
 # Local Variables:
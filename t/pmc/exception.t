@@ -19,7 +19,7 @@ Tests C<Exception> and C<ExceptionHandler> PMCs.
 
 .sub main :main
     .include 'test_more.pir'
-    plan(53)
+    plan(59)
     test_bool()
     test_int()
     test_new_int()
@@ -39,6 +39,7 @@ Tests C<Exception> and C<ExceptionHandler> PMCs.
     test_throw_clone()
     test_throw_serialized()
     test_backtrace()
+    test_backtrace_strings()
     test_annotations()
     test_subclass_throw()
     test_subclass_finalize()
@@ -463,6 +464,51 @@ _handler:
     is($I0, 0, 'got backtrace from unthrow Exception')
 .end
 
+.sub test_backtrace_strings
+    .local pmc ex, bts
+    push_eh catch
+    bt_rethrower()
+    pop_eh
+    ok(0, 'rethrown exception not caught')
+    .return()
+  catch:
+    .get_results(ex)
+    pop_eh
+    bts = ex.'backtrace_strings'()
+    $I0 = elements bts
+    is($I0, 2, 'backtrace_strings has an entry for each throw')
+    $S0 = bts[0]
+    $I0 = index $S0, "'bt_thrower'"
+    isnt($I0, -1, 'first backtrace starts at the original thrower')
+    $I0 = index $S0, "'bt_rethrower'"
+    isnt($I0, -1, 'first backtrace includes its caller')
+    bts = ex.'backtrace_strings'()
+    $I0 = elements bts
+    is($I0, 2, 'backtrace_strings does not grow when called again')
+    bts = getattribute ex, 'bt_strings'
+    $I0 = elements bts
+    is($I0, 1, 'bt_strings attribute has an entry for each rethrow')
+    $S0 = bts[0]
+    $I0 = index $S0, "'bt_thrower'"
+    isnt($I0, -1, 'bt_strings attribute holds the formatted backtrace')
+.end
+
+.sub bt_rethrower
+    .local pmc ex
+    push_eh catch
+    bt_thrower()
+    pop_eh
+    .return()
+  catch:
+    .get_results(ex)
+    pop_eh
+    rethrow ex
+.end
+
+.sub bt_thrower
+    die 'backtrace me'
+.end
+
 .sub test_annotations
     .local pmc ex, ann
     ex = new ['Exception']
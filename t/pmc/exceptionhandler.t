@@ -22,7 +22,7 @@ Tests the ExceptionHandler PMC.
     .include 'test_more.pir'
 
     # If test exited with "bad plan" MyHandlerCan.can_handle wasn't invoked.
-    plan(25)
+    plan(31)
 
     test_bool()
     test_int()
@@ -105,6 +105,7 @@ Tests the ExceptionHandler PMC.
     test_handle_types_except()
     test_init_pmc_with_key()
     test_all_types()
+    test_label_handlers()
 
     goto init_int
 
@@ -155,6 +156,47 @@ Tests the ExceptionHandler PMC.
     ok($I0, 'Exception Handler subclass catch exception')
 .end
 
+.sub test_label_handlers
+    .local pmc eh, ctx, handlers
+    push_eh outer
+    push_eh middle
+    push_eh inner
+    $I0 = count_eh
+    is($I0, 3, 'count_eh counts handlers pushed with a label')
+    pop_eh
+    $I0 = count_eh
+    is($I0, 2, 'pop_eh removes a handler pushed with a label')
+
+    eh = new ['ExceptionHandler']
+    set_label eh, pmc_handler
+    push_eh eh
+    ctx = getinterp
+    ctx = ctx['context']
+    handlers = getattribute ctx, 'handlers'
+    $I0 = elements handlers
+    is($I0, 3, 'label handlers appear in the context handler list')
+    $P0 = handlers[0]
+    $I0 = issame $P0, eh
+    ok($I0, 'the newest handler is first in the list')
+    pop_eh
+
+    die 'to middle'
+  pmc_handler:
+  inner:
+  outer:
+    ok(0, 'wrong handler caught the exception')
+    .return()
+  middle:
+    .local pmc ex
+    .get_results(ex)
+    $S0 = ex['message']
+    is($S0, 'to middle', 'newest remaining label handler catches')
+    pop_eh
+    $I0 = count_eh
+    is($I0, 1, 'one handler left after pop_eh')
+    pop_eh
+.end
+
 .sub test_bool
     $P0 = new 'ExceptionHandler'
     nok($P0,'ExceptionHandler without address is false')
@@ -19,7 +19,7 @@ out-of-bounds test. Checks INT and PMC keys.
 .sub main :main
     .include 'fp_equality.pasm'
     .include 'test_more.pir'
-    plan(32)
+    plan(35)
 
     array_size_tests()
     element_set_tests()
@@ -32,6 +32,7 @@ out-of-bounds test. Checks INT and PMC keys.
     test_new_style_init()
     test_invalid_init_tt1509()
     test_get_string()
+    test_freeze_thaw()
 .end
 
 .sub array_size_tests
@@ -284,6 +285,21 @@ CODE
     is($S0, '[ -1.5, 0, 3.14 ]', 'has string representation')
 .end
 
+.sub test_freeze_thaw
+    $P0 = new 'FixedFloatArray', 3
+    $P0[0] = -1.5
+    $P0[1] = 0
+    $P0[2] = 3.14
+    $S0 = freeze $P0
+    $P1 = thaw $S0
+    $I0 = $P1
+    is($I0, 3, 'thawed array has the same size')
+    $N0 = $P1[0]
+    is($N0, -1.5, 'thawed array has the first element')
+    $S0 = $P1
+    is($S0, '[ -1.5, 0, 3.14 ]', 'thawed array has all elements')
+.end
+
 # Local Variables:
 #   mode: pir
 #   fill-column: 100
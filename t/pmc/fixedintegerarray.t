@@ -34,6 +34,7 @@ out-of-bounds test. Checks INT and PMC keys.
     test_new_style_init()
     test_invalid_init_tt1509()
     test_custom_cmp()
+    test_freeze_thaw()
 
     done_testing()
 .end
@@ -328,6 +329,30 @@ CODE
 
 
 
+.sub 'test_freeze_thaw'
+    .local pmc fia
+    .local int i, sum
+    fia = new ['FixedIntegerArray'], 1000
+    i = 0
+  fill:
+    fia[i] = i
+    inc i
+    if i < 1000 goto fill
+    fia[999] = -7
+
+    $S0 = freeze fia
+    $P0 = thaw $S0
+
+    $I0 = $P0
+    is($I0, 1000, 'thawed FIA has the same size')
+    $I0 = $P0[0]
+    is($I0, 0, 'thawed FIA has the first element')
+    $I0 = $P0[500]
+    is($I0, 500, 'thawed FIA has an element in the middle')
+    $I0 = $P0[999]
+    is($I0, -7, 'thawed FIA has the last element')
+.end
+
 # Local Variables:
 #   mode: pir
 #   fill-column: 100
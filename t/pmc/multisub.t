@@ -19,7 +19,7 @@ Tests the creation and invocation of Perl6 multi subs.
 .sub main :main
     .include 'test_more.pir'
 
-    plan( 8 )
+    plan( 13 )
 
     $P0 = new ['MultiSub']
     $I0 = defined $P0
@@ -51,6 +51,49 @@ Tests the creation and invocation of Perl6 multi subs.
     $S0 = foo($P1 :flat, $P2 :flat)
     is($S0, "testing 42, goodbye", "Int and String double :flat")
 
+    candidates_changed()
+.end
+
+.sub candidates_changed
+    .local pmc multi, generic, specific, arg
+    $P0      = get_global 'generic'
+    generic  = $P0[0]
+    $P0      = get_global 'specific'
+    specific = $P0[0]
+    arg      = new ['Integer']
+
+    multi = new ['MultiSub']
+    push multi, generic
+    $S0 = multi(arg)
+    is($S0, "generic", "dispatch with one candidate")
+
+    push multi, specific
+    $S0 = multi(arg)
+    is($S0, "specific", "added candidate seen after a dispatch")
+
+    $P0 = pop multi
+    $S0 = multi(arg)
+    is($S0, "generic", "removed candidate forgotten after a dispatch")
+
+    multi[0] = specific
+    $S0 = multi(arg)
+    is($S0, "specific", "replaced candidate seen after a dispatch")
+
+    $P0 = new ['ResizablePMCArray']
+    push $P0, generic
+    assign multi, $P0
+    $S0 = multi(arg)
+    is($S0, "generic", "assigned candidates seen after a dispatch")
+.end
+
+.sub generic :multi(_)
+    .param pmc arg
+    .return ('generic')
+.end
+
+.sub specific :multi(Integer)
+    .param pmc arg
+    .return ('specific')
 .end
 
 .sub foo :multi()
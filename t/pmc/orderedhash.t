@@ -5,7 +5,7 @@ use strict;
 use warnings;
 use lib qw( . lib ../lib ../../lib );
 use Test::More;
-use Parrot::Test tests => 32;
+use Parrot::Test tests => 35;
 
 =head1 NAME
 
@@ -936,6 +936,144 @@ Bar
 Bar
 OUTPUT
 
+pir_output_is( <<'CODE', <<'OUTPUT', "delete many, then index, iterate and freeze" );
+.sub main :main
+    .local pmc hash
+    hash = new ['OrderedHash']
+    $I0 = 0
+  fill:
+    $S0 = $I0
+    hash[$S0] = $I0
+    inc $I0
+    if $I0 < 100 goto fill
+
+    # delete all but every tenth entry, leaving holes
+    $I0 = 0
+  remove:
+    $I1 = $I0 % 10
+    if $I1 == 0 goto keep
+    $S0 = $I0
+    delete hash[$S0]
+  keep:
+    inc $I0
+    if $I0 < 100 goto remove
+
+    $I0 = elements hash
+    say $I0
+    $I0 = hash[3]
+    say $I0
+    $I0 = hash[-1]
+    say $I0
+
+    $S1 = ''
+    $P0 = iter hash
+  loop:
+    unless $P0 goto done
+    $S0 = shift $P0
+    $S1 .= $S0
+    $S1 .= ' '
+    goto loop
+  done:
+    say $S1
+
+    $S0 = freeze hash
+    $P1 = thaw $S0
+    $I0 = elements $P1
+    say $I0
+    $I0 = $P1[9]
+    say $I0
+.end
+CODE
+10
+30
+90
+0 10 20 30 40 50 60 70 80 90 
+10
+90
+OUTPUT
+
+pir_output_is( <<'CODE', <<'OUTPUT', "inserting after deletes keeps the order" );
+.sub main :main
+    .local pmc hash
+    hash = new ['OrderedHash']
+    $I0 = 0
+  fill:
+    $S0 = $I0
+    hash[$S0] = $I0
+    inc $I0
+    if $I0 < 8 goto fill
+
+    delete hash['1']
+    delete hash['2']
+    delete hash['4']
+    delete hash['5']
+    delete hash['6']
+
+    # the entries are full, so this squeezes out the holes
+    hash['a'] = 'A'
+    hash['b'] = 'B'
+    hash['3'] = 'three'
+
+    $S1 = ''
+    $P0 = iter hash
+  loop:
+    unless $P0 goto done
+    $S0 = shift $P0
+    $S2 = hash[$S0]
+    $S1 .= $S2
+    $S1 .= ' '
+    goto loop
+  done:
+    say $S1
+    $S0 = hash[1]
+    say $S0
+.end
+CODE
+0 three 7 A B 
+three
+OUTPUT
+
+pir_output_is( <<'CODE', <<'OUTPUT', "iterators keep their place when entries move" );
+.include 'iterator.pasm'
+.sub main :main
+    .local pmc hash
+    hash = new ['OrderedHash']
+    $I0 = 0
+  fill:
+    $S0 = $I0
+    hash[$S0] = $I0
+    inc $I0
+    if $I0 < 8 goto fill
+
+    $P0 = iter hash
+    $S0 = shift $P0
+    $S1 = shift $P0
+    $P1 = iter hash
+    $P1 = .ITERATE_FROM_END
+    $S2 = pop $P1
+    print $S0
+    print $S1
+    say $S2
+
+    delete hash['0']
+    delete hash['2']
+    delete hash['3']
+    delete hash['4']
+    delete hash['5']
+    hash['x'] = 'X'
+
+    $S0 = shift $P0
+    $S1 = shift $P0
+    $S2 = pop $P1
+    print $S0
+    print $S1
+    say $S2
+.end
+CODE
+017
+676
+OUTPUT
+
 # Local Variables:
 #   mode: cperl
 #   cperl-indent-level: 4
@@ -22,12 +22,13 @@ t/pmc/orderedhash.t.
 .sub 'main' :main
     .include 'test_more.pir'
 
-    plan(7)
+    plan(11)
 
     'test_init'()
     'test_bad_type'()
     'test_shift'()
     'test_pop'()
+    'test_stored_keys'()
     'test_clone'()
 .end
 
@@ -113,6 +114,36 @@ t/pmc/orderedhash.t.
     ok(i, 'pop_pmc in empty OH throws')
 .end
 
+.sub 'test_stored_keys'
+    .local pmc oh, it, k, p
+    .local string s
+    .local int i
+    oh = new ['OrderedHash']
+    k = new ['String']
+    k = 'a'
+    oh[k] = 1
+    s = 'b'
+    oh[s] = 2
+    s = 'c'
+
+    it = iter oh
+    p = shift it
+    i = issame p, k
+    ok(i, 'shift_pmc returns the stored key PMC')
+    p = shift it
+    s = typeof p
+    is(s, 'Key', 'shift_pmc returns a Key for a register key')
+    s = p
+    is(s, 'b', '... which keeps its value')
+
+    it = iter oh
+    it = .ITERATE_FROM_END
+    p = pop it
+    p = pop it
+    i = issame p, k
+    ok(i, 'pop_pmc returns the stored key PMC')
+.end
+
 .sub 'test_clone'
     .local pmc oh, it, cl
     .local int result
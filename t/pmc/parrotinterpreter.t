@@ -21,10 +21,11 @@ Tests the ParrotInterpreter PMC.
 .sub main :main
 .include 'test_more.pir'
 
-    plan(14)
+    plan(19)
     test_new()      # 1 test
     test_hll_map()  # 3 tests
     test_hll_map_invalid()  # 1 tests
+    test_metrics()  # 5 tests
 
 # Need for testing
 .annotate 'foo', 'bar'
@@ -86,6 +87,35 @@ Tests the ParrotInterpreter PMC.
     is(result, 1, 'hll_map outside an HLL throws')
 .end
 
+.sub test_metrics
+    .local pmc interp, before, after, pause
+    interp = getinterp
+    before = interp.'metrics'()
+    $I0 = before['pmc_allocs']
+    ok($I0, 'metrics count PMC allocations')
+
+    foo()
+    interp.'run_gc'()
+    after = interp.'metrics'()
+
+    $I0 = before['contexts_created']
+    $I1 = after['contexts_created']
+    $I2 = $I1 > $I0
+    ok($I2, 'metrics count contexts')
+
+    $I0 = before['gc_runs']
+    $I1 = after['gc_runs']
+    $I2 = $I1 > $I0
+    ok($I2, 'metrics count GC runs')
+
+    pause = after['gc_pause_ns']
+    $I0 = pause['count']
+    is($I0, $I1, 'every GC run has a pause observation')
+    $P0 = pause['buckets']
+    $I0 = elements $P0
+    is($I0, 32, 'histogram has 32 buckets')
+.end
+
 # Test accessors to various Interp fields
 .sub 'test_inspect'
     .local pmc interp
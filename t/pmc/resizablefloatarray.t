@@ -16,7 +16,7 @@ out-of-bounds test. Checks INT and PMC keys.
 
 =cut
 
-.const int TESTS = 63
+.const int TESTS = 75
 .const num PRECISION = 1e-6
 
 .sub 'test' :main
@@ -50,6 +50,11 @@ out-of-bounds test. Checks INT and PMC keys.
     get_iter()
     'clone'()
     method_reverse()
+    method_fill()
+    method_copy_range()
+    method_map()
+    method_reductions()
+    method_reserve()
 .end
 
 .sub 'creation'
@@ -495,6 +500,92 @@ out-of-bounds test. Checks INT and PMC keys.
     is($S0, "4.53156", "method_reverse - five elements second reverse")
 .end
 
+.sub method_fill
+    .local pmc array
+    array = new ['ResizableFloatArray']
+    array.'fill'(1.5, 0, 3)
+    $S0 = join ",", array
+    is($S0, "1.5,1.5,1.5", "method_fill - grows the array")
+    array.'fill'(0.5, 1, 1)
+    $S0 = join ",", array
+    is($S0, "1.5,0.5,1.5", "method_fill - a range")
+.end
+
+.sub method_copy_range
+    .local pmc array, src
+    array = new ['ResizableFloatArray']
+    src   = new ['FixedFloatArray'], 2
+    src[0] = 0.25
+    src[1] = 0.75
+    array.'copy_range'(src, 0, 1, 2)
+    $S0 = join ",", array
+    is($S0, "0,0.25,0.75", "method_copy_range - into a new range")
+.end
+
+.sub method_map
+    .local pmc array, other
+    array = new ['ResizableFloatArray']
+    array.'fill'(2.0, 0, 3)
+    array.'map_mul'(0.5)
+    $S0 = join ",", array
+    is($S0, "1,1,1", "method_map - multiply by a scalar")
+    other = new ['ResizableIntegerArray']
+    push other, 1
+    push other, 2
+    push other, 3
+    array.'map_add'(other)
+    $S0 = join ",", array
+    is($S0, "2,3,4", "method_map - add an integer array")
+.end
+
+.sub method_reductions
+    .local pmc array
+    array = new ['ResizableFloatArray']
+    $I0 = 0
+  fill:
+    $N0 = $I0
+    $N0 *= 0.5
+    push array, $N0
+    inc $I0
+    if $I0 < 11 goto fill
+
+    $N0 = array.'sum'()
+    is($N0, 27.5, "method_sum")
+    $N0 = array.'min'()
+    is($N0, 0.0, "method_min")
+    $N0 = array.'max'()
+    is($N0, 5.0, "method_max")
+    $N0 = array.'dot'(array)
+    is($N0, 96.25, "method_dot")
+
+    push_eh empty
+    array = new ['ResizableFloatArray']
+    array.'min'()
+    pop_eh
+    ok(0, "method_min - empty array throws")
+    .return ()
+  empty:
+    pop_eh
+    ok(1, "method_min - empty array throws")
+.end
+
+.sub method_reserve
+    .local pmc array
+    array = new ['ResizableFloatArray']
+    array.'reserve'(50)
+    push array, 1.5
+    array.'shrink_to_fit'()
+    push array, 2.5
+    $S0 = join ",", array
+    is($S0, "1.5,2.5", "method_reserve and method_shrink_to_fit keep the elements")
+
+    array = new ['ResizableFloatArray']
+    array.'reserve'(20)
+    array = 20
+    $N0 = array.'sum'()
+    is($N0, 0, "method_reserve - the new room is zero")
+.end
+
 # Local Variables:
 #   mode: pir
 #   fill-column: 100
@@ -42,7 +42,7 @@ Coverage plan:
 
 .sub main :main
     .include 'test_more.pir'
-    plan(55)
+    plan(72)
 
     test_does_interfaces()
 
@@ -75,6 +75,11 @@ Coverage plan:
     test_clone()
     test_freeze()
     method_reverse()
+    method_fill()
+    method_copy_range()
+    method_map()
+    method_reductions()
+    method_reserve()
 .end
 
 .sub test_does_interfaces
@@ -644,6 +649,114 @@ k0:
     is($S0, "43156", "method_reverse - five elements second reverse")
 .end
 
+.sub method_fill
+    .local pmc array
+    array = new ['ResizableIntegerArray']
+    array.'fill'(7, 0, 4)
+    $S0 = join ",", array
+    is($S0, "7,7,7,7", "method_fill - grows the array")
+    array.'fill'(1, 2)
+    $S0 = join ",", array
+    is($S0, "7,7,1,1", "method_fill - to the end")
+    array.'fill'(0)
+    $S0 = join ",", array
+    is($S0, "0,0,0,0", "method_fill - whole array")
+.end
+
+.sub method_copy_range
+    .local pmc array, src
+    array = new ['ResizableIntegerArray']
+    src   = new ['ResizablePMCArray']
+    push src, 1
+    push src, 2
+    push src, 3
+    array.'copy_range'(src, 0, 0, 3)
+    $S0 = join ",", array
+    is($S0, "1,2,3", "method_copy_range - from another kind of array")
+    array.'copy_range'(array, 0, 1, 3)
+    $S0 = join ",", array
+    is($S0, "1,1,2,3", "method_copy_range - overlapping ranges in one array")
+
+    push_eh out_of_bounds
+    array.'copy_range'(src, 2, 0, 2)
+    pop_eh
+    ok(0, "method_copy_range - past the end of the source throws")
+    .return ()
+  out_of_bounds:
+    pop_eh
+    ok(1, "method_copy_range - past the end of the source throws")
+.end
+
+.sub method_map
+    .local pmc array, other
+    array = new ['ResizableIntegerArray']
+    array.'fill'(2, 0, 3)
+    array.'map_add'(3)
+    $S0 = join ",", array
+    is($S0, "5,5,5", "method_map - add a scalar")
+    other = new ['FixedIntegerArray'], 3
+    other[0] = 1
+    other[1] = 2
+    other[2] = 3
+    array.'map_mul'(other)
+    $S0 = join ",", array
+    is($S0, "5,10,15", "method_map - multiply by an array")
+
+    push_eh mismatch
+    push other, 4
+    $P0 = new ['ResizableIntegerArray']
+    array.'map_add'($P0)
+    pop_eh
+    ok(0, "method_map - arrays of different lengths throw")
+    .return ()
+  mismatch:
+    pop_eh
+    ok(1, "method_map - arrays of different lengths throw")
+.end
+
+.sub method_reductions
+    .local pmc array
+    array = new ['ResizableIntegerArray']
+    push array, 4
+    push array, -2
+    push array, 9
+    push array, 1
+    push array, 3
+    $I0 = array.'sum'()
+    is($I0, 15, "method_sum")
+    $I0 = array.'min'()
+    is($I0, -2, "method_min")
+    $I0 = array.'max'()
+    is($I0, 9, "method_max")
+    $I0 = array.'dot'(array)
+    is($I0, 111, "method_dot")
+.end
+
+.sub method_reserve
+    .local pmc array
+    array = new ['ResizableIntegerArray']
+    array.'reserve'(100)
+    $I0 = elements array
+    is($I0, 0, "method_reserve - doesn't change the size")
+    push array, 1
+    push array, 2
+    array.'shrink_to_fit'()
+    push array, 3
+    $S0 = join ",", array
+    is($S0, "1,2,3", "method_shrink_to_fit - keeps the elements")
+
+    array = new ['ResizableIntegerArray']
+    array.'reserve'(20)
+    array = 20
+    $I0 = array.'sum'()
+    is($I0, 0, "method_reserve - the new room is zero")
+
+    array = new ['ResizableIntegerArray']
+    array.'fill'(7, 3, 2)
+    $S0 = join ",", array
+    is($S0, "0,0,0,7,7", "method_fill - the elements skipped are zero")
+.end
+
 # Local Variables:
 #   mode: pir
 #   fill-column: 100
@@ -9,14 +9,15 @@
     # Use say instead inside tasks
     .include 'test_more.pir'
 
-    plan(8)
+    plan(9)
 
     ok(1, "initialized")
 
     tasks_run()
     task_send_recv()
+    task_outer_handlers()
 
-    print "ok 7 #SKIP task.kill - no reliable test yet [GH #907]\n"
+    print "ok 8 #SKIP task.kill - no reliable test yet [GH #907]\n"
     goto post_kill
 
     $S0 = sysinfo .SYSINFO_PARROT_OS
@@ -25,7 +26,7 @@
     task_kill()
     goto post_kill
   skip_kill:
-    print "ok 7 #SKIP task.kill - no signals on Windows yet\n"
+    print "ok 8 #SKIP task.kill - no signals on Windows yet\n"
   post_kill:
     preempt_and_exit()
 .end
@@ -105,6 +106,32 @@ ok:
     say "ok 6 Got existing message"
 .end
 
+.sub task_outer_handlers
+    push_eh no_handler
+    .const 'Sub' count_handlers = 'count_outer_handlers'
+    $P0 = newclosure count_handlers
+    $P1 = new 'Task', $P0
+    schedule $P1
+    wait $P1
+    pop_eh
+    .return ()
+  no_handler:
+    say "not ok 7 task_outer_handlers threw"
+.end
+
+.sub count_outer_handlers :outer('task_outer_handlers')
+    $P0 = getinterp
+    $P0 = $P0['context']
+    $P0 = getattribute $P0, 'outer_ctx'
+    $P0 = getattribute $P0, 'handlers'
+    $I0 = elements $P0
+    if $I0 == 1 goto ok
+    say "not ok 7 label handler of the outer context lost in a task"
+    returncc
+ok:
+    say "ok 7 label handler of the outer context seen in a task"
+.end
+
 .sub task_kill
     .local pmc task, code
     code = get_global 'task_to_kill'
@@ -122,9 +149,9 @@ ok:
 .end
 
 .sub task_to_kill
-    print "ok 7 task_to_kill running\n"
+    print "ok 8 task_to_kill running\n"
     sleep 0.2
-    say "not ok 8 task_to_kill wasn't killed"
+    say "not ok 9 task_to_kill wasn't killed"
 .end
 
 .sub preempt_and_exit
@@ -136,7 +163,7 @@ again:
 .end
 
 .sub exit0
-    say "ok 8 pre-empt and exit"
+    say "ok 9 pre-empt and exit"
     exit 0
 .end
 
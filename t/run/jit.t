@@ -0,0 +1,207 @@
+#!perl
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/run/jit.t - test the jit runcore
+
+=head1 SYNOPSIS
+
+    % prove t/run/jit.t
+
+=head1 DESCRIPTION
+
+Runs programs with C<-R jit> and a threshold of 1, so that their subs run as
+native code right away, and checks they give the same results as with the
+fast core.
+
+=cut
+
+use strict;
+use warnings;
+use lib qw( lib . ../lib ../../lib );
+
+use Test::More tests => 10;
+use Parrot::Config;
+use File::Temp 0.13 qw/tempfile/;
+
+my $PARROT = ".$PConfig{slash}$PConfig{test_prog}";
+
+# redirect STDERR to read the error messages
+my $redir = '2>&1';
+
+$ENV{PARROT_JIT_THRESHOLD} = 1;
+
+sub same_as_fast {
+    my ( $code, $expected, $desc ) = @_;
+    my $file = create_pir_file($code);
+
+    is( `"$PARROT" -R fast "$file" $redir`, $expected, "$desc (fast)" );
+    is( `"$PARROT" -R jit "$file" $redir`, $expected, "$desc (jit)" );
+}
+
+same_as_fast( <<'END_PIR', "4950\n-4950\n328350\n", 'integer loops' );
+.sub 'main' :main
+    $I0 = 0
+    $I1 = 0
+    $I3 = 0
+  loop:
+    add $I1, $I1, $I0
+    sub $I2, 0, $I1
+    $I4 = $I0 * $I0
+    $I3 += $I4
+    inc $I0
+    lt $I0, 100, loop
+    say $I1
+    say $I2
+    say $I3
+.end
+END_PIR
+
+same_as_fast( <<'END_PIR', "12.5\n1.5\n1\n0\n1\n1\n", 'number loops and NaN' );
+.sub 'main' :main
+    $N0 = 0.0
+    $N1 = 0.0
+    $I0 = 0
+  loop:
+    $N1 = $N0 * 0.5
+    $N0 += 0.5
+    inc $I0
+    if $I0 < 10 goto loop
+    $N2 = $N0 * 2.5
+    say $N2
+    $N3 = $N1 - 1.5
+    $N3 = -$N3
+    $N3 += 0.75
+    $N3 += 1.5
+    $N3 -= 0.0
+    say $N3
+    $N4 = 'NaN'
+    $I1 = $N4 != $N4
+    say $I1
+    $I2 = 0
+    if $N4 == $N4 goto equal
+    if $N4 <  0.0 goto equal
+    if $N4 >= 0.0 goto equal
+    unless $N4 goto equal
+    goto done
+  equal:
+    $I2 = 1
+  done:
+    say $I2
+    $I3 = 0
+    if $N4 goto true
+    goto next
+  true:
+    $I3 = 1
+  next:
+    say $I3
+    $N5 = 1.0
+    $I4 = 0
+    unless $N5 > 0.5 goto skip
+    $I4 = 1
+  skip:
+    say $I4
+.end
+END_PIR
+
+same_as_fast( <<'END_PIR', "55\n6765\n", 'calls and recursion' );
+.sub 'main' :main
+    $I0 = 'sum'(10)
+    say $I0
+    $I1 = 'fib'(20)
+    say $I1
+.end
+
+.sub 'sum'
+    .param int n
+    $I0 = 0
+  loop:
+    unless n goto done
+    $I0 += n
+    dec n
+    goto loop
+  done:
+    .return ($I0)
+.end
+
+.sub 'fib'
+    .param int n
+    if n >= 2 goto recurse
+    .return (n)
+  recurse:
+    $I0 = n - 1
+    $I1 = 'fib'($I0)
+    $I2 = n - 2
+    $I3 = 'fib'($I2)
+    $I4 = $I1 + $I3
+    .return ($I4)
+.end
+END_PIR
+
+same_as_fast( <<'END_PIR', "caught 3\nhandled 5\n", 'exceptions' );
+.sub 'main' :main
+    $I0 = 0
+    push_eh handler
+  loop:
+    inc $I0
+    if $I0 < 3 goto loop
+    die 'boom'
+    say 'not reached'
+  handler:
+    pop_eh
+    print 'caught '
+    say $I0
+    $I1 = 'thrower'(5)
+    print 'handled '
+    say $I1
+.end
+
+.sub 'thrower'
+    .param int n
+    push_eh handler
+    $I0 = 10 / 0
+    .return (0)
+  handler:
+    .return (n)
+.end
+END_PIR
+
+same_as_fast( <<'END_PIR', "3\n1\n", 'integer compares and unless' );
+.sub 'main' :main
+    $I0 = 0
+    $I1 = 5
+    $I2 = 0
+  loop:
+    inc $I0
+    ne $I0, 3, skip
+    $I2 = $I0
+  skip:
+    le $I0, $I1, loop
+    say $I2
+    $I3 = 0
+    eq $I0, 6, yes
+    goto done
+  yes:
+    $I3 = 1
+  done:
+    say $I3
+.end
+END_PIR
+
+sub create_pir_file {
+    my $code = shift;
+
+    my ( $fh, $filename ) = tempfile( UNLINK => 1, SUFFIX => '.pir' );
+    print $fh $code;
+    close $fh;
+
+    return $filename;
+}
+
+# Local Variables:
+#   mode: cperl
+#   cperl-indent-level: 4
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4:
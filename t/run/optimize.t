@@ -0,0 +1,271 @@
+#!perl
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/run/optimize.t - test the IMCC optimizer levels
+
+=head1 SYNOPSIS
+
+    % prove t/run/optimize.t
+
+=head1 DESCRIPTION
+
+Runs programs with each of C<-O0> to C<-O3> and checks they give the same
+results, then disassembles the bytecode of C<-O3> to check that the
+redundant and loop-invariant work is gone, and that the PMCs which never
+escape are replaced by registers.
+
+=cut
+
+use strict;
+use warnings;
+use lib qw( lib . ../lib ../../lib );
+
+use Test::More tests => 45;
+use Parrot::Config;
+use File::Temp 0.13 qw/tempfile/;
+
+my $PARROT = ".$PConfig{slash}$PConfig{test_prog}";
+my $DISASM = ".$PConfig{slash}pbc_disassemble$PConfig{exe}";
+
+# redirect STDERR to read the error messages
+my $redir = '2>&1';
+
+sub same_at_all_levels {
+    my ( $code, $expected, $desc ) = @_;
+    my $file = create_file( $code, '.pir' );
+
+    for my $level ( 0 .. 3 ) {
+        is( `"$PARROT" -O$level "$file" $redir`, $expected, "$desc (-O$level)" );
+    }
+    return $file;
+}
+
+sub ops_at {
+    my ( $level, $file ) = @_;
+    my ( undef, $pbc ) = tempfile( UNLINK => 1, SUFFIX => '.pbc' );
+
+    `"$PARROT" -O$level -o "$pbc" "$file" $redir`;
+    return join '', grep { /^\d+-\d+\s/ } `"$DISASM" "$pbc" $redir`;
+}
+
+my $loop = same_at_all_levels( <<'END_PIR', "4200\n150\n11\n", 'loop with invariants' );
+.sub 'main' :main
+    .local int i, n, k, s
+    .local num f
+    n = 100
+    k = 7
+    s = 0
+    i = 0
+    f = 0.0
+  loop:
+    $I0 = k * 3
+    $I1 = k * 3
+    $I2 = $I0 + $I1
+    $I3 = $I2
+    s += $I3
+    $N0 = 1.5
+    f += $N0
+    inc i
+    if i < n goto loop
+    say s
+    say f
+    $I5 = 10
+    $I6 = $I5 + 1
+    say $I6
+.end
+END_PIR
+
+my $ops = ops_at( 3, $loop );
+unlike( $ops, qr/\bmul_i/, 'repeated multiplication folded away' );
+like( $ops, qr/add_i_ic I\d+,42/, 'copies and constants propagated into the loop' );
+like( $ops, qr/say_ic 11/, 'constant result propagated to its use' );
+
+my $reuse = same_at_all_levels( <<'END_PIR', "30\n30\n5\n", 'value reused across blocks' );
+.sub 'main' :main
+    .local int a, b
+    a = 'five'()
+    b = 'six'()
+    $I0 = a * b
+    if a > 3 goto big
+    $I1 = 0
+    goto done
+  big:
+    $I1 = a * b
+  done:
+    say $I0
+    say $I1
+    say a
+.end
+
+.sub 'five'
+    .return (5)
+.end
+
+.sub 'six'
+    .return (6)
+.end
+END_PIR
+
+is( scalar( () = ops_at( 2, $reuse ) =~ /\bmul_i/g ), 1, 'dominated recomputation removed' );
+
+my $invariant = same_at_all_levels( <<'END_PIR', "2100\n", 'invariant of a loop' );
+.sub 'main' :main
+    .local int i, k, s
+    k = 'seven'()
+    s = 0
+    i = 0
+  loop:
+    $I0 = k * 3
+    s += $I0
+    inc i
+    if i < 100 goto loop
+    say s
+.end
+
+.sub 'seven'
+    .return (7)
+.end
+END_PIR
+
+like( ops_at( 2, $invariant ), qr/^\S+ \S+ \s*L\d+:\s*mul_i/m, 'invariant left in the loop at -O2' );
+like( ops_at( 3, $invariant ), qr/mul_i\S* [^\n]*\n[^\n]*L\d+:/, 'invariant hoisted at -O3' );
+
+same_at_all_levels( <<'END_PIR', "caught 3\n6\n", 'exception handlers keep their values' );
+.sub 'main' :main
+    $I0 = 0
+    $I1 = 2
+    push_eh handler
+  loop:
+    inc $I0
+    $I2 = $I1 * 3
+    if $I0 < 3 goto loop
+    die 'boom'
+    say 'not reached'
+  handler:
+    pop_eh
+    print 'caught '
+    say $I0
+    say $I2
+.end
+END_PIR
+
+same_at_all_levels( <<'END_PIR', "ab\n3\n", 'strings and registers set twice' );
+.sub 'main' :main
+    $S0 = 'a'
+    $S1 = 'b'
+    $S2 = $S0 . $S1
+    say $S2
+    $I0 = 1
+    $I1 = $I0 + 1
+    $I0 = $I1 + 1
+    say $I0
+.end
+END_PIR
+
+same_at_all_levels( <<'END_PIR', "5\nnot taken\n2\n7\n", 'constants of branches, conversions and calls' );
+.sub 'main' :main
+    $I0 = 5
+    unless $I0 goto skip
+    say $I0
+  skip:
+    $I1 = 0
+    if $I1 goto done
+    say 'not taken'
+    $N0 = 2.5
+    $I2 = $N0
+    say $I2
+    $I3 = 1
+    $I3 = 'seven'()
+    say $I3
+  done:
+.end
+
+.sub 'seven'
+    .return (7)
+.end
+END_PIR
+
+my $scalars = same_at_all_levels( <<'END_PIR', "4\n109\n109\n4\n", 'PMCs which never escape' );
+.sub 'main' :main
+    $P0 = new ['Integer']
+    $P1 = new 'Float'
+    $I0 = 0
+    $P1 = 0.5
+  loop:
+    $P0 = $I0
+    $P1 += 1.5
+    $P1 *= 2.0
+    inc $I0
+    if $I0 < 5 goto loop
+    say $P0
+    $N0 = $P1
+    say $N0
+    $I1 = $P1
+    say $I1
+    unless $P0 goto done
+    $S0 = $P0
+    say $S0
+  done:
+.end
+END_PIR
+
+$ops = ops_at( 2, $scalars );
+unlike( $ops, qr/\bnew_p/, 'Integer and Float replaced by registers' );
+like( $ops, qr/add_n_nc N\d+,1.5/, 'arithmetic on the register' );
+
+same_at_all_levels( <<'END_PIR', "5\n", 'replaced PMC as a branch condition' );
+.sub 'main' :main
+    $P0 = new 'Integer'
+    $P0 = 5
+    unless $P0 goto no
+    say $P0
+  no:
+.end
+END_PIR
+
+my $escapes = same_at_all_levels( <<'END_PIR', "8\n8\nFloat\n5\n", 'PMCs which escape' );
+.sub 'main' :main
+    $P0 = new 'Integer'
+    $P0 = 7
+    inc $P0
+    say $P0
+    $P1 = new 'Integer'
+    $P1 = 8
+    'show'($P1)
+    $P2 = new 'Float'
+    $P2 = 2.5
+    $P2 = 5
+    $P3 = new 'Float'
+    $P4 = $P3
+    $P4 = 5.5
+    $S0 = typeof $P3
+    say $S0
+    say $P2
+.end
+
+.sub 'show'
+    .param pmc p
+    say p
+.end
+END_PIR
+
+is( scalar( () = ops_at( 2, $escapes ) =~ /\bnew_p/g ), 4, 'PMCs which escape kept' );
+
+sub create_file {
+    my ( $code, $suffix ) = @_;
+
+    my ( $fh, $filename ) = tempfile( UNLINK => 1, SUFFIX => $suffix );
+    print $fh $code;
+    close $fh;
+
+    return $filename;
+}
+
+# Local Variables:
+#   mode: cperl
+#   cperl-indent-level: 4
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4:
@@ -19,7 +19,7 @@ use strict;
 use warnings;
 use lib qw( lib . ../lib ../../lib );
 
-use Test::More tests => 40;
+use Test::More tests => 42;
 use Parrot::Config;
 use File::Temp 0.13 qw/tempfile/;
 use File::Spec;
@@ -90,6 +90,37 @@ $cmd = qq{"$PARROT" -D 8 -R slow "$second_pir_file" 2>&1};
 like( qx{$cmd}, qr/Parrot VM: slow core/, "-r option <$cmd>" );
 }
 
+# the sampling profiler writes folded stacks of the subs it saw running
+{
+my ( $fh, $busy_pir_file ) = tempfile( SUFFIX => '.pir', UNLINK => 1 );
+print $fh <<'END_PIR';
+.sub main :main
+  busy()
+  say "done"
+.end
+
+.sub busy
+  $I0 = 0
+  loop:
+    inc $I0
+    if $I0 < 20000000 goto loop
+.end
+END_PIR
+close $fh;
+
+my ( undef, $folded_file ) = tempfile( SUFFIX => '.folded', UNLINK => 1 );
+local $ENV{PARROT_SAMPLING_FILENAME} = $folded_file;
+local $ENV{PARROT_SAMPLING_INTERVAL} = 100;
+
+is( qx{"$PARROT" -R sampling "$busy_pir_file" $redir}, "done\n", '-R sampling runs the program' );
+
+open my $in, '<', $folded_file or die "couldn't open $folded_file: $!";
+my $folded = do { local $/; <$in> };
+close $in;
+like( $folded, qr/main \(\S+:\d+\);\S*busy \(\S+:\d+\) \d+$/m,
+    '-R sampling records folded stacks' );
+}
+
 ## GH #346 test remaining options
 
 # Test --runtime-prefix
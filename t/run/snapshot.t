@@ -0,0 +1,126 @@
+#!perl
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/run/snapshot.t - test parrot --snapshot-out and --snapshot-in
+
+=head1 SYNOPSIS
+
+    % prove t/run/snapshot.t
+
+=head1 DESCRIPTION
+
+Tests writing a snapshot of a program after its C<:init> subs have run, and
+starting the program again from it.
+
+=cut
+
+use strict;
+use warnings;
+use lib qw( lib . ../lib ../../lib );
+
+use Test::More tests => 7;
+use Parrot::Config;
+use File::Temp 0.13 qw/tempfile/;
+use File::Spec;
+
+my $PARROT = ".$PConfig{slash}$PConfig{test_prog}";
+
+# redirect STDERR to read the error messages
+my $redir = '2>&1';
+
+my $program = create_pir_file(<<'END_PIR');
+.sub 'setup' :init
+    say 'init ran'
+    $P0 = new ['Integer']
+    $P0 = 42
+    set_global 'answer', $P0
+    $P1 = newclass 'Point'
+    addattribute $P1, 'x'
+    $P2 = new 'Point'
+    $P3 = box 7
+    setattribute $P2, 'x', $P3
+    set_global 'origin', $P2
+    $P4 = subclass 'Point', 'Point3'
+.end
+
+.sub 'main' :main
+    .param pmc argv
+    $P0 = get_global 'answer'
+    say $P0
+    $P1 = get_global 'origin'
+    $P2 = getattribute $P1, 'x'
+    say $P2
+    $S0 = typeof $P1
+    say $S0
+    $P3 = new 'Point3'
+    $I0 = isa $P3, 'Point'
+    say $I0
+    $P4 = $P1.'hello'()
+    say $P4
+    $S0 = join ' ', argv
+    say $S0
+.end
+
+.namespace ['Point']
+.sub 'hello' :method
+    .return ('hi')
+.end
+END_PIR
+
+my ( undef, $snapshot ) = tempfile( UNLINK => 1, SUFFIX => '.snap' );
+
+is( `"$PARROT" --snapshot-out="$snapshot" "$program" $redir`, "init ran\n",
+    'writing a snapshot runs the :init subs only' );
+is( $?, 0, '... and succeeds' );
+ok( -s $snapshot, '... and writes the file' );
+
+is( `"$PARROT" --snapshot-in="$snapshot" a b $redir`,
+    "42\n7\nPoint\n1\nhi\n$snapshot a b\n",
+    'running from a snapshot keeps globals, classes and objects' );
+
+my $closure = create_pir_file(<<'END_PIR');
+.sub 'setup' :init
+    .lex '$x', $P0
+    $P0 = box 1
+    .const 'Sub' inner = 'inner'
+    $P1 = newclosure inner
+    set_global 'counter', $P1
+.end
+
+.sub 'inner' :outer('setup')
+    $P0 = find_lex '$x'
+    say $P0
+.end
+
+.sub 'main' :main
+.end
+END_PIR
+
+my ( undef, $bad_snapshot ) = tempfile( UNLINK => 1, SUFFIX => '.snap' );
+
+like( `"$PARROT" --snapshot-out="$bad_snapshot" "$closure" $redir`,
+    qr/Cannot freeze sub 'inner': it is a closure/,
+    'a closure cannot be kept' );
+isnt( $?, 0, '... and writing fails' );
+
+like( `"$PARROT" --snapshot-in="$program" $redir`, qr/is not a Parrot snapshot/,
+    'reading something else as a snapshot fails' );
+
+sub create_pir_file {
+    my $code = shift;
+
+    my ( $fh, $filename ) = tempfile( UNLINK => 1, SUFFIX => '.pir' );
+    print $fh $code;
+    close $fh;
+
+    return $filename;
+}
+
+# Local Variables:
+#   mode: cperl
+#   cperl-indent-level: 4
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4:
@@ -14,7 +14,7 @@ my $parrot_config = "parrot_config" . $PConfig{o};
 
 plan skip_all => 'src/parrot_config.o does not exist' unless -e catfile("src", $parrot_config);
 
-plan tests => 9;
+plan tests => 10;
 
 =head1 NAME
 
@@ -298,6 +298,38 @@ int main(void) {
 CODE
 OUTPUT
 
+c_output_is( linedirective(__LINE__) . <<"CODE", << 'OUTPUT', "Parrot_api_get_metrics");
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "parrot/api.h"
+
+int main(void) {
+    Parrot_PMC interp, metrics, hist, buckets;
+    Parrot_String key;
+    Parrot_Int allocs, count;
+
+    Parrot_api_make_interpreter(NULL, 0, NULL, &interp);
+    Parrot_api_get_metrics(interp, &metrics);
+
+    Parrot_api_string_import_ascii(interp, "pmc_allocs", &key);
+    Parrot_api_pmc_get_keyed_string(interp, metrics, key, &hist);
+    Parrot_api_pmc_get_integer(interp, hist, &allocs);
+    printf("%s\\n", allocs > 0 ? "allocs counted" : "no allocs");
+
+    Parrot_api_string_import_ascii(interp, "gc_pause_ns", &key);
+    Parrot_api_pmc_get_keyed_string(interp, metrics, key, &hist);
+    Parrot_api_string_import_ascii(interp, "buckets", &key);
+    Parrot_api_pmc_get_keyed_string(interp, hist, key, &buckets);
+    Parrot_api_pmc_get_integer(interp, buckets, &count);
+    printf("%d buckets\\n", (int)count);
+    return 0;
+}
+CODE
+allocs counted
+32 buckets
+OUTPUT
+
 c_output_is( linedirective(__LINE__) . <<"CODE", << 'OUTPUT', "Parrot_api_(un)wrap_pointer");
 #include <stdio.h>
 #include <stdlib.h>
@@ -0,0 +1,94 @@
+#! perl
+# Copyright (C) 2012, Parrot Foundation.
+
+=head1 NAME
+
+t/tools/pprof2cg.t - test the binary profile converter
+
+=head1 SYNOPSIS
+
+    % prove t/tools/pprof2cg.t
+
+=head1 DESCRIPTION
+
+Runs a small program under the profiling runcore with binary output, checks
+the profile header and converts it with C<pprof2cg>, checking that the call
+graph in the Callgrind output is what would be expected.
+
+=cut
+
+use strict;
+use warnings;
+use lib qw( . lib ../lib ../../lib );
+use Test::More;
+use Parrot::Test;
+use Parrot::Config;
+use File::Temp qw( tempdir );
+use File::Spec;
+
+my $PARROT   = ".$PConfig{slash}$PConfig{test_prog}";
+my $PPROF2CG = ".$PConfig{slash}pprof2cg$PConfig{exe}";
+
+# Only test if we have the converter built.
+if ( -e $PPROF2CG ) {
+    plan tests => 8;
+}
+else {
+    plan skip_all => "pprof2cg not built";
+}
+
+my $dir   = tempdir( CLEANUP => 1 );
+my $pir   = File::Spec->catfile( $dir, 'prof.pir' );
+my $pprof = File::Spec->catfile( $dir, 'prof.pprof' );
+my $out   = File::Spec->catfile( $dir, 'prof.out' );
+
+open my $FILE, '>', $pir or die "can't write $pir: $!";
+print $FILE <<'PIR';
+.sub main :main
+    $I0 = 0
+  loop:
+    $I1 = square($I0)
+    inc $I0
+    if $I0 < 10 goto loop
+.end
+
+.sub square
+    .param int n
+    $I0 = n * n
+    .return ($I0)
+.end
+PIR
+close $FILE;
+
+{
+    local $ENV{PARROT_PROFILING_OUTPUT}   = 'binary';
+    local $ENV{PARROT_PROFILING_FILENAME} = $pprof;
+    my $stderr = `$PARROT -R profiling $pir 2>&1`;
+    is( $?, 0, 'profiled run succeeds' );
+    like( $stderr, qr/pprof2cg/, 'runcore points at the converter' );
+}
+
+open my $PPROF, '<:raw', $pprof or die "can't read $pprof: $!";
+read $PPROF, my $magic, 8;
+close $PPROF;
+is( $magic, 'PPROFBIN', 'profile starts with the binary magic' );
+
+my $msg = `$PPROF2CG $pprof $out`;
+is( $?, 0, 'converter succeeds' );
+like( $msg, qr/kcachegrind/, 'converter reports the output file' );
+
+open my $CG, '<', $out or die "can't read $out: $!";
+my $cg = do { local $/; <$CG> };
+close $CG;
+
+like( $cg, qr/^events: Ir$/m, 'callgrind header' );
+like( $cg, qr/^fn=parrot;main\n(?:\d+ \d+\n)*cfn=parrot;square\ncalls=10 4$/m,
+    'calls from main to square are counted' );
+like( $cg, qr/^totals: \d+$/m, 'totals line' );
+
+# Local Variables:
+#   mode: cperl
+#   cperl-indent-level: 4
+#   fill-column: 100
+# End:
+# vim: expandtab shiftwidth=4: